@@ -0,0 +1,206 @@
+#!/usr/bin/env python
+"""Run the SSA/tDPD benchmarks and report the timings as JSON
+
+  python run_bench.py                          all models, sizes and modes
+  python run_bench.py -m diffusion_2d -N 1e4 1e5 --modes ssa -n 1 4
+
+Every run is one LAMMPS invocation of in.<model> with -var N, mode and
+steps. Its log file is parsed for the loop time of the timed run, the
+number of SSA events printed by the input, the memory per rank and both
+timing tables (the MPI task breakdown and the SSA/tDPD breakdown).
+A run that fails is kept in the report with status "failed" and the
+first ERROR line, so a sweep continues past sizes that do not fit.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import platform
+import re
+import subprocess
+import sys
+import time
+
+MODELS = ["diffusion_2d", "natural_convection", "cylinder_annihilation",
+          "cell_model"]
+MODES = ["sdpd", "ssa", "hybrid"]
+SIZES = ["1e3", "1e4", "1e5", "1e6"]
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+loop_re = re.compile(r"^Loop time of (\S+) on (\d+) procs for (\d+) steps "
+                     r"with (\d+) atoms")
+events_re = re.compile(r"^SSA events = (\S+)")
+memory_re = re.compile(r"^Per MPI rank memory allocation \(min/avg/max\) = "
+                       r"(\S+) \| (\S+) \| (\S+) Mbytes")
+row_re = re.compile(r"^([^|]+?)\s*\|\s*(\S*)\s*\|\s*(\S+)\s*\|\s*(\S*)\s*\|"
+                    r"\s*(\S*)\s*\|\s*(\S+)\s*$")
+
+
+def number(s):
+    return float(s) if s else None
+
+
+def parse_log(text):
+    """values of the last (timed) run in a LAMMPS log"""
+    run = {}
+    table = None
+    memory = None
+    for line in text.splitlines():
+        m = loop_re.match(line)
+        if m:
+            run = {"loop_time": float(m.group(1)),
+                   "nprocs": int(m.group(2)),
+                   "steps": int(m.group(3)),
+                   "atoms": int(m.group(4)),
+                   "timers": {}, "ssa_timers": {}}
+            table = None
+            continue
+        m = memory_re.match(line)
+        if m:
+            memory = float(m.group(3))
+            continue
+        m = events_re.match(line)
+        if m:
+            run["ssa_events"] = float(m.group(1))
+            continue
+        if not run:
+            continue
+        if line.startswith("MPI task timing breakdown"):
+            table = run["timers"]
+        elif line.startswith("SSA/tDPD breakdown"):
+            table = run["ssa_timers"]
+        elif not line.strip():
+            table = None
+        elif table is not None:
+            m = row_re.match(line)
+            if m and m.group(1) != "Section":
+                table[m.group(1)] = {"min": number(m.group(2)),
+                                     "avg": number(m.group(3)),
+                                     "max": number(m.group(4)),
+                                     "varavg": number(m.group(5)),
+                                     "total_percent": number(m.group(6))}
+    if run and memory is not None:
+        run["memory_mb"] = memory
+    return run
+
+
+def first_error(text):
+    for line in text.splitlines():
+        if line.startswith("ERROR"):
+            return line.strip()
+    return None
+
+
+def run_one(args, model, mode, size, np):
+    name = "%s.%s.%s.%d" % (model, mode, size, np)
+    log = os.path.join(args.logdir, "log." + name)
+    cmd = args.mpirun.format(np=np).split() + [
+        args.lmp, "-in", os.path.join(HERE, "in." + model),
+        "-var", "N", str(int(float(size))), "-var", "mode", mode,
+        "-var", "steps", str(args.steps), "-log", log]
+
+    result = {"model": model, "mode": mode, "N": int(float(size)),
+              "nprocs": np, "command": " ".join(cmd)}
+    start = time.time()
+    try:
+        proc = subprocess.Popen(cmd, stdout=subprocess.PIPE,
+                                stderr=subprocess.STDOUT,
+                                universal_newlines=True)
+        output = proc.communicate()[0]
+        status = proc.returncode
+    except OSError as e:
+        output, status = str(e), -1
+    result["wall"] = time.time() - start
+
+    text = open(log).read() if os.path.exists(log) else ""
+    run = parse_log(text)
+    if status != 0 or "ssa_events" not in run:
+        result["status"] = "failed"
+        lines = text.strip().splitlines() or [""]
+        result["error"] = first_error(output) or first_error(text) or \
+            "exit status %d after: %s" % (status, lines[-1])
+        return result
+
+    result.update(run)
+    t = run["loop_time"]
+    result["status"] = "ok"
+    result["steps_per_s"] = run["steps"]/t if t > 0 else None
+    result["particle_steps_per_s"] = \
+        run["atoms"]*run["steps"]/t if t > 0 else None
+    result["ssa_events_per_s"] = run["ssa_events"]/t if t > 0 else None
+    return result
+
+
+def lammps_version(logdir):
+    """version string in the first log of the sweep, e.g. 31 Mar 2017"""
+    for name in sorted(os.listdir(logdir)):
+        with open(os.path.join(logdir, name)) as f:
+            m = re.match(r"LAMMPS \((.*)\)", f.readline())
+        if m:
+            return m.group(1)
+    return None
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    p.add_argument("-l", "--lmp",
+                   default=os.path.join(HERE, "..", "src", "lmp_mpi"),
+                   help="LAMMPS executable (default ../src/lmp_mpi)")
+    p.add_argument("-m", "--models", nargs="+", default=MODELS,
+                   choices=MODELS)
+    p.add_argument("--modes", nargs="+", default=MODES, choices=MODES)
+    p.add_argument("-N", "--sizes", nargs="+", default=SIZES,
+                   help="approximate particle counts (default 1e3 .. 1e6)")
+    p.add_argument("-n", "--nprocs", nargs="+", type=int, default=[1],
+                   help="MPI process counts (default 1)")
+    p.add_argument("-s", "--steps", type=int, default=200,
+                   help="timesteps of each timed run (default 200)")
+    p.add_argument("--mpirun", default="mpirun -np {np}",
+                   help="launcher, {np} is replaced (default '%(default)s')")
+    p.add_argument("--logdir", default="logs",
+                   help="directory of the LAMMPS logs (default logs)")
+    p.add_argument("-o", "--output", default="bench.json",
+                   help="JSON report, - for stdout (default bench.json)")
+    args = p.parse_args()
+
+    if not os.path.isdir(args.logdir):
+        os.makedirs(args.logdir)
+
+    report = {"lammps": None,
+              "host": platform.node(),
+              "date": time.strftime("%Y-%m-%d %H:%M:%S"),
+              "steps": args.steps, "runs": []}
+
+    for model in args.models:
+        for mode in args.modes:
+            for size in args.sizes:
+                for np in args.nprocs:
+                    r = run_one(args, model, mode, size, np)
+                    report["runs"].append(r)
+                    if r["status"] == "ok":
+                        print("%-22s %-6s N=%-8d np=%-3d %10.1f steps/s "
+                              "%12.4g particle-steps/s %12.4g events/s" %
+                              (model, mode, r["atoms"], np, r["steps_per_s"],
+                               r["particle_steps_per_s"],
+                               r["ssa_events_per_s"]), file=sys.stderr)
+                    else:
+                        print("%-22s %-6s N=%-8s np=%-3d failed: %s" %
+                              (model, mode, size, np, r["error"]),
+                              file=sys.stderr)
+
+    report["lammps"] = lammps_version(args.logdir)
+
+    if args.output == "-":
+        json.dump(report, sys.stdout, indent=2)
+        print()
+    else:
+        with open(args.output, "w") as f:
+            json.dump(report, f, indent=2)
+            f.write("\n")
+
+
+if __name__ == "__main__":
+    main()
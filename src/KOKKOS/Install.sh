@@ -55,6 +55,8 @@ action atom_vec_kokkos.cpp
 action atom_vec_kokkos.h
 action atom_vec_molecular_kokkos.cpp atom_vec_molecular.cpp
 action atom_vec_molecular_kokkos.h atom_vec_molecular.h
+action atom_vec_ssa_tsdpd_kokkos.cpp atom_vec_ssa_tsdpd.cpp
+action atom_vec_ssa_tsdpd_kokkos.h atom_vec_ssa_tsdpd.h
 action bond_class2_kokkos.cpp bond_class2.cpp 
 action bond_class2_kokkos.h bond_class2.h
 action bond_fene_kokkos.cpp bond_fene.cpp
@@ -97,6 +99,8 @@ action fix_reaxc_species_kokkos.cpp fix_reaxc_species.cpp
 action fix_reaxc_species_kokkos.h fix_reaxc_species.h
 action fix_setforce_kokkos.cpp
 action fix_setforce_kokkos.h
+action fix_ssa_tsdpd_verlet_kokkos.cpp fix_ssa_tsdpd_verlet.cpp
+action fix_ssa_tsdpd_verlet_kokkos.h fix_ssa_tsdpd_verlet.h
 action fix_momentum_kokkos.cpp
 action fix_momentum_kokkos.h
 action fix_wall_reflect_kokkos.cpp
@@ -185,6 +189,8 @@ action pair_morse_kokkos.cpp
 action pair_morse_kokkos.h
 action pair_reax_c_kokkos.cpp pair_reax_c.cpp
 action pair_reax_c_kokkos.h pair_reax_c.h
+action pair_ssa_tsdpd_wt_kokkos.cpp pair_ssa_tsdpd_wt.cpp
+action pair_ssa_tsdpd_wt_kokkos.h pair_ssa_tsdpd_wt.h
 action pair_sw_kokkos.cpp pair_sw.cpp
 action pair_sw_kokkos.h pair_sw.h
 action pair_vashishta_kokkos.cpp pair_vashishta.cpp
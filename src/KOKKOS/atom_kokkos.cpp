@@ -73,6 +73,21 @@ AtomKokkos::~AtomKokkos()
   memory->destroy_kokkos(k_improper_atom2, improper_atom2);
   memory->destroy_kokkos(k_improper_atom3, improper_atom3);
   memory->destroy_kokkos(k_improper_atom4, improper_atom4);
+
+  memory->destroy_kokkos(k_rho, rho);
+  memory->destroy_kokkos(k_drho, drho);
+  memory->destroy_kokkos(k_e, e);
+  memory->destroy_kokkos(k_de, de);
+  memory->destroy_kokkos(k_cv, cv);
+  memory->destroy_kokkos(k_vest, vest);
+  memory->destroy_kokkos(k_C);
+  memory->destroy_kokkos(k_Q);
+  memory->destroy_kokkos(k_Cd);
+  memory->destroy_kokkos(k_Qd);
+  C.destroy(memory);
+  Q.destroy(memory);
+  Cd.destroy(memory);
+  Qd.destroy(memory);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -169,7 +184,7 @@ void AtomKokkos::sort()
 
   n = 0;
   for (m = 0; m < nbins; m++) {
-    i = binhead[m];
+    i = binhead[binorder[m]];
     while (i >= 0) {
       permute[n++] = i;
       i = next[i];
@@ -51,6 +51,11 @@ class AtomKokkos : public Atom {
   DAT::tdual_int_2d k_improper_type;
   DAT::tdual_tagint_2d k_improper_atom1, k_improper_atom2, k_improper_atom3, k_improper_atom4;
 
+  DAT::tdual_float_1d k_rho, k_drho, k_e, k_de, k_cv;
+  DAT::tdual_v_array k_vest;
+  DAT::tdual_float_2d k_C, k_Q;
+  DAT::tdual_int_2d k_Cd, k_Qd;
+
   AtomKokkos(class LAMMPS *);
   ~AtomKokkos();
 
@@ -0,0 +1,1351 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+#include "atom_vec_ssa_tsdpd_kokkos.h"
+#include "atom_kokkos.h"
+#include "comm_kokkos.h"
+#include "domain.h"
+#include "force.h"
+#include "modify.h"
+#include "fix.h"
+#include "atom_masks.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define DELTA 10000
+
+// layout of the per-atom restart record, same as atom_style ssa_tsdpd
+
+#define RESTART_VERSION 2
+
+/* ---------------------------------------------------------------------- */
+
+AtomVecSsaTsdpdKokkos::AtomVecSsaTsdpdKokkos(LAMMPS *lmp) : AtomVecKokkos(lmp)
+{
+  molecular = 0;
+  mass_type = 1;
+  forceclearflag = 1;
+
+  comm_x_only = 0;
+  comm_f_only = 0;
+  size_forward = 8;
+  size_reverse = 5;
+  size_border = 12;
+  size_velocity = 3;
+  size_data_atom = 8;
+  size_data_vel = 4;
+  xcol_data = 6;
+
+  atom->e_flag = 1;
+  atom->rho_flag = 1;
+  atom->cv_flag = 1;
+  atom->vest_flag = 1;
+  atom->tsdpd_flag = 1;
+
+  size_ssa = 0;
+
+  atomKK = (AtomKokkos *) atom;
+  commKK = (CommKokkos *) comm;
+}
+
+/* ----------------------------------------------------------------------
+   process additional args, same syntax as atom_style ssa_tsdpd
+------------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::process_args(int narg, char **arg)
+{
+  if (narg < 2) error->all(FLERR,"Invalid atom_style ssa_tsdpd/kk command");
+
+  // C, Q, Cd, Qd are views of the host side of atom-major dual views
+  // the device kernels advance a single SSA realization
+
+  while (narg >= 4 && (strcmp(arg[narg-2],"layout") == 0 ||
+                       strcmp(arg[narg-2],"ensemble") == 0)) {
+    if (strcmp(arg[narg-2],"layout") == 0 && strcmp(arg[narg-1],"atom") != 0)
+      error->all(FLERR,"Atom_style ssa_tsdpd/kk requires layout atom");
+    if (strcmp(arg[narg-2],"ensemble") == 0 &&
+        force->inumeric(FLERR,arg[narg-1]) != 1)
+      error->all(FLERR,"Atom_style ssa_tsdpd/kk requires ensemble 1");
+    narg -= 2;
+  }
+
+  atom->num_tdpd_species = atoi(arg[0]);
+  atom->num_ssa_species = atoi(arg[1]);
+  if (narg < 3) atom->num_ssa_reactions = 0;
+  else atom->num_ssa_reactions = atoi(arg[2]);
+
+  atom->concentration_conversion = 1.0;
+  if (narg >= 4) {
+    if (strcmp(arg[3],"concentration") == 0) atom->Cd_concentration_flag = 1;
+    else if (strcmp(arg[3],"population") == 0) atom->Cd_concentration_flag = 0;
+  }
+  if (narg == 5) atom->concentration_conversion = atof(arg[4]);
+
+  const int ntdpd = atom->num_tdpd_species;
+  const int nssa = atom->num_ssa_species;
+  const int nrxn = atom->num_ssa_reactions;
+
+  size_ssa = nrxn + 2*nrxn*nssa;
+
+  size_forward += ntdpd + nssa + size_ssa;
+  size_reverse += ntdpd + nssa;
+  size_border += ntdpd + nssa + size_ssa;
+  size_data_atom += ntdpd + nssa + nrxn + nrxn*nssa;
+}
+
+/* ----------------------------------------------------------------------
+   grow a per-species dual view, the SpeciesArray views its host data
+------------------------------------------------------------------------- */
+
+template<class TYPE, class T>
+static void grow_species(Memory *memory, TYPE &k_data, SpeciesArray<T> &array,
+                         int n1, int n2, const char *name)
+{
+  if (array.data == NULL) memory->create_kokkos(k_data,n1,n2,name);
+  else k_data.resize(n1,n2);
+  array.wrap(k_data.h_view.ptr_on_device(),n1,n2,k_data.h_view.stride_0());
+}
+
+/* ----------------------------------------------------------------------
+   grow atom arrays
+   n = 0 grows arrays by DELTA
+   n > 0 allocates arrays to size n
+------------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::grow(int n)
+{
+  int nssa = atom->num_ssa_species;
+  int nrxn = atom->num_ssa_reactions;
+
+  if (n == 0) nmax += DELTA;
+  else nmax = n;
+  atomKK->nmax = nmax;
+  if (nmax < 0 || nmax > MAXSMALLINT)
+    error->one(FLERR,"Per-processor system is too big");
+
+  sync(Device,ALL_MASK);
+  modified(Device,ALL_MASK);
+
+  memory->grow_kokkos(atomKK->k_tag,atomKK->tag,nmax,"atom:tag");
+  memory->grow_kokkos(atomKK->k_type,atomKK->type,nmax,"atom:type");
+  memory->grow_kokkos(atomKK->k_mask,atomKK->mask,nmax,"atom:mask");
+  memory->grow_kokkos(atomKK->k_image,atomKK->image,nmax,"atom:image");
+
+  memory->grow_kokkos(atomKK->k_x,atomKK->x,nmax,3,"atom:x");
+  memory->grow_kokkos(atomKK->k_v,atomKK->v,nmax,3,"atom:v");
+  memory->grow_kokkos(atomKK->k_f,atomKK->f,nmax,3,"atom:f");
+
+  memory->grow_kokkos(atomKK->k_rho,atomKK->rho,nmax,"atom:rho");
+  memory->grow_kokkos(atomKK->k_drho,atomKK->drho,nmax,"atom:drho");
+  memory->grow_kokkos(atomKK->k_e,atomKK->e,nmax,"atom:e");
+  memory->grow_kokkos(atomKK->k_de,atomKK->de,nmax,"atom:de");
+  memory->grow_kokkos(atomKK->k_cv,atomKK->cv,nmax,"atom:cv");
+  memory->grow_kokkos(atomKK->k_vest,atomKK->vest,nmax,3,"atom:vest");
+
+  grow_species(memory,atomKK->k_C,atomKK->C,nmax,atom->num_tdpd_species,
+               "atom:C");
+  grow_species(memory,atomKK->k_Q,atomKK->Q,nmax,atom->num_tdpd_species,
+               "atom:Q");
+  grow_species(memory,atomKK->k_Cd,atomKK->Cd,nmax,nssa,"atom:Cd");
+  grow_species(memory,atomKK->k_Qd,atomKK->Qd,nmax,nssa,"atom:Qd");
+
+  if (nrxn > 0)
+    memory->grow(atom->ssa_rxn_propensity,nmax,nrxn,"atom:ssa_rxn_propensity");
+  if (nrxn > 0 && nssa > 0) {
+    memory->grow(atom->d_ssa_rxn_prop_d_c,nmax,nrxn,nssa,
+                 "atom:d_ssa_rxn_prop_d_c");
+    memory->grow(atom->ssa_stoich_matrix,nmax,nrxn,nssa,
+                 "atom:ssa_stoich_matrix");
+  }
+
+  grow_reset();
+  sync(Host,ALL_MASK);
+
+  if (atom->nextra_grow)
+    for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
+      modify->fix[atom->extra_grow[iextra]]->grow_arrays(nmax);
+}
+
+/* ----------------------------------------------------------------------
+   reset local array ptrs
+------------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::grow_reset()
+{
+  tag = atomKK->tag;
+  d_tag = atomKK->k_tag.d_view;
+  h_tag = atomKK->k_tag.h_view;
+
+  type = atomKK->type;
+  d_type = atomKK->k_type.d_view;
+  h_type = atomKK->k_type.h_view;
+  mask = atomKK->mask;
+  d_mask = atomKK->k_mask.d_view;
+  h_mask = atomKK->k_mask.h_view;
+  image = atomKK->image;
+  d_image = atomKK->k_image.d_view;
+  h_image = atomKK->k_image.h_view;
+
+  x = atomKK->x;
+  d_x = atomKK->k_x.d_view;
+  h_x = atomKK->k_x.h_view;
+  v = atomKK->v;
+  d_v = atomKK->k_v.d_view;
+  h_v = atomKK->k_v.h_view;
+  f = atomKK->f;
+  d_f = atomKK->k_f.d_view;
+  h_f = atomKK->k_f.h_view;
+
+  rho = atomKK->rho;
+  d_rho = atomKK->k_rho.d_view;
+  h_rho = atomKK->k_rho.h_view;
+  drho = atomKK->drho;
+  d_drho = atomKK->k_drho.d_view;
+  h_drho = atomKK->k_drho.h_view;
+  e = atomKK->e;
+  d_e = atomKK->k_e.d_view;
+  h_e = atomKK->k_e.h_view;
+  de = atomKK->de;
+  d_de = atomKK->k_de.d_view;
+  h_de = atomKK->k_de.h_view;
+  cv = atomKK->cv;
+  d_cv = atomKK->k_cv.d_view;
+  h_cv = atomKK->k_cv.h_view;
+  vest = atomKK->vest;
+  d_vest = atomKK->k_vest.d_view;
+  h_vest = atomKK->k_vest.h_view;
+
+  C = atomKK->C;
+  d_C = atomKK->k_C.d_view;
+  h_C = atomKK->k_C.h_view;
+  Q = atomKK->Q;
+  d_Q = atomKK->k_Q.d_view;
+  h_Q = atomKK->k_Q.h_view;
+  Cd = atomKK->Cd;
+  d_Cd = atomKK->k_Cd.d_view;
+  h_Cd = atomKK->k_Cd.h_view;
+  Qd = atomKK->Qd;
+  d_Qd = atomKK->k_Qd.d_view;
+  h_Qd = atomKK->k_Qd.h_view;
+
+  ssa_rxn_propensity = atom->ssa_rxn_propensity;
+  d_ssa_rxn_prop_d_c = atom->d_ssa_rxn_prop_d_c;
+  ssa_stoich_matrix = atom->ssa_stoich_matrix;
+}
+
+/* ----------------------------------------------------------------------
+   pack/unpack the host-only SSA reaction block of one atom
+------------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_ssa(int i, double *buf)
+{
+  const int nssa = atom->num_ssa_species;
+  const int nrxn = atom->num_ssa_reactions;
+  int m = 0;
+
+  for (int r = 0; r < nrxn; r++) buf[m++] = ssa_rxn_propensity[i][r];
+  for (int r = 0; r < nrxn; r++)
+    for (int k = 0; k < nssa; k++) buf[m++] = d_ssa_rxn_prop_d_c[i][r][k];
+  for (int r = 0; r < nrxn; r++)
+    for (int k = 0; k < nssa; k++) buf[m++] = ssa_stoich_matrix[i][r][k];
+  return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::unpack_ssa(int i, double *buf)
+{
+  const int nssa = atom->num_ssa_species;
+  const int nrxn = atom->num_ssa_reactions;
+  int m = 0;
+
+  for (int r = 0; r < nrxn; r++) ssa_rxn_propensity[i][r] = buf[m++];
+  for (int r = 0; r < nrxn; r++)
+    for (int k = 0; k < nssa; k++) d_ssa_rxn_prop_d_c[i][r][k] = buf[m++];
+  for (int r = 0; r < nrxn; r++)
+    for (int k = 0; k < nssa; k++)
+      ssa_stoich_matrix[i][r][k] = static_cast<int> (buf[m++]);
+  return m;
+}
+
+/* ----------------------------------------------------------------------
+   copy atom I info to atom J
+------------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::copy(int i, int j, int delflag)
+{
+  const int nssa = atom->num_ssa_species;
+  const int nrxn = atom->num_ssa_reactions;
+
+  h_tag[j] = h_tag[i];
+  h_type[j] = h_type[i];
+  mask[j] = mask[i];
+  h_image[j] = h_image[i];
+  for (int k = 0; k < 3; k++) {
+    h_x(j,k) = h_x(i,k);
+    h_v(j,k) = h_v(i,k);
+    h_vest(j,k) = h_vest(i,k);
+  }
+  h_rho[j] = h_rho[i];
+  h_drho[j] = h_drho[i];
+  h_e[j] = h_e[i];
+  h_de[j] = h_de[i];
+  h_cv[j] = h_cv[i];
+  for (int k = 0; k < atom->num_tdpd_species; k++) h_C(j,k) = h_C(i,k);
+  for (int k = 0; k < nssa; k++) h_Cd(j,k) = h_Cd(i,k);
+
+  for (int r = 0; r < nrxn; r++) {
+    ssa_rxn_propensity[j][r] = ssa_rxn_propensity[i][r];
+    for (int k = 0; k < nssa; k++) {
+      d_ssa_rxn_prop_d_c[j][r][k] = d_ssa_rxn_prop_d_c[i][r][k];
+      ssa_stoich_matrix[j][r][k] = ssa_stoich_matrix[i][r][k];
+    }
+  }
+
+  if (atom->nextra_grow)
+    for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
+      modify->fix[atom->extra_grow[iextra]]->copy_arrays(i,j,delflag);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::force_clear(int n, size_t nbytes)
+{
+  sync(Host,DRHO_MASK | DE_MASK);
+  memset(&de[n],0,nbytes);
+  memset(&drho[n],0,nbytes);
+  modified(Host,DRHO_MASK | DE_MASK);
+}
+
+/* ----------------------------------------------------------------------
+   device comm is not provided, CommKokkos switches to classic comm
+   for atom styles that send more than coordinates
+------------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::device_comm_error()
+{
+  error->all(FLERR,"Atom style ssa_tsdpd/kk requires classic communication");
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_comm_kokkos(const int &n,
+                                            const DAT::tdual_int_2d &list,
+                                            const int & iswap,
+                                            const DAT::tdual_xfloat_2d &buf,
+                                            const int &pbc_flag,
+                                            const int* const pbc)
+{
+  device_comm_error();
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_comm_self(const int &n,
+                                          const DAT::tdual_int_2d &list,
+                                          const int & iswap,
+                                          const int nfirst,
+                                          const int &pbc_flag,
+                                          const int* const pbc)
+{
+  device_comm_error();
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::unpack_comm_kokkos(const int &n, const int &first,
+                                               const DAT::tdual_xfloat_2d &buf)
+{
+  device_comm_error();
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_border_kokkos(int n,
+                                              DAT::tdual_int_2d k_sendlist,
+                                              DAT::tdual_xfloat_2d buf,
+                                              int iswap, int pbc_flag,
+                                              int *pbc, ExecutionSpace space)
+{
+  device_comm_error();
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::unpack_border_kokkos(const int &n,
+                                                 const int &first,
+                                                 const DAT::tdual_xfloat_2d &buf,
+                                                 ExecutionSpace space)
+{
+  device_comm_error();
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_exchange_kokkos(const int &nsend,
+                                                DAT::tdual_xfloat_2d &k_buf,
+                                                DAT::tdual_int_1d k_sendlist,
+                                                DAT::tdual_int_1d k_copylist,
+                                                ExecutionSpace space, int dim,
+                                                X_FLOAT lo, X_FLOAT hi)
+{
+  device_comm_error();
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::unpack_exchange_kokkos(DAT::tdual_xfloat_2d &k_buf,
+                                                  int nrecv, int nlocal,
+                                                  int dim, X_FLOAT lo,
+                                                  X_FLOAT hi,
+                                                  ExecutionSpace space)
+{
+  device_comm_error();
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_comm(int n, int *list, double *buf,
+                                     int pbc_flag, int *pbc)
+{
+  int i,j,m;
+  double dx,dy,dz;
+
+  if (pbc_flag == 0) {
+    dx = dy = dz = 0.0;
+  } else if (domain->triclinic == 0) {
+    dx = pbc[0]*domain->xprd;
+    dy = pbc[1]*domain->yprd;
+    dz = pbc[2]*domain->zprd;
+  } else {
+    dx = pbc[0]*domain->xprd + pbc[5]*domain->xy + pbc[4]*domain->xz;
+    dy = pbc[1]*domain->yprd + pbc[3]*domain->yz;
+    dz = pbc[2]*domain->zprd;
+  }
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    buf[m++] = h_x(j,0) + dx;
+    buf[m++] = h_x(j,1) + dy;
+    buf[m++] = h_x(j,2) + dz;
+    buf[m++] = h_rho[j];
+    buf[m++] = h_e[j];
+    buf[m++] = h_vest(j,0);
+    buf[m++] = h_vest(j,1);
+    buf[m++] = h_vest(j,2);
+    for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = h_C(j,k);
+    for (int k = 0; k < atom->num_ssa_species; k++)
+      buf[m++] = (double) h_Cd(j,k);
+    m += pack_ssa(j,&buf[m]);
+  }
+  return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_comm_vel(int n, int *list, double *buf,
+                                         int pbc_flag, int *pbc)
+{
+  int i,j,m;
+  double dx,dy,dz;
+
+  if (pbc_flag == 0) {
+    dx = dy = dz = 0.0;
+  } else if (domain->triclinic == 0) {
+    dx = pbc[0]*domain->xprd;
+    dy = pbc[1]*domain->yprd;
+    dz = pbc[2]*domain->zprd;
+  } else {
+    dx = pbc[0]*domain->xprd + pbc[5]*domain->xy + pbc[4]*domain->xz;
+    dy = pbc[1]*domain->yprd + pbc[3]*domain->yz;
+    dz = pbc[2]*domain->zprd;
+  }
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    buf[m++] = h_x(j,0) + dx;
+    buf[m++] = h_x(j,1) + dy;
+    buf[m++] = h_x(j,2) + dz;
+    buf[m++] = h_v(j,0);
+    buf[m++] = h_v(j,1);
+    buf[m++] = h_v(j,2);
+    buf[m++] = h_rho[j];
+    buf[m++] = h_e[j];
+    buf[m++] = h_vest(j,0);
+    buf[m++] = h_vest(j,1);
+    buf[m++] = h_vest(j,2);
+    for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = h_C(j,k);
+    for (int k = 0; k < atom->num_ssa_species; k++)
+      buf[m++] = (double) h_Cd(j,k);
+    m += pack_ssa(j,&buf[m]);
+  }
+  return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::unpack_comm(int n, int first, double *buf)
+{
+  int i,m,last;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++) {
+    h_x(i,0) = buf[m++];
+    h_x(i,1) = buf[m++];
+    h_x(i,2) = buf[m++];
+    h_rho[i] = buf[m++];
+    h_e[i] = buf[m++];
+    h_vest(i,0) = buf[m++];
+    h_vest(i,1) = buf[m++];
+    h_vest(i,2) = buf[m++];
+    for (int k = 0; k < atom->num_tdpd_species; k++) h_C(i,k) = buf[m++];
+    for (int k = 0; k < atom->num_ssa_species; k++)
+      h_Cd(i,k) = (int) buf[m++];
+    m += unpack_ssa(i,&buf[m]);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::unpack_comm_vel(int n, int first, double *buf)
+{
+  int i,m,last;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++) {
+    h_x(i,0) = buf[m++];
+    h_x(i,1) = buf[m++];
+    h_x(i,2) = buf[m++];
+    h_v(i,0) = buf[m++];
+    h_v(i,1) = buf[m++];
+    h_v(i,2) = buf[m++];
+    h_rho[i] = buf[m++];
+    h_e[i] = buf[m++];
+    h_vest(i,0) = buf[m++];
+    h_vest(i,1) = buf[m++];
+    h_vest(i,2) = buf[m++];
+    for (int k = 0; k < atom->num_tdpd_species; k++) h_C(i,k) = buf[m++];
+    for (int k = 0; k < atom->num_ssa_species; k++)
+      h_Cd(i,k) = (int) buf[m++];
+    m += unpack_ssa(i,&buf[m]);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_reverse(int n, int first, double *buf)
+{
+  if (n > 0)
+    sync(Host,F_MASK | DRHO_MASK | DE_MASK | TDPD_Q_MASK | SSA_QD_MASK);
+
+  int m = 0;
+  const int last = first + n;
+  for (int i = first; i < last; i++) {
+    buf[m++] = h_f(i,0);
+    buf[m++] = h_f(i,1);
+    buf[m++] = h_f(i,2);
+    buf[m++] = h_drho[i];
+    buf[m++] = h_de[i];
+    for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = h_Q(i,k);
+    for (int k = 0; k < atom->num_ssa_species; k++)
+      buf[m++] = (double) h_Qd(i,k);
+  }
+  return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::unpack_reverse(int n, int *list, double *buf)
+{
+  if (n > 0) {
+    sync(Host,F_MASK | DRHO_MASK | DE_MASK | TDPD_Q_MASK | SSA_QD_MASK);
+    modified(Host,F_MASK | DRHO_MASK | DE_MASK | TDPD_Q_MASK | SSA_QD_MASK);
+  }
+
+  int m = 0;
+  for (int i = 0; i < n; i++) {
+    const int j = list[i];
+    h_f(j,0) += buf[m++];
+    h_f(j,1) += buf[m++];
+    h_f(j,2) += buf[m++];
+    h_drho[j] += buf[m++];
+    h_de[j] += buf[m++];
+    for (int k = 0; k < atom->num_tdpd_species; k++) h_Q(j,k) += buf[m++];
+    for (int k = 0; k < atom->num_ssa_species; k++)
+      h_Qd(j,k) += (int) buf[m++];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_border(int n, int *list, double *buf,
+                                       int pbc_flag, int *pbc)
+{
+  int i,j,m;
+  double dx,dy,dz;
+
+  if (pbc_flag == 0) {
+    dx = dy = dz = 0.0;
+  } else if (domain->triclinic == 0) {
+    dx = pbc[0]*domain->xprd;
+    dy = pbc[1]*domain->yprd;
+    dz = pbc[2]*domain->zprd;
+  } else {
+    dx = pbc[0];
+    dy = pbc[1];
+    dz = pbc[2];
+  }
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    buf[m++] = h_x(j,0) + dx;
+    buf[m++] = h_x(j,1) + dy;
+    buf[m++] = h_x(j,2) + dz;
+    buf[m++] = ubuf(h_tag(j)).d;
+    buf[m++] = ubuf(h_type(j)).d;
+    buf[m++] = ubuf(h_mask(j)).d;
+    buf[m++] = h_rho[j];
+    buf[m++] = h_e[j];
+    buf[m++] = h_cv[j];
+    buf[m++] = h_vest(j,0);
+    buf[m++] = h_vest(j,1);
+    buf[m++] = h_vest(j,2);
+    for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = h_C(j,k);
+    for (int k = 0; k < atom->num_ssa_species; k++)
+      buf[m++] = (double) h_Cd(j,k);
+    m += pack_ssa(j,&buf[m]);
+  }
+
+  if (atom->nextra_border)
+    for (int iextra = 0; iextra < atom->nextra_border; iextra++)
+      m += modify->fix[atom->extra_border[iextra]]->pack_border(n,list,&buf[m]);
+
+  return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_border_vel(int n, int *list, double *buf,
+                                           int pbc_flag, int *pbc)
+{
+  int i,j,m;
+  double dx,dy,dz,dvx,dvy,dvz;
+
+  dvx = dvy = dvz = 0.0;
+  if (pbc_flag == 0) {
+    dx = dy = dz = 0.0;
+  } else {
+    if (domain->triclinic == 0) {
+      dx = pbc[0]*domain->xprd;
+      dy = pbc[1]*domain->yprd;
+      dz = pbc[2]*domain->zprd;
+    } else {
+      dx = pbc[0];
+      dy = pbc[1];
+      dz = pbc[2];
+    }
+    if (deform_vremap) {
+      dvx = pbc[0]*h_rate[0] + pbc[5]*h_rate[5] + pbc[4]*h_rate[4];
+      dvy = pbc[1]*h_rate[1] + pbc[3]*h_rate[3];
+      dvz = pbc[2]*h_rate[2];
+    }
+  }
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    buf[m++] = h_x(j,0) + dx;
+    buf[m++] = h_x(j,1) + dy;
+    buf[m++] = h_x(j,2) + dz;
+    buf[m++] = ubuf(h_tag(j)).d;
+    buf[m++] = ubuf(h_type(j)).d;
+    buf[m++] = ubuf(h_mask(j)).d;
+    if (h_mask(j) & deform_groupbit) {
+      buf[m++] = h_v(j,0) + dvx;
+      buf[m++] = h_v(j,1) + dvy;
+      buf[m++] = h_v(j,2) + dvz;
+      buf[m++] = h_vest(j,0) + dvx;
+      buf[m++] = h_vest(j,1) + dvy;
+      buf[m++] = h_vest(j,2) + dvz;
+    } else {
+      buf[m++] = h_v(j,0);
+      buf[m++] = h_v(j,1);
+      buf[m++] = h_v(j,2);
+      buf[m++] = h_vest(j,0);
+      buf[m++] = h_vest(j,1);
+      buf[m++] = h_vest(j,2);
+    }
+    buf[m++] = h_rho[j];
+    buf[m++] = h_e[j];
+    buf[m++] = h_cv[j];
+    for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = h_C(j,k);
+    for (int k = 0; k < atom->num_ssa_species; k++)
+      buf[m++] = (double) h_Cd(j,k);
+    m += pack_ssa(j,&buf[m]);
+  }
+
+  if (atom->nextra_border)
+    for (int iextra = 0; iextra < atom->nextra_border; iextra++)
+      m += modify->fix[atom->extra_border[iextra]]->pack_border(n,list,&buf[m]);
+
+  return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::unpack_border(int n, int first, double *buf)
+{
+  int i,m,last;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++) {
+    if (i == nmax) grow(0);
+    h_x(i,0) = buf[m++];
+    h_x(i,1) = buf[m++];
+    h_x(i,2) = buf[m++];
+    h_tag(i) = (tagint) ubuf(buf[m++]).i;
+    h_type(i) = (int) ubuf(buf[m++]).i;
+    h_mask(i) = (int) ubuf(buf[m++]).i;
+    h_rho[i] = buf[m++];
+    h_e[i] = buf[m++];
+    h_cv[i] = buf[m++];
+    h_vest(i,0) = buf[m++];
+    h_vest(i,1) = buf[m++];
+    h_vest(i,2) = buf[m++];
+    for (int k = 0; k < atom->num_tdpd_species; k++) h_C(i,k) = buf[m++];
+    for (int k = 0; k < atom->num_ssa_species; k++)
+      h_Cd(i,k) = (int) buf[m++];
+    m += unpack_ssa(i,&buf[m]);
+  }
+
+  if (atom->nextra_border)
+    for (int iextra = 0; iextra < atom->nextra_border; iextra++)
+      m += modify->fix[atom->extra_border[iextra]]->
+        unpack_border(n,first,&buf[m]);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::unpack_border_vel(int n, int first, double *buf)
+{
+  int i,m,last;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++) {
+    if (i == nmax) grow(0);
+    h_x(i,0) = buf[m++];
+    h_x(i,1) = buf[m++];
+    h_x(i,2) = buf[m++];
+    h_tag(i) = (tagint) ubuf(buf[m++]).i;
+    h_type(i) = (int) ubuf(buf[m++]).i;
+    h_mask(i) = (int) ubuf(buf[m++]).i;
+    h_v(i,0) = buf[m++];
+    h_v(i,1) = buf[m++];
+    h_v(i,2) = buf[m++];
+    h_vest(i,0) = buf[m++];
+    h_vest(i,1) = buf[m++];
+    h_vest(i,2) = buf[m++];
+    h_rho[i] = buf[m++];
+    h_e[i] = buf[m++];
+    h_cv[i] = buf[m++];
+    for (int k = 0; k < atom->num_tdpd_species; k++) h_C(i,k) = buf[m++];
+    for (int k = 0; k < atom->num_ssa_species; k++)
+      h_Cd(i,k) = (int) buf[m++];
+    m += unpack_ssa(i,&buf[m]);
+  }
+
+  if (atom->nextra_border)
+    for (int iextra = 0; iextra < atom->nextra_border; iextra++)
+      m += modify->fix[atom->extra_border[iextra]]->
+        unpack_border(n,first,&buf[m]);
+}
+
+/* ----------------------------------------------------------------------
+   pack data for atom I for sending to another proc
+   xyz must be 1st 3 values, so comm::exchange() can test on them
+------------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_exchange(int i, double *buf)
+{
+  int m = 1;
+  buf[m++] = h_x(i,0);
+  buf[m++] = h_x(i,1);
+  buf[m++] = h_x(i,2);
+  buf[m++] = h_v(i,0);
+  buf[m++] = h_v(i,1);
+  buf[m++] = h_v(i,2);
+  buf[m++] = ubuf(h_tag(i)).d;
+  buf[m++] = ubuf(h_type(i)).d;
+  buf[m++] = ubuf(h_mask(i)).d;
+  buf[m++] = ubuf(h_image(i)).d;
+  buf[m++] = h_rho[i];
+  buf[m++] = h_e[i];
+  buf[m++] = h_cv[i];
+  buf[m++] = h_vest(i,0);
+  buf[m++] = h_vest(i,1);
+  buf[m++] = h_vest(i,2);
+  for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = h_C(i,k);
+  for (int k = 0; k < atom->num_ssa_species; k++)
+    buf[m++] = (double) h_Cd(i,k);
+  m += pack_ssa(i,&buf[m]);
+
+  if (atom->nextra_grow)
+    for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
+      m += modify->fix[atom->extra_grow[iextra]]->pack_exchange(i,&buf[m]);
+
+  buf[0] = m;
+  return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::unpack_exchange(double *buf)
+{
+  int nlocal = atom->nlocal;
+  if (nlocal == nmax) grow(0);
+  modified(Host,ALL_MASK);
+
+  int m = 1;
+  h_x(nlocal,0) = buf[m++];
+  h_x(nlocal,1) = buf[m++];
+  h_x(nlocal,2) = buf[m++];
+  h_v(nlocal,0) = buf[m++];
+  h_v(nlocal,1) = buf[m++];
+  h_v(nlocal,2) = buf[m++];
+  h_tag(nlocal) = (tagint) ubuf(buf[m++]).i;
+  h_type(nlocal) = (int) ubuf(buf[m++]).i;
+  h_mask(nlocal) = (int) ubuf(buf[m++]).i;
+  h_image(nlocal) = (imageint) ubuf(buf[m++]).i;
+  h_rho[nlocal] = buf[m++];
+  h_e[nlocal] = buf[m++];
+  h_cv[nlocal] = buf[m++];
+  h_vest(nlocal,0) = buf[m++];
+  h_vest(nlocal,1) = buf[m++];
+  h_vest(nlocal,2) = buf[m++];
+  for (int k = 0; k < atom->num_tdpd_species; k++) h_C(nlocal,k) = buf[m++];
+  for (int k = 0; k < atom->num_ssa_species; k++)
+    h_Cd(nlocal,k) = (int) buf[m++];
+  m += unpack_ssa(nlocal,&buf[m]);
+
+  if (atom->nextra_grow)
+    for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
+      m += modify->fix[atom->extra_grow[iextra]]->
+        unpack_exchange(nlocal,&buf[m]);
+
+  atom->nlocal++;
+  return m;
+}
+
+/* ----------------------------------------------------------------------
+   size of restart data for all atoms owned by this proc
+   include extra data stored by fixes
+------------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::size_restart()
+{
+  int i;
+
+  int nlocal = atom->nlocal;
+  int n = (18 + atom->num_tdpd_species + atom->num_ssa_species + size_ssa) *
+    nlocal;
+
+  if (atom->nextra_restart)
+    for (int iextra = 0; iextra < atom->nextra_restart; iextra++)
+      for (i = 0; i < nlocal; i++)
+        n += modify->fix[atom->extra_restart[iextra]]->size_restart(i);
+
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   pack atom I's data for restart file including extra quantities
+   xyz must be 1st 3 values, so that read_restart can test on them
+   layout matches atom_style ssa_tsdpd
+------------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::pack_restart(int i, double *buf)
+{
+  sync(Host,ALL_MASK);
+
+  int m = 1;
+  buf[m++] = h_x(i,0);
+  buf[m++] = h_x(i,1);
+  buf[m++] = h_x(i,2);
+  buf[m++] = ubuf(h_tag(i)).d;
+  buf[m++] = ubuf(h_type(i)).d;
+  buf[m++] = ubuf(h_mask(i)).d;
+  buf[m++] = ubuf(h_image(i)).d;
+  buf[m++] = h_v(i,0);
+  buf[m++] = h_v(i,1);
+  buf[m++] = h_v(i,2);
+  buf[m++] = h_rho[i];
+  buf[m++] = h_e[i];
+  buf[m++] = h_cv[i];
+  buf[m++] = h_vest(i,0);
+  buf[m++] = h_vest(i,1);
+  buf[m++] = h_vest(i,2);
+  buf[m++] = ubuf(RESTART_VERSION).d;
+  for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = h_C(i,k);
+  for (int k = 0; k < atom->num_ssa_species; k++)
+    buf[m++] = (double) h_Cd(i,k);
+  m += pack_ssa(i,&buf[m]);
+
+  if (atom->nextra_restart)
+    for (int iextra = 0; iextra < atom->nextra_restart; iextra++)
+      m += modify->fix[atom->extra_restart[iextra]]->pack_restart(i,&buf[m]);
+
+  buf[0] = m;
+  return m;
+}
+
+/* ----------------------------------------------------------------------
+   unpack data for one atom from restart file including extra quantities
+------------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::unpack_restart(double *buf)
+{
+  int nlocal = atom->nlocal;
+  if (nlocal == nmax) {
+    grow(0);
+    if (atom->nextra_store)
+      memory->grow(atom->extra,nmax,atom->nextra_store,"atom:extra");
+  }
+  modified(Host,ALL_MASK);
+
+  int m = 1;
+  h_x(nlocal,0) = buf[m++];
+  h_x(nlocal,1) = buf[m++];
+  h_x(nlocal,2) = buf[m++];
+  h_tag(nlocal) = (tagint) ubuf(buf[m++]).i;
+  h_type(nlocal) = (int) ubuf(buf[m++]).i;
+  h_mask(nlocal) = (int) ubuf(buf[m++]).i;
+  h_image(nlocal) = (imageint) ubuf(buf[m++]).i;
+  h_v(nlocal,0) = buf[m++];
+  h_v(nlocal,1) = buf[m++];
+  h_v(nlocal,2) = buf[m++];
+  h_rho[nlocal] = buf[m++];
+  h_e[nlocal] = buf[m++];
+  h_cv[nlocal] = buf[m++];
+  h_vest(nlocal,0) = buf[m++];
+  h_vest(nlocal,1) = buf[m++];
+  h_vest(nlocal,2) = buf[m++];
+  int version = 1;
+  if (ubuf(buf[m]).i == RESTART_VERSION) version = (int) ubuf(buf[m++]).i;
+  for (int k = 0; k < atom->num_tdpd_species; k++) h_C(nlocal,k) = buf[m++];
+  for (int k = 0; k < atom->num_ssa_species; k++)
+    h_Cd(nlocal,k) = (int) buf[m++];
+  m += unpack_ssa(nlocal,&buf[m]);
+  if (version == 1) m += 4;
+
+  double **extra = atom->extra;
+  if (atom->nextra_store) {
+    int size = static_cast<int> (buf[0]) - m;
+    for (int i = 0; i < size; i++) extra[nlocal][i] = buf[m++];
+  }
+
+  atom->nlocal++;
+  return m;
+}
+
+/* ----------------------------------------------------------------------
+   create one atom of itype at coord
+   set other values to defaults
+------------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::create_atom(int itype, double *coord)
+{
+  int nlocal = atom->nlocal;
+  if (nlocal == nmax) {
+    atomKK->modified(Host,ALL_MASK);
+    grow(0);
+  }
+  atomKK->modified(Host,ALL_MASK);
+
+  h_tag[nlocal] = 0;
+  h_type[nlocal] = itype;
+  h_x(nlocal,0) = coord[0];
+  h_x(nlocal,1) = coord[1];
+  h_x(nlocal,2) = coord[2];
+  h_mask[nlocal] = 1;
+  h_image[nlocal] = ((imageint) IMGMAX << IMG2BITS) |
+    ((imageint) IMGMAX << IMGBITS) | IMGMAX;
+  for (int k = 0; k < 3; k++) {
+    h_v(nlocal,k) = 0.0;
+    h_vest(nlocal,k) = 0.0;
+  }
+  h_rho[nlocal] = 0.0;
+  h_e[nlocal] = 0.0;
+  h_cv[nlocal] = 1.0;
+  h_de[nlocal] = 0.0;
+  h_drho[nlocal] = 0.0;
+  for (int k = 0; k < atom->num_tdpd_species; k++) h_C(nlocal,k) = 0.0;
+  for (int k = 0; k < atom->num_ssa_species; k++) h_Cd(nlocal,k) = 0;
+  for (int r = 0; r < atom->num_ssa_reactions; r++) {
+    ssa_rxn_propensity[nlocal][r] = 0.0;
+    for (int k = 0; k < atom->num_ssa_species; k++) {
+      d_ssa_rxn_prop_d_c[nlocal][r][k] = 0.0;
+      ssa_stoich_matrix[nlocal][r][k] = 0;
+    }
+  }
+
+  atom->nlocal++;
+}
+
+/* ----------------------------------------------------------------------
+   unpack one line from Atoms section of data file
+   initialize other atom quantities
+------------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::data_atom(double *coord, imageint imagetmp,
+                                      char **values)
+{
+  const int nssa = atom->num_ssa_species;
+  const int nrxn = atom->num_ssa_reactions;
+
+  int nlocal = atom->nlocal;
+  if (nlocal == nmax) grow(0);
+  atomKK->modified(Host,ALL_MASK);
+
+  h_tag[nlocal] = ATOTAGINT(values[0]);
+  h_type[nlocal] = atoi(values[1]);
+  if (h_type[nlocal] <= 0 || h_type[nlocal] > atom->ntypes)
+    error->one(FLERR,"Invalid atom type in Atoms section of data file");
+
+  h_rho[nlocal] = atof(values[2]);
+  h_e[nlocal] = atof(values[3]);
+  h_cv[nlocal] = atof(values[4]);
+
+  h_x(nlocal,0) = coord[0];
+  h_x(nlocal,1) = coord[1];
+  h_x(nlocal,2) = coord[2];
+
+  int m = 5;
+  for (int k = 0; k < atom->num_tdpd_species; k++)
+    h_C(nlocal,k) = atof(values[m++]);
+  for (int k = 0; k < nssa; k++) h_Cd(nlocal,k) = atoi(values[m++]);
+  for (int r = 0; r < nrxn; r++) ssa_rxn_propensity[nlocal][r] = atof(values[m++]);
+  for (int r = 0; r < nrxn; r++)
+    for (int k = 0; k < nssa; k++)
+      d_ssa_rxn_prop_d_c[nlocal][r][k] = atof(values[m++]);
+
+  h_image[nlocal] = imagetmp;
+  h_mask[nlocal] = 1;
+  for (int k = 0; k < 3; k++) {
+    h_v(nlocal,k) = 0.0;
+    h_vest(nlocal,k) = 0.0;
+  }
+  h_de[nlocal] = 0.0;
+  h_drho[nlocal] = 0.0;
+
+  atom->nlocal++;
+}
+
+/* ----------------------------------------------------------------------
+   pack atom info for data file including 3 image flags
+------------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::pack_data(double **buf)
+{
+  sync(Host,ALL_MASK);
+
+  int nlocal = atom->nlocal;
+  for (int i = 0; i < nlocal; i++) {
+    buf[i][0] = ubuf(h_tag[i]).d;
+    buf[i][1] = ubuf(h_type[i]).d;
+    buf[i][2] = h_rho[i];
+    buf[i][3] = h_e[i];
+    buf[i][4] = h_cv[i];
+    buf[i][5] = h_x(i,0);
+    buf[i][6] = h_x(i,1);
+    buf[i][7] = h_x(i,2);
+    buf[i][8] = ubuf((h_image[i] & IMGMASK) - IMGMAX).d;
+    buf[i][9] = ubuf((h_image[i] >> IMGBITS & IMGMASK) - IMGMAX).d;
+    buf[i][10] = ubuf((h_image[i] >> IMG2BITS) - IMGMAX).d;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   write atom info to data file including 3 image flags
+------------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::write_data(FILE *fp, int n, double **buf)
+{
+  for (int i = 0; i < n; i++)
+    fprintf(fp,TAGINT_FORMAT
+            " %d %-1.16e %-1.16e %-1.16e %-1.16e %-1.16e %-1.16e "
+            "%d %d %d\n",
+            (tagint) ubuf(buf[i][0]).i,(int) ubuf(buf[i][1]).i,
+            buf[i][2],buf[i][3],buf[i][4],
+            buf[i][5],buf[i][6],buf[i][7],
+            (int) ubuf(buf[i][8]).i,(int) ubuf(buf[i][9]).i,
+            (int) ubuf(buf[i][10]).i);
+}
+
+/* ----------------------------------------------------------------------
+   assign an index to named atom property and return index
+   return -1 if name is unknown to this atom style
+------------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpdKokkos::property_atom(char *name)
+{
+  if (strcmp(name,"rho") == 0) return 0;
+  if (strcmp(name,"drho") == 0) return 1;
+  if (strcmp(name,"e") == 0) return 2;
+  if (strcmp(name,"de") == 0) return 3;
+  if (strcmp(name,"cv") == 0) return 4;
+  return -1;
+}
+
+/* ----------------------------------------------------------------------
+   pack per-atom data into buf for ComputePropertyAtom
+   index maps to data specific to this atom style
+------------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::pack_property_atom(int index, double *buf,
+                                               int nvalues, int groupbit)
+{
+  sync(Host,MASK_MASK | RHO_MASK | DRHO_MASK | E_MASK | DE_MASK | CV_MASK);
+
+  double *ptr;
+  if (index == 0) ptr = rho;
+  else if (index == 1) ptr = drho;
+  else if (index == 2) ptr = e;
+  else if (index == 3) ptr = de;
+  else ptr = cv;
+
+  int nlocal = atom->nlocal;
+  int n = 0;
+  for (int i = 0; i < nlocal; i++) {
+    if (mask[i] & groupbit) buf[n] = ptr[i];
+    else buf[n] = 0.0;
+    n += nvalues;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   return # of bytes of allocated memory
+------------------------------------------------------------------------- */
+
+bigint AtomVecSsaTsdpdKokkos::memory_usage()
+{
+  int nssa = atom->num_ssa_species;
+  int nrxn = atom->num_ssa_reactions;
+
+  bigint bytes = 0;
+
+  if (atom->memcheck("tag")) bytes += memory->usage(tag,nmax);
+  if (atom->memcheck("type")) bytes += memory->usage(type,nmax);
+  if (atom->memcheck("mask")) bytes += memory->usage(mask,nmax);
+  if (atom->memcheck("image")) bytes += memory->usage(image,nmax);
+  if (atom->memcheck("x")) bytes += memory->usage(x,nmax,3);
+  if (atom->memcheck("v")) bytes += memory->usage(v,nmax,3);
+  if (atom->memcheck("f")) bytes += memory->usage(f,nmax,3);
+  if (atom->memcheck("rho")) bytes += memory->usage(rho,nmax);
+  if (atom->memcheck("drho")) bytes += memory->usage(drho,nmax);
+  if (atom->memcheck("e")) bytes += memory->usage(e,nmax);
+  if (atom->memcheck("de")) bytes += memory->usage(de,nmax);
+  if (atom->memcheck("cv")) bytes += memory->usage(cv,nmax);
+  if (atom->memcheck("vest")) bytes += memory->usage(vest,nmax,3);
+  if (atom->memcheck("C")) bytes += C.usage();
+  if (atom->memcheck("Q")) bytes += Q.usage();
+  if (atom->memcheck("Cd")) bytes += Cd.usage();
+  if (atom->memcheck("Qd")) bytes += Qd.usage();
+  if (nrxn > 0 && atom->memcheck("ssa_rxn_propensity"))
+    bytes += memory->usage(ssa_rxn_propensity,nmax,nrxn);
+  if (nrxn > 0 && nssa > 0 && atom->memcheck("d_ssa_rxn_prop_d_c"))
+    bytes += memory->usage(d_ssa_rxn_prop_d_c,nmax,nrxn,nssa);
+  if (nrxn > 0 && nssa > 0 && atom->memcheck("ssa_stoich_matrix"))
+    bytes += memory->usage(ssa_stoich_matrix,nmax,nrxn,nssa);
+
+  return bytes;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::sync(ExecutionSpace space, unsigned int mask)
+{
+  if (space == Device) {
+    if (mask & X_MASK) atomKK->k_x.sync<LMPDeviceType>();
+    if (mask & V_MASK) atomKK->k_v.sync<LMPDeviceType>();
+    if (mask & F_MASK) atomKK->k_f.sync<LMPDeviceType>();
+    if (mask & TAG_MASK) atomKK->k_tag.sync<LMPDeviceType>();
+    if (mask & TYPE_MASK) atomKK->k_type.sync<LMPDeviceType>();
+    if (mask & MASK_MASK) atomKK->k_mask.sync<LMPDeviceType>();
+    if (mask & IMAGE_MASK) atomKK->k_image.sync<LMPDeviceType>();
+    if (mask & RHO_MASK) atomKK->k_rho.sync<LMPDeviceType>();
+    if (mask & DRHO_MASK) atomKK->k_drho.sync<LMPDeviceType>();
+    if (mask & E_MASK) atomKK->k_e.sync<LMPDeviceType>();
+    if (mask & DE_MASK) atomKK->k_de.sync<LMPDeviceType>();
+    if (mask & VEST_MASK) atomKK->k_vest.sync<LMPDeviceType>();
+    if (mask & CV_MASK) atomKK->k_cv.sync<LMPDeviceType>();
+    if (mask & TDPD_C_MASK) atomKK->k_C.sync<LMPDeviceType>();
+    if (mask & TDPD_Q_MASK) atomKK->k_Q.sync<LMPDeviceType>();
+    if (mask & SSA_CD_MASK) atomKK->k_Cd.sync<LMPDeviceType>();
+    if (mask & SSA_QD_MASK) atomKK->k_Qd.sync<LMPDeviceType>();
+  } else {
+    if (mask & X_MASK) atomKK->k_x.sync<LMPHostType>();
+    if (mask & V_MASK) atomKK->k_v.sync<LMPHostType>();
+    if (mask & F_MASK) atomKK->k_f.sync<LMPHostType>();
+    if (mask & TAG_MASK) atomKK->k_tag.sync<LMPHostType>();
+    if (mask & TYPE_MASK) atomKK->k_type.sync<LMPHostType>();
+    if (mask & MASK_MASK) atomKK->k_mask.sync<LMPHostType>();
+    if (mask & IMAGE_MASK) atomKK->k_image.sync<LMPHostType>();
+    if (mask & RHO_MASK) atomKK->k_rho.sync<LMPHostType>();
+    if (mask & DRHO_MASK) atomKK->k_drho.sync<LMPHostType>();
+    if (mask & E_MASK) atomKK->k_e.sync<LMPHostType>();
+    if (mask & DE_MASK) atomKK->k_de.sync<LMPHostType>();
+    if (mask & VEST_MASK) atomKK->k_vest.sync<LMPHostType>();
+    if (mask & CV_MASK) atomKK->k_cv.sync<LMPHostType>();
+    if (mask & TDPD_C_MASK) atomKK->k_C.sync<LMPHostType>();
+    if (mask & TDPD_Q_MASK) atomKK->k_Q.sync<LMPHostType>();
+    if (mask & SSA_CD_MASK) atomKK->k_Cd.sync<LMPHostType>();
+    if (mask & SSA_QD_MASK) atomKK->k_Qd.sync<LMPHostType>();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::sync_overlapping_device(ExecutionSpace space,
+                                                    unsigned int mask)
+{
+  if (space == Device) {
+    if ((mask & X_MASK) && atomKK->k_x.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_x_array>(atomKK->k_x,space);
+    if ((mask & V_MASK) && atomKK->k_v.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_v_array>(atomKK->k_v,space);
+    if ((mask & F_MASK) && atomKK->k_f.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_f_array>(atomKK->k_f,space);
+    if ((mask & TAG_MASK) && atomKK->k_tag.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_tagint_1d>(atomKK->k_tag,space);
+    if ((mask & TYPE_MASK) && atomKK->k_type.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_int_1d>(atomKK->k_type,space);
+    if ((mask & MASK_MASK) && atomKK->k_mask.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_int_1d>(atomKK->k_mask,space);
+    if ((mask & IMAGE_MASK) && atomKK->k_image.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_imageint_1d>(atomKK->k_image,space);
+    if ((mask & RHO_MASK) && atomKK->k_rho.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_float_1d>(atomKK->k_rho,space);
+    if ((mask & DRHO_MASK) && atomKK->k_drho.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_float_1d>(atomKK->k_drho,space);
+    if ((mask & E_MASK) && atomKK->k_e.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_float_1d>(atomKK->k_e,space);
+    if ((mask & DE_MASK) && atomKK->k_de.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_float_1d>(atomKK->k_de,space);
+    if ((mask & VEST_MASK) && atomKK->k_vest.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_v_array>(atomKK->k_vest,space);
+    if ((mask & CV_MASK) && atomKK->k_cv.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_float_1d>(atomKK->k_cv,space);
+    if ((mask & TDPD_C_MASK) && atomKK->k_C.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_float_2d>(atomKK->k_C,space);
+    if ((mask & TDPD_Q_MASK) && atomKK->k_Q.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_float_2d>(atomKK->k_Q,space);
+    if ((mask & SSA_CD_MASK) && atomKK->k_Cd.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_int_2d>(atomKK->k_Cd,space);
+    if ((mask & SSA_QD_MASK) && atomKK->k_Qd.need_sync<LMPDeviceType>())
+      perform_async_copy<DAT::tdual_int_2d>(atomKK->k_Qd,space);
+  } else {
+    if ((mask & X_MASK) && atomKK->k_x.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_x_array>(atomKK->k_x,space);
+    if ((mask & V_MASK) && atomKK->k_v.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_v_array>(atomKK->k_v,space);
+    if ((mask & F_MASK) && atomKK->k_f.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_f_array>(atomKK->k_f,space);
+    if ((mask & TAG_MASK) && atomKK->k_tag.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_tagint_1d>(atomKK->k_tag,space);
+    if ((mask & TYPE_MASK) && atomKK->k_type.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_int_1d>(atomKK->k_type,space);
+    if ((mask & MASK_MASK) && atomKK->k_mask.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_int_1d>(atomKK->k_mask,space);
+    if ((mask & IMAGE_MASK) && atomKK->k_image.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_imageint_1d>(atomKK->k_image,space);
+    if ((mask & RHO_MASK) && atomKK->k_rho.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_float_1d>(atomKK->k_rho,space);
+    if ((mask & DRHO_MASK) && atomKK->k_drho.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_float_1d>(atomKK->k_drho,space);
+    if ((mask & E_MASK) && atomKK->k_e.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_float_1d>(atomKK->k_e,space);
+    if ((mask & DE_MASK) && atomKK->k_de.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_float_1d>(atomKK->k_de,space);
+    if ((mask & VEST_MASK) && atomKK->k_vest.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_v_array>(atomKK->k_vest,space);
+    if ((mask & CV_MASK) && atomKK->k_cv.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_float_1d>(atomKK->k_cv,space);
+    if ((mask & TDPD_C_MASK) && atomKK->k_C.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_float_2d>(atomKK->k_C,space);
+    if ((mask & TDPD_Q_MASK) && atomKK->k_Q.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_float_2d>(atomKK->k_Q,space);
+    if ((mask & SSA_CD_MASK) && atomKK->k_Cd.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_int_2d>(atomKK->k_Cd,space);
+    if ((mask & SSA_QD_MASK) && atomKK->k_Qd.need_sync<LMPHostType>())
+      perform_async_copy<DAT::tdual_int_2d>(atomKK->k_Qd,space);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void AtomVecSsaTsdpdKokkos::modified(ExecutionSpace space, unsigned int mask)
+{
+  if (space == Device) {
+    if (mask & X_MASK) atomKK->k_x.modify<LMPDeviceType>();
+    if (mask & V_MASK) atomKK->k_v.modify<LMPDeviceType>();
+    if (mask & F_MASK) atomKK->k_f.modify<LMPDeviceType>();
+    if (mask & TAG_MASK) atomKK->k_tag.modify<LMPDeviceType>();
+    if (mask & TYPE_MASK) atomKK->k_type.modify<LMPDeviceType>();
+    if (mask & MASK_MASK) atomKK->k_mask.modify<LMPDeviceType>();
+    if (mask & IMAGE_MASK) atomKK->k_image.modify<LMPDeviceType>();
+    if (mask & RHO_MASK) atomKK->k_rho.modify<LMPDeviceType>();
+    if (mask & DRHO_MASK) atomKK->k_drho.modify<LMPDeviceType>();
+    if (mask & E_MASK) atomKK->k_e.modify<LMPDeviceType>();
+    if (mask & DE_MASK) atomKK->k_de.modify<LMPDeviceType>();
+    if (mask & VEST_MASK) atomKK->k_vest.modify<LMPDeviceType>();
+    if (mask & CV_MASK) atomKK->k_cv.modify<LMPDeviceType>();
+    if (mask & TDPD_C_MASK) atomKK->k_C.modify<LMPDeviceType>();
+    if (mask & TDPD_Q_MASK) atomKK->k_Q.modify<LMPDeviceType>();
+    if (mask & SSA_CD_MASK) atomKK->k_Cd.modify<LMPDeviceType>();
+    if (mask & SSA_QD_MASK) atomKK->k_Qd.modify<LMPDeviceType>();
+  } else {
+    if (mask & X_MASK) atomKK->k_x.modify<LMPHostType>();
+    if (mask & V_MASK) atomKK->k_v.modify<LMPHostType>();
+    if (mask & F_MASK) atomKK->k_f.modify<LMPHostType>();
+    if (mask & TAG_MASK) atomKK->k_tag.modify<LMPHostType>();
+    if (mask & TYPE_MASK) atomKK->k_type.modify<LMPHostType>();
+    if (mask & MASK_MASK) atomKK->k_mask.modify<LMPHostType>();
+    if (mask & IMAGE_MASK) atomKK->k_image.modify<LMPHostType>();
+    if (mask & RHO_MASK) atomKK->k_rho.modify<LMPHostType>();
+    if (mask & DRHO_MASK) atomKK->k_drho.modify<LMPHostType>();
+    if (mask & E_MASK) atomKK->k_e.modify<LMPHostType>();
+    if (mask & DE_MASK) atomKK->k_de.modify<LMPHostType>();
+    if (mask & VEST_MASK) atomKK->k_vest.modify<LMPHostType>();
+    if (mask & CV_MASK) atomKK->k_cv.modify<LMPHostType>();
+    if (mask & TDPD_C_MASK) atomKK->k_C.modify<LMPHostType>();
+    if (mask & TDPD_Q_MASK) atomKK->k_Q.modify<LMPHostType>();
+    if (mask & SSA_CD_MASK) atomKK->k_Cd.modify<LMPHostType>();
+    if (mask & SSA_QD_MASK) atomKK->k_Qd.modify<LMPHostType>();
+  }
+}
@@ -0,0 +1,171 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef ATOM_CLASS
+
+AtomStyle(ssa_tsdpd/kk,AtomVecSsaTsdpdKokkos)
+
+#else
+
+#ifndef LMP_ATOM_VEC_SSA_TSDPD_KOKKOS_H
+#define LMP_ATOM_VEC_SSA_TSDPD_KOKKOS_H
+
+#include "atom_vec_kokkos.h"
+#include "kokkos_type.h"
+#include "species_array.h"
+
+namespace LAMMPS_NS {
+
+class AtomVecSsaTsdpdKokkos : public AtomVecKokkos {
+ public:
+  AtomVecSsaTsdpdKokkos(class LAMMPS *);
+  virtual ~AtomVecSsaTsdpdKokkos() {}
+  void process_args(int, char **);
+  void grow(int);
+  void copy(int, int, int);
+  void force_clear(int, size_t);
+  int pack_comm(int, int *, double *, int, int *);
+  int pack_comm_vel(int, int *, double *, int, int *);
+  void unpack_comm(int, int, double *);
+  void unpack_comm_vel(int, int, double *);
+  int pack_reverse(int, int, double *);
+  void unpack_reverse(int, int *, double *);
+  int pack_border(int, int *, double *, int, int *);
+  int pack_border_vel(int, int *, double *, int, int *);
+  void unpack_border(int, int, double *);
+  void unpack_border_vel(int, int, double *);
+  int pack_exchange(int, double *);
+  int unpack_exchange(double *);
+  int size_restart();
+  int pack_restart(int, double *);
+  int unpack_restart(double *);
+  void create_atom(int, double *);
+  void data_atom(double *, imageint, char **);
+  void pack_data(double **);
+  void write_data(FILE *, int, double **);
+  int property_atom(char *);
+  void pack_property_atom(int, double *, int, int);
+  bigint memory_usage();
+
+  void grow_reset();
+  int pack_comm_kokkos(const int &n, const DAT::tdual_int_2d &k_sendlist,
+                       const int & iswap,
+                       const DAT::tdual_xfloat_2d &buf,
+                       const int &pbc_flag, const int pbc[]);
+  void unpack_comm_kokkos(const int &n, const int &nfirst,
+                          const DAT::tdual_xfloat_2d &buf);
+  int pack_comm_self(const int &n, const DAT::tdual_int_2d &list,
+                     const int & iswap, const int nfirst,
+                     const int &pbc_flag, const int pbc[]);
+  int pack_border_kokkos(int n, DAT::tdual_int_2d k_sendlist,
+                         DAT::tdual_xfloat_2d buf,int iswap,
+                         int pbc_flag, int *pbc, ExecutionSpace space);
+  void unpack_border_kokkos(const int &n, const int &nfirst,
+                            const DAT::tdual_xfloat_2d &buf,
+                            ExecutionSpace space);
+  int pack_exchange_kokkos(const int &nsend,DAT::tdual_xfloat_2d &buf,
+                           DAT::tdual_int_1d k_sendlist,
+                           DAT::tdual_int_1d k_copylist,
+                           ExecutionSpace space, int dim,
+                           X_FLOAT lo, X_FLOAT hi);
+  int unpack_exchange_kokkos(DAT::tdual_xfloat_2d &k_buf, int nrecv,
+                             int nlocal, int dim, X_FLOAT lo, X_FLOAT hi,
+                             ExecutionSpace space);
+
+  void sync(ExecutionSpace space, unsigned int mask);
+  void modified(ExecutionSpace space, unsigned int mask);
+  void sync_overlapping_device(ExecutionSpace space, unsigned int mask);
+
+ protected:
+  tagint *tag;
+  imageint *image;
+  int *type,*mask;
+  double **x,**v,**f;
+  double *rho,*drho,*e,*de,*cv;
+  double **vest;
+  SpeciesArray<double> C,Q;
+  SpeciesArray<int> Cd,Qd;
+
+  // SSA reaction data stays on the host, the reaction stage runs there
+
+  double **ssa_rxn_propensity,***d_ssa_rxn_prop_d_c;
+  int ***ssa_stoich_matrix;
+
+  DAT::t_tagint_1d d_tag;
+  HAT::t_tagint_1d h_tag;
+  DAT::t_imageint_1d d_image;
+  HAT::t_imageint_1d h_image;
+  DAT::t_int_1d d_type, d_mask;
+  HAT::t_int_1d h_type, h_mask;
+
+  DAT::t_x_array d_x;
+  DAT::t_v_array d_v;
+  DAT::t_f_array d_f;
+  HAT::t_x_array h_x;
+  HAT::t_v_array h_v;
+  HAT::t_f_array h_f;
+
+  DAT::t_float_1d d_rho, d_drho, d_e, d_de, d_cv;
+  HAT::t_float_1d h_rho, h_drho, h_e, h_de, h_cv;
+  DAT::t_v_array d_vest;
+  HAT::t_v_array h_vest;
+  DAT::t_float_2d d_C, d_Q;
+  HAT::t_float_2d h_C, h_Q;
+  DAT::t_int_2d d_Cd, d_Qd;
+  HAT::t_int_2d h_Cd, h_Qd;
+
+ private:
+  int size_ssa;                  // per-atom length of the SSA reaction block
+
+  int pack_ssa(int, double *);
+  int unpack_ssa(int, double *);
+  void device_comm_error();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Invalid atom_style ssa_tsdpd/kk command
+
+The number of tDPD and SSA species must be given.
+
+E: Atom_style ssa_tsdpd/kk requires layout atom
+
+The Kokkos views of the species arrays are stored by atom, the
+species-major layout of atom_style ssa_tsdpd is not available.
+
+E: Atom_style ssa_tsdpd/kk requires ensemble 1
+
+The Kokkos pair styles and integrator advance one SSA realization per
+particle, ensemble replicas are only available without Kokkos.
+
+E: Per-processor system is too big
+
+The number of owned atoms plus ghost atoms on a single
+processor must fit in 32-bit integer.
+
+E: Invalid atom type in Atoms section of data file
+
+Atom types must range from 1 to specified # of types.
+
+E: Atom style ssa_tsdpd/kk requires classic communication
+
+The species arrays are packed on the host.  This is selected
+automatically by the Kokkos comm class for atom styles that
+communicate more than coordinates.
+
+*/
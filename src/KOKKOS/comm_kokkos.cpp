@@ -134,6 +134,13 @@ void CommKokkos::init()
 
   if(check_reverse || check_forward)
     forward_comm_classic = true;
+
+  // atom styles that communicate more than x and f only pack on the host
+
+  if (!atom->avec->comm_x_only || !atom->avec->comm_f_only) {
+    forward_comm_classic = true;
+    exchange_comm_classic = true;
+  }
 }
 
 /* ----------------------------------------------------------------------
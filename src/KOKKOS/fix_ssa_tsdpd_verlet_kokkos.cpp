@@ -0,0 +1,292 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "fix_ssa_tsdpd_verlet_kokkos.h"
+#include "atom_masks.h"
+#include "atom_kokkos.h"
+#include "force.h"
+#include "update.h"
+#include "error.h"
+#include "timer.h"
+#include "fix_ssa_tsdpd_ssa_rxn_mass_action.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+/* ---------------------------------------------------------------------- */
+
+template<class DeviceType>
+FixSsaTsdpdVerletKokkos<DeviceType>::FixSsaTsdpdVerletKokkos(LAMMPS *lmp,
+                                                             int narg,
+                                                             char **arg) :
+  FixSsaTsdpd(lmp, narg, arg), rand_pool(seed)
+{
+  kokkosable = 1;
+  atomKK = (AtomKokkos *) atom;
+  execution_space = ExecutionSpaceFromDevice<DeviceType>::space;
+
+  if (strcmp(atom->atom_style,"ssa_tsdpd/kk") != 0)
+    error->all(FLERR,"Fix ssa_tsdpd/verlet/kk requires "
+               "atom style ssa_tsdpd/kk");
+
+  datamask_read = X_MASK | V_MASK | F_MASK | MASK_MASK | TYPE_MASK |
+    VEST_MASK | RHO_MASK | DRHO_MASK | TDPD_C_MASK | TDPD_Q_MASK |
+    SSA_CD_MASK | SSA_QD_MASK;
+  datamask_modify = X_MASK | V_MASK | VEST_MASK | RHO_MASK | TDPD_C_MASK |
+    SSA_CD_MASK;
+}
+
+/* ---------------------------------------------------------------------- */
+
+template<class DeviceType>
+void FixSsaTsdpdVerletKokkos<DeviceType>::init()
+{
+  FixSsaTsdpd::init();
+
+  ntdpd = atom->num_tdpd_species;
+  nssa = atom->num_ssa_species;
+  nrxn = atom->num_ssa_reactions;
+
+  atomKK->k_mass.modify<LMPHostType>();
+  atomKK->k_mass.sync<LMPDeviceType>();
+}
+
+/* ----------------------------------------------------------------------
+   set vest equal to v
+------------------------------------------------------------------------- */
+
+template<class DeviceType>
+void FixSsaTsdpdVerletKokkos<DeviceType>::setup_pre_force(int vflag)
+{
+  atomKK->sync(execution_space,V_MASK | VEST_MASK | MASK_MASK);
+  atomKK->modified(execution_space,VEST_MASK);
+
+  v = atomKK->k_v.view<DeviceType>();
+  vest = atomKK->k_vest.view<DeviceType>();
+  mask = atomKK->k_mask.view<DeviceType>();
+  int nlocal = atomKK->nlocal;
+  if (igroup == atomKK->firstgroup) nlocal = atomKK->nfirst;
+
+  FixSsaTsdpdVerletKokkosSetupFunctor<DeviceType> functor(this);
+  Kokkos::parallel_for(nlocal,functor);
+  DeviceType::fence();
+}
+
+template<class DeviceType>
+KOKKOS_INLINE_FUNCTION
+void FixSsaTsdpdVerletKokkos<DeviceType>::setup_item(int i) const
+{
+  if (mask[i] & groupbit) {
+    vest(i,0) = v(i,0);
+    vest(i,1) = v(i,1);
+    vest(i,2) = v(i,2);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template<class DeviceType>
+void FixSsaTsdpdVerletKokkos<DeviceType>::initial_integrate(int vflag)
+{
+  atomKK->sync(execution_space,datamask_read);
+  atomKK->modified(execution_space,datamask_modify);
+
+  x = atomKK->k_x.view<DeviceType>();
+  v = atomKK->k_v.view<DeviceType>();
+  vest = atomKK->k_vest.view<DeviceType>();
+  f = atomKK->k_f.view<DeviceType>();
+  rho = atomKK->k_rho.view<DeviceType>();
+  drho = atomKK->k_drho.view<DeviceType>();
+  C = atomKK->k_C.view<DeviceType>();
+  Q = atomKK->k_Q.view<DeviceType>();
+  mass = atomKK->k_mass.view<DeviceType>();
+  type = atomKK->k_type.view<DeviceType>();
+  mask = atomKK->k_mask.view<DeviceType>();
+  int nlocal = atomKK->nlocal;
+  if (igroup == atomKK->firstgroup) nlocal = atomKK->nfirst;
+
+  FixSsaTsdpdVerletKokkosInitialIntegrateFunctor<DeviceType> functor(this);
+  Kokkos::parallel_for(nlocal,functor);
+  DeviceType::fence();
+}
+
+template<class DeviceType>
+KOKKOS_INLINE_FUNCTION
+void FixSsaTsdpdVerletKokkos<DeviceType>::initial_integrate_item(int i) const
+{
+  if (mask[i] & groupbit) {
+    const double dtfm = dtf / mass[type[i]];
+
+    // extrapolate velocity for use with velocity-dependent potentials
+
+    vest(i,0) = v(i,0) + 2.0 * dtfm * f(i,0);
+    vest(i,1) = v(i,1) + 2.0 * dtfm * f(i,1);
+    vest(i,2) = v(i,2) + 2.0 * dtfm * f(i,2);
+
+    v(i,0) += dtfm * f(i,0);
+    v(i,1) += dtfm * f(i,1);
+    v(i,2) += dtfm * f(i,2);
+    x(i,0) += dtv * v(i,0);
+    x(i,1) += dtv * v(i,1);
+    x(i,2) += dtv * v(i,2);
+
+    for (int k = 0; k < ntdpd; k++) {
+      const double c = C(i,k) + Q(i,k) * dtf;
+      C(i,k) = c > 0.0 ? c : 0.0;
+    }
+
+    rho[i] += dtf * drho[i];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template<class DeviceType>
+void FixSsaTsdpdVerletKokkos<DeviceType>::final_integrate()
+{
+  atomKK->sync(execution_space,datamask_read);
+  atomKK->modified(execution_space,datamask_modify);
+
+  v = atomKK->k_v.view<DeviceType>();
+  f = atomKK->k_f.view<DeviceType>();
+  rho = atomKK->k_rho.view<DeviceType>();
+  drho = atomKK->k_drho.view<DeviceType>();
+  C = atomKK->k_C.view<DeviceType>();
+  Q = atomKK->k_Q.view<DeviceType>();
+  Cd = atomKK->k_Cd.view<DeviceType>();
+  Qd = atomKK->k_Qd.view<DeviceType>();
+  mass = atomKK->k_mass.view<DeviceType>();
+  type = atomKK->k_type.view<DeviceType>();
+  mask = atomKK->k_mask.view<DeviceType>();
+  int nlocal = atomKK->nlocal;
+  if (igroup == atomKK->firstgroup) nlocal = atomKK->nfirst;
+
+  FixSsaTsdpdVerletKokkosFinalIntegrateFunctor<DeviceType> functor(this);
+  Kokkos::parallel_for(nlocal,functor);
+  DeviceType::fence();
+
+  // SSA reactions, one independent Gillespie process per atom
+
+  if (nssa == 0 || nrxn == 0) return;
+
+  atomKK->sync(Host,SSA_CD_MASK | MASK_MASK | TYPE_MASK | RHO_MASK);
+  h_Cd = atomKK->k_Cd.h_view;
+  h_mask = atomKK->k_mask.h_view;
+  h_type = atomKK->k_type.h_view;
+  h_rho = atomKK->k_rho.h_view;
+  h_mass = atom->mass;
+  ssa_rxn_propensity = atom->ssa_rxn_propensity;
+  ssa_stoich_matrix = atom->ssa_stoich_matrix;
+  dt = update->dt;
+
+  timer->sub_start(Timer::SSA_REACTION);
+  FixSsaTsdpdVerletKokkosReactionFunctor<DeviceType> rfunctor(this);
+  Kokkos::parallel_for(Kokkos::RangePolicy<LMPHostType>(0,nlocal),rfunctor);
+  LMPHostType::fence();
+  timer->sub_stamp(Timer::SSA_REACTION);
+
+  atomKK->modified(Host,SSA_CD_MASK);
+}
+
+template<class DeviceType>
+KOKKOS_INLINE_FUNCTION
+void FixSsaTsdpdVerletKokkos<DeviceType>::final_integrate_item(int i) const
+{
+  if (mask[i] & groupbit) {
+    const double dtfm = dtf / mass[type[i]];
+    v(i,0) += dtfm * f(i,0);
+    v(i,1) += dtfm * f(i,1);
+    v(i,2) += dtfm * f(i,2);
+
+    for (int k = 0; k < ntdpd; k++) {
+      const double c = C(i,k) + Q(i,k) * dtf;
+      C(i,k) = c > 0.0 ? c : 0.0;
+    }
+
+    for (int s = 0; s < nssa; s++) {
+      const int cd = Cd(i,s) + Qd(i,s);
+      Cd(i,s) = cd > 0 ? cd : 0;
+    }
+
+    rho[i] += dtf * drho[i];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   Gillespie direct method over the reactions of atom I
+   propensities are recomputed by the reaction fixes after each firing,
+   as in fix ssa_tsdpd/verlet
+------------------------------------------------------------------------- */
+
+template<class DeviceType>
+void FixSsaTsdpdVerletKokkos<DeviceType>::reaction_item(int i) const
+{
+  if (!(h_mask[i] & groupbit)) return;
+
+  double *a = ssa_rxn_propensity[i];
+  const SpeciesArray<int>::Row cd(&h_Cd(i,0),1);
+  const double volume = h_mass[h_type[i]] / h_rho[i];
+  double a0 = 0.0;
+  for (int r = 0; r < nrxn; r++) {
+    a[r] = rxnfix[r] ? rxnfix[r]->propensity(cd,volume) : 0.0;
+    a0 += a[r];
+  }
+  if (a0 <= 0.0) return;
+
+  Kokkos::Random_XorShift64_Pool<LMPHostType>::generator_type rand_gen =
+    rand_pool.get_state();
+
+  double tt = -log(1.0 - rand_gen.drand()) / a0;
+  while (tt < dt) {
+    const double r2 = a0 * rand_gen.drand();
+    double a_sum = 0.0;
+    int r;
+    for (r = 0; r < nrxn - 1; r++)
+      if ((a_sum += a[r]) > r2) break;
+
+    for (int s = 0; s < nssa; s++)
+      h_Cd(i,s) += ssa_stoich_matrix[i][r][s];
+
+    a0 = 0.0;
+    for (int ro = 0; ro < nrxn; ro++) {
+      a[ro] = rxnfix[ro] ? rxnfix[ro]->propensity(cd,volume) : 0.0;
+      a0 += a[ro];
+    }
+
+    if (a0 <= 0.0) break;
+    tt += -log(1.0 - rand_gen.drand()) / a0;
+  }
+
+  rand_pool.free_state(rand_gen);
+}
+
+/* ---------------------------------------------------------------------- */
+
+template<class DeviceType>
+void FixSsaTsdpdVerletKokkos<DeviceType>::cleanup_copy()
+{
+  id = style = NULL;
+  vatom = NULL;
+  random = NULL;
+  rxnfix = NULL;
+}
+
+namespace LAMMPS_NS {
+template class FixSsaTsdpdVerletKokkos<LMPDeviceType>;
+#ifdef KOKKOS_HAVE_CUDA
+template class FixSsaTsdpdVerletKokkos<LMPHostType>;
+#endif
+}
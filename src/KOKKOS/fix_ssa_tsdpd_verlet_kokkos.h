@@ -0,0 +1,153 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(ssa_tsdpd/verlet/kk,FixSsaTsdpdVerletKokkos<LMPDeviceType>)
+FixStyle(ssa_tsdpd/verlet/kk/device,FixSsaTsdpdVerletKokkos<LMPDeviceType>)
+FixStyle(ssa_tsdpd/verlet/kk/host,FixSsaTsdpdVerletKokkos<LMPHostType>)
+
+#else
+
+#ifndef LMP_FIX_SSA_TSDPD_VERLET_KOKKOS_H
+#define LMP_FIX_SSA_TSDPD_VERLET_KOKKOS_H
+
+#include "fix_ssa_tsdpd_verlet.h"
+#include "kokkos_type.h"
+#include "Kokkos_Random.hpp"
+
+namespace LAMMPS_NS {
+
+template<class DeviceType>
+class FixSsaTsdpdVerletKokkos;
+
+template <class DeviceType>
+class FixSsaTsdpdVerletKokkosSetupFunctor;
+template <class DeviceType>
+class FixSsaTsdpdVerletKokkosInitialIntegrateFunctor;
+template <class DeviceType>
+class FixSsaTsdpdVerletKokkosFinalIntegrateFunctor;
+
+template<class DeviceType>
+class FixSsaTsdpdVerletKokkos : public FixSsaTsdpd {
+ public:
+  FixSsaTsdpdVerletKokkos(class LAMMPS *, int, char **);
+  ~FixSsaTsdpdVerletKokkos() {}
+  void cleanup_copy();
+  void init();
+  void setup_pre_force(int);
+  void initial_integrate(int);
+  void final_integrate();
+
+  KOKKOS_INLINE_FUNCTION
+  void setup_item(int) const;
+  KOKKOS_INLINE_FUNCTION
+  void initial_integrate_item(int) const;
+  KOKKOS_INLINE_FUNCTION
+  void final_integrate_item(int) const;
+
+  void reaction_item(int) const;
+
+ private:
+  typename ArrayTypes<DeviceType>::t_x_array x;
+  typename ArrayTypes<DeviceType>::t_v_array v;
+  typename ArrayTypes<DeviceType>::t_v_array vest;
+  typename ArrayTypes<DeviceType>::t_f_array_const f;
+  typename ArrayTypes<DeviceType>::t_float_1d rho;
+  typename ArrayTypes<DeviceType>::t_float_1d_randomread drho;
+  typename ArrayTypes<DeviceType>::t_float_2d C;
+  typename ArrayTypes<DeviceType>::t_float_2d_randomread Q;
+  typename ArrayTypes<DeviceType>::t_int_2d Cd;
+  typename ArrayTypes<DeviceType>::t_int_2d Qd;
+  typename ArrayTypes<DeviceType>::t_float_1d_randomread mass;
+  typename ArrayTypes<DeviceType>::t_int_1d type;
+  typename ArrayTypes<DeviceType>::t_int_1d mask;
+
+  int ntdpd,nssa,nrxn;
+
+  // the SSA reaction stage runs per atom on the host,
+  // since the propensity and stoichiometry arrays live there
+
+  HAT::t_int_2d h_Cd;
+  HAT::t_int_1d h_mask,h_type;
+  HAT::t_float_1d h_rho;
+  double *h_mass;
+  double **ssa_rxn_propensity;
+  int ***ssa_stoich_matrix;
+  double dt;
+  Kokkos::Random_XorShift64_Pool<LMPHostType> rand_pool;
+};
+
+template <class DeviceType>
+struct FixSsaTsdpdVerletKokkosSetupFunctor  {
+  typedef DeviceType  device_type ;
+  FixSsaTsdpdVerletKokkos<DeviceType> c;
+
+  FixSsaTsdpdVerletKokkosSetupFunctor(FixSsaTsdpdVerletKokkos<DeviceType>* c_ptr):
+  c(*c_ptr) {c.cleanup_copy();};
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const int i) const {
+    c.setup_item(i);
+  }
+};
+
+template <class DeviceType>
+struct FixSsaTsdpdVerletKokkosInitialIntegrateFunctor  {
+  typedef DeviceType  device_type ;
+  FixSsaTsdpdVerletKokkos<DeviceType> c;
+
+  FixSsaTsdpdVerletKokkosInitialIntegrateFunctor(FixSsaTsdpdVerletKokkos<DeviceType>* c_ptr):
+  c(*c_ptr) {c.cleanup_copy();};
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const int i) const {
+    c.initial_integrate_item(i);
+  }
+};
+
+template <class DeviceType>
+struct FixSsaTsdpdVerletKokkosFinalIntegrateFunctor  {
+  typedef DeviceType  device_type ;
+  FixSsaTsdpdVerletKokkos<DeviceType> c;
+
+  FixSsaTsdpdVerletKokkosFinalIntegrateFunctor(FixSsaTsdpdVerletKokkos<DeviceType>* c_ptr):
+  c(*c_ptr) {c.cleanup_copy();};
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const int i) const {
+    c.final_integrate_item(i);
+  }
+};
+
+template <class DeviceType>
+struct FixSsaTsdpdVerletKokkosReactionFunctor  {
+  typedef LMPHostType  device_type ;
+  FixSsaTsdpdVerletKokkos<DeviceType> c;
+
+  FixSsaTsdpdVerletKokkosReactionFunctor(FixSsaTsdpdVerletKokkos<DeviceType>* c_ptr):
+  c(*c_ptr) {c.cleanup_copy();};
+  void operator()(const int i) const {
+    c.reaction_item(i);
+  }
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Fix ssa_tsdpd/verlet/kk requires atom style ssa_tsdpd/kk
+
+The species arrays must be mirrored on the device.
+
+*/
@@ -0,0 +1,791 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "kokkos.h"
+#include "pair_kokkos.h"
+#include "pair_ssa_tsdpd_wt_kokkos.h"
+#include "atom_kokkos.h"
+#include "force.h"
+#include "comm.h"
+#include "universe.h"
+#include "domain.h"
+#include "update.h"
+#include "neighbor.h"
+#include "neigh_list_kokkos.h"
+#include "neigh_request.h"
+#include "memory.h"
+#include "error.h"
+#include "timer.h"
+#include "atom_masks.h"
+
+using namespace LAMMPS_NS;
+
+namespace LAMMPS_NS {
+
+/* ----------------------------------------------------------------------
+   SSA diffusion of one discrete species over the host jump graph
+   species are independent, so each one runs on its own host thread
+   as in PairSsaTsdpdWt, only owned voxels are sources, ghosts have a zero
+   base propensity and only collect the molecules that jump into them
+------------------------------------------------------------------------- */
+
+struct PairSsaTsdpdWtSSADiffusionFunctor {
+  typedef LMPHostType device_type;
+  typedef Kokkos::Random_XorShift64_Pool<LMPHostType> pool_type;
+
+  int nlocal,ntdpd;
+  double dt;
+  int *jump_first,*jump_dest;
+  double *jump_w;
+  double **a_base;
+  int **pop;
+  HAT::t_int_1d type;
+  HAT::t_int_2d Cd,Qd;
+  double ***kappa;
+  pool_type rand_pool;
+
+  PairSsaTsdpdWtSSADiffusionFunctor(int nlocal_in, int ntdpd_in, double dt_in,
+                                    int *first_in, int *dest_in,
+                                    double *w_in, double **a_in, int **pop_in,
+                                    HAT::t_int_1d type_in, HAT::t_int_2d Cd_in,
+                                    HAT::t_int_2d Qd_in, double ***kappa_in,
+                                    pool_type pool_in) :
+    nlocal(nlocal_in), ntdpd(ntdpd_in), dt(dt_in), jump_first(first_in),
+    jump_dest(dest_in), jump_w(w_in), a_base(a_in), pop(pop_in),
+    type(type_in), Cd(Cd_in), Qd(Qd_in), kappa(kappa_in),
+    rand_pool(pool_in) {}
+
+  double rate(const int s, const int src, const int m) const {
+    return kappa[type(src)][type(jump_dest[m])][ntdpd+s] * jump_w[m];
+  }
+
+  void operator()(const int s) const {
+    int v,m;
+
+    // per-voxel base propensity, multiplied by the population of the voxel
+
+    double a0 = 0.0;
+    for (v = 0; v < nlocal; v++) {
+      pop[v][s] = Cd(v,s) > 0 ? Cd(v,s) : 0;
+      double base = 0.0;
+      for (m = jump_first[v]; m < jump_first[v+1]; m++) base += rate(s,v,m);
+      a_base[v][s] = base;
+      a0 += base * pop[v][s];
+    }
+    if (a0 <= 0.0) return;
+
+    pool_type::generator_type rand_gen = rand_pool.get_state();
+
+    double tt = -log(1.0 - rand_gen.drand()) / a0;
+    while (tt < dt) {
+
+      // voxel the molecule leaves
+
+      const double r2 = a0 * rand_gen.drand();
+      double sum = 0.0;
+      int src = -1;
+      for (v = 0; v < nlocal; v++) {
+        if (pop[v][s] <= 0) continue;
+        src = v;
+        sum += a_base[v][s] * pop[v][s];
+        if (sum > r2) break;
+      }
+      if (src < 0) break;
+
+      // neighbor it jumps to
+
+      const double r3 = a_base[src][s] * rand_gen.drand();
+      sum = 0.0;
+      int dest = -1;
+      for (m = jump_first[src]; m < jump_first[src+1]; m++) {
+        dest = jump_dest[m];
+        sum += rate(s,src,m);
+        if (sum > r3) break;
+      }
+      if (dest < 0) break;
+
+      pop[src][s]--;
+      Qd(src,s)--;
+      Qd(dest,s)++;
+      a0 -= a_base[src][s];
+      if (dest < nlocal) {
+        pop[dest][s]++;
+        a0 += a_base[dest][s];
+      }
+
+      if (a0 <= 0.0) break;
+      tt += -log(1.0 - rand_gen.drand()) / a0;
+    }
+
+    rand_pool.free_state(rand_gen);
+  }
+};
+
+}
+
+/* ---------------------------------------------------------------------- */
+
+template<class DeviceType>
+PairSsaTsdpdWtKokkos<DeviceType>::PairSsaTsdpdWtKokkos(LAMMPS *lmp) :
+  PairSsaTsdpdWt(lmp)
+{
+  respa_enable = 0;
+
+  atomKK = (AtomKokkos *) atom;
+  execution_space = ExecutionSpaceFromDevice<DeviceType>::space;
+  datamask_read = X_MASK | VEST_MASK | F_MASK | TYPE_MASK | RHO_MASK |
+    E_MASK | DRHO_MASK | DE_MASK | TDPD_C_MASK | TDPD_Q_MASK |
+    ENERGY_MASK | VIRIAL_MASK;
+  datamask_modify = F_MASK | DRHO_MASK | DE_MASK | TDPD_Q_MASK |
+    ENERGY_MASK | VIRIAL_MASK;
+
+  maxvoxel = maxjump = 0;
+  jump_first = jump_dest = NULL;
+  jump_w = NULL;
+  a_base = NULL;
+  pop = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+template<class DeviceType>
+PairSsaTsdpdWtKokkos<DeviceType>::~PairSsaTsdpdWtKokkos()
+{
+  if (!copymode) {
+    memory->destroy_kokkos(k_vatom,vatom);
+    memory->destroy(jump_first);
+    memory->destroy(jump_dest);
+    memory->destroy(jump_w);
+    memory->destroy(a_base);
+    memory->destroy(pop);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template<class DeviceType>
+void PairSsaTsdpdWtKokkos<DeviceType>::compute(int eflag_in, int vflag_in)
+{
+  eflag = eflag_in;
+  vflag = vflag_in;
+
+  if (eflag || vflag) ev_setup(eflag,vflag,0);
+  else evflag = vflag_fdotr = 0;
+
+  // reallocate per-atom arrays if necessary
+
+  if (vflag_atom) {
+    memory->destroy_kokkos(k_vatom,vatom);
+    memory->create_kokkos(k_vatom,vatom,maxvatom,6,"pair:vatom");
+    d_vatom = k_vatom.view<DeviceType>();
+  }
+
+  atomKK->sync(execution_space,datamask_read);
+  if (eflag || vflag) atomKK->modified(execution_space,datamask_modify);
+  else atomKK->modified(execution_space,
+                        F_MASK | DRHO_MASK | DE_MASK | TDPD_Q_MASK);
+
+  x = atomKK->k_x.view<DeviceType>();
+  vest = atomKK->k_vest.view<DeviceType>();
+  f = atomKK->k_f.view<DeviceType>();
+  type = atomKK->k_type.view<DeviceType>();
+  mass = atomKK->k_mass.view<DeviceType>();
+  rho = atomKK->k_rho.view<DeviceType>();
+  e = atomKK->k_e.view<DeviceType>();
+  drho = atomKK->k_drho.view<DeviceType>();
+  de = atomKK->k_de.view<DeviceType>();
+  C = atomKK->k_C.view<DeviceType>();
+  Q = atomKK->k_Q.view<DeviceType>();
+  nlocal = atom->nlocal;
+  nall = atom->nlocal + atom->nghost;
+  newton_pair = force->newton_pair;
+  dimension = domain->dimension;
+  boltz = force->boltz;
+  dtinv = 1.0 / update->dt;
+  modified_mass_flag = atom->modified_mass_flag;
+  modified_mass_type = atom->modified_mass_type;
+  modified_mass = atom->modified_mass;
+
+  k_params.template sync<DeviceType>();
+  k_rho0.template sync<DeviceType>();
+  k_soundspeed.template sync<DeviceType>();
+  k_B.template sync<DeviceType>();
+  k_kappa.template sync<DeviceType>();
+
+  NeighListKokkos<DeviceType>* k_list =
+    static_cast<NeighListKokkos<DeviceType>*>(list);
+  d_numneigh = k_list->d_numneigh;
+  d_neighbors = k_list->d_neighbors;
+  d_ilist = k_list->d_ilist;
+  int inum = list->inum;
+
+  // jump weights are only needed when there are discrete species
+
+  if (nssa > 0 && (k_wij.d_view.dimension_0() < d_neighbors.dimension_0() ||
+                   k_wij.d_view.dimension_1() < d_neighbors.dimension_1())) {
+    k_wij = DAT::tdual_ffloat_2d("pair:wij",d_neighbors.dimension_0(),
+                                 d_neighbors.dimension_1());
+    k_wji = DAT::tdual_ffloat_2d("pair:wji",d_neighbors.dimension_0(),
+                                 d_neighbors.dimension_1());
+  }
+  d_wij = k_wij.template view<DeviceType>();
+  d_wji = k_wji.template view<DeviceType>();
+
+  // Call cleanup_copy which sets allocations NULL which are destructed by the PairStyle
+
+  k_list->clean_copy();
+  copymode = 1;
+
+  // loop over neighbors of my atoms
+
+  EV_FLOAT ev;
+
+  if (evflag) {
+    if (neighflag == HALF) {
+      if (newton_pair) {
+        Kokkos::parallel_reduce(Kokkos::RangePolicy<DeviceType, TagPairSsaTsdpdWtCompute<HALF,1,1> >(0,inum),*this,ev);
+      } else {
+        Kokkos::parallel_reduce(Kokkos::RangePolicy<DeviceType, TagPairSsaTsdpdWtCompute<HALF,0,1> >(0,inum),*this,ev);
+      }
+    } else if (neighflag == HALFTHREAD) {
+      if (newton_pair) {
+        Kokkos::parallel_reduce(Kokkos::RangePolicy<DeviceType, TagPairSsaTsdpdWtCompute<HALFTHREAD,1,1> >(0,inum),*this,ev);
+      } else {
+        Kokkos::parallel_reduce(Kokkos::RangePolicy<DeviceType, TagPairSsaTsdpdWtCompute<HALFTHREAD,0,1> >(0,inum),*this,ev);
+      }
+    }
+  } else {
+    if (neighflag == HALF) {
+      if (newton_pair) {
+        Kokkos::parallel_for(Kokkos::RangePolicy<DeviceType, TagPairSsaTsdpdWtCompute<HALF,1,0> >(0,inum),*this);
+      } else {
+        Kokkos::parallel_for(Kokkos::RangePolicy<DeviceType, TagPairSsaTsdpdWtCompute<HALF,0,0> >(0,inum),*this);
+      }
+    } else if (neighflag == HALFTHREAD) {
+      if (newton_pair) {
+        Kokkos::parallel_for(Kokkos::RangePolicy<DeviceType, TagPairSsaTsdpdWtCompute<HALFTHREAD,1,0> >(0,inum),*this);
+      } else {
+        Kokkos::parallel_for(Kokkos::RangePolicy<DeviceType, TagPairSsaTsdpdWtCompute<HALFTHREAD,0,0> >(0,inum),*this);
+      }
+    }
+  }
+
+  if (vflag_global) {
+    virial[0] += ev.v[0];
+    virial[1] += ev.v[1];
+    virial[2] += ev.v[2];
+    virial[3] += ev.v[3];
+    virial[4] += ev.v[4];
+    virial[5] += ev.v[5];
+  }
+
+  if (vflag_fdotr) pair_virial_fdotr_compute(this);
+
+  if (vflag_atom) {
+    k_vatom.template modify<DeviceType>();
+    k_vatom.template sync<LMPHostType>();
+  }
+
+  copymode = 0;
+
+  if (nssa > 0) ssa_diffusion(inum);
+}
+
+/* ----------------------------------------------------------------------
+   global settings
+------------------------------------------------------------------------- */
+
+template<class DeviceType>
+void PairSsaTsdpdWtKokkos<DeviceType>::settings(int narg, char **arg)
+{
+  PairSsaTsdpdWt::settings(narg,arg);
+  if (dfsp_flag)
+    error->all(FLERR,"Pair style ssa_tsdpd/wt/kk does not support diffusion dfsp");
+
+  rand_pool.init(seed,DeviceType::max_hardware_threads());
+  host_rand_pool.init(seed + universe->nprocs,LMPHostType::max_hardware_threads());
+}
+
+/* ----------------------------------------------------------------------
+   init specific to this pair style
+------------------------------------------------------------------------- */
+
+template<class DeviceType>
+void PairSsaTsdpdWtKokkos<DeviceType>::init_style()
+{
+  PairSsaTsdpdWt::init_style();
+
+  if (strcmp(atom->atom_style,"ssa_tsdpd/kk") != 0)
+    error->all(FLERR,"Pair style ssa_tsdpd/wt/kk requires "
+               "atom style ssa_tsdpd/kk");
+
+  // irequest = neigh request made by parent class
+
+  neighflag = lmp->kokkos->neighflag;
+  int irequest = neighbor->nrequest - 1;
+
+  neighbor->requests[irequest]->
+    kokkos_host = Kokkos::Impl::is_same<DeviceType,LMPHostType>::value &&
+    !Kokkos::Impl::is_same<DeviceType,LMPDeviceType>::value;
+  neighbor->requests[irequest]->
+    kokkos_device = Kokkos::Impl::is_same<DeviceType,LMPDeviceType>::value;
+
+  if (neighflag == HALF || neighflag == HALFTHREAD) {
+    neighbor->requests[irequest]->full = 0;
+    neighbor->requests[irequest]->half = 1;
+  } else {
+    error->all(FLERR,"Cannot use chosen neighbor list style with "
+               "pair ssa_tsdpd/wt/kk");
+  }
+
+  // per-type parameters, per-pair ones are set in init_one()
+
+  int n = atom->ntypes;
+  ntdpd = atom->num_tdpd_species;
+  nssa = atom->num_ssa_species;
+
+  k_params = Kokkos::DualView<params_ssa_tsdpd**,Kokkos::LayoutRight,
+    DeviceType>("PairSsaTsdpdWt::params",n+1,n+1);
+  params = k_params.d_view;
+
+  k_rho0 = DAT::tdual_float_1d("pair:rho0",n+1);
+  k_soundspeed = DAT::tdual_float_1d("pair:soundspeed",n+1);
+  k_B = DAT::tdual_float_1d("pair:B",n+1);
+  for (int i = 1; i <= n; i++) {
+    k_rho0.h_view(i) = rho0[i];
+    k_soundspeed.h_view(i) = soundspeed[i];
+    k_B.h_view(i) = B[i];
+  }
+  k_rho0.template modify<LMPHostType>();
+  k_soundspeed.template modify<LMPHostType>();
+  k_B.template modify<LMPHostType>();
+  k_rho0.template sync<DeviceType>();
+  k_soundspeed.template sync<DeviceType>();
+  k_B.template sync<DeviceType>();
+  d_rho0 = k_rho0.template view<DeviceType>();
+  d_soundspeed = k_soundspeed.template view<DeviceType>();
+  d_B = k_B.template view<DeviceType>();
+
+  k_kappa = tdual_ffloat_3d("pair:kappa",n+1,n+1,ntdpd+nssa > 0 ? ntdpd+nssa : 1);
+  d_kappa = k_kappa.template view<DeviceType>();
+
+  atomKK->k_mass.modify<LMPHostType>();
+  atomKK->k_mass.sync<DeviceType>();
+}
+
+/* ----------------------------------------------------------------------
+   init for one type pair i,j and corresponding j,i
+------------------------------------------------------------------------- */
+
+template<class DeviceType>
+double PairSsaTsdpdWtKokkos<DeviceType>::init_one(int i, int j)
+{
+  double cutone = PairSsaTsdpdWt::init_one(i,j);
+
+  k_params.h_view(i,j).cut = cut[i][j];
+  k_params.h_view(i,j).cutsq = cutone*cutone;
+  k_params.h_view(i,j).viscosity = viscosity[i][j];
+  k_params.h_view(i,j).cutc = cutc[i][j];
+  k_params.h_view(j,i) = k_params.h_view(i,j);
+  for (int k = 0; k < ntdpd + nssa; k++)
+    k_kappa.h_view(i,j,k) = k_kappa.h_view(j,i,k) = kappa[i][j][k];
+
+  k_params.template modify<LMPHostType>();
+  k_kappa.template modify<LMPHostType>();
+
+  return cutone;
+}
+
+/* ----------------------------------------------------------------------
+   Lucy kernel, returns (1/r dW/dr) in wfd and W in wf
+------------------------------------------------------------------------- */
+
+template<class DeviceType>
+KOKKOS_INLINE_FUNCTION
+void PairSsaTsdpdWtKokkos<DeviceType>::lucy(const F_FLOAT &h,
+                                            const F_FLOAT &r,
+                                            F_FLOAT &wfd, F_FLOAT &wf) const
+{
+  const F_FLOAT ih = 1.0 / h;
+  const F_FLOAT ihsq = ih * ih;
+  const F_FLOAT hr = h - r;
+
+  if (dimension == 3) {
+    wfd = -25.066903536973515383e0 * hr * hr * ihsq * ihsq * ihsq * ih;
+    wf = 2.088908628081126 * hr * hr * hr * ihsq * ihsq * (h + 3.*r);
+  } else if (dimension == 2) {
+    wfd = -19.098593171027440292e0 * hr * hr * ihsq * ihsq * ihsq;
+    wf = 1.591549430918954 * hr * hr * hr * ihsq * ihsq * (h + 3.*r);
+  } else {
+    wfd = -15.0 * hr * hr * ihsq * ihsq * ih;
+    const F_FLOAT q = 1. - r*ih;
+    wf = (5./4.) * ih * q * q * q * (1. + 3.*r*ih);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template<class DeviceType>
+template<int NEIGHFLAG, int NEWTON_PAIR, int EVFLAG>
+KOKKOS_INLINE_FUNCTION
+void PairSsaTsdpdWtKokkos<DeviceType>::operator()(TagPairSsaTsdpdWtCompute<NEIGHFLAG,NEWTON_PAIR,EVFLAG>, const int &ii, EV_FLOAT& ev) const {
+
+  // f, drho, de and Q are atomic for Half/Thread neighbor style
+  Kokkos::View<F_FLOAT*[3], typename DAT::t_f_array::array_layout,DeviceType,Kokkos::MemoryTraits<AtomicF<NEIGHFLAG>::value> > a_f = f;
+  Kokkos::View<LMP_FLOAT*, typename DAT::t_float_1d::array_layout,DeviceType,Kokkos::MemoryTraits<AtomicF<NEIGHFLAG>::value> > a_drho = drho;
+  Kokkos::View<LMP_FLOAT*, typename DAT::t_float_1d::array_layout,DeviceType,Kokkos::MemoryTraits<AtomicF<NEIGHFLAG>::value> > a_de = de;
+  Kokkos::View<LMP_FLOAT**, typename DAT::t_float_2d::array_layout,DeviceType,Kokkos::MemoryTraits<AtomicF<NEIGHFLAG>::value> > a_Q = Q;
+
+  const double eps_xsph = 0.5;
+
+  const int i = d_ilist[ii];
+  const X_FLOAT xtmp = x(i,0);
+  const X_FLOAT ytmp = x(i,1);
+  const X_FLOAT ztmp = x(i,2);
+  const F_FLOAT vxtmp = vest(i,0);
+  const F_FLOAT vytmp = vest(i,1);
+  const F_FLOAT vztmp = vest(i,2);
+  const int itype = type(i);
+  const F_FLOAT imass = mass(itype);
+  const F_FLOAT rhoi = rho(i);
+  const int jnum = d_numneigh[i];
+
+  // pressure of atom i with Tait EOS
+
+  F_FLOAT tmp = rhoi / d_rho0(itype);
+  F_FLOAT fi = tmp * tmp * tmp;
+  fi = d_B(itype) * (fi * fi * tmp - 1.0) / (rhoi * rhoi);
+
+  rand_type rand_gen = rand_pool.get_state();
+
+  F_FLOAT fxtmp = 0.0;
+  F_FLOAT fytmp = 0.0;
+  F_FLOAT fztmp = 0.0;
+  F_FLOAT drhotmp = 0.0;
+  F_FLOAT detmp = 0.0;
+
+  for (int jj = 0; jj < jnum; jj++) {
+    int j = d_neighbors(i,jj);
+    j &= NEIGHMASK;
+    if (nssa > 0) {
+      d_wij(i,jj) = 0.0;
+      d_wji(i,jj) = 0.0;
+    }
+
+    const X_FLOAT delx = xtmp - x(j,0);
+    const X_FLOAT dely = ytmp - x(j,1);
+    const X_FLOAT delz = ztmp - x(j,2);
+    const F_FLOAT rsq = delx*delx + dely*dely + delz*delz;
+    const int jtype = type(j);
+
+    if (rsq >= params(itype,jtype).cutsq) continue;
+
+    const F_FLOAT jmass = mass(jtype);
+    const F_FLOAT rhoj = rho(j);
+    const F_FLOAT r = sqrt(rsq);
+    F_FLOAT h = params(itype,jtype).cut;
+    F_FLOAT wfd,wf;
+    lucy(h,r,wfd,wf);
+
+    // pressure of atom j with Tait EOS
+
+    tmp = rhoj / d_rho0(jtype);
+    F_FLOAT fj = tmp * tmp * tmp;
+    fj = d_B(jtype) * (fj * fj * tmp - 1.0) / (rhoj * rhoj);
+
+    const F_FLOAT velx = vxtmp - vest(j,0);
+    const F_FLOAT vely = vytmp - vest(j,1);
+    const F_FLOAT velz = vztmp - vest(j,2);
+    const F_FLOAT delVdotDelR = delx*velx + dely*vely + delz*velz;
+
+    // artificial viscosity (Monaghan, 1992)
+
+    const F_FLOAT csum = d_soundspeed(itype) + d_soundspeed(jtype);
+    F_FLOAT fvisc = 0.0;
+    if (delVdotDelR < 0.) {
+      const F_FLOAT mu = delVdotDelR / (rsq + 0.01 * h * h);
+      fvisc = -8. * params(itype,jtype).viscosity * csum * mu / (rhoi + rhoj);
+    }
+    fvisc *= imass * jmass * wfd / (0.5*(rhoi + rhoj) * 0.5*csum);
+
+    const F_FLOAT fpair = imass * jmass * (fi + fj) * wfd;
+
+    // random force from the symmetric traceless part of a Wiener matrix
+
+    F_FLOAT wiener[3][3] = {{0.0,0.0,0.0},{0.0,0.0,0.0},{0.0,0.0,0.0}};
+    for (int l = 0; l < dimension; l++)
+      for (int m = 0; m < dimension; m++)
+        wiener[l][m] = rand_gen.normal();
+
+    wiener[0][1] = wiener[1][0] = 0.5 * (wiener[0][1] + wiener[1][0]);
+    wiener[0][2] = wiener[2][0] = 0.5 * (wiener[0][2] + wiener[2][0]);
+    wiener[1][2] = wiener[2][1] = 0.5 * (wiener[1][2] + wiener[2][1]);
+    const F_FLOAT trace_over_dim =
+      (wiener[0][0] + wiener[1][1] + wiener[2][2]) / dimension;
+    wiener[0][0] -= trace_over_dim;
+    wiener[1][1] -= trace_over_dim;
+    wiener[2][2] -= trace_over_dim;
+
+    const F_FLOAT prefactor =
+      sqrt(-4. * boltz * e(i) * (imass * jmass * wfd / (rhoi * rhoj)) * dtinv) /
+      (r + 0.01*h);
+    F_FLOAT f_random[3] = {0.0,0.0,0.0};
+    for (int l = 0; l < dimension; l++)
+      f_random[l] = prefactor * (wiener[l][0]*delx + wiener[l][1]*dely +
+                                 wiener[l][2]*delz);
+
+    // total force with XSPH term (Monaghan, 1992)
+
+    const F_FLOAT xsph = eps_xsph * imass * jmass * wf / (0.5*(rhoi + rhoj));
+    const F_FLOAT fx = -delx * (fpair + fvisc) + f_random[0] - xsph * velx;
+    const F_FLOAT fy = -dely * (fpair + fvisc) + f_random[1] - xsph * vely;
+    const F_FLOAT fz = -delz * (fpair + fvisc) + f_random[2] - xsph * velz;
+
+    fxtmp += fx;
+    fytmp += fy;
+    fztmp += fz;
+
+    // density with artificial density diffusion (Molteni, 2009), energy
+
+    const F_FLOAT hdamp = rsq / (rsq + 0.01*h*h);
+    drhotmp += rhoi * jmass * delVdotDelR * wfd / rhoj -
+      0.1 * h * d_soundspeed(itype) * jmass * 2.0 *
+      (((imass/rhoi) / (jmass/rhoj)) - 1.0) * hdamp * wfd;
+
+    const F_FLOAT deltaE = -0.5 * (fpair * delVdotDelR +
+                                   fvisc * (velx*velx + vely*vely + velz*velz));
+    detmp += deltaE;
+
+    if (NEWTON_PAIR || j < nlocal) {
+      a_f(j,0) -= fx;
+      a_f(j,1) -= fy;
+      a_f(j,2) -= fz;
+      a_drho(j) += rhoj * imass * delVdotDelR * wfd / rhoi -
+        0.1 * h * d_soundspeed(jtype) * imass * 2.0 *
+        (((jmass/rhoj) / (imass/rhoi)) - 1.0) * hdamp * wfd;
+      a_de(j) += deltaE;
+    }
+
+    // transport of species
+
+    if (r < params(itype,jtype).cutc) {
+      h = params(itype,jtype).cutc;
+      lucy(h,r,wfd,wf);
+
+      F_FLOAT imass_c = imass;
+      F_FLOAT jmass_c = jmass;
+      if (modified_mass_flag == 1) {
+        if (itype == modified_mass_type) imass_c = modified_mass;
+        if (jtype == modified_mass_type) jmass_c = modified_mass;
+      }
+
+      const F_FLOAT cdamp = rsq / (rsq + 0.01*h*h);
+      const F_FLOAT dQc_base = 2.0 * jmass_c / rhoj * wfd * cdamp;
+      const F_FLOAT dQc_basei = 2.0 * imass_c / rhoi * wfd * cdamp;
+
+      for (int k = 0; k < ntdpd; k++) {
+        const F_FLOAT dC = C(i,k) - C(j,k);
+        a_Q(i,k) += d_kappa(itype,jtype,k) * dC * dQc_base;
+        if (NEWTON_PAIR || j < nlocal)
+          a_Q(j,k) -= d_kappa(jtype,itype,k) * dC * dQc_basei;
+      }
+
+      if (nssa > 0) {
+        d_wij(i,jj) = -dQc_base;
+        d_wji(i,jj) = -dQc_basei;
+      }
+    }
+
+    if (EVFLAG && vflag_either)
+      this->template ev_tally<NEIGHFLAG,NEWTON_PAIR>(ev,i,j,fpair,delx,dely,delz);
+  }
+
+  rand_pool.free_state(rand_gen);
+
+  a_f(i,0) += fxtmp;
+  a_f(i,1) += fytmp;
+  a_f(i,2) += fztmp;
+  a_drho(i) += drhotmp;
+  a_de(i) += detmp;
+}
+
+template<class DeviceType>
+template<int NEIGHFLAG, int NEWTON_PAIR, int EVFLAG>
+KOKKOS_INLINE_FUNCTION
+void PairSsaTsdpdWtKokkos<DeviceType>::operator()(TagPairSsaTsdpdWtCompute<NEIGHFLAG,NEWTON_PAIR,EVFLAG>, const int &ii) const {
+  EV_FLOAT ev;
+  this->template operator()<NEIGHFLAG,NEWTON_PAIR,EVFLAG>(TagPairSsaTsdpdWtCompute<NEIGHFLAG,NEWTON_PAIR,EVFLAG>(), ii, ev);
+}
+
+/* ---------------------------------------------------------------------- */
+
+template<class DeviceType>
+template<int NEIGHFLAG, int NEWTON_PAIR>
+KOKKOS_INLINE_FUNCTION
+void PairSsaTsdpdWtKokkos<DeviceType>::ev_tally(EV_FLOAT &ev, const int &i, const int &j,
+      const F_FLOAT &fpair, const F_FLOAT &delx,
+                const F_FLOAT &dely, const F_FLOAT &delz) const
+{
+  // The vatom array is atomic for Half/Thread neighbor style
+  Kokkos::View<F_FLOAT*[6], typename DAT::t_virial_array::array_layout,DeviceType,Kokkos::MemoryTraits<AtomicF<NEIGHFLAG>::value> > v_vatom = k_vatom.view<DeviceType>();
+
+  const E_FLOAT v0 = delx*delx*fpair;
+  const E_FLOAT v1 = dely*dely*fpair;
+  const E_FLOAT v2 = delz*delz*fpair;
+  const E_FLOAT v3 = delx*dely*fpair;
+  const E_FLOAT v4 = delx*delz*fpair;
+  const E_FLOAT v5 = dely*delz*fpair;
+
+  if (vflag_global) {
+    if (NEWTON_PAIR || i < nlocal) {
+      ev.v[0] += 0.5*v0;
+      ev.v[1] += 0.5*v1;
+      ev.v[2] += 0.5*v2;
+      ev.v[3] += 0.5*v3;
+      ev.v[4] += 0.5*v4;
+      ev.v[5] += 0.5*v5;
+    }
+    if (NEWTON_PAIR || j < nlocal) {
+      ev.v[0] += 0.5*v0;
+      ev.v[1] += 0.5*v1;
+      ev.v[2] += 0.5*v2;
+      ev.v[3] += 0.5*v3;
+      ev.v[4] += 0.5*v4;
+      ev.v[5] += 0.5*v5;
+    }
+  }
+
+  if (vflag_atom) {
+    if (NEWTON_PAIR || i < nlocal) {
+      v_vatom(i,0) += 0.5*v0;
+      v_vatom(i,1) += 0.5*v1;
+      v_vatom(i,2) += 0.5*v2;
+      v_vatom(i,3) += 0.5*v3;
+      v_vatom(i,4) += 0.5*v4;
+      v_vatom(i,5) += 0.5*v5;
+    }
+    if (NEWTON_PAIR || j < nlocal) {
+      v_vatom(j,0) += 0.5*v0;
+      v_vatom(j,1) += 0.5*v1;
+      v_vatom(j,2) += 0.5*v2;
+      v_vatom(j,3) += 0.5*v3;
+      v_vatom(j,4) += 0.5*v4;
+      v_vatom(j,5) += 0.5*v5;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   SSA diffusion of the discrete species Cd, stored as jumps in Qd
+   outbound jump rates of every voxel are collected from the half
+   neighbor list into a CSR graph on the host, molecules only leave owned
+   voxels, jumps into ghosts are summed to their owners by the reverse
+   comm of Qd
+------------------------------------------------------------------------- */
+
+template<class DeviceType>
+void PairSsaTsdpdWtKokkos<DeviceType>::ssa_diffusion(int inum)
+{
+  int ii,jj,i,j,v,m;
+
+  timer->sub_start(Timer::SSA_DIFFUSION);
+
+  typename AT::t_neighbors_2d::HostMirror h_neighbors =
+    Kokkos::create_mirror_view(d_neighbors);
+  typename AT::t_int_1d::HostMirror h_ilist = Kokkos::create_mirror_view(d_ilist);
+  typename AT::t_int_1d::HostMirror h_numneigh =
+    Kokkos::create_mirror_view(d_numneigh);
+  Kokkos::deep_copy(h_neighbors,d_neighbors);
+  Kokkos::deep_copy(h_ilist,d_ilist);
+  Kokkos::deep_copy(h_numneigh,d_numneigh);
+
+  k_wij.template modify<DeviceType>();
+  k_wij.template sync<LMPHostType>();
+  k_wji.template modify<DeviceType>();
+  k_wji.template sync<LMPHostType>();
+  HAT::t_ffloat_2d h_wij = k_wij.h_view;
+  HAT::t_ffloat_2d h_wji = k_wji.h_view;
+
+  atomKK->sync(Host,TYPE_MASK | SSA_CD_MASK | SSA_QD_MASK);
+
+  if (nall > maxvoxel) {
+    maxvoxel = atom->nmax;
+    memory->destroy(jump_first);
+    memory->destroy(a_base);
+    memory->destroy(pop);
+    memory->create(jump_first,maxvoxel+1,"pair:jump_first");
+    memory->create(a_base,maxvoxel,nssa,"pair:a_base");
+    memory->create(pop,maxvoxel,nssa,"pair:pop");
+  }
+
+  // count, then place, the outbound jumps of each voxel
+
+  for (v = 0; v <= nall; v++) jump_first[v] = 0;
+  for (ii = 0; ii < inum; ii++) {
+    i = h_ilist(ii);
+    for (jj = 0; jj < h_numneigh(i); jj++) {
+      if (h_wij(i,jj) <= 0.0) continue;
+      j = h_neighbors(i,jj) & NEIGHMASK;
+      jump_first[i+1]++;
+      jump_first[j+1]++;
+    }
+  }
+  for (v = 0; v < nall; v++) jump_first[v+1] += jump_first[v];
+
+  if (jump_first[nall] > maxjump) {
+    maxjump = jump_first[nall];
+    memory->destroy(jump_dest);
+    memory->destroy(jump_w);
+    memory->create(jump_dest,maxjump,"pair:jump_dest");
+    memory->create(jump_w,maxjump,"pair:jump_w");
+  }
+
+  for (ii = 0; ii < inum; ii++) {
+    i = h_ilist(ii);
+    for (jj = 0; jj < h_numneigh(i); jj++) {
+      if (h_wij(i,jj) <= 0.0) continue;
+      j = h_neighbors(i,jj) & NEIGHMASK;
+      m = jump_first[i]++;
+      jump_dest[m] = j;
+      jump_w[m] = h_wij(i,jj);
+      m = jump_first[j]++;
+      jump_dest[m] = i;
+      jump_w[m] = h_wji(i,jj);
+    }
+  }
+  for (v = nall; v > 0; v--) jump_first[v] = jump_first[v-1];
+  jump_first[0] = 0;
+
+  PairSsaTsdpdWtSSADiffusionFunctor
+    functor(atom->nlocal,ntdpd,update->dt,jump_first,jump_dest,jump_w,a_base,pop,
+            atomKK->k_type.h_view,atomKK->k_Cd.h_view,atomKK->k_Qd.h_view,
+            kappa,host_rand_pool);
+  Kokkos::parallel_for(Kokkos::RangePolicy<LMPHostType>(0,nssa),functor);
+  LMPHostType::fence();
+
+  atomKK->modified(Host,SSA_QD_MASK);
+  atomKK->sync(execution_space,SSA_QD_MASK);
+
+  timer->sub_stamp(Timer::SSA_DIFFUSION);
+}
+
+namespace LAMMPS_NS {
+template class PairSsaTsdpdWtKokkos<LMPDeviceType>;
+#ifdef KOKKOS_HAVE_CUDA
+template class PairSsaTsdpdWtKokkos<LMPHostType>;
+#endif
+}
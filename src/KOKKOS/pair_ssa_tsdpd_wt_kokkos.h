@@ -0,0 +1,158 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(ssa_tsdpd/wt/kk,PairSsaTsdpdWtKokkos<LMPDeviceType>)
+PairStyle(ssa_tsdpd/wt/kk/device,PairSsaTsdpdWtKokkos<LMPDeviceType>)
+PairStyle(ssa_tsdpd/wt/kk/host,PairSsaTsdpdWtKokkos<LMPHostType>)
+
+#else
+
+#ifndef LMP_PAIR_SSA_TSDPD_WT_KOKKOS_H
+#define LMP_PAIR_SSA_TSDPD_WT_KOKKOS_H
+
+#include "pair_kokkos.h"
+#include "pair_ssa_tsdpd_wt.h"
+#include "neigh_list_kokkos.h"
+#include "Kokkos_Random.hpp"
+
+namespace LAMMPS_NS {
+
+template<int NEIGHFLAG, int NEWTON_PAIR, int EVFLAG>
+struct TagPairSsaTsdpdWtCompute{};
+
+template<class DeviceType>
+class PairSsaTsdpdWtKokkos : public PairSsaTsdpdWt {
+ public:
+  enum {EnabledNeighFlags=HALFTHREAD|HALF};
+  typedef DeviceType device_type;
+  typedef ArrayTypes<DeviceType> AT;
+  typedef EV_FLOAT value_type;
+
+  PairSsaTsdpdWtKokkos(class LAMMPS *);
+  virtual ~PairSsaTsdpdWtKokkos();
+  virtual void compute(int, int);
+  void settings(int, char **);
+  void init_style();
+  double init_one(int, int);
+
+  template<int NEIGHFLAG, int NEWTON_PAIR, int EVFLAG>
+  KOKKOS_INLINE_FUNCTION
+  void operator()(TagPairSsaTsdpdWtCompute<NEIGHFLAG,NEWTON_PAIR,EVFLAG>,
+                  const int&, EV_FLOAT&) const;
+
+  template<int NEIGHFLAG, int NEWTON_PAIR, int EVFLAG>
+  KOKKOS_INLINE_FUNCTION
+  void operator()(TagPairSsaTsdpdWtCompute<NEIGHFLAG,NEWTON_PAIR,EVFLAG>,
+                  const int&) const;
+
+  template<int NEIGHFLAG, int NEWTON_PAIR>
+  KOKKOS_INLINE_FUNCTION
+  void ev_tally(EV_FLOAT &ev, const int &i, const int &j,
+                const F_FLOAT &fpair, const F_FLOAT &delx,
+                const F_FLOAT &dely, const F_FLOAT &delz) const;
+
+  KOKKOS_INLINE_FUNCTION
+  void lucy(const F_FLOAT &, const F_FLOAT &, F_FLOAT &, F_FLOAT &) const;
+
+  struct params_ssa_tsdpd {
+    KOKKOS_INLINE_FUNCTION
+    params_ssa_tsdpd() {cut=0;cutsq=0;viscosity=0;cutc=0;};
+    KOKKOS_INLINE_FUNCTION
+    params_ssa_tsdpd(int i) {cut=0;cutsq=0;viscosity=0;cutc=0;};
+    F_FLOAT cut,cutsq,viscosity,cutc;
+  };
+
+ protected:
+  typename AT::t_x_array_randomread x;
+  typename AT::t_v_array_randomread vest;
+  typename AT::t_f_array f;
+  typename AT::t_int_1d_randomread type;
+  typename AT::t_float_1d_randomread mass;
+  typename AT::t_float_1d_randomread rho,e;
+  typename AT::t_float_1d drho,de;
+  typename AT::t_float_2d_randomread C;
+  typename AT::t_float_2d Q;
+
+  DAT::tdual_virial_array k_vatom;
+  typename AT::t_virial_array d_vatom;
+
+  Kokkos::DualView<params_ssa_tsdpd**,Kokkos::LayoutRight,DeviceType> k_params;
+  typename Kokkos::DualView<params_ssa_tsdpd**,
+    Kokkos::LayoutRight,DeviceType>::t_dev_const_um params;
+
+  DAT::tdual_float_1d k_rho0,k_soundspeed,k_B;
+  typename AT::t_float_1d_randomread d_rho0,d_soundspeed,d_B;
+
+  typedef Kokkos::DualView<F_FLOAT***,Kokkos::LayoutRight,DeviceType>
+    tdual_ffloat_3d;
+  tdual_ffloat_3d k_kappa;
+  typename tdual_ffloat_3d::t_dev_const_randomread d_kappa;
+
+  // outbound DFSP jump weights i->j and j->i of every neighbor pair,
+  // handed to the SSA diffusion stage on the host
+
+  DAT::tdual_ffloat_2d k_wij,k_wji;
+  typename AT::t_ffloat_2d d_wij,d_wji;
+
+  typename AT::t_neighbors_2d d_neighbors;
+  typename AT::t_int_1d d_ilist;
+  typename AT::t_int_1d d_numneigh;
+
+  Kokkos::Random_XorShift64_Pool<DeviceType> rand_pool;
+  typedef typename Kokkos::Random_XorShift64_Pool<DeviceType>::generator_type
+    rand_type;
+  Kokkos::Random_XorShift64_Pool<LMPHostType> host_rand_pool;
+
+  int neighflag,newton_pair;
+  int nlocal,nall,eflag,vflag;
+  int dimension,ntdpd,nssa;
+  int modified_mass_flag,modified_mass_type;
+  double modified_mass;
+  double boltz,dtinv;
+
+  // host CSR of outbound jumps per voxel used by the SSA diffusion stage
+
+  int maxvoxel,maxjump;
+  int *jump_first,*jump_dest;
+  double *jump_w;
+  double **a_base;
+  int **pop;
+
+  void ssa_diffusion(int);
+
+  friend void pair_virial_fdotr_compute<PairSsaTsdpdWtKokkos>(PairSsaTsdpdWtKokkos*);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Cannot use chosen neighbor list style with pair ssa_tsdpd/wt/kk
+
+Only half neighbor lists are supported, since the random and
+artificial viscosity terms are computed once per pair.
+
+E: Pair style ssa_tsdpd/wt/kk requires atom style ssa_tsdpd/kk
+
+The species arrays must be mirrored on the device.
+
+E: Pair style ssa_tsdpd/wt/kk does not support diffusion dfsp
+
+The Kokkos style diffuses the discrete species by jumps only.
+
+*/
@@ -580,7 +580,7 @@ void VerletKokkos::force_clear()
         atomKK->modified(Device,F_MASK);
       }
       if (torqueflag)  memset(&(atomKK->torque[0][0]),0,3*nbytes);
-
+      if (tsdpdflag) force_clear_tsdpd();
     }
 
   // neighbor includegroup flag is set
@@ -596,6 +596,7 @@ void VerletKokkos::force_clear()
       memset_kokkos(atomKK->k_f.view<LMPDeviceType>());
       atomKK->modified(Device,F_MASK);
     }
+    if (tsdpdflag) force_clear_tsdpd();
     if (torqueflag) {
       double **torque = atomKK->torque;
       for (i = 0; i < nall; i++) {
@@ -621,4 +622,26 @@ void VerletKokkos::force_clear()
   }
 }
 
+/* ----------------------------------------------------------------------
+   clear SDPD rates and tDPD/SSA source terms of atom_style ssa_tsdpd/kk
+   on the side they were last modified on, same as f above
+------------------------------------------------------------------------- */
 
+void VerletKokkos::force_clear_tsdpd()
+{
+  const unsigned int mask = DRHO_MASK | DE_MASK | TDPD_Q_MASK | SSA_QD_MASK;
+
+  if (atomKK->k_Q.modified_host() > atomKK->k_Q.modified_device()) {
+    memset_kokkos(atomKK->k_drho.view<LMPHostType>());
+    memset_kokkos(atomKK->k_de.view<LMPHostType>());
+    memset_kokkos(atomKK->k_Q.view<LMPHostType>());
+    memset_kokkos(atomKK->k_Qd.view<LMPHostType>());
+    atomKK->modified(Host,mask);
+  } else {
+    memset_kokkos(atomKK->k_drho.view<LMPDeviceType>());
+    memset_kokkos(atomKK->k_de.view<LMPDeviceType>());
+    memset_kokkos(atomKK->k_Q.view<LMPDeviceType>());
+    memset_kokkos(atomKK->k_Qd.view<LMPDeviceType>());
+    atomKK->modified(Device,mask);
+  }
+}
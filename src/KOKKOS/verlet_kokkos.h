@@ -45,6 +45,7 @@ class VerletKokkos : public Verlet {
   DAT::t_f_array f_merge_copy,f;
 
   void force_clear();
+  void force_clear_tsdpd();
 };
 
 }
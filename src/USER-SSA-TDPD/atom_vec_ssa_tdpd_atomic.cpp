@@ -108,8 +108,9 @@ void AtomVecSsaTdpdAtomic::grow(int n)
   x = memory->grow(atom->x,nmax,3,"atom:x");
   v = memory->grow(atom->v,nmax,3,"atom:v");
   f = memory->grow(atom->f,nmax*comm->nthreads,3,"atom:f");
-  C = memory->grow(atom->C,nmax,atom->num_tdpd_species,"atom:C"); //added (grow C)
-  Q = memory->grow(atom->Q,nmax*comm->nthreads,atom->num_tdpd_species,"atom:Q"); //added (grow Q)
+  atom->C.grow(memory,nmax,atom->num_tdpd_species,ATOM_MAJOR,"atom:C"); //added (grow C)
+  atom->Q.grow(memory,nmax*comm->nthreads,atom->num_tdpd_species,ATOM_MAJOR,"atom:Q"); //added (grow Q)
+  C = atom->C; Q = atom->Q;
   Aetd = memory->grow(atom->Aetd,nmax*comm->nthreads,3,"atom:Aetd"); //added (grow Aetd)
   Betd = memory->grow(atom->Betd,nmax*comm->nthreads,3,"atom:Betd"); //added (grow Betd)
   Cetd = memory->grow(atom->Cetd,nmax*comm->nthreads,3,"atom:Cetd"); //added (grow Cetd)
@@ -775,8 +776,8 @@ bigint AtomVecSsaTdpdAtomic::memory_usage()
   if (atom->memcheck("x")) bytes += memory->usage(x,nmax,3);
   if (atom->memcheck("v")) bytes += memory->usage(v,nmax,3);
   if (atom->memcheck("f")) bytes += memory->usage(f,nmax*comm->nthreads,3);
-  if (atom->memcheck("C")) bytes += memory->usage(C,nmax,atom->num_tdpd_species); //added
-  if (atom->memcheck("Q")) bytes += memory->usage(Q,nmax*comm->nthreads,atom->num_tdpd_species); //added
+  if (atom->memcheck("C")) bytes += C.usage(); //added
+  if (atom->memcheck("Q")) bytes += Q.usage(); //added
   if (atom->memcheck("Aetd")) bytes += memory->usage(Aetd,nmax*comm->nthreads,3); //added (etd)
   if (atom->memcheck("Betd")) bytes += memory->usage(Betd,nmax*comm->nthreads,3); //added (etd)
   if (atom->memcheck("Cetd")) bytes += memory->usage(Cetd,nmax*comm->nthreads,3); //added (etd)
@@ -21,6 +21,7 @@ AtomStyle(ssa_tdpd/atomic,AtomVecSsaTdpdAtomic)
 #define LMP_ATOM_VEC_SSA_TDPD_ATOMIC_H
 
 #include "atom_vec.h"
+#include "species_array.h"
 
 namespace LAMMPS_NS {
 
@@ -58,7 +59,7 @@ class AtomVecSsaTdpdAtomic : public AtomVec {
   int *type,*mask;
   imageint *image;
   double **x,**v,**f;
-  double **C,**Q; //added tDPD variables
+  SpeciesArray<double> C,Q; //added tDPD variables
   double **Aetd,**Betd,**Cetd; //added ETD integration terms
 };
 
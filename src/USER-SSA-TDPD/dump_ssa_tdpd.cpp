@@ -2194,7 +2194,7 @@ void DumpSsaTdpd::pack_mass(int n)
 //added
 void DumpSsaTdpd::pack_C(int n)
 {
-  double **C = atom->C;
+  SpeciesArray<double> C = atom->C;
   int index = argindex[n];
   for (int i = 0; i < nchoose; i++) {
           buf[n] = C[clist[i]][index];
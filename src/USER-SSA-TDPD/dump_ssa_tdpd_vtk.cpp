@@ -2437,7 +2437,7 @@ void DumpSsaTdpdVTK::pack_custom(int n)
 //added
 void DumpSsaTdpdVTK::pack_C(int n)
 {
-  double **C = atom->C;
+  SpeciesArray<double> C = atom->C;
   int index = argindex[current_pack_choice_key];
 
   for (int i = 0; i < nchoose; i++){
@@ -197,8 +197,8 @@ void FixBCForce::post_force(int vflag)
 	double **x = atom->x;
 	double **f = atom->f;
 	double **v = atom->v;
-	double **C = atom->C;
-	double **Q = atom->Q;
+	SpeciesArray<double> C = atom->C;
+	SpeciesArray<double> Q = atom->Q;
 	int *mask = atom->mask;
 	int nlocal = atom->nlocal;
 	double h, h1, h2, gammah, sigmah, fc, fd, fr, Qc, Qv, Qr, TT, prefactor, randnum;
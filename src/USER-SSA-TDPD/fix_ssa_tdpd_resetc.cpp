@@ -107,8 +107,8 @@ void FixSsaTdpdResetC::post_integrate()
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
   double **x = atom->x;
-  double **C = atom->C;
-  double **Q = atom->Q;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<double> Q = atom->Q;
   if (igroup == atom->firstgroup) nlocal = atom->nfirst;
 
   double drx, dry, rsq;
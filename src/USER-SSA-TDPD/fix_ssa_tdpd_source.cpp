@@ -108,8 +108,8 @@ void FixSsaTdpdSource::init()
 void FixSsaTdpdSource::post_force(int vflag)
 {
   double **x = atom->x;
-  double **C = atom->C;
-  double **Q = atom->Q;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<double> Q = atom->Q;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
   if (igroup == atom->firstgroup) nlocal = atom->nfirst;
@@ -81,7 +81,7 @@ void FixSsaTdpdVelT::end_of_step()
   int *mask = atom->mask;
   double **x = atom->x;
   double **v = atom->v;
-  double **C = atom->C;
+  SpeciesArray<double> C = atom->C;
   int t_step = update->ntimestep;
   if (t_step > st_start){
     if((dump_each - ((t_step-st_start)%dump_each))%dump_each < nevery*nrepeat)
@@ -68,8 +68,8 @@ void FixSsaTdpdVerlet::initial_integrate(int vflag)
 {
 	double dtCm;
 
-	double **C = atom->C;
-	double **Q = atom->Q;
+	SpeciesArray<double> C = atom->C;
+	SpeciesArray<double> Q = atom->Q;
 
 
 
@@ -107,8 +107,8 @@ void FixSsaTdpdVerlet::final_integrate()
 {
   double dtCm;
 
-  double **C = atom->C;
-  double **Q = atom->Q;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<double> Q = atom->Q;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
   if (igroup == atom->firstgroup) nlocal = atom->nfirst;
@@ -88,8 +88,8 @@ void PairSsaTdpd::compute(int eflag, int vflag)
   double **x = atom->x;
   double **v = atom->v;
   double **f = atom->f;
-  double **C = atom->C; //added
-  double **Q = atom->Q; //added
+  SpeciesArray<double> C = atom->C; //added
+  SpeciesArray<double> Q = atom->Q; //added
  
   double **Aetd = atom->Aetd; //added (ETD)
   double **Betd = atom->Betd; //added (ETD)
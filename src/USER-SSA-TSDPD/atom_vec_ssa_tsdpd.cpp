@@ -17,6 +17,7 @@
 #include "atom.h"
 #include "comm.h"
 #include "domain.h"
+#include "force.h"
 #include "modify.h"
 #include "fix.h"
 #include "memory.h"
@@ -24,6 +25,31 @@
 
 using namespace LAMMPS_NS;
 
+#define MAX(A,B) ((A) > (B) ? (A) : (B))
+
+// layout of the per-atom restart record, stored after vest
+// records without it (version 1) end in 4 values of the former per-atom
+//   DFSP arrays, they are still read and these values are skipped
+
+#define RESTART_VERSION 2
+
+/* ----------------------------------------------------------------------
+   gather rows of w values of atoms perm[0..n-1] into buf, copy back
+------------------------------------------------------------------------- */
+
+template<class T>
+static void reorder_rows(T *data, int w, int n, int *perm, T *buf)
+{
+  if (n <= 0 || w <= 0) return;
+
+  T *b = buf;
+  for (int i = 0; i < n; i++) {
+    T *src = &data[(bigint) perm[i]*w];
+    for (int k = 0; k < w; k++) *b++ = src[k];
+  }
+  memcpy(data,buf,sizeof(T)*((size_t) n)*((size_t) w));
+}
+
 /* ---------------------------------------------------------------------- */
 
 AtomVecSsaTsdpd::AtomVecSsaTsdpd(LAMMPS *lmp) : AtomVec(lmp)
@@ -34,9 +60,9 @@ AtomVecSsaTsdpd::AtomVecSsaTsdpd(LAMMPS *lmp) : AtomVec(lmp)
 
   comm_x_only = 0; // we communicate not only x forward but also vest ...
   comm_f_only = 0; // we also communicate de and drho in reverse direction
-  size_forward = 12; // 3 + rho + e + vest[3], that means we may only communicate 5 in hybrid (was 8 before)
+  size_forward = 8; // 3 + rho + e + vest[3], that means we may only communicate 5 in hybrid
   size_reverse = 5; // 3 + drho + de
-  size_border = 16; // 6 + rho + e + vest[3] + cv (was 12 before)
+  size_border = 12; // 6 + rho + e + vest[3] + cv
   size_velocity = 3;
   size_data_atom = 8;
   size_data_vel = 4;
@@ -48,7 +74,20 @@ AtomVecSsaTsdpd::AtomVecSsaTsdpd(LAMMPS *lmp) : AtomVec(lmp)
   atom->vest_flag = 1;
   atom->tsdpd_flag = 1;
 
+  // sort the atoms along a Hilbert curve on every reneighboring,
+  // unless atom_modify has already chosen otherwise
+
+  sortbuf = NULL;
+  maxsortbuf = 0;
+  if (!(atom->sortuser & 1) && !atom->firstgroupname) atom->sortfreq = 1;
+  if (!(atom->sortuser & 2)) atom->sortorder = Atom::SORT_HILBERT;
+}
+
+/* ---------------------------------------------------------------------- */
 
+AtomVecSsaTsdpd::~AtomVecSsaTsdpd()
+{
+  memory->sfree(sortbuf);
 }
 
 
@@ -62,6 +101,25 @@ void AtomVecSsaTsdpd::process_args(int narg, char **arg)
 {
   if (narg < 1) error->all(FLERR,"Invalid atom_style body command");
 
+  // optional trailing keywords, in any order
+  // layout = storage of C, Q, Cd, Qd
+  // ensemble = # of SSA replicas of Cd, Qd carried by each particle
+
+  while (narg >= 4 && (strcmp(arg[narg-2],"layout") == 0 ||
+                       strcmp(arg[narg-2],"ensemble") == 0)) {
+    if (strcmp(arg[narg-2],"layout") == 0) {
+      if (strcmp(arg[narg-1],"atom") == 0) atom->species_layout = ATOM_MAJOR;
+      else if (strcmp(arg[narg-1],"species") == 0)
+        atom->species_layout = SPECIES_MAJOR;
+      else error->all(FLERR,"Illegal atom_style ssa_tsdpd layout");
+    } else {
+      atom->num_ssa_replicas = force->inumeric(FLERR,arg[narg-1]);
+      if (atom->num_ssa_replicas < 1)
+        error->all(FLERR,"Illegal atom_style ssa_tsdpd ensemble");
+    }
+    narg -= 2;
+  }
+
   atom->num_tdpd_species = atoi(arg[0]);
   atom->num_ssa_species = atoi(arg[1]);
   if(narg < 3){
@@ -83,9 +141,12 @@ void AtomVecSsaTsdpd::process_args(int narg, char **arg)
     atom->concentration_conversion = atof(arg[4]);
  }
   
-  size_forward   += atom->num_tdpd_species + atom->num_ssa_species + 2 * atom->num_ssa_reactions * atom->num_ssa_species + atom->num_ssa_reactions;
-  size_reverse   += atom->num_tdpd_species + atom->num_ssa_species;
-  size_border    += atom->num_tdpd_species + atom->num_ssa_species + 2 * atom->num_ssa_reactions * atom->num_ssa_species + atom->num_ssa_reactions;
+  // Cd and Qd hold all replicas, data files give the values of one
+
+  int ncd = atom->num_ssa_species * atom->num_ssa_replicas;
+  size_forward   += atom->num_tdpd_species + ncd + 2 * atom->num_ssa_reactions * atom->num_ssa_species + atom->num_ssa_reactions;
+  size_reverse   += atom->num_tdpd_species + ncd;
+  size_border    += atom->num_tdpd_species + ncd + 2 * atom->num_ssa_reactions * atom->num_ssa_species + atom->num_ssa_reactions;
   size_data_atom += atom->num_tdpd_species + atom->num_ssa_species + 2 * atom->num_ssa_reactions * atom->num_ssa_species + atom->num_ssa_reactions;
 
 
@@ -107,13 +168,8 @@ void AtomVecSsaTsdpd::grow(int n)
 //  printf("in AtomVecSsaTsdpd::grow\n");
 
   int num_ssa_reactions = atom->num_ssa_reactions;
-  int num_tdpd_species = atom->num_tdpd_species;
   int num_ssa_species = atom->num_ssa_species;
-  
 
-  if (num_ssa_species == 0) num_ssa_species = 1;
-  if (num_ssa_reactions == 0) num_ssa_reactions = 1;
-  
   if (n == 0) grow_nmax();
   else nmax = n;
   atom->nmax = nmax;
@@ -135,18 +191,29 @@ void AtomVecSsaTsdpd::grow(int n)
   vest = memory->grow(atom->vest, nmax, 3, "atom:vest");
   cv = memory->grow(atom->cv, nmax, "atom:cv");
  
-  C = memory->grow(atom->C,nmax,atom->num_tdpd_species,"atom:C"); //added (grow C)
-  Q = memory->grow(atom->Q,nmax*comm->nthreads,atom->num_tdpd_species,"atom:Q"); //added (grow Q)
-
-  Cd = memory->grow(atom->Cd,nmax,num_ssa_species,"atom:Cd"); //added (grow Cd)
-  Qd = memory->grow(atom->Qd,nmax*comm->nthreads,num_ssa_species,"atom:Qd"); //added (grow Qd)
-  ssa_rxn_propensity = memory->grow(atom->ssa_rxn_propensity,nmax*comm->nthreads,num_ssa_reactions,"atom:ssa_rxn_propensity"); //added (grow ssa_rxn_propensity)
-  d_ssa_rxn_prop_d_c = memory->grow(atom->d_ssa_rxn_prop_d_c,nmax*comm->nthreads,num_ssa_reactions,num_ssa_species,"atom:d_ssa_rxn_prop_d_c"); //added (grow d_ssa_rxn_prop_d_c)
-  ssa_stoich_matrix = memory->grow(atom->ssa_stoich_matrix,nmax*comm->nthreads,num_ssa_reactions,num_ssa_species,"atom:ssa_stoich_matrix"); //added (grow ssa_stoich_matrix)
-  dfsp_D_matrix = memory->grow(atom->dfsp_D_matrix,nmax*nmax,"atom:dfsp_D_matrix");
-  dfsp_D_diag = memory->grow(atom->dfsp_D_diag,nmax,"atom:dfsp_D_diag");
-  dfsp_Diffusion_coeff = memory->grow(atom->dfsp_Diffusion_coeff,nmax*nmax*num_ssa_species,"atom:dfsp_Diffusion_coeff");
-  dfsp_a_i = memory->grow(atom->dfsp_a_i, nmax,"atom:dfsp_a_i");
+  int layout = atom->species_layout;
+  atom->C.grow(memory,nmax,atom->num_tdpd_species,layout,"atom:C"); //added (grow C)
+  atom->Q.grow(memory,nmax*comm->nthreads,atom->num_tdpd_species,layout,"atom:Q"); //added (grow Q)
+  C = atom->C; Q = atom->Q;
+
+  // SSA arrays only exist for the species and reactions of the style,
+  // a pure SDPD run allocates none of them
+  // only Qd is accumulated per thread, the reaction arrays are written
+  // per atom by the reaction fixes and are not replicated
+
+  // replica q of species s is column q*num_ssa_species + s of Cd and Qd
+
+  int ncd = num_ssa_species * atom->num_ssa_replicas;
+  atom->Cd.grow(memory,nmax,ncd,layout,"atom:Cd"); //added (grow Cd)
+  atom->Qd.grow(memory,nmax*comm->nthreads,ncd,layout,"atom:Qd"); //added (grow Qd)
+  Cd = atom->Cd; Qd = atom->Qd;
+  if (num_ssa_reactions > 0) {
+    ssa_rxn_propensity = memory->grow(atom->ssa_rxn_propensity,nmax,num_ssa_reactions,"atom:ssa_rxn_propensity"); //added (grow ssa_rxn_propensity)
+    if (num_ssa_species > 0) {
+      d_ssa_rxn_prop_d_c = memory->grow(atom->d_ssa_rxn_prop_d_c,nmax,num_ssa_reactions,num_ssa_species,"atom:d_ssa_rxn_prop_d_c"); //added (grow d_ssa_rxn_prop_d_c)
+      ssa_stoich_matrix = memory->grow(atom->ssa_stoich_matrix,nmax,num_ssa_reactions,num_ssa_species,"atom:ssa_stoich_matrix"); //added (grow ssa_stoich_matrix)
+    }
+  }
 
 
   if (atom->nextra_grow)
@@ -184,10 +251,6 @@ void AtomVecSsaTsdpd::grow_reset() {
   d_ssa_rxn_prop_d_c = atom->d_ssa_rxn_prop_d_c; //added
 
   ssa_stoich_matrix = atom->ssa_stoich_matrix;  //added
-  dfsp_D_matrix = atom->dfsp_D_matrix; //added
-  dfsp_D_diag = atom->dfsp_D_diag; //added
-  dfsp_Diffusion_coeff = atom->dfsp_Diffusion_coeff; //added
-  dfsp_a_i = atom->dfsp_a_i; //added
 
 
 }
@@ -220,7 +283,7 @@ void AtomVecSsaTsdpd::copy(int i, int j, int delflag) {
   vest[j][2] = vest[i][2];
   for (int k = 0; k < atom->num_tdpd_species; k++)  C[j][k] = C[i][k]; //added
 
-  for (int k = 0; k < atom->num_ssa_species; k++)  Cd[j][k] = Cd[i][k]; //added
+  for (int k = 0; k < Cd.ncol; k++)  Cd[j][k] = Cd[i][k]; //added
 
   for (int r = 0; r < atom->num_ssa_reactions; r++)  ssa_rxn_propensity[j][r] = ssa_rxn_propensity[i][r]; //added
 
@@ -232,17 +295,63 @@ void AtomVecSsaTsdpd::copy(int i, int j, int delflag) {
     for (int k = 0; k < atom->num_ssa_species; k++)
       ssa_stoich_matrix[j][r][k] = ssa_stoich_matrix[i][r][k]; //added
 
-  dfsp_D_matrix[j] = dfsp_D_matrix[i]; //added
-  dfsp_D_diag[j] = dfsp_D_diag[i]; //added
-  dfsp_Diffusion_coeff[j] = dfsp_Diffusion_coeff[i]; //added
-  dfsp_a_i[j] = dfsp_a_i[i]; //added
-
   if (atom->nextra_grow)
     for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
       modify->fix[atom->extra_grow[iextra]]->copy_arrays(i, j,delflag);
 
 }
 
+/* ----------------------------------------------------------------------
+   permute owned atoms for Atom::sort(), new atom i = old atom perm[i]
+   gathers each array through one buffer instead of one copy() per atom
+   moves what copy() moves, Q and Qd are cleared every step
+------------------------------------------------------------------------- */
+
+int AtomVecSsaTsdpd::reorder(int n, int *perm)
+{
+  if (n == 0) return 1;
+
+  int nssa = atom->num_ssa_species;
+  int nrxn = atom->num_ssa_reactions;
+
+  // bytes per atom of the widest array, signed like maxsortbuf
+
+  bigint dsize = sizeof(double);
+  bigint width = 3*dsize;
+  width = MAX(width,atom->num_tdpd_species*dsize);
+  width = MAX(width,Cd.ncol*(bigint) sizeof(int));
+  width = MAX(width,nrxn*dsize);
+  width = MAX(width,nrxn*nssa*dsize);
+  if (width*n > maxsortbuf) {
+    maxsortbuf = width*n;
+    memory->sfree(sortbuf);
+    sortbuf = (char *) memory->smalloc(maxsortbuf,"atom:sortbuf");
+  }
+
+  reorder_rows(tag,1,n,perm,(tagint *) sortbuf);
+  reorder_rows(type,1,n,perm,(int *) sortbuf);
+  reorder_rows(mask,1,n,perm,(int *) sortbuf);
+  reorder_rows(image,1,n,perm,(imageint *) sortbuf);
+  reorder_rows(x[0],3,n,perm,(double *) sortbuf);
+  reorder_rows(v[0],3,n,perm,(double *) sortbuf);
+  reorder_rows(rho,1,n,perm,(double *) sortbuf);
+  reorder_rows(drho,1,n,perm,(double *) sortbuf);
+  reorder_rows(e,1,n,perm,(double *) sortbuf);
+  reorder_rows(de,1,n,perm,(double *) sortbuf);
+  reorder_rows(cv,1,n,perm,(double *) sortbuf);
+  reorder_rows(vest[0],3,n,perm,(double *) sortbuf);
+  C.reorder(n,perm,(double *) sortbuf);
+  Cd.reorder(n,perm,(int *) sortbuf);
+  if (nrxn > 0)
+    reorder_rows(ssa_rxn_propensity[0],nrxn,n,perm,(double *) sortbuf);
+  if (nrxn > 0 && nssa > 0) {
+    reorder_rows(d_ssa_rxn_prop_d_c[0][0],nrxn*nssa,n,perm,(double *) sortbuf);
+    reorder_rows(ssa_stoich_matrix[0][0],nrxn*nssa,n,perm,(int *) sortbuf);
+  }
+
+  return 1;
+}
+
 /* ---------------------------------------------------------------------- */
 
 void AtomVecSsaTsdpd::force_clear(int n, size_t nbytes)
@@ -272,7 +381,7 @@ int AtomVecSsaTsdpd::pack_comm_hybrid(int n, int *list, double *buf) {
     buf[m++] = vest[j][2];
     for (int k = 0; k < atom->num_tdpd_species; k++)  buf[m++] = C[j][k];
 
-    for (int k = 0; k < atom->num_ssa_species; k++)  buf[m++] = (double) Cd[j][k];
+    for (int k = 0; k < Cd.ncol; k++)  buf[m++] = (double) Cd[j][k];
 
     for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[j][r];
 
@@ -283,11 +392,6 @@ int AtomVecSsaTsdpd::pack_comm_hybrid(int n, int *list, double *buf) {
     for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             buf[m++] = ssa_stoich_matrix[j][r][k];
-
-   buf[m++] = dfsp_D_matrix[j];
-   buf[m++] = dfsp_D_diag[j];
-   buf[m++] = dfsp_Diffusion_coeff[j];
-   buf[m++] = dfsp_a_i[j];
   }
   return m;
 }
@@ -310,7 +414,7 @@ int AtomVecSsaTsdpd::unpack_comm_hybrid(int n, int first, double *buf) {
     vest[i][2] = buf[m++];
     for (int k = 0; k < atom->num_tdpd_species; k++)  C[i][k] = buf[m++];
   
-    for (int k = 0; k < atom->num_ssa_species; k++)  Cd[i][k] = (int) buf[m++];
+    for (int k = 0; k < Cd.ncol; k++)  Cd[i][k] = (int) buf[m++];
 
     for (int r = 0; r < atom->num_ssa_reactions; r++) ssa_rxn_propensity[i][r] = buf[m++];
 
@@ -322,12 +426,6 @@ int AtomVecSsaTsdpd::unpack_comm_hybrid(int n, int first, double *buf) {
     for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             ssa_stoich_matrix[i][r][k] = buf[m++];
-
-
-   dfsp_D_matrix[i]=buf[m++];
-   dfsp_D_diag[i]=buf[m++];
-   dfsp_Diffusion_coeff[i]=buf[m++];
-   dfsp_a_i[i]=buf[m++];
   }
   return m;
 }
@@ -351,7 +449,7 @@ int AtomVecSsaTsdpd::pack_border_hybrid(int n, int *list, double *buf) {
     for (int k = 0; k < atom->num_tdpd_species; k++)  buf[m++] = C[j][k];
 
 
-    for (int k = 0; k < atom->num_ssa_species; k++)  buf[m++] = (double) Cd[j][k];
+    for (int k = 0; k < Cd.ncol; k++)  buf[m++] = (double) Cd[j][k];
 
     for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[j][r];
 
@@ -363,11 +461,6 @@ int AtomVecSsaTsdpd::pack_border_hybrid(int n, int *list, double *buf) {
      for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             buf[m++] = ssa_stoich_matrix[j][r][k];
- 
-  buf[m++] = dfsp_D_matrix[j];
-  buf[m++] = dfsp_D_diag[j];
-  buf[m++] = dfsp_Diffusion_coeff[j];
-  buf[m++] = dfsp_a_i[j];
   }
   return m;
 }
@@ -391,7 +484,7 @@ int AtomVecSsaTsdpd::unpack_border_hybrid(int n, int first, double *buf) {
     for (int k = 0; k < atom->num_tdpd_species; k++)  C[i][k] = buf[m++];
 
 
-    for (int k = 0; k < atom->num_ssa_species; k++)  Cd[i][k] = (int) buf[m++];
+    for (int k = 0; k < Cd.ncol; k++)  Cd[i][k] = (int) buf[m++];
 
     for (int r = 0; r < atom->num_ssa_reactions; r++) ssa_rxn_propensity[i][r] = buf[m++];
 
@@ -403,11 +496,6 @@ int AtomVecSsaTsdpd::unpack_border_hybrid(int n, int first, double *buf) {
     for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             ssa_stoich_matrix[i][r][k] = buf[m++];
-
-  dfsp_D_matrix[i] = buf[m++];
-  dfsp_D_diag[i] = buf[m++];
-  dfsp_Diffusion_coeff[i] = buf[m++];
-  dfsp_a_i[i] = buf[m++];
   }
   return m;
 }
@@ -426,7 +514,7 @@ int AtomVecSsaTsdpd::pack_reverse_hybrid(int n, int first, double *buf) {
     buf[m++] = drho[i];
     buf[m++] = de[i];
     for (int k = 0; k < atom->num_tdpd_species; k++)  buf[m++] = Q[i][k];
-    for (int k = 0; k < atom->num_ssa_species; k++)  buf[m++] = (double) Qd[i][k];
+    for (int k = 0; k < Qd.ncol; k++)  buf[m++] = (double) Qd[i][k];
   }
   return m;
 }
@@ -446,7 +534,7 @@ int AtomVecSsaTsdpd::unpack_reverse_hybrid(int n, int *list, double *buf) {
     de[j] += buf[m++];
     for (int k = 0; k < atom->num_tdpd_species; k++)  C[j][k] += buf[m++];
 
-    for (int k = 0; k < atom->num_ssa_species; k++)  Cd[j][k] += (int) buf[m++];
+    for (int k = 0; k < Cd.ncol; k++)  Cd[j][k] += (int) buf[m++];
 
     for (int r = 0; r < atom->num_ssa_reactions; r++) ssa_rxn_propensity[j][r] = buf[m++];
 
@@ -458,7 +546,6 @@ int AtomVecSsaTsdpd::unpack_reverse_hybrid(int n, int *list, double *buf) {
     for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             ssa_stoich_matrix[j][r][k] = buf[m++];
-
   }
 
   return m;
@@ -488,7 +575,7 @@ int AtomVecSsaTsdpd::pack_comm(int n, int *list, double *buf, int pbc_flag,
       buf[m++] = vest[j][2];
       for (int k = 0; k < atom->num_tdpd_species; k++)  buf[m++] = C[j][k];
 
-      for (int k = 0; k < atom->num_ssa_species; k++)  buf[m++] = (double) Cd[j][k];
+      for (int k = 0; k < Cd.ncol; k++)  buf[m++] = (double) Cd[j][k];
 
       for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[j][r];
 
@@ -499,12 +586,6 @@ int AtomVecSsaTsdpd::pack_comm(int n, int *list, double *buf, int pbc_flag,
       for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             buf[m++] = ssa_stoich_matrix[j][r][k];
-
-     buf[m++] = dfsp_D_matrix[j];
-     buf[m++] = dfsp_D_diag[j];
-     buf[m++] = dfsp_Diffusion_coeff[j];
-     buf[m++] = dfsp_a_i[j];
-
     }
   } else {
     if (domain->triclinic == 0) {
@@ -528,7 +609,7 @@ int AtomVecSsaTsdpd::pack_comm(int n, int *list, double *buf, int pbc_flag,
       buf[m++] = vest[j][2];
       for (int k = 0; k < atom->num_tdpd_species; k++)  buf[m++] = C[j][k];
 
-      for (int k = 0; k < atom->num_ssa_species; k++)  buf[m++] = (double) Cd[j][k];
+      for (int k = 0; k < Cd.ncol; k++)  buf[m++] = (double) Cd[j][k];
 
       for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[j][r];
 
@@ -539,11 +620,6 @@ int AtomVecSsaTsdpd::pack_comm(int n, int *list, double *buf, int pbc_flag,
       for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             buf[m++] = ssa_stoich_matrix[j][r][k];
-
-      buf[m++] = dfsp_D_matrix[j];
-      buf[m++] = dfsp_D_diag[j];
-      buf[m++] = dfsp_Diffusion_coeff[j];
-      buf[m++] = dfsp_a_i[j];
     }
   }
   return m;
@@ -576,7 +652,7 @@ int AtomVecSsaTsdpd::pack_comm_vel(int n, int *list, double *buf, int pbc_flag,
       buf[m++] = vest[j][2];
       for (int k = 0; k < atom->num_tdpd_species; k++)  buf[m++] = C[j][k];
 
-      for (int k = 0; k < atom->num_ssa_species; k++)  buf[m++] = (double) Cd[j][k];
+      for (int k = 0; k < Cd.ncol; k++)  buf[m++] = (double) Cd[j][k];
 
       for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[j][r];
 
@@ -587,12 +663,6 @@ int AtomVecSsaTsdpd::pack_comm_vel(int n, int *list, double *buf, int pbc_flag,
       for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             buf[m++] = ssa_stoich_matrix[j][r][k];
-
-      buf[m++] = dfsp_D_matrix[j];
-      buf[m++] = dfsp_D_diag[j];
-      buf[m++] = dfsp_Diffusion_coeff[j];
-      buf[m++] = dfsp_a_i[j];
-      
     }
   } else {
     if (domain->triclinic == 0) {
@@ -619,7 +689,7 @@ int AtomVecSsaTsdpd::pack_comm_vel(int n, int *list, double *buf, int pbc_flag,
       buf[m++] = vest[j][2];
       for (int k = 0; k < atom->num_tdpd_species; k++)  buf[m++] = C[j][k];
 
-      for (int k = 0; k < atom->num_ssa_species; k++)  buf[m++] = (double) Cd[j][k];
+      for (int k = 0; k < Cd.ncol; k++)  buf[m++] = (double) Cd[j][k];
 
       for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[j][r];
 
@@ -630,11 +700,6 @@ int AtomVecSsaTsdpd::pack_comm_vel(int n, int *list, double *buf, int pbc_flag,
       for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             buf[m++] = ssa_stoich_matrix[j][r][k];
-
-     buf[m++] = dfsp_D_matrix[j];
-     buf[m++] = dfsp_D_diag[j];
-     buf[m++] = dfsp_Diffusion_coeff[j];
-     buf[m++] = dfsp_a_i[j];
     }
   }
   return m;
@@ -661,7 +726,7 @@ void AtomVecSsaTsdpd::unpack_comm(int n, int first, double *buf) {
     vest[i][2] = buf[m++];
     for (int k = 0; k < atom->num_tdpd_species; k++) C[i][k] = buf[m++];
 
-    for (int k = 0; k < atom->num_ssa_species; k++) Cd[i][k] = (int) buf[m++];
+    for (int k = 0; k < Cd.ncol; k++) Cd[i][k] = (int) buf[m++];
 
     for (int r = 0; r < atom->num_ssa_reactions; r++) ssa_rxn_propensity[i][r] = buf[m++];
 
@@ -672,11 +737,6 @@ void AtomVecSsaTsdpd::unpack_comm(int n, int first, double *buf) {
     for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             ssa_stoich_matrix[i][r][k] = buf[m++];
-
-   dfsp_D_matrix[i] = buf[m++];
-   dfsp_D_diag[i] = buf[m++];
-   dfsp_Diffusion_coeff[i] = buf[m++];
-   dfsp_a_i[i] = buf[m++];
   }
 }
 
@@ -704,7 +764,7 @@ void AtomVecSsaTsdpd::unpack_comm_vel(int n, int first, double *buf) {
     vest[i][2] = buf[m++];
     for (int k = 0; k < atom->num_tdpd_species; k++) C[i][k] = buf[m++];
 
-    for (int k = 0; k < atom->num_ssa_species; k++) Cd[i][k] = (int) buf[m++];
+    for (int k = 0; k < Cd.ncol; k++) Cd[i][k] = (int) buf[m++];
 
 //    for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[i][r]; modified (backwards!)
     for (int r = 0; r < atom->num_ssa_reactions; r++)  ssa_rxn_propensity[i][r] = buf[m++];
@@ -719,10 +779,6 @@ void AtomVecSsaTsdpd::unpack_comm_vel(int n, int first, double *buf) {
 		ssa_stoich_matrix[i][r][k] = buf[m++];
          //   buf[m++] = ssa_stoich_matrix[i][r][k];   modified (backwards!)
   
-   dfsp_D_matrix[i] = buf[m++];
-   dfsp_D_diag[i] = buf[m++];
-   dfsp_Diffusion_coeff[i] = buf[m++];
-   dfsp_a_i[i] = buf[m++];
 
   }
 }
@@ -744,7 +800,7 @@ int AtomVecSsaTsdpd::pack_reverse(int n, int first, double *buf) {
     buf[m++] = drho[i];
     buf[m++] = de[i];
     for (int k = 0; k < atom->num_tdpd_species; k++)  buf[m++] = Q[i][k];  //added (this packs source term for tdpd model)
-    for (int k = 0; k < atom->num_ssa_species; k++)  buf[m++] = (double) Qd[i][k];  //added (this packs source term for tdpd model)
+    for (int k = 0; k < Qd.ncol; k++)  buf[m++] = (double) Qd[i][k];  //added (this packs source term for tdpd model)
   }
   return m;
 }
@@ -766,7 +822,7 @@ void AtomVecSsaTsdpd::unpack_reverse(int n, int *list, double *buf) {
     drho[j] += buf[m++];
     de[j] += buf[m++];
     for (int k = 0; k < atom->num_tdpd_species; k++) Q[j][k] += buf[m++]; //added (this unpacks source term for tdpd model)
-    for (int k = 0; k < atom->num_ssa_species; k++) Qd[j][k] += (int) buf[m++]; //added (this unpacks source term for tdpd model)
+    for (int k = 0; k < Qd.ncol; k++) Qd[j][k] += (int) buf[m++]; //added (this unpacks source term for tdpd model)
 
   }
 }
@@ -799,7 +855,7 @@ int AtomVecSsaTsdpd::pack_border(int n, int *list, double *buf, int pbc_flag,
       buf[m++] = vest[j][2];
       for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = C[j][k];
 
-      for (int k = 0; k < atom->num_ssa_species; k++) buf[m++] = (double) Cd[j][k];
+      for (int k = 0; k < Cd.ncol; k++) buf[m++] = (double) Cd[j][k];
 
       for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[j][r];
 
@@ -810,12 +866,6 @@ int AtomVecSsaTsdpd::pack_border(int n, int *list, double *buf, int pbc_flag,
       for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             buf[m++] = ssa_stoich_matrix[j][r][k];
-
-      buf[m++] = dfsp_D_matrix[j];
-      buf[m++] = dfsp_D_diag[j];
-      buf[m++] = dfsp_Diffusion_coeff[j];
-      buf[m++] = dfsp_a_i[j];
-
     }
   } else {
     if (domain->triclinic == 0) {
@@ -843,7 +893,7 @@ int AtomVecSsaTsdpd::pack_border(int n, int *list, double *buf, int pbc_flag,
       buf[m++] = vest[j][2];
       for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = C[j][k];
 
-      for (int k = 0; k < atom->num_ssa_species; k++) buf[m++] = (double) Cd[j][k];
+      for (int k = 0; k < Cd.ncol; k++) buf[m++] = (double) Cd[j][k];
 
       for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[j][r];
 
@@ -854,11 +904,6 @@ int AtomVecSsaTsdpd::pack_border(int n, int *list, double *buf, int pbc_flag,
      for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             buf[m++] = ssa_stoich_matrix[j][r][k];
-     
-     buf[m++] = dfsp_D_matrix[j]; 
-     buf[m++] = dfsp_D_diag[j]; 
-     buf[m++] = dfsp_Diffusion_coeff[j]; 
-     buf[m++] = dfsp_a_i[j]; 
     }
   }
 
@@ -898,7 +943,7 @@ int AtomVecSsaTsdpd::pack_border_vel(int n, int *list, double *buf, int pbc_flag
       buf[m++] = vest[j][2];
       for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = C[j][k];
 
-      for (int k = 0; k < atom->num_ssa_species; k++) buf[m++] = (double) Cd[j][k];
+      for (int k = 0; k < Cd.ncol; k++) buf[m++] = (double) Cd[j][k];
 
       for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[j][r];
 
@@ -909,12 +954,6 @@ int AtomVecSsaTsdpd::pack_border_vel(int n, int *list, double *buf, int pbc_flag
      for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             buf[m++] = ssa_stoich_matrix[j][r][k];
-
-     buf[m++] = dfsp_D_matrix[j];
-     buf[m++] = dfsp_D_diag[j];
-     buf[m++] = dfsp_Diffusion_coeff[j];
-     buf[m++] = dfsp_a_i[j];
-
     }
   } else {
     if (domain->triclinic == 0) {
@@ -946,7 +985,7 @@ int AtomVecSsaTsdpd::pack_border_vel(int n, int *list, double *buf, int pbc_flag
         buf[m++] = vest[j][2];
         for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = C[j][k];
 
-        for (int k = 0; k < atom->num_ssa_species; k++) buf[m++] = (double) Cd[j][k];
+        for (int k = 0; k < Cd.ncol; k++) buf[m++] = (double) Cd[j][k];
 
         for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[j][r];
 
@@ -957,12 +996,6 @@ int AtomVecSsaTsdpd::pack_border_vel(int n, int *list, double *buf, int pbc_flag
         for (int r = 0; r < atom->num_ssa_reactions; r++)
           for (int k = 0; k < atom->num_ssa_species; k++)
             buf[m++] = ssa_stoich_matrix[j][r][k];
-        
-        buf[m++] = dfsp_D_matrix[j];
-        buf[m++] = dfsp_D_diag[j];
-        buf[m++] = dfsp_Diffusion_coeff[j];
-        buf[m++] = dfsp_a_i[j];
-      
       }
     } else {
       dvx = pbc[0] * h_rate[0] + pbc[5] * h_rate[5] + pbc[4] * h_rate[4];
@@ -996,7 +1029,7 @@ int AtomVecSsaTsdpd::pack_border_vel(int n, int *list, double *buf, int pbc_flag
         buf[m++] = cv[j];
         for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = C[j][k];
 
-        for (int k = 0; k < atom->num_ssa_species; k++) buf[m++] = (double) Cd[j][k];
+        for (int k = 0; k < Cd.ncol; k++) buf[m++] = (double) Cd[j][k];
 
         for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[j][r];
 
@@ -1007,12 +1040,6 @@ int AtomVecSsaTsdpd::pack_border_vel(int n, int *list, double *buf, int pbc_flag
         for (int r = 0; r < atom->num_ssa_reactions; r++)
           for (int k = 0; k < atom->num_ssa_species; k++)
             buf[m++] = ssa_stoich_matrix[j][r][k];
-
-        buf[m++] = dfsp_D_matrix[j];
-        buf[m++] = dfsp_D_diag[j];
-        buf[m++] = dfsp_Diffusion_coeff[j];
-        buf[m++] = dfsp_a_i[j];
-
       }
     }
   }
@@ -1051,7 +1078,7 @@ void AtomVecSsaTsdpd::unpack_border(int n, int first, double *buf) {
     vest[i][2] = buf[m++];
     for (int k = 0; k < atom->num_tdpd_species; k++) C[i][k] = buf[m++];
 
-    for (int k = 0; k < atom->num_ssa_species; k++) Cd[i][k] = (int) buf[m++];
+    for (int k = 0; k < Cd.ncol; k++) Cd[i][k] = (int) buf[m++];
 
     for (int r = 0; r < atom->num_ssa_reactions; r++) ssa_rxn_propensity[i][r] = buf[m++];
 
@@ -1062,12 +1089,6 @@ void AtomVecSsaTsdpd::unpack_border(int n, int first, double *buf) {
     for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             ssa_stoich_matrix[i][r][k] = buf[m++];
-
-    dfsp_D_matrix[i] = buf[m++];
-    dfsp_D_diag[i] = buf[m++];
-    dfsp_Diffusion_coeff[i] = buf[m++];
-    dfsp_a_i[i] = buf[m++];
-
   }
 
   if (atom->nextra_border)
@@ -1106,7 +1127,7 @@ void AtomVecSsaTsdpd::unpack_border_vel(int n, int first, double *buf) {
     cv[i] = buf[m++];
     for (int k = 0; k < atom->num_tdpd_species; k++) C[i][k] = buf[m++];
 
-    for (int k = 0; k < atom->num_ssa_species; k++) Cd[i][k] = (int) buf[m++];
+    for (int k = 0; k < Cd.ncol; k++) Cd[i][k] = (int) buf[m++];
 
     for (int r = 0; r < atom->num_ssa_reactions; r++) ssa_rxn_propensity[i][r] = buf[m++];
 
@@ -1117,12 +1138,6 @@ void AtomVecSsaTsdpd::unpack_border_vel(int n, int first, double *buf) {
     for (int r = 0; r < atom->num_ssa_reactions; r++)
         for (int k = 0; k < atom->num_ssa_species; k++)
             ssa_stoich_matrix[i][r][k] = buf[m++];
-
-    dfsp_D_matrix[i] = buf[m++];
-    dfsp_D_diag[i] = buf[m++];
-    dfsp_Diffusion_coeff[i] = buf[m++];
-    dfsp_a_i[i] = buf[m++];
-
   }
 
   if (atom->nextra_border)
@@ -1159,7 +1174,7 @@ int AtomVecSsaTsdpd::pack_exchange(int i, double *buf) {
   buf[m++] = vest[i][2];
   for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = C[i][k];
 
-  for (int k = 0; k < atom->num_ssa_species; k++) buf[m++] = (double) Cd[i][k];
+  for (int k = 0; k < Cd.ncol; k++) buf[m++] = (double) Cd[i][k];
 
   for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[i][r];
 
@@ -1171,10 +1186,6 @@ int AtomVecSsaTsdpd::pack_exchange(int i, double *buf) {
     for (int k = 0; k < atom->num_ssa_species; k++)
         buf[m++] = ssa_stoich_matrix[i][r][k];
 
-  buf[m++] = dfsp_D_matrix[i];
-  buf[m++] = dfsp_D_diag[i];
-  buf[m++] = dfsp_Diffusion_coeff[i];
-  buf[m++] = dfsp_a_i[i];
 
   if (atom->nextra_grow)
     for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
@@ -1213,7 +1224,7 @@ int AtomVecSsaTsdpd::unpack_exchange(double *buf) {
   vest[nlocal][2] = buf[m++];
   for (int k = 0; k < atom->num_tdpd_species; k++) C[nlocal][k] = buf[m++];
 
-  for (int k = 0; k < atom->num_ssa_species; k++) Cd[nlocal][k] = (int) buf[m++];
+  for (int k = 0; k < Cd.ncol; k++) Cd[nlocal][k] = (int) buf[m++];
 
   for (int r = 0; r < atom->num_ssa_reactions; r++) ssa_rxn_propensity[nlocal][r] = buf[m++];
 
@@ -1225,10 +1236,6 @@ int AtomVecSsaTsdpd::unpack_exchange(double *buf) {
       for (int k = 0; k < atom->num_ssa_species; k++)
          ssa_stoich_matrix[nlocal][r][k] = buf[m++];
 
-  dfsp_D_matrix[nlocal] = buf[m++];
-  dfsp_D_diag[nlocal] = buf[m++];
-  dfsp_Diffusion_coeff[nlocal] = buf[m++];
-  dfsp_a_i[nlocal] = buf[m++];
 
   if (atom->nextra_grow)
     for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
@@ -1248,7 +1255,7 @@ int AtomVecSsaTsdpd::size_restart() {
   int i;
 
   int nlocal = atom->nlocal;
-  int n = ( 17 +  atom->num_tdpd_species + atom->num_ssa_species + 2 * atom->num_ssa_reactions * atom->num_ssa_species + atom->num_ssa_reactions) * nlocal; // 11 + rho + e + cv + vest[3]
+  int n = ( 18 +  atom->num_tdpd_species + Cd.ncol + 2 * atom->num_ssa_reactions * atom->num_ssa_species + atom->num_ssa_reactions) * nlocal; // 11 + rho + e + cv + vest[3] + version
   
   if (atom->nextra_restart)
     for (int iextra = 0; iextra < atom->nextra_restart; iextra++)
@@ -1283,9 +1290,10 @@ int AtomVecSsaTsdpd::pack_restart(int i, double *buf) {
   buf[m++] = vest[i][0];
   buf[m++] = vest[i][1];
   buf[m++] = vest[i][2];
+  buf[m++] = ubuf(RESTART_VERSION).d;
   for (int k = 0; k < atom->num_tdpd_species; k++) buf[m++] = C[i][k];
 
-  for (int k = 0; k < atom->num_ssa_species; k++) buf[m++] = (double) Cd[i][k];
+  for (int k = 0; k < Cd.ncol; k++) buf[m++] = (double) Cd[i][k];
 
   for (int r = 0; r < atom->num_ssa_reactions; r++)  buf[m++] = ssa_rxn_propensity[i][r];
 
@@ -1298,10 +1306,6 @@ int AtomVecSsaTsdpd::pack_restart(int i, double *buf) {
         buf[m++] = ssa_stoich_matrix[i][r][k];
 
 
-  buf[m++] = dfsp_D_matrix[i];
-  buf[m++] = dfsp_D_diag[i];
-  buf[m++] = dfsp_Diffusion_coeff[i];
-  buf[m++] = dfsp_a_i[i];
 
   if (atom->nextra_restart)
     for (int iextra = 0; iextra < atom->nextra_restart; iextra++)
@@ -1340,9 +1344,11 @@ int AtomVecSsaTsdpd::unpack_restart(double *buf) {
   vest[nlocal][0] = buf[m++];
   vest[nlocal][1] = buf[m++];
   vest[nlocal][2] = buf[m++];
+  int version = 1;
+  if (ubuf(buf[m]).i == RESTART_VERSION) version = (int) ubuf(buf[m++]).i;
   for(int k = 0; k < atom->num_tdpd_species; k++) C[nlocal][k] = buf[m++]; //added
 
-  for(int k = 0; k < atom->num_ssa_species; k++) Cd[nlocal][k] = buf[m++]; //added
+  for(int k = 0; k < Cd.ncol; k++) Cd[nlocal][k] = buf[m++]; //added
 
   for (int r = 0; r < atom->num_ssa_reactions; r++) ssa_rxn_propensity[nlocal][r] = buf[m++];
 
@@ -1354,10 +1360,7 @@ int AtomVecSsaTsdpd::unpack_restart(double *buf) {
       for (int k = 0; k < atom->num_ssa_species; k++)
          ssa_stoich_matrix[nlocal][r][k] = buf[m++];
 
-  dfsp_D_matrix[nlocal] = buf[m++];
-  dfsp_D_diag[nlocal] = buf[m++];
-  dfsp_Diffusion_coeff[nlocal] = buf[m++];
-  dfsp_a_i[nlocal] = buf[m++];
+  if (version == 1) m += 4;
 
   double **extra = atom->extra;
   if (atom->nextra_store) {
@@ -1401,7 +1404,7 @@ void AtomVecSsaTsdpd::create_atom(int itype, double *coord) {
   drho[nlocal] = 0.0;
   for (int k = 0; k < atom->num_tdpd_species; k++) C[nlocal][k] = 0.0;
 
-  for (int k = 0; k < atom->num_ssa_species; k++) Cd[nlocal][k] = 0;
+  for (int k = 0; k < Cd.ncol; k++) Cd[nlocal][k] = 0;
 
   for (int r = 0; r < atom->num_ssa_reactions; r++) ssa_rxn_propensity[nlocal][r] = 0.0;
 
@@ -1445,7 +1448,10 @@ void AtomVecSsaTsdpd::data_atom(double *coord, imageint imagetmp, char **values)
   for (int k = 0; k < atom->num_tdpd_species; k++) C[nlocal][k] = atof(values[m+k]);
   m += atom->num_tdpd_species;
 
-  for (int k = 0; k < atom->num_ssa_species; k++) Cd[nlocal][k] = atof(values[m+k]);
+  // every replica starts from the populations of the data file
+
+  for (int k = 0; k < Cd.ncol; k++)
+    Cd[nlocal][k] = atof(values[m + k % atom->num_ssa_species]);
   m += atom->num_ssa_species;
 
   for (int r = 0; r < atom->num_ssa_reactions; r++) ssa_rxn_propensity[nlocal][r] = atof(values[m+r]);
@@ -1647,37 +1653,30 @@ bigint AtomVecSsaTsdpd::memory_usage() {
   if (atom->memcheck("cv"))
     bytes += memory->usage(cv, nmax);
   if (atom->memcheck("vest"))
-    bytes += memory->usage(vest, nmax);
+    bytes += memory->usage(vest, nmax, 3);
   if (atom->memcheck("C")) 
-    bytes += memory->usage(C,nmax,atom->num_tdpd_species); //added
+    bytes += C.usage(); //added
   if (atom->memcheck("Q")) 
-    bytes += memory->usage(Q,nmax*comm->nthreads,atom->num_tdpd_species); //added
+    bytes += Q.usage(); //added
 
   if (atom->memcheck("Cd")) 
-    bytes += memory->usage(Cd,nmax,atom->num_ssa_species); //added
+    bytes += Cd.usage(); //added
   if (atom->memcheck("Qd")) 
-    bytes += memory->usage(Qd,nmax*comm->nthreads,atom->num_ssa_species); //added
-
-  if (atom->memcheck("ssa_rxn_propensity")) 
-    bytes += memory->usage(ssa_rxn_propensity,nmax*comm->nthreads,atom->num_ssa_reactions); //added
-
-  if (atom->memcheck("d_ssa_rxn_prop_d_c")) 
-    bytes += memory->usage(d_ssa_rxn_prop_d_c,nmax*comm->nthreads,atom->num_ssa_reactions,atom->num_ssa_species); //added
+    bytes += Qd.usage(); //added
 
-  if (atom->memcheck("ssa_stoich_matrix")) 
-    bytes += memory->usage(ssa_stoich_matrix,nmax*comm->nthreads,atom->num_ssa_reactions,atom->num_ssa_species); //added
+  int nrxn = atom->num_ssa_reactions;
+  int nssa = atom->num_ssa_species;
 
-  if (atom->memcheck("dfsp_D_matrix"))
-    bytes += memory->usage(dfsp_D_matrix, nmax); //added
+  if (nrxn > 0 && atom->memcheck("ssa_rxn_propensity"))
+    bytes += memory->usage(ssa_rxn_propensity,nmax,nrxn); //added
 
-   if (atom->memcheck("dfsp_D_diag"))
-    bytes += memory->usage(dfsp_D_diag, nmax); //added
+  if (nrxn > 0 && nssa > 0 && atom->memcheck("d_ssa_rxn_prop_d_c"))
+    bytes += memory->usage(d_ssa_rxn_prop_d_c,nmax,nrxn,nssa); //added
 
-  if (atom->memcheck("dfsp_Diffusion_coeff"))
-    bytes += memory->usage(dfsp_Diffusion_coeff, nmax*nmax*atom->num_ssa_species); //added
+  if (nrxn > 0 && nssa > 0 && atom->memcheck("ssa_stoich_matrix"))
+    bytes += memory->usage(ssa_stoich_matrix,nmax,nrxn,nssa); //added
 
-  if (atom->memcheck("dfsp_a_i"))
-    bytes += memory->usage(dfsp_a_i, nmax); //added
+  bytes += maxsortbuf;
 
   return bytes;
 
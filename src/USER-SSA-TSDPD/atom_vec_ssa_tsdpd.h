@@ -21,17 +21,19 @@ AtomStyle(ssa_tsdpd,AtomVecSsaTsdpd)
 #define LMP_ATOM_VEC_SSA_TSDPD_H
 
 #include "atom_vec.h"
+#include "species_array.h"
 
 namespace LAMMPS_NS {
 
 class AtomVecSsaTsdpd : public AtomVec {
  public:
   AtomVecSsaTsdpd(class LAMMPS *);
-  ~AtomVecSsaTsdpd() {}
+  ~AtomVecSsaTsdpd();
   void process_args(int, char **);
   void grow(int);
   void grow_reset();
   void copy(int, int, int);
+  int reorder(int, int *);
   void force_clear(int, size_t);
   int pack_comm(int, int *, double *, int, int *);
   int pack_comm_vel(int, int *, double *, int, int *);
@@ -72,11 +74,13 @@ class AtomVecSsaTsdpd : public AtomVec {
   double **x,**v,**f;
   double *rho, *drho, *e, *de, *cv;
   double **vest; // estimated velocity during force computation
-  double **C, **Q; //added tDPD/tSDPD variables
-  int **Cd, **Qd; //added tDPD/tSDPD variables (SSA)
+  SpeciesArray<double> C, Q; //added tDPD/tSDPD variables
+  SpeciesArray<int> Cd, Qd; //added tDPD/tSDPD variables (SSA)
   double **ssa_rxn_propensity, ***d_ssa_rxn_prop_d_c;  // SSA reaction propensities, SSA reaction jacobian
   int ***ssa_stoich_matrix; // SSA reaction species change matrix
-  double *dfsp_D_matrix,*dfsp_D_diag,*dfsp_Diffusion_coeff,*dfsp_a_i;
+
+  char *sortbuf;           // scratch of reorder()
+  bigint maxsortbuf;       // allocated bytes of sortbuf
 };
 
 }
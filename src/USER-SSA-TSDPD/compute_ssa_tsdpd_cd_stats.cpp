@@ -0,0 +1,220 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+// Running per-particle mean and variance (Welford) of C and Cd, sampled
+// every Nevery steps from the definition of the compute on, with optional
+// histograms. The accumulators are kept by an internal fix, so they move
+// with the atoms between procs and are stored in restart files. Evaluating
+// the compute only converts them, it can be dumped once at the end.
+//
+// Example:
+//#        label group       style        Nevery  fields
+//compute  cds   all  ssa_tsdpd/cd/stats    10    Cd_[0] C_[0] hist 20 0 40
+//...
+//run      1000000
+//dump     stats all custom 1 stats.txt id x y c_cds[1] c_cds[2] c_cds[23] c_cds[24]
+//run      0
+//
+// Keywords:
+//   hist N lo hi                 = also histogram each field in N bins on [lo,hi)
+//   cd population/concentration  = units of Cd (default as in atom_style)
+// Per-atom array, per field: mean, variance, then N histogram fractions.
+// The statistics are over time; Cd_[q*Nssa+s] selects replica q of an
+// atom_style with ensemble replicas, see ssa_tsdpd/cd/ensemble for the
+// statistics over the replicas.
+
+#include <stdlib.h>
+#include <string.h>
+#include "compute_ssa_tsdpd_cd_stats.h"
+#include "fix_ssa_tsdpd_cd_stats.h"
+#include "atom.h"
+#include "update.h"
+#include "modify.h"
+#include "group.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+ComputeSsaTsdpdCdStats::ComputeSsaTsdpdCdStats(LAMMPS *lmp, int narg,
+                                               char **arg) :
+  Compute(lmp, narg, arg), id_fix(NULL), fix(NULL), stats(NULL)
+{
+  if (atom->tsdpd_flag != 1)
+    error->all(FLERR,"Compute ssa_tsdpd/cd/stats requires atom_style ssa_tsdpd");
+  if (narg < 5) error->all(FLERR,"Illegal compute ssa_tsdpd/cd/stats command");
+
+  int nevery = force->inumeric(FLERR,arg[3]);
+  if (nevery <= 0) error->all(FLERR,"Illegal compute ssa_tsdpd/cd/stats command");
+
+  // fields, C_[*] and Cd_[*] expand to all species
+
+  int *which = new int[narg + atom->num_tdpd_species + atom->Cd.ncol];
+  int *index = new int[narg + atom->num_tdpd_species + atom->Cd.ncol];
+  nfield = 0;
+
+  int iarg = 4;
+  while (iarg < narg) {
+    char *a = arg[iarg];
+    if (strncmp(a,"C_[",3) != 0 && strncmp(a,"Cd_[",4) != 0) break;
+    int kind = (a[1] == 'd') ? FixSsaTsdpdCdStats::DISCRETE :
+      FixSsaTsdpdCdStats::CONC;
+    int nspecies = (kind == FixSsaTsdpdCdStats::CONC) ?
+      atom->num_tdpd_species : atom->Cd.ncol;
+    char *ptr = strchr(a,'[');
+    if (a[strlen(a)-1] != ']')
+      error->all(FLERR,"Invalid compute ssa_tsdpd/cd/stats field");
+    if (strcmp(ptr,"[*]") == 0) {
+      for (int k = 0; k < nspecies; k++) {
+        which[nfield] = kind;
+        index[nfield++] = k;
+      }
+    } else {
+      int k = atoi(ptr+1);
+      if (k < 0 || k >= nspecies)
+        error->all(FLERR,"Compute ssa_tsdpd/cd/stats species index is out of range");
+      which[nfield] = kind;
+      index[nfield++] = k;
+    }
+    iarg++;
+  }
+  if (nfield == 0) error->all(FLERR,"Invalid compute ssa_tsdpd/cd/stats field");
+
+  nhist = 0;
+  double hlo = 0.0, hhi = 1.0;
+  int cdconc = atom->Cd_concentration_flag;
+
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"hist") == 0) {
+      if (iarg+4 > narg)
+        error->all(FLERR,"Illegal compute ssa_tsdpd/cd/stats command");
+      nhist = force->inumeric(FLERR,arg[iarg+1]);
+      hlo = force->numeric(FLERR,arg[iarg+2]);
+      hhi = force->numeric(FLERR,arg[iarg+3]);
+      if (nhist <= 0 || hlo >= hhi)
+        error->all(FLERR,"Illegal compute ssa_tsdpd/cd/stats command");
+      iarg += 4;
+    } else if (strcmp(arg[iarg],"cd") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal compute ssa_tsdpd/cd/stats command");
+      if (strcmp(arg[iarg+1],"concentration") == 0) cdconc = 1;
+      else if (strcmp(arg[iarg+1],"population") == 0) cdconc = 0;
+      else error->all(FLERR,"Illegal compute ssa_tsdpd/cd/stats command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal compute ssa_tsdpd/cd/stats command");
+  }
+
+  peratom_flag = 1;
+  size_peratom_cols = nfield*(2+nhist);
+
+  // create the fix holding the accumulators
+  // id = compute-ID + COMPUTE_STORE, fix group = compute group
+  // if it was read from a restart file, the statistics continue
+
+  int n = strlen(id) + strlen("_COMPUTE_STORE") + 1;
+  id_fix = new char[n];
+  strcpy(id_fix,id);
+  strcat(id_fix,"_COMPUTE_STORE");
+
+  char nvalues[16];
+  sprintf(nvalues,"%d",1 + nfield*(2+nhist));
+
+  char **newarg = new char*[7];
+  newarg[0] = id_fix;
+  newarg[1] = group->names[igroup];
+  newarg[2] = (char *) "SSA_TSDPD_CD_STATS";
+  newarg[3] = (char *) "peratom";
+  newarg[4] = (char *) "1";
+  newarg[5] = nvalues;
+  newarg[6] = arg[3];
+  modify->add_fix(7,newarg);
+  fix = (FixSsaTsdpdCdStats *) modify->fix[modify->nfix-1];
+  delete [] newarg;
+
+  fix->set_fields(nfield,which,index,cdconc,nhist,hlo,hhi);
+  if (fix->restart_reset) fix->restart_reset = 0;
+
+  delete [] which;
+  delete [] index;
+
+  nmax = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+ComputeSsaTsdpdCdStats::~ComputeSsaTsdpdCdStats()
+{
+  // check nfix in case all fixes have already been deleted
+
+  if (modify->nfix) modify->delete_fix(id_fix);
+
+  delete [] id_fix;
+  memory->destroy(stats);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeSsaTsdpdCdStats::init()
+{
+  int ifix = modify->find_fix(id_fix);
+  if (ifix < 0)
+    error->all(FLERR,"Could not find compute ssa_tsdpd/cd/stats fix ID");
+  fix = (FixSsaTsdpdCdStats *) modify->fix[ifix];
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeSsaTsdpdCdStats::compute_peratom()
+{
+  invoked_peratom = update->ntimestep;
+
+  if (atom->nmax > nmax) {
+    memory->destroy(stats);
+    nmax = atom->nmax;
+    memory->create(stats,nmax,size_peratom_cols,"ssa_tsdpd/cd/stats:stats");
+    array_atom = stats;
+  }
+
+  // mean, unbiased variance and histogram fractions of each field
+
+  double **s = fix->astore;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int w = fix->width();
+
+  for (int i = 0; i < nlocal; i++) {
+    double count = s[i][0];
+    for (int m = 0; m < nfield; m++) {
+      double *f = &s[i][1 + m*w];
+      double *out = &stats[i][m*w];
+      if (!(mask[i] & groupbit) || count == 0.0) {
+        for (int j = 0; j < w; j++) out[j] = 0.0;
+        continue;
+      }
+      out[0] = f[0];
+      out[1] = count > 1.0 ? f[1]/(count-1.0) : 0.0;
+      for (int j = 0; j < nhist; j++) out[2+j] = f[2+j]/count;
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double ComputeSsaTsdpdCdStats::memory_usage()
+{
+  double bytes = (double) nmax*size_peratom_cols * sizeof(double);
+  return bytes;
+}
@@ -0,0 +1,73 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef COMPUTE_CLASS
+
+ComputeStyle(ssa_tsdpd/cd/stats,ComputeSsaTsdpdCdStats)
+
+#else
+
+#ifndef LMP_COMPUTE_SSA_TSDPD_CD_STATS_H
+#define LMP_COMPUTE_SSA_TSDPD_CD_STATS_H
+
+#include "compute.h"
+
+namespace LAMMPS_NS {
+
+class ComputeSsaTsdpdCdStats : public Compute {
+ public:
+  ComputeSsaTsdpdCdStats(class LAMMPS *, int, char **);
+  ~ComputeSsaTsdpdCdStats();
+  void init();
+  void compute_peratom();
+  double memory_usage();
+
+ private:
+  int nfield,nhist;
+  char *id_fix;
+  class FixSsaTsdpdCdStats *fix;
+
+  int nmax;
+  double **stats;
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal compute ssa_tsdpd/cd/stats command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: Compute ssa_tsdpd/cd/stats requires atom_style ssa_tsdpd
+
+The C and Cd fields are stored by this atom style.
+
+E: Invalid compute ssa_tsdpd/cd/stats field
+
+Valid fields are C_[k], Cd_[k], C_[*] and Cd_[*].
+
+E: Compute ssa_tsdpd/cd/stats species index is out of range
+
+C_[k] must be less than the number of tsdpd species and Cd_[k] less
+than the number of ssa species of the atom style.
+
+E: Could not find compute ssa_tsdpd/cd/stats fix ID
+
+The internal fix holding the accumulators was deleted.
+
+*/
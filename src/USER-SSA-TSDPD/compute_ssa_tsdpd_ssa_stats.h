@@ -0,0 +1,69 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef COMPUTE_CLASS
+
+ComputeStyle(ssa_tsdpd/ssa/stats,ComputeSsaTsdpdSsaStats)
+
+#else
+
+#ifndef LMP_COMPUTE_SSA_TSDPD_SSA_STATS_H
+#define LMP_COMPUTE_SSA_TSDPD_SSA_STATS_H
+
+#include "compute.h"
+
+namespace LAMMPS_NS {
+
+class ComputeSsaTsdpdSsaStats : public Compute {
+ public:
+  ComputeSsaTsdpdSsaStats(class LAMMPS *, int, char **);
+  ~ComputeSsaTsdpdSsaStats();
+  void init();
+  void compute_vector();
+  void compute_peratom();
+  double memory_usage();
+
+ private:
+  int nspecies,nreaction;
+  class SsaTsdpdStats *stats;
+
+  int nmax;
+  double **peratom;
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal compute ssa_tsdpd/ssa/stats command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: Compute ssa_tsdpd/ssa/stats requires atom_style ssa_tsdpd
+
+The SSA species and reactions are defined by this atom style.
+
+E: Only one compute ssa_tsdpd/ssa/stats can be defined
+
+The SSA loops record into a single set of counters.
+
+W: Compute ssa_tsdpd/ssa/stats does not count events of KOKKOS styles
+
+The KOKKOS versions of the pair styles and of fix ssa_tsdpd/verlet do
+not record their SSA events, the counters stay zero for them.
+
+*/
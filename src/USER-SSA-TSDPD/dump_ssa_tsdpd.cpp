@@ -12,6 +12,8 @@
 ------------------------------------------------------------------------- */
 
 #include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "dump_ssa_tsdpd.h"
@@ -51,6 +53,8 @@ enum{INT,DOUBLE,STRING,BIGINT};    // same as in DumpCFG
 #define ONEFIELD 32
 #define DELTA 1048576
 
+#define MAX(A,B) ((A) > (B) ? (A) : (B))
+
 /* ---------------------------------------------------------------------- */
 
 DumpSsaTsdpd::DumpSsaTsdpd(LAMMPS *lmp, int narg, char **arg) :
@@ -120,6 +124,15 @@ DumpSsaTsdpd::DumpSsaTsdpd(LAMMPS *lmp, int narg, char **arg) :
   id_custom = NULL;
   flag_custom = NULL;
 
+  // snapshots are written synchronously unless dump_modify async yes
+
+  async_flag = 0;
+  async_depth = 2;
+  async = NULL;
+  hbuf = NULL;
+  nhbuf = maxhbuf = 0;
+  hstage = 0;
+
   // process attributes
   // ioptional = start of additional optional args in expanded args
 
@@ -190,6 +203,11 @@ DumpSsaTsdpd::DumpSsaTsdpd(LAMMPS *lmp, int narg, char **arg) :
 
 DumpSsaTsdpd::~DumpSsaTsdpd()
 {
+  // write out queued snapshots before buffers and files go away
+
+  delete async;
+  memory->destroy(hbuf);
+
   // if wildcard expansion occurred, free earg memory from expand_args()
   // could not do in constructor, b/c some derived classes process earg
 
@@ -365,6 +383,219 @@ void DumpSsaTsdpd::init_style()
 
   if (multifile == 0) openfile();
 
+  init_async();
+}
+
+/* ----------------------------------------------------------------------
+   create the i/o thread queue on filewriter procs if requested
+   wait for queued snapshots, since settings may have changed
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpd::init_async()
+{
+  if (async) async->flush();
+  if (async_flag && filewriter && async == NULL)
+    async = new DumpSsaTsdpdAsync(lmp,&DumpSsaTsdpd::async_callback,
+                                  this,async_depth);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpSsaTsdpd::post_run()
+{
+  if (async) async->flush();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpSsaTsdpd::write()
+{
+  if (async_flag) write_async();
+  else Dump::write();
+}
+
+/* ----------------------------------------------------------------------
+   same as Dump::write(), but the filewriter stages the header and
+     the formatted lines of its cluster in a slot of the async queue
+   the i/o thread then writes and closes the file while the run goes on
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpd::write_async()
+{
+  imageint *imagehold = NULL;
+  double **xhold = NULL,**vhold = NULL;
+
+  // if file per timestep, open new file
+  // the i/o thread closes it after writing
+
+  if (multifile) openfile();
+
+  if (domain->triclinic == 0) {
+    boxxlo = domain->boxlo[0];
+    boxxhi = domain->boxhi[0];
+    boxylo = domain->boxlo[1];
+    boxyhi = domain->boxhi[1];
+    boxzlo = domain->boxlo[2];
+    boxzhi = domain->boxhi[2];
+  } else {
+    boxxlo = domain->boxlo_bound[0];
+    boxxhi = domain->boxhi_bound[0];
+    boxylo = domain->boxlo_bound[1];
+    boxyhi = domain->boxhi_bound[1];
+    boxzlo = domain->boxlo_bound[2];
+    boxzhi = domain->boxhi_bound[2];
+    boxxy = domain->xy;
+    boxxz = domain->xz;
+    boxyz = domain->yz;
+  }
+
+  nme = count();
+
+  bigint bnme = nme;
+  MPI_Allreduce(&bnme,&ntotal,1,MPI_LMP_BIGINT,MPI_SUM,world);
+
+  int nmax;
+  if (multiproc != nprocs) MPI_Allreduce(&nme,&nmax,1,MPI_INT,MPI_MAX,world);
+  else nmax = nme;
+
+  bigint nheader = ntotal;
+  if (multiproc)
+    MPI_Allreduce(&bnme,&nheader,1,MPI_LMP_BIGINT,MPI_SUM,clustercomm);
+
+  if (nmax > maxbuf) {
+    if ((bigint) nmax * size_one > MAXSMALLINT)
+      error->all(FLERR,"Too much per-proc info for dump");
+    maxbuf = nmax;
+    memory->destroy(buf);
+    memory->create(buf,maxbuf*size_one,"dump:buf");
+  }
+
+  if (sort_flag && sortcol == 0 && nmax > maxids) {
+    maxids = nmax;
+    memory->destroy(ids);
+    memory->create(ids,maxids,"dump:ids");
+  }
+
+  if (pbcflag) {
+    int nlocal = atom->nlocal;
+    if (nlocal > maxpbc) pbc_allocate();
+    if (nlocal) {
+      memcpy(&xpbc[0][0],&atom->x[0][0],3*nlocal*sizeof(double));
+      memcpy(&vpbc[0][0],&atom->v[0][0],3*nlocal*sizeof(double));
+      memcpy(imagepbc,atom->image,nlocal*sizeof(imageint));
+    }
+    xhold = atom->x;
+    vhold = atom->v;
+    imagehold = atom->image;
+    atom->x = xpbc;
+    atom->v = vpbc;
+    atom->image = imagepbc;
+    domain->pbc();
+  }
+
+  if (sort_flag && sortcol == 0) pack(ids);
+  else pack(NULL);
+  if (sort_flag) sort();
+
+  if (pbcflag) {
+    atom->x = xhold;
+    atom->v = vhold;
+    atom->image = imagehold;
+  }
+
+  // text output is always formatted by each proc for its own atoms
+
+  if (!binary) {
+    nsme = convert_string(nme,buf);
+    int nsmin,nsmax;
+    MPI_Allreduce(&nsme,&nsmin,1,MPI_INT,MPI_MIN,world);
+    if (nsmin < 0) error->all(FLERR,"Too much buffered per-proc info for dump");
+    if (multiproc != nprocs)
+      MPI_Allreduce(&nsme,&nsmax,1,MPI_INT,MPI_MAX,world);
+    else nsmax = nsme;
+    if (nsmax > maxsbuf) {
+      maxsbuf = nsmax;
+      memory->grow(sbuf,maxsbuf,"dump:sbuf");
+    }
+  }
+
+  int tmp,nlines,nchars;
+  MPI_Status status;
+  MPI_Request request;
+
+  if (filewriter) {
+    DumpSsaTsdpdAsync::Job *job = async->acquire();
+
+    // header is written by the usual header functions into hbuf
+
+    nhbuf = 0;
+    hstage = 1;
+    write_header(nheader);
+    hstage = 0;
+    async->append(job,hbuf,nhbuf);
+
+    for (int iproc = 0; iproc < nclusterprocs; iproc++) {
+      if (binary) {
+        if (iproc) {
+          MPI_Irecv(buf,maxbuf*size_one,MPI_DOUBLE,me+iproc,0,world,&request);
+          MPI_Send(&tmp,0,MPI_INT,me+iproc,0,world);
+          MPI_Wait(&request,&status);
+          MPI_Get_count(&status,MPI_DOUBLE,&nlines);
+        } else nlines = nme*size_one;
+        async->append(job,&nlines,sizeof(int));
+        async->append(job,buf,(bigint) nlines*sizeof(double));
+      } else {
+        if (iproc) {
+          MPI_Irecv(sbuf,maxsbuf,MPI_CHAR,me+iproc,0,world,&request);
+          MPI_Send(&tmp,0,MPI_INT,me+iproc,0,world);
+          MPI_Wait(&request,&status);
+          MPI_Get_count(&status,MPI_CHAR,&nchars);
+        } else nchars = nsme;
+        async->append(job,sbuf,nchars);
+      }
+    }
+
+    job->ntimestep = update->ntimestep;
+    job->fp = fp;
+    job->flushflag = flush_flag;
+    if (multifile) {
+      job->closeflag = compressed ? 2 : 1;
+      fp = NULL;
+    }
+    async->submit();
+
+  } else {
+    MPI_Recv(&tmp,0,MPI_INT,fileproc,0,world,MPI_STATUS_IGNORE);
+    if (binary) MPI_Rsend(buf,nme*size_one,MPI_DOUBLE,fileproc,0,world);
+    else MPI_Rsend(sbuf,nsme,MPI_CHAR,fileproc,0,world);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   called by the i/o thread, write one staged snapshot
+   only touches the slot, never members of the dump
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpd::write_job(DumpSsaTsdpdAsync::Job *job)
+{
+  fwrite(job->data,sizeof(char),job->nbytes,job->fp);
+  if (job->flushflag) fflush(job->fp);
+
+  if (job->closeflag == 1) fclose(job->fp);
+  else if (job->closeflag == 2) {
+#ifdef _WIN32
+    _pclose(job->fp);
+#else
+    pclose(job->fp);
+#endif
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpSsaTsdpd::async_callback(void *ptr, DumpSsaTsdpdAsync::Job *job)
+{
+  ((DumpSsaTsdpd *) ptr)->write_job(job);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -375,75 +606,126 @@ void DumpSsaTsdpd::write_header(bigint ndump)
   else if (me == 0) (this->*header_choice)(ndump);
 }
 
+/* ----------------------------------------------------------------------
+   output of the header functions, written to fp
+     or appended to hbuf while write_async() stages the header
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpd::header_write(const void *ptr, int nbytes)
+{
+  if (!hstage) {
+    fwrite(ptr,nbytes,1,fp);
+    return;
+  }
+
+  grow_header(nbytes);
+  memcpy(&hbuf[nhbuf],ptr,nbytes);
+  nhbuf += nbytes;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpSsaTsdpd::header_printf(const char *format, ...)
+{
+  va_list args;
+
+  if (!hstage) {
+    va_start(args,format);
+    vfprintf(fp,format,args);
+    va_end(args);
+    return;
+  }
+
+  va_start(args,format);
+  int n = vsnprintf(NULL,0,format,args);
+  va_end(args);
+  if (n < 0) error->one(FLERR,"Cannot stage dump header");
+
+  grow_header(n+1);
+  va_start(args,format);
+  vsnprintf(&hbuf[nhbuf],n+1,format,args);
+  va_end(args);
+  nhbuf += n;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpSsaTsdpd::grow_header(int nbytes)
+{
+  if (nhbuf + nbytes <= maxhbuf) return;
+  maxhbuf = MAX(nhbuf + nbytes,2*maxhbuf);
+  memory->grow(hbuf,maxhbuf,"dump:hbuf");
+}
+
 /* ---------------------------------------------------------------------- */
 
 void DumpSsaTsdpd::header_binary(bigint ndump)
 {
-  fwrite(&update->ntimestep,sizeof(bigint),1,fp);
-  fwrite(&ndump,sizeof(bigint),1,fp);
-  fwrite(&domain->triclinic,sizeof(int),1,fp);
-  fwrite(&domain->boundary[0][0],6*sizeof(int),1,fp);
-  fwrite(&boxxlo,sizeof(double),1,fp);
-  fwrite(&boxxhi,sizeof(double),1,fp);
-  fwrite(&boxylo,sizeof(double),1,fp);
-  fwrite(&boxyhi,sizeof(double),1,fp);
-  fwrite(&boxzlo,sizeof(double),1,fp);
-  fwrite(&boxzhi,sizeof(double),1,fp);
-  fwrite(&size_one,sizeof(int),1,fp);
-  if (multiproc) fwrite(&nclusterprocs,sizeof(int),1,fp);
-  else fwrite(&nprocs,sizeof(int),1,fp);
+  header_write(&update->ntimestep,sizeof(bigint));
+  header_write(&ndump,sizeof(bigint));
+  header_write(&domain->triclinic,sizeof(int));
+  header_write(&domain->boundary[0][0],6*sizeof(int));
+  header_write(&boxxlo,sizeof(double));
+  header_write(&boxxhi,sizeof(double));
+  header_write(&boxylo,sizeof(double));
+  header_write(&boxyhi,sizeof(double));
+  header_write(&boxzlo,sizeof(double));
+  header_write(&boxzhi,sizeof(double));
+  header_write(&size_one,sizeof(int));
+  if (multiproc) header_write(&nclusterprocs,sizeof(int));
+  else header_write(&nprocs,sizeof(int));
 }
 
 /* ---------------------------------------------------------------------- */
 
 void DumpSsaTsdpd::header_binary_triclinic(bigint ndump)
 {
-  fwrite(&update->ntimestep,sizeof(bigint),1,fp);
-  fwrite(&ndump,sizeof(bigint),1,fp);
-  fwrite(&domain->triclinic,sizeof(int),1,fp);
-  fwrite(&domain->boundary[0][0],6*sizeof(int),1,fp);
-  fwrite(&boxxlo,sizeof(double),1,fp);
-  fwrite(&boxxhi,sizeof(double),1,fp);
-  fwrite(&boxylo,sizeof(double),1,fp);
-  fwrite(&boxyhi,sizeof(double),1,fp);
-  fwrite(&boxzlo,sizeof(double),1,fp);
-  fwrite(&boxzhi,sizeof(double),1,fp);
-  fwrite(&boxxy,sizeof(double),1,fp);
-  fwrite(&boxxz,sizeof(double),1,fp);
-  fwrite(&boxyz,sizeof(double),1,fp);
-  fwrite(&size_one,sizeof(int),1,fp);
-  if (multiproc) fwrite(&nclusterprocs,sizeof(int),1,fp);
-  else fwrite(&nprocs,sizeof(int),1,fp);
+  header_write(&update->ntimestep,sizeof(bigint));
+  header_write(&ndump,sizeof(bigint));
+  header_write(&domain->triclinic,sizeof(int));
+  header_write(&domain->boundary[0][0],6*sizeof(int));
+  header_write(&boxxlo,sizeof(double));
+  header_write(&boxxhi,sizeof(double));
+  header_write(&boxylo,sizeof(double));
+  header_write(&boxyhi,sizeof(double));
+  header_write(&boxzlo,sizeof(double));
+  header_write(&boxzhi,sizeof(double));
+  header_write(&boxxy,sizeof(double));
+  header_write(&boxxz,sizeof(double));
+  header_write(&boxyz,sizeof(double));
+  header_write(&size_one,sizeof(int));
+  if (multiproc) header_write(&nclusterprocs,sizeof(int));
+  else header_write(&nprocs,sizeof(int));
 }
 
 /* ---------------------------------------------------------------------- */
 
 void DumpSsaTsdpd::header_item(bigint ndump)
 {
-  fprintf(fp,"ITEM: TIMESTEP\n");
-  fprintf(fp,BIGINT_FORMAT "\n",update->ntimestep);
-  fprintf(fp,"ITEM: NUMBER OF ATOMS\n");
-  fprintf(fp,BIGINT_FORMAT "\n",ndump);
-  fprintf(fp,"ITEM: BOX BOUNDS %s\n",boundstr);
-  fprintf(fp,"%-1.16e %-1.16e\n",boxxlo,boxxhi);
-  fprintf(fp,"%-1.16e %-1.16e\n",boxylo,boxyhi);
-  fprintf(fp,"%-1.16e %-1.16e\n",boxzlo,boxzhi);
-  fprintf(fp,"ITEM: ATOMS %s\n",columns);
+  header_printf("ITEM: TIMESTEP\n");
+  header_printf(BIGINT_FORMAT "\n",update->ntimestep);
+  header_printf("ITEM: NUMBER OF ATOMS\n");
+  header_printf(BIGINT_FORMAT "\n",ndump);
+  header_printf("ITEM: BOX BOUNDS %s\n",boundstr);
+  header_printf("%-1.16e %-1.16e\n",boxxlo,boxxhi);
+  header_printf("%-1.16e %-1.16e\n",boxylo,boxyhi);
+  header_printf("%-1.16e %-1.16e\n",boxzlo,boxzhi);
+  header_printf("ITEM: ATOMS %s\n",columns);
 }
 
 /* ---------------------------------------------------------------------- */
 
 void DumpSsaTsdpd::header_item_triclinic(bigint ndump)
 {
-  fprintf(fp,"ITEM: TIMESTEP\n");
-  fprintf(fp,BIGINT_FORMAT "\n",update->ntimestep);
-  fprintf(fp,"ITEM: NUMBER OF ATOMS\n");
-  fprintf(fp,BIGINT_FORMAT "\n",ndump);
-  fprintf(fp,"ITEM: BOX BOUNDS xy xz yz %s\n",boundstr);
-  fprintf(fp,"%-1.16e %-1.16e %-1.16e\n",boxxlo,boxxhi,boxxy);
-  fprintf(fp,"%-1.16e %-1.16e %-1.16e\n",boxylo,boxyhi,boxxz);
-  fprintf(fp,"%-1.16e %-1.16e %-1.16e\n",boxzlo,boxzhi,boxyz);
-  fprintf(fp,"ITEM: ATOMS %s\n",columns);
+  header_printf("ITEM: TIMESTEP\n");
+  header_printf(BIGINT_FORMAT "\n",update->ntimestep);
+  header_printf("ITEM: NUMBER OF ATOMS\n");
+  header_printf(BIGINT_FORMAT "\n",ndump);
+  header_printf("ITEM: BOX BOUNDS xy xz yz %s\n",boundstr);
+  header_printf("%-1.16e %-1.16e %-1.16e\n",boxxlo,boxxhi,boxxy);
+  header_printf("%-1.16e %-1.16e %-1.16e\n",boxylo,boxyhi,boxxz);
+  header_printf("%-1.16e %-1.16e %-1.16e\n",boxzlo,boxzhi,boxyz);
+  header_printf("ITEM: ATOMS %s\n",columns);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -1201,9 +1483,24 @@ int DumpSsaTsdpd::parse_fields(int narg, char **arg)
       delete [] suffix;
 
 
+    // mean and variance of an SSA species over the ensemble replicas
+
+    } else if (strncmp(arg[iarg],"Cdmean_",7) == 0 ||
+               strncmp(arg[iarg],"Cdvar_",6) == 0) {
+      if (arg[iarg][2] == 'm') pack_choice[i] = &DumpSsaTsdpd::pack_Cdmean;
+      else pack_choice[i] = &DumpSsaTsdpd::pack_Cdvar;
+      vtype[i] = DOUBLE;
+      char *ptr = strchr(arg[iarg],'[');
+      if (ptr == NULL || arg[iarg][strlen(arg[iarg])-1] != ']')
+        error->all(FLERR,"Invalid attribute in dump custom command");
+      argindex[i] = atoi(ptr+1);
+      if (argindex[i] < 0 || argindex[i] > atom->num_ssa_species - 1)
+        error->all(FLERR,"Argument in Cdmean_[] or Cdvar_[] is greater "
+                   "than the number of SSA species");
+
     //added
     } else if (strncmp(arg[iarg],"Cd_",2) == 0) {
-      pack_choice[i] = &DumpSsaTsdpd::pack_C;
+      pack_choice[i] = &DumpSsaTsdpd::pack_Cd;
 
       if (atom->Cd_concentration_flag == 1) {
         vtype[i] = DOUBLE;
@@ -1219,7 +1516,7 @@ int DumpSsaTsdpd::parse_fields(int narg, char **arg)
       if (ptr) {
         if (suffix[strlen(suffix)-1] != ']')
           error->all(FLERR,"Invalid attribute in dump custom command");
-	if (atoi(ptr+1) > atom->num_ssa_species - 1)
+	if (atoi(ptr+1) > atom->Cd.ncol - 1)
 	  error->all(FLERR,"Argument in Cd_[] is greater than the number of SSA species");
         argindex[i] = atoi(ptr+1);
         *ptr = '\0';
@@ -1635,6 +1932,9 @@ int DumpSsaTsdpd::add_custom(char *id, int flag)
 
 int DumpSsaTsdpd::modify_param(int narg, char **arg)
 {
+  int n = modify_param_async(narg,arg);
+  if (n) return n;
+
   if (strcmp(arg[0],"region") == 0) {
     if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
     if (strcmp(arg[1],"none") == 0) iregion = -1;
@@ -2034,6 +2334,40 @@ int DumpSsaTsdpd::modify_param(int narg, char **arg)
   return 0;
 }
 
+/* ----------------------------------------------------------------------
+   dump_modify keywords for asynchronous output, shared with derived dumps
+   changing them drops the current queue, init_async() makes a new one
+------------------------------------------------------------------------- */
+
+int DumpSsaTsdpd::modify_param_async(int narg, char **arg)
+{
+  if (strcmp(arg[0],"async") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    if (strcmp(arg[1],"yes") == 0) async_flag = 1;
+    else if (strcmp(arg[1],"no") == 0) async_flag = 0;
+    else error->all(FLERR,"Illegal dump_modify command");
+    delete async;
+    async = NULL;
+#if !defined(SSA_TSDPD_ASYNC)
+    if (async_flag && me == 0)
+      error->warning(FLERR,"Dump_modify async needs -DSSA_TSDPD_ASYNC, "
+                     "snapshots are written synchronously");
+#endif
+    return 2;
+  }
+
+  if (strcmp(arg[0],"queue") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    async_depth = force->inumeric(FLERR,arg[1]);
+    if (async_depth < 1) error->all(FLERR,"Illegal dump_modify command");
+    delete async;
+    async = NULL;
+    return 2;
+  }
+
+  return 0;
+}
+
 /* ----------------------------------------------------------------------
    return # of bytes of allocated memory in buf, choose, variable arrays
 ------------------------------------------------------------------------- */
@@ -2041,6 +2375,8 @@ int DumpSsaTsdpd::modify_param(int narg, char **arg)
 bigint DumpSsaTsdpd::memory_usage()
 {
   bigint bytes = Dump::memory_usage();
+  if (async) bytes += async->memory_usage();
+  bytes += memory->usage(hbuf,maxhbuf);
   bytes += memory->usage(choose,maxlocal);
   bytes += memory->usage(dchoose,maxlocal);
   bytes += memory->usage(clist,maxlocal);
@@ -2221,7 +2557,7 @@ void DumpSsaTsdpd::pack_mass(int n)
 //added
 void DumpSsaTsdpd::pack_C(int n)
 {
-  double **C = atom->C;
+  SpeciesArray<double> C = atom->C;
   int index = argindex[n];
   for (int i = 0; i < nchoose; i++) {
           buf[n] = C[clist[i]][index];
@@ -2233,7 +2569,7 @@ void DumpSsaTsdpd::pack_C(int n)
 //added
 void DumpSsaTsdpd::pack_Cd(int n)
 {
-  int **Cd = atom->Cd;
+  SpeciesArray<int> Cd = atom->Cd;
   int index = argindex[n];
   double *mass = atom->mass;
   double *rho = atom->rho;
@@ -2255,6 +2591,64 @@ void DumpSsaTsdpd::pack_Cd(int n)
 
 }
 
+/* ----------------------------------------------------------------------
+   mean of SSA species index over the replicas of each atom
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpd::pack_Cdmean(int n)
+{
+  SpeciesArray<int> Cd = atom->Cd;
+  int index = argindex[n];
+  int nssa = atom->num_ssa_species;
+  int nrep = atom->num_ssa_replicas;
+  double *mass = atom->mass;
+  double *rho = atom->rho;
+  int *type = atom->type;
+
+  for (int i = 0; i < nchoose; i++) {
+    int j = clist[i];
+    double sum = 0.0;
+    for (int q = 0; q < nrep; q++) sum += Cd[j][q*nssa+index];
+    buf[n] = sum/nrep;
+    if (atom->Cd_concentration_flag == 1) buf[n] *= rho[j] / mass[type[j]];
+    n += size_one;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   sample variance of SSA species index over the replicas of each atom,
+     0 for a single replica
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpd::pack_Cdvar(int n)
+{
+  SpeciesArray<int> Cd = atom->Cd;
+  int index = argindex[n];
+  int nssa = atom->num_ssa_species;
+  int nrep = atom->num_ssa_replicas;
+  double *mass = atom->mass;
+  double *rho = atom->rho;
+  int *type = atom->type;
+
+  for (int i = 0; i < nchoose; i++) {
+    int j = clist[i];
+    double sum = 0.0;
+    for (int q = 0; q < nrep; q++) sum += Cd[j][q*nssa+index];
+    double mean = sum/nrep;
+    double var = 0.0;
+    for (int q = 0; q < nrep; q++) {
+      double del = Cd[j][q*nssa+index] - mean;
+      var += del*del;
+    }
+    buf[n] = nrep > 1 ? var/(nrep-1) : 0.0;
+    if (atom->Cd_concentration_flag == 1) {
+      double scale = rho[j] / mass[type[j]];
+      buf[n] *= scale*scale;
+    }
+    n += size_one;
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void DumpSsaTsdpd::pack_x(int n)
@@ -0,0 +1,180 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include <string.h>
+#include "dump_ssa_tsdpd_async.h"
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+
+#define DELTA 1048576
+
+/* ---------------------------------------------------------------------- */
+
+DumpSsaTsdpdAsync::DumpSsaTsdpdAsync(LAMMPS *lmp, FnPtrJob fn, void *p,
+                                     int n) :
+  Pointers(lmp), callback(fn), ptr(p), depth(n)
+{
+  jobs = new Job[depth];
+  for (int i = 0; i < depth; i++) {
+    jobs[i].fp = NULL;
+    jobs[i].nbytes = jobs[i].maxbytes = 0;
+    jobs[i].data = NULL;
+  }
+  head = nqueued = 0;
+  quit = 0;
+
+#if defined(SSA_TSDPD_ASYNC)
+  pthread_mutex_init(&mutex,NULL);
+  pthread_cond_init(&cond_work,NULL);
+  pthread_cond_init(&cond_free,NULL);
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr,PTHREAD_CREATE_JOINABLE);
+  pthread_create(&iothread,&attr,&dump_ssa_tsdpd_async_worker,this);
+  pthread_attr_destroy(&attr);
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+
+DumpSsaTsdpdAsync::~DumpSsaTsdpdAsync()
+{
+#if defined(SSA_TSDPD_ASYNC)
+  pthread_mutex_lock(&mutex);
+  quit = 1;
+  pthread_cond_signal(&cond_work);
+  pthread_mutex_unlock(&mutex);
+  pthread_join(iothread,NULL);
+
+  pthread_mutex_destroy(&mutex);
+  pthread_cond_destroy(&cond_work);
+  pthread_cond_destroy(&cond_free);
+#endif
+
+  for (int i = 0; i < depth; i++) memory->sfree(jobs[i].data);
+  delete [] jobs;
+}
+
+/* ----------------------------------------------------------------------
+   return the next free slot, block while all slots are queued
+------------------------------------------------------------------------- */
+
+DumpSsaTsdpdAsync::Job *DumpSsaTsdpdAsync::acquire()
+{
+#if defined(SSA_TSDPD_ASYNC)
+  pthread_mutex_lock(&mutex);
+  while (nqueued == depth) pthread_cond_wait(&cond_free,&mutex);
+  Job *job = &jobs[(head+nqueued) % depth];
+  pthread_mutex_unlock(&mutex);
+#else
+  Job *job = &jobs[head];
+#endif
+
+  job->n = 0;
+  job->fp = NULL;
+  job->closeflag = job->flushflag = 0;
+  job->nbytes = 0;
+  return job;
+}
+
+/* ----------------------------------------------------------------------
+   copy N bytes to end of data of an acquired slot
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdAsync::append(Job *job, const void *src, bigint n)
+{
+  if (job->nbytes + n > job->maxbytes) {
+    job->maxbytes = job->nbytes + n + DELTA;
+    job->data = (char *)
+      memory->srealloc(job->data,job->maxbytes,"dump:async");
+  }
+  memcpy(&job->data[job->nbytes],src,n);
+  job->nbytes += n;
+}
+
+/* ----------------------------------------------------------------------
+   hand the acquired slot to the i/o thread
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdAsync::submit()
+{
+#if defined(SSA_TSDPD_ASYNC)
+  pthread_mutex_lock(&mutex);
+  nqueued++;
+  pthread_cond_signal(&cond_work);
+  pthread_mutex_unlock(&mutex);
+#else
+  callback(ptr,&jobs[head]);
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   wait until the i/o thread has written all queued slots
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdAsync::flush()
+{
+#if defined(SSA_TSDPD_ASYNC)
+  pthread_mutex_lock(&mutex);
+  while (nqueued) pthread_cond_wait(&cond_free,&mutex);
+  pthread_mutex_unlock(&mutex);
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   i/o thread: write queued slots in order until told to quit
+   a slot stays counted in nqueued until written, so acquire()
+     cannot hand it out again while it is in use
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdAsync::run()
+{
+#if defined(SSA_TSDPD_ASYNC)
+  pthread_mutex_lock(&mutex);
+  while (1) {
+    while (nqueued == 0 && !quit) pthread_cond_wait(&cond_work,&mutex);
+    if (nqueued == 0) break;
+    Job *job = &jobs[head];
+    pthread_mutex_unlock(&mutex);
+
+    callback(ptr,job);
+
+    pthread_mutex_lock(&mutex);
+    head = (head+1) % depth;
+    nqueued--;
+    pthread_cond_broadcast(&cond_free);
+  }
+  pthread_mutex_unlock(&mutex);
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+
+bigint DumpSsaTsdpdAsync::memory_usage()
+{
+  bigint bytes = 0;
+  for (int i = 0; i < depth; i++) bytes += jobs[i].maxbytes;
+  return bytes;
+}
+
+/* ----------------------------------------------------------------------
+   c wrapper for pthread_create()
+------------------------------------------------------------------------- */
+
+void *dump_ssa_tsdpd_async_worker(void *t)
+{
+  ((DumpSsaTsdpdAsync *) t)->run();
+  return NULL;
+}
@@ -0,0 +1,103 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef DUMP_CLASS
+
+DumpStyle(ssa_tsdpd/col,DumpSsaTsdpdCol)
+
+#else
+
+#ifndef DUMP_SSA_TSDPD_COL_H
+#define DUMP_SSA_TSDPD_COL_H
+
+#include "dump_ssa_tsdpd.h"
+
+namespace LAMMPS_NS {
+
+// columnar binary snapshots, one encoded chunk per field
+// file  = header, then one self-contained frame per snapshot
+// frame = 16-byte header with the frame size, the field chunks
+//   (each 8-byte aligned), an index with timestep, box and the offset,
+//   size and codec of every chunk, and a 16-byte trailer locating the index
+// readers can skip frames and fields without decoding them,
+//   see tools/ssa_tsdpd_col for the full layout and C++/Python readers
+
+class DumpSsaTsdpdCol : public DumpSsaTsdpd {
+ public:
+  DumpSsaTsdpdCol(class LAMMPS *, int, char **);
+  virtual ~DumpSsaTsdpdCol();
+
+ protected:
+  int codec;                 // RAW, FAST or ZLIB for all fields
+  int single;                // 1 = store floating point fields as float32
+  char **fname;              // name of each field
+  int *ftype;                // integer or floating point storage of each field
+  int *fcodec;               // codec used for each field in current frame
+  bigint *foffset;           // offset of each chunk in current frame
+  bigint *fbytes;            // size of each chunk in current frame
+
+  int nwrite;                // # of procs received for current frame
+  bigint nrows,maxrows;      // # of rows staged for current frame
+  double *rows;              // staged rows, same layout as buf
+
+  bigint nframe,maxframe;    // bytes used and allocated in frame
+  unsigned char *frame;      // current frame
+  bigint maxscratch;
+  unsigned char *scratch;    // one column before encoding
+
+  virtual void init_style();
+  virtual void openfile();
+  virtual void write_header(bigint);
+  virtual void write_data(int, double *);
+  virtual int modify_param(int, char **);
+  virtual bigint memory_usage();
+
+  void write_frame();
+  void encode_field(int);
+  void grow_frame(bigint);
+  void grow_scratch(bigint);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Dump ssa_tsdpd/col does not support the element field
+
+Strings cannot be stored in the binary columns.
+
+E: Dump ssa_tsdpd/col cannot write compressed files
+
+The fields are already compressed, do not use a .gz suffix.
+
+E: Dump ssa_tsdpd/col does not support dump_modify async
+
+Frames are encoded by the filewriter procs while they are written.
+
+E: Dump_modify codec zlib requires -DSSA_TSDPD_ZLIB
+
+LAMMPS was built without zlib support for this dump style.  Add
+-DSSA_TSDPD_ZLIB to LMP_INC and link with -lz.
+
+E: Cannot compress dump ssa_tsdpd/col field
+
+The zlib library returned an error.
+
+E: Illegal dump_modify command
+
+Self-explanatory.
+
+*/
@@ -0,0 +1,429 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dump_ssa_tsdpd_vtu.h"
+#include "atom.h"
+#include "domain.h"
+#include "update.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+enum{INT,DOUBLE,STRING,BIGINT};    // same as in DumpSsaTsdpd
+enum{POINTS=-1,CONNECTIVITY=-2,OFFSETS=-3,TYPES=-4};
+
+#define VTK_VERTEX 1
+#define MAXLINE 256
+
+static const char *footer = "\n  </AppendedData>\n</VTKFile>\n";
+
+/* ---------------------------------------------------------------------- */
+
+DumpSsaTsdpdVTU::DumpSsaTsdpdVTU(LAMMPS *lmp, int narg, char **arg) :
+  DumpSsaTsdpd(lmp, narg, arg), fname(NULL), bfield(NULL), bsize(NULL),
+  boffset(NULL), filecurrent(NULL), cbuf(NULL)
+{
+  if (multifile == 0)
+    error->all(FLERR,"Dump ssa_tsdpd/vtu requires one file per snapshot");
+  if (binary || compressed)
+    error->all(FLERR,"Dump ssa_tsdpd/vtu cannot write binary or compressed files");
+  if (multiproc)
+    error->all(FLERR,"Dump ssa_tsdpd/vtu cannot write multiple files per snapshot");
+
+  buffer_allow = 0;
+  buffer_flag = 0;
+
+  // earg is not kept after the constructor
+
+  fname = new char*[nfield];
+  ix = iy = iz = -1;
+  for (int i = 0; i < nfield; i++) {
+    fname[i] = new char[strlen(earg[i])+1];
+    strcpy(fname[i],earg[i]);
+    if (strcmp(earg[i],"x") == 0) ix = i;
+    else if (strcmp(earg[i],"y") == 0) iy = i;
+    else if (strcmp(earg[i],"z") == 0) iz = i;
+    if (vtype[i] == STRING)
+      error->all(FLERR,"Dump ssa_tsdpd/vtu does not support the element field");
+  }
+  if (ix < 0 || iy < 0 || iz < 0)
+    error->all(FLERR,"Dump ssa_tsdpd/vtu requires x y z fields");
+
+  // appended arrays in file order:
+  // points, one array per remaining field, then the vertex cells
+
+  nblock = nfield - 3 + 4;
+  bfield = new int[nblock];
+  bsize = new int[nblock];
+  boffset = new MPI_Offset[nblock];
+
+  int m = 0;
+  bfield[m] = POINTS;
+  bsize[m++] = 3*sizeof(double);
+  for (int i = 0; i < nfield; i++) {
+    if (i == ix || i == iy || i == iz) continue;
+    bfield[m] = i;
+    if (vtype[i] == INT) bsize[m++] = sizeof(int);
+    else if (vtype[i] == BIGINT) bsize[m++] = sizeof(int64_t);
+    else bsize[m++] = sizeof(double);
+  }
+  bfield[m] = CONNECTIVITY;
+  bsize[m++] = sizeof(int64_t);
+  bfield[m] = OFFSETS;
+  bsize[m++] = sizeof(int64_t);
+  bfield[m] = TYPES;
+  bsize[m++] = sizeof(unsigned char);
+
+  maxcbuf = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+DumpSsaTsdpdVTU::~DumpSsaTsdpdVTU()
+{
+  for (int i = 0; i < nfield; i++) delete [] fname[i];
+  delete [] fname;
+  delete [] bfield;
+  delete [] bsize;
+  delete [] boffset;
+  memory->destroy(cbuf);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpSsaTsdpdVTU::init_style()
+{
+  if (multiproc)
+    error->all(FLERR,"Dump ssa_tsdpd/vtu cannot write multiple files per snapshot");
+  if (async_flag)
+    error->all(FLERR,"Dump ssa_tsdpd/vtu does not support dump_modify async");
+
+  DumpSsaTsdpd::init_style();
+}
+
+/* ----------------------------------------------------------------------
+   open the file of the current snapshot on all procs
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdVTU::openfile()
+{
+  char *filestar = filename;
+  filecurrent = new char[strlen(filestar) + 16];
+  char *ptr = strchr(filestar,'*');
+  *ptr = '\0';
+  if (padflag == 0)
+    sprintf(filecurrent,"%s" BIGINT_FORMAT "%s",
+            filestar,update->ntimestep,ptr+1);
+  else {
+    char bif[8],pad[16];
+    strcpy(bif,BIGINT_FORMAT);
+    sprintf(pad,"%%s%%0%d%s%%s",padflag,&bif[1]);
+    sprintf(filecurrent,pad,filestar,update->ntimestep,ptr+1);
+  }
+  *ptr = '*';
+
+#ifdef MPI_STUBS
+  fp = fopen(filecurrent,"wb");
+  int err = (fp == NULL) ? MPI_ERR_ARG : MPI_SUCCESS;
+#else
+  int err = MPI_File_open(world,filecurrent,MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                          MPI_INFO_NULL,&mpifh);
+#endif
+  if (err != MPI_SUCCESS) {
+    char str[128];
+    sprintf(str,"Cannot open dump file %s",filecurrent);
+    error->one(FLERR,str);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpSsaTsdpdVTU::write()
+{
+  imageint *imagehold = NULL;
+  double **xhold = NULL;
+  double **vhold = NULL;
+
+  // nme = # of atoms this proc contributes to dump
+  // ntotal = total # of atoms in snapshot
+
+  nme = count();
+
+  bigint bnme = nme;
+  MPI_Allreduce(&bnme,&ntotal,1,MPI_LMP_BIGINT,MPI_SUM,world);
+
+  int nmax;
+  MPI_Allreduce(&nme,&nmax,1,MPI_INT,MPI_MAX,world);
+
+  if (nmax > maxbuf) {
+    if ((bigint) nmax * size_one > MAXSMALLINT)
+      error->all(FLERR,"Too much per-proc info for dump");
+    maxbuf = nmax;
+    memory->destroy(buf);
+    memory->create(buf,maxbuf*size_one,"dump:buf");
+  }
+
+  if (sort_flag && sortcol == 0 && nmax > maxids) {
+    maxids = nmax;
+    memory->destroy(ids);
+    memory->create(ids,maxids,"dump:ids");
+  }
+
+  // apply PBC on copy of x,v,image if requested
+
+  if (pbcflag) {
+    int nlocal = atom->nlocal;
+    if (nlocal > maxpbc) pbc_allocate();
+    if (nlocal) {
+      memcpy(&xpbc[0][0],&atom->x[0][0],3*nlocal*sizeof(double));
+      memcpy(&vpbc[0][0],&atom->v[0][0],3*nlocal*sizeof(double));
+      memcpy(imagepbc,atom->image,nlocal*sizeof(imageint));
+    }
+    xhold = atom->x;
+    vhold = atom->v;
+    imagehold = atom->image;
+    atom->x = xpbc;
+    atom->v = vpbc;
+    atom->image = imagepbc;
+    domain->pbc();
+  }
+
+  // pack my data into buf, sort may change nme
+
+  if (sort_flag && sortcol == 0) pack(ids);
+  else pack(NULL);
+  if (sort_flag) sort();
+
+  if (pbcflag) {
+    atom->x = xhold;
+    atom->v = vhold;
+    atom->image = imagehold;
+  }
+
+  // nbefore = # of atoms written by lower procs
+
+  bnme = nme;
+  bigint nbefore;
+  MPI_Scan(&bnme,&nbefore,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  nbefore -= bnme;
+
+  MPI_Allreduce(&nme,&nmax,1,MPI_INT,MPI_MAX,world);
+  if (nmax > maxcbuf) {
+    if ((bigint) nmax * 3*sizeof(double) > MAXSMALLINT)
+      error->all(FLERR,"Too much per-proc info for dump");
+    maxcbuf = nmax;
+    memory->destroy(cbuf);
+    memory->create(cbuf,maxcbuf*3*sizeof(double),"dump:cbuf");
+  }
+
+  // file layout = XML header, then each appended array as
+  //   a UInt64 byte count followed by ntotal values, then the footer
+  // every proc computes the same layout, no communication needed
+
+  MPI_Offset offset = 0;
+  for (int ib = 0; ib < nblock; ib++) {
+    boffset[ib] = offset;
+    offset += sizeof(uint64_t) + (MPI_Offset) ntotal*bsize[ib];
+  }
+  MPI_Offset headersize = header_string(NULL,ntotal);
+
+  openfile();
+#ifndef MPI_STUBS
+  MPI_File_set_size(mpifh,headersize + offset + strlen(footer));
+#endif
+
+  if (me == 0) {
+    char *header = new char[headersize+1];
+    header_string(header,ntotal);
+    write_at(0,header,headersize,0);
+    delete [] header;
+
+    for (int ib = 0; ib < nblock; ib++) {
+      uint64_t nbytes = (uint64_t) ntotal*bsize[ib];
+      write_at(headersize+boffset[ib],&nbytes,sizeof(uint64_t),0);
+    }
+    write_at(headersize+offset,footer,strlen(footer),0);
+  }
+
+  // each proc writes its slab of every array
+
+  for (int ib = 0; ib < nblock; ib++) {
+    pack_block(ib,nbefore);
+    MPI_Offset mpifo = headersize + boffset[ib] + sizeof(uint64_t) +
+      (MPI_Offset) nbefore*bsize[ib];
+    write_at(mpifo,cbuf,nme*bsize[ib],1);
+  }
+
+  closefile();
+  delete [] filecurrent;
+  filecurrent = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   write N bytes of DATA at OFFSET of the current file,
+     collective over all procs if ALL is set
+   with the MPI STUBS library the only proc seeks and writes with stdio
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdVTU::write_at(MPI_Offset offset, const void *data, int n,
+                               int all)
+{
+#ifdef MPI_STUBS
+  fseek(fp,offset,SEEK_SET);
+  fwrite(data,1,n,fp);
+#else
+  if (all)
+    MPI_File_write_at_all(mpifh,offset,(void *) data,n,MPI_BYTE,
+                          MPI_STATUS_IGNORE);
+  else
+    MPI_File_write_at(mpifh,offset,(void *) data,n,MPI_BYTE,
+                      MPI_STATUS_IGNORE);
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpSsaTsdpdVTU::closefile()
+{
+#ifdef MPI_STUBS
+  fclose(fp);
+  fp = NULL;
+#else
+  MPI_File_close(&mpifh);
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   copy column(s) of buf for appended array IB into cbuf
+   nbefore = global index of my first atom
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdVTU::pack_block(int ib, bigint nbefore)
+{
+  int i;
+  int k = bfield[ib];
+
+  if (k == POINTS) {
+    double *p = (double *) cbuf;
+    for (i = 0; i < nme; i++) {
+      p[3*i] = buf[i*size_one+ix];
+      p[3*i+1] = buf[i*size_one+iy];
+      p[3*i+2] = buf[i*size_one+iz];
+    }
+  } else if (k == CONNECTIVITY || k == OFFSETS) {
+    int64_t *p = (int64_t *) cbuf;
+    int64_t shift = (k == OFFSETS) ? 1 : 0;
+    for (i = 0; i < nme; i++) p[i] = nbefore + i + shift;
+  } else if (k == TYPES) {
+    memset(cbuf,VTK_VERTEX,nme);
+  } else if (vtype[k] == INT) {
+    int *p = (int *) cbuf;
+    for (i = 0; i < nme; i++) p[i] = static_cast<int> (buf[i*size_one+k]);
+  } else if (vtype[k] == BIGINT) {
+    int64_t *p = (int64_t *) cbuf;
+    for (i = 0; i < nme; i++) p[i] = static_cast<int64_t> (buf[i*size_one+k]);
+  } else {
+    double *p = (double *) cbuf;
+    for (i = 0; i < nme; i++) p[i] = buf[i*size_one+k];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   XML part of the file up to and including the "_" that starts
+     the appended data
+   copied into str unless it is NULL, return # of chars
+------------------------------------------------------------------------- */
+
+int DumpSsaTsdpdVTU::header_string(char *str, bigint n)
+{
+  char line[MAXLINE];
+  int len = 0;
+
+#define ADDLINE                                    \
+  {                                                \
+    int m = strlen(line);                          \
+    if (str) memcpy(&str[len],line,m);             \
+    len += m;                                      \
+  }
+
+  int one = 1;
+  const char *order = (*(char *) &one) ? "LittleEndian" : "BigEndian";
+  double time = update->atime +
+    (update->ntimestep - update->atimestep)*update->dt;
+
+  snprintf(line,MAXLINE,"<?xml version=\"1.0\"?>\n"
+           "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" "
+           "byte_order=\"%s\" header_type=\"UInt64\">\n"
+           "  <UnstructuredGrid>\n",order);
+  ADDLINE;
+  snprintf(line,MAXLINE,"    <FieldData>\n"
+           "      <DataArray type=\"Float64\" Name=\"TimeValue\" "
+           "NumberOfTuples=\"1\" format=\"ascii\">%.16g</DataArray>\n"
+           "    </FieldData>\n",time);
+  ADDLINE;
+  snprintf(line,MAXLINE,"    <Piece NumberOfPoints=\"" BIGINT_FORMAT
+           "\" NumberOfCells=\"" BIGINT_FORMAT "\">\n",n,n);
+  ADDLINE;
+  snprintf(line,MAXLINE,"      <Points>\n"
+           "        <DataArray type=\"Float64\" NumberOfComponents=\"3\" "
+           "format=\"appended\" offset=\"" BIGINT_FORMAT "\"/>\n"
+           "      </Points>\n"
+           "      <PointData>\n",(bigint) boffset[0]);
+  ADDLINE;
+
+  for (int ib = 0; ib < nblock; ib++) {
+    int k = bfield[ib];
+    if (k < 0) continue;
+    const char *type = "Float64";
+    if (vtype[k] == INT) type = "Int32";
+    else if (vtype[k] == BIGINT) type = "Int64";
+    snprintf(line,MAXLINE,"        <DataArray type=\"%s\" Name=\"%s\" "
+             "format=\"appended\" offset=\"" BIGINT_FORMAT "\"/>\n",
+             type,fname[k],(bigint) boffset[ib]);
+    ADDLINE;
+  }
+
+  snprintf(line,MAXLINE,"      </PointData>\n      <Cells>\n");
+  ADDLINE;
+  for (int ib = 0; ib < nblock; ib++) {
+    int k = bfield[ib];
+    if (k == CONNECTIVITY)
+      snprintf(line,MAXLINE,"        <DataArray type=\"Int64\" "
+               "Name=\"connectivity\" format=\"appended\" offset=\""
+               BIGINT_FORMAT "\"/>\n",(bigint) boffset[ib]);
+    else if (k == OFFSETS)
+      snprintf(line,MAXLINE,"        <DataArray type=\"Int64\" "
+               "Name=\"offsets\" format=\"appended\" offset=\""
+               BIGINT_FORMAT "\"/>\n",(bigint) boffset[ib]);
+    else if (k == TYPES)
+      snprintf(line,MAXLINE,"        <DataArray type=\"UInt8\" "
+               "Name=\"types\" format=\"appended\" offset=\""
+               BIGINT_FORMAT "\"/>\n",(bigint) boffset[ib]);
+    else continue;
+    ADDLINE;
+  }
+
+  snprintf(line,MAXLINE,"      </Cells>\n    </Piece>\n"
+           "  </UnstructuredGrid>\n"
+           "  <AppendedData encoding=\"raw\">\n   _");
+  ADDLINE;
+
+#undef ADDLINE
+
+  if (str) str[len] = '\0';
+  return len;
+}
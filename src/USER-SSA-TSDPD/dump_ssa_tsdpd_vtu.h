@@ -0,0 +1,106 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef DUMP_CLASS
+
+DumpStyle(ssa_tsdpd/vtu,DumpSsaTsdpdVTU)
+
+#else
+
+#ifndef DUMP_SSA_TSDPD_VTU_H
+#define DUMP_SSA_TSDPD_VTU_H
+
+#include "dump_ssa_tsdpd.h"
+
+namespace LAMMPS_NS {
+
+// writes one VTK XML UnstructuredGrid (.vtu) file per snapshot
+// with raw appended binary data, without the VTK library
+// every proc writes its own slab of each array via MPI-IO,
+//   offsets come from a prefix sum over per-proc atom counts
+// the MPI STUBS library has no MPI-IO, a serial build writes with stdio
+
+class DumpSsaTsdpdVTU : public DumpSsaTsdpd {
+ public:
+  DumpSsaTsdpdVTU(class LAMMPS *, int, char **);
+  virtual ~DumpSsaTsdpdVTU();
+
+  virtual void write();
+
+ protected:
+  int ix,iy,iz;              // columns holding the point coordinates
+  char **fname;              // name of each field
+
+  int nblock;                // # of appended data arrays
+  int *bfield;               // column of each array, -1 for points/cells
+  int *bsize;                // bytes per atom of each array
+  MPI_Offset *boffset;       // offset of each array in appended data
+
+#ifndef MPI_STUBS
+  MPI_File mpifh;            // current file
+#endif
+  char *filecurrent;         // filename of current snapshot
+
+  int maxcbuf;               // size of cbuf
+  char *cbuf;                // per-proc bytes of one array
+
+  virtual void init_style();
+  virtual void openfile();
+
+  int header_string(char *, bigint);
+  void pack_block(int, bigint);
+  void write_at(MPI_Offset, const void *, int, int);
+  void closefile();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Dump ssa_tsdpd/vtu requires one file per snapshot
+
+The filename must contain a "*" wildcard, since a .vtu file holds a
+single snapshot.
+
+E: Dump ssa_tsdpd/vtu requires x y z fields
+
+The point coordinates of the unstructured grid are taken from the x, y
+and z fields, which must all be listed.
+
+E: Dump ssa_tsdpd/vtu does not support the element field
+
+Strings cannot be stored in the appended binary data.
+
+E: Dump ssa_tsdpd/vtu cannot write binary or compressed files
+
+The .vtu format is already binary, use a .vtu suffix.
+
+E: Dump ssa_tsdpd/vtu cannot write multiple files per snapshot
+
+All procs write to a single file via MPI-IO, so the dump_modify
+nfile and fileper keywords cannot be used.
+
+E: Dump ssa_tsdpd/vtu does not support dump_modify async
+
+All procs already write their part of each snapshot in parallel, so
+there is no single filewriter to hand the output to an i/o thread.
+
+E: Cannot open dump file %s
+
+The output file for the dump command cannot be opened.  Check that the
+path and name are correct.
+
+*/
@@ -0,0 +1,501 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+// In-situ statistics of ssa_tsdpd particles on a regular nx x ny x nz grid.
+// Every Nevery steps, Nrepeat times before each Nfreq step, the fields of
+// the atoms in the group are summed per bin. On the Nfreq step all bins
+// are reduced to proc 0 with one MPI_Reduce and the mean (and variance) of
+// each field over all atom samples of the window is written, as CSV or as
+// binary frames. The sums are reset for the next window.
+//
+// Example:
+//#   label group     style     Nevery Nrepeat Nfreq nx ny nz  file       fields
+//fix  bin   all  ssa_tsdpd/bin   10     100    1000  50 50 1  bins.csv   vx vy rho C_[*] Cd_[0] &
+//     variance yes cd concentration
+//
+// Keywords:
+//   bounds xlo xhi ylo yhi zlo zhi  = bin this part of the box (default whole box)
+//   variance yes/no                 = also write the variance of each field
+//   cd population/concentration     = units of Cd (default as in atom_style)
+//   format csv/binary               = output format (default csv)
+// A '*' in the file name is replaced by the timestep and each output goes to
+// its own file, otherwise all outputs are appended to one file.
+//
+// With atom_style ssa_tsdpd ensemble R, Cd_[q*Nssa+s] is SSA species s of
+// replica q and Cd_[*] expands to all replicas.
+//
+// CSV columns: step,ix,iy,iz,x,y,z,count,<field>[,<field>_var]...
+//   x y z is the bin center, count the mean number of atoms in the bin.
+// Binary: "SSABIN01", int32 1, int32 nx ny nz ncol, ncol x (int32 length,
+//   name), then per output int64 step, int64 nsample, double lo[3] hi[3],
+//   double[nx*ny*nz][ncol] with x the fastest varying bin index.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fix_ssa_tsdpd_bin.h"
+#include "atom.h"
+#include "domain.h"
+#include "update.h"
+#include "force.h"
+#include "comm.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+enum{VX,VY,VZ,RHO,ENERGY,CONC,DISCRETE};
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdBin::FixSsaTsdpdBin(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg), which(NULL), argindex(NULL), fieldname(NULL),
+  acc(NULL), accall(NULL), ibin(NULL), filename(NULL), fp(NULL)
+{
+  if (atom->tsdpd_flag != 1)
+    error->all(FLERR,"Fix ssa_tsdpd/bin requires atom_style ssa_tsdpd");
+
+  if (narg < 11) error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+
+  nevery = force->inumeric(FLERR,arg[3]);
+  nrepeat = force->inumeric(FLERR,arg[4]);
+  nfreq = force->inumeric(FLERR,arg[5]);
+  nx = force->inumeric(FLERR,arg[6]);
+  ny = force->inumeric(FLERR,arg[7]);
+  nz = force->inumeric(FLERR,arg[8]);
+  global_freq = nfreq;
+
+  if (nevery <= 0 || nrepeat <= 0 || nfreq <= 0)
+    error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+  if (nfreq % nevery || nrepeat*nevery > nfreq)
+    error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+  if (nx <= 0 || ny <= 0 || nz <= 0)
+    error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+  if (domain->dimension == 2 && nz != 1)
+    error->all(FLERR,"Fix ssa_tsdpd/bin nz must be 1 for 2d simulation");
+  if (domain->triclinic)
+    error->all(FLERR,"Fix ssa_tsdpd/bin does not support triclinic boxes");
+
+  bigint nbig = (bigint) nx * ny * nz;
+  if (nbig > MAXSMALLINT) error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+  nbins = nbig;
+
+  int n = strlen(arg[9]) + 1;
+  filename = new char[n];
+  strcpy(filename,arg[9]);
+  multifile = strchr(filename,'*') ? 1 : 0;
+
+  // fields, C_[*] and Cd_[*] expand to all species
+
+  nfield = 0;
+  int iarg = 10;
+  while (iarg < narg) {
+    char *a = arg[iarg];
+    if (strcmp(a,"vx") == 0) add_field(a,VX,0);
+    else if (strcmp(a,"vy") == 0) add_field(a,VY,0);
+    else if (strcmp(a,"vz") == 0) add_field(a,VZ,0);
+    else if (strcmp(a,"rho") == 0) add_field(a,RHO,0);
+    else if (strcmp(a,"e") == 0) add_field(a,ENERGY,0);
+    else if (strncmp(a,"C_[",3) == 0 || strncmp(a,"Cd_[",4) == 0) {
+      int kind = (a[1] == 'd') ? DISCRETE : CONC;
+      int nspecies = (kind == CONC) ? atom->num_tdpd_species : atom->Cd.ncol;
+      char *ptr = strchr(a,'[');
+      if (a[strlen(a)-1] != ']')
+        error->all(FLERR,"Invalid fix ssa_tsdpd/bin field");
+      char name[32];
+      if (strcmp(ptr,"[*]") == 0) {
+        for (int k = 0; k < nspecies; k++) {
+          sprintf(name,"%s%d]",kind == CONC ? "C_[" : "Cd_[",k);
+          add_field(name,kind,k);
+        }
+      } else {
+        int k = atoi(ptr+1);
+        if (k < 0 || k >= nspecies)
+          error->all(FLERR,"Fix ssa_tsdpd/bin species index is out of range");
+        add_field(a,kind,k);
+      }
+    } else break;
+    iarg++;
+  }
+  if (nfield == 0) error->all(FLERR,"Invalid fix ssa_tsdpd/bin field");
+
+  // optional keywords
+
+  boundsflag = 0;
+  varflag = 0;
+  cdconc = atom->Cd_concentration_flag;
+  binary = 0;
+
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"bounds") == 0) {
+      if (iarg+7 > narg) error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+      for (int d = 0; d < 3; d++) {
+        lo[d] = force->numeric(FLERR,arg[iarg+1+2*d]);
+        hi[d] = force->numeric(FLERR,arg[iarg+2+2*d]);
+        if (lo[d] >= hi[d])
+          error->all(FLERR,"Fix ssa_tsdpd/bin bounds are invalid");
+      }
+      boundsflag = 1;
+      iarg += 7;
+    } else if (strcmp(arg[iarg],"variance") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+      if (strcmp(arg[iarg+1],"yes") == 0) varflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) varflag = 0;
+      else error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"cd") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+      if (strcmp(arg[iarg+1],"concentration") == 0) cdconc = 1;
+      else if (strcmp(arg[iarg+1],"population") == 0) cdconc = 0;
+      else error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"format") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+      if (strcmp(arg[iarg+1],"binary") == 0) binary = 1;
+      else if (strcmp(arg[iarg+1],"csv") == 0) binary = 0;
+      else error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal fix ssa_tsdpd/bin command");
+  }
+
+  // per bin: atom count, then sum (and sum of squares) of each field
+
+  nacc = 1 + nfield*(1+varflag);
+  ncol = nacc;
+  memory->create(acc,(bigint) nbins*nacc,"ssa_tsdpd/bin:acc");
+  if (comm->me == 0)
+    memory->create(accall,(bigint) nbins*nacc,"ssa_tsdpd/bin:accall");
+  memset(acc,0,(bigint) nbins*nacc*sizeof(double));
+
+  maxatom = 0;
+
+  if (comm->me == 0 && !multifile) {
+    fp = fopen(filename,binary ? "wb" : "w");
+    if (fp == NULL) {
+      char str[256];
+      snprintf(str,256,"Cannot open fix ssa_tsdpd/bin file %s",filename);
+      error->one(FLERR,str);
+    }
+    write_file_header(fp);
+  }
+
+  irepeat = 0;
+  nvalid_last = -1;
+  nvalid = nextvalid();
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdBin::~FixSsaTsdpdBin()
+{
+  for (int m = 0; m < nfield; m++) delete [] fieldname[m];
+  memory->sfree(fieldname);
+  memory->sfree(which);
+  memory->sfree(argindex);
+  memory->destroy(acc);
+  memory->destroy(accall);
+  memory->destroy(ibin);
+  delete [] filename;
+  if (fp) fclose(fp);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdBin::setmask()
+{
+  int mask = 0;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdBin::init()
+{
+  // reset nvalid if a minimize was performed
+
+  if (nvalid < update->ntimestep) {
+    irepeat = 0;
+    nvalid = nextvalid();
+  }
+}
+
+/* ----------------------------------------------------------------------
+   sample the initial state if it is on a valid step
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdBin::setup(int vflag)
+{
+  end_of_step();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdBin::end_of_step()
+{
+  bigint ntimestep = update->ntimestep;
+  if (ntimestep < nvalid_last || ntimestep > nvalid)
+    error->all(FLERR,"Invalid timestep reset for fix ssa_tsdpd/bin");
+  if (ntimestep != nvalid) return;
+  nvalid_last = nvalid;
+
+  if (irepeat == 0) memset(acc,0,(bigint) nbins*nacc*sizeof(double));
+
+  bin_atoms();
+
+  irepeat++;
+  if (irepeat < nrepeat) {
+    nvalid += nevery;
+    return;
+  }
+
+  write_output();
+
+  irepeat = 0;
+  nvalid = ntimestep + nfreq - (nrepeat-1)*nevery;
+}
+
+/* ----------------------------------------------------------------------
+   add fields of owned atoms in group to the accumulators of their bin
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdBin::bin_atoms()
+{
+  double **x = atom->x;
+  double **v = atom->v;
+  double *rho = atom->rho;
+  double *e = atom->e;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<int> Cd = atom->Cd;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int i,m,d;
+
+  double blo[3],bhi[3],dinv[3],prd[3];
+  int nb[3] = {nx,ny,nz};
+  int *periodicity = domain->periodicity;
+  for (d = 0; d < 3; d++) {
+    blo[d] = boundsflag ? lo[d] : domain->boxlo[d];
+    bhi[d] = boundsflag ? hi[d] : domain->boxhi[d];
+    dinv[d] = nb[d] / (bhi[d] - blo[d]);
+    prd[d] = domain->prd[d];
+  }
+
+  if (nlocal > maxatom) {
+    maxatom = atom->nmax;
+    memory->destroy(ibin);
+    memory->create(ibin,maxatom,"ssa_tsdpd/bin:ibin");
+  }
+
+  // bin of each atom, atoms may have moved out of a periodic box
+  // since the last reneighboring
+
+  for (i = 0; i < nlocal; i++) {
+    ibin[i] = -1;
+    if (!(mask[i] & groupbit)) continue;
+    int index[3];
+    for (d = 0; d < 3; d++) {
+      double coord = x[i][d];
+      if (periodicity[d]) {
+        if (coord < domain->boxlo[d]) coord += prd[d];
+        else if (coord >= domain->boxhi[d]) coord -= prd[d];
+      }
+      if (coord < blo[d] || coord >= bhi[d]) break;
+      index[d] = static_cast<int> ((coord - blo[d]) * dinv[d]);
+      if (index[d] >= nb[d]) index[d] = nb[d]-1;
+    }
+    if (d < 3) continue;
+    ibin[i] = (index[2]*ny + index[1])*nx + index[0];
+  }
+
+  for (i = 0; i < nlocal; i++)
+    if (ibin[i] >= 0) acc[(bigint) ibin[i]*nacc] += 1.0;
+
+  for (m = 0; m < nfield; m++) {
+    int col = 1 + m*(1+varflag);
+    int k = argindex[m];
+    double value;
+    for (i = 0; i < nlocal; i++) {
+      if (ibin[i] < 0) continue;
+      switch (which[m]) {
+      case VX: value = v[i][0]; break;
+      case VY: value = v[i][1]; break;
+      case VZ: value = v[i][2]; break;
+      case RHO: value = rho[i]; break;
+      case ENERGY: value = e[i]; break;
+      case CONC: value = C[i][k]; break;
+      default:
+        value = Cd[i][k];
+        if (cdconc) value *= rho[i] / mass[type[i]];
+      }
+      double *a = &acc[(bigint) ibin[i]*nacc + col];
+      a[0] += value;
+      if (varflag) a[1] += value*value;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   reduce all bins with a single MPI_Reduce and write the window averages
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdBin::write_output()
+{
+  bigint total = (bigint) nbins*nacc;
+  MPI_Reduce(acc,accall,(int) total,MPI_DOUBLE,MPI_SUM,0,world);
+  if (comm->me) return;
+
+  // convert sums to mean atom count, field means and variances in place
+
+  for (int ib = 0; ib < nbins; ib++) {
+    double *a = &accall[(bigint) ib*nacc];
+    double count = a[0];
+    a[0] = count / nrepeat;
+    for (int m = 0; m < nfield; m++) {
+      double *f = &a[1 + m*(1+varflag)];
+      double mean = count > 0.0 ? f[0]/count : 0.0;
+      if (varflag) {
+        double var = 0.0;
+        if (count > 1.0) var = (f[1] - mean*f[0]) / (count-1.0);
+        f[1] = var > 0.0 ? var : 0.0;
+      }
+      f[0] = mean;
+    }
+  }
+
+  double blo[3],bhi[3];
+  for (int d = 0; d < 3; d++) {
+    blo[d] = boundsflag ? lo[d] : domain->boxlo[d];
+    bhi[d] = boundsflag ? hi[d] : domain->boxhi[d];
+  }
+
+  FILE *out = fp;
+  if (multifile) {
+    char *ptr = strchr(filename,'*');
+    char *name = new char[strlen(filename) + 16];
+    *ptr = '\0';
+    sprintf(name,"%s" BIGINT_FORMAT "%s",filename,update->ntimestep,ptr+1);
+    *ptr = '*';
+    out = fopen(name,binary ? "wb" : "w");
+    if (out == NULL) {
+      char str[256];
+      snprintf(str,256,"Cannot open fix ssa_tsdpd/bin file %s",name);
+      error->one(FLERR,str);
+    }
+    delete [] name;
+    write_file_header(out);
+  }
+
+  if (binary) {
+    int64_t step = update->ntimestep;
+    int64_t nsample = nrepeat;
+    fwrite(&step,sizeof(int64_t),1,out);
+    fwrite(&nsample,sizeof(int64_t),1,out);
+    fwrite(blo,sizeof(double),3,out);
+    fwrite(bhi,sizeof(double),3,out);
+    fwrite(accall,sizeof(double),total,out);
+  } else {
+    double dx = (bhi[0]-blo[0])/nx;
+    double dy = (bhi[1]-blo[1])/ny;
+    double dz = (bhi[2]-blo[2])/nz;
+    int ib = 0;
+    for (int iz = 0; iz < nz; iz++)
+      for (int iy = 0; iy < ny; iy++)
+        for (int ix = 0; ix < nx; ix++) {
+          double *a = &accall[(bigint) ib*nacc];
+          fprintf(out,BIGINT_FORMAT ",%d,%d,%d,%g,%g,%g",update->ntimestep,
+                  ix,iy,iz,blo[0]+(ix+0.5)*dx,blo[1]+(iy+0.5)*dy,
+                  blo[2]+(iz+0.5)*dz);
+          for (int c = 0; c < ncol; c++) fprintf(out,",%.10g",a[c]);
+          fprintf(out,"\n");
+          ib++;
+        }
+  }
+
+  if (multifile) fclose(out);
+  else fflush(out);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdBin::write_file_header(FILE *out)
+{
+  if (binary) {
+    int header[5] = {1,nx,ny,nz,ncol};
+    fwrite("SSABIN01",1,8,out);
+    fwrite(header,sizeof(int),5,out);
+    char name[64];
+    for (int c = 0; c < ncol; c++) {
+      if (c == 0) strcpy(name,"count");
+      else if (varflag && (c-1) % 2)
+        snprintf(name,64,"%s_var",fieldname[(c-1)/2]);
+      else snprintf(name,64,"%s",fieldname[(c-1)/(1+varflag)]);
+      int n = strlen(name);
+      fwrite(&n,sizeof(int),1,out);
+      fwrite(name,1,n,out);
+    }
+  } else {
+    fprintf(out,"step,ix,iy,iz,x,y,z,count");
+    for (int m = 0; m < nfield; m++) {
+      fprintf(out,",%s",fieldname[m]);
+      if (varflag) fprintf(out,",%s_var",fieldname[m]);
+    }
+    fprintf(out,"\n");
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdBin::add_field(const char *name, int kind, int index)
+{
+  which = (int *)
+    memory->srealloc(which,(nfield+1)*sizeof(int),"ssa_tsdpd/bin:which");
+  argindex = (int *)
+    memory->srealloc(argindex,(nfield+1)*sizeof(int),"ssa_tsdpd/bin:argindex");
+  fieldname = (char **)
+    memory->srealloc(fieldname,(nfield+1)*sizeof(char *),
+                     "ssa_tsdpd/bin:fieldname");
+  which[nfield] = kind;
+  argindex[nfield] = index;
+  fieldname[nfield] = new char[strlen(name)+1];
+  strcpy(fieldname[nfield],name);
+  nfield++;
+}
+
+/* ----------------------------------------------------------------------
+   next step on which end_of_step does something, as in fix ave/chunk
+------------------------------------------------------------------------- */
+
+bigint FixSsaTsdpdBin::nextvalid()
+{
+  bigint nvalid = (update->ntimestep/nfreq)*nfreq + nfreq;
+  if (nvalid-nfreq == update->ntimestep && nrepeat == 1)
+    nvalid = update->ntimestep;
+  else
+    nvalid -= (nrepeat-1)*nevery;
+  if (nvalid < update->ntimestep) nvalid += nfreq;
+  return nvalid;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixSsaTsdpdBin::memory_usage()
+{
+  double bytes = (double) nbins*nacc * sizeof(double);
+  if (accall) bytes += (double) nbins*nacc * sizeof(double);
+  bytes += maxatom * sizeof(int);
+  return bytes;
+}
@@ -0,0 +1,116 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(ssa_tsdpd/bin,FixSsaTsdpdBin)
+
+#else
+
+#ifndef LMP_FIX_SSA_TSDPD_BIN_H
+#define LMP_FIX_SSA_TSDPD_BIN_H
+
+#include <stdio.h>
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixSsaTsdpdBin : public Fix {
+ public:
+  FixSsaTsdpdBin(class LAMMPS *, int, char **);
+  ~FixSsaTsdpdBin();
+  int setmask();
+  void init();
+  void setup(int);
+  void end_of_step();
+  double memory_usage();
+
+ private:
+  int nrepeat,nfreq,irepeat;
+  bigint nvalid,nvalid_last;
+  int nx,ny,nz,nbins;
+  int boundsflag;              // 1 if bins span the given bounds, else the box
+  double lo[3],hi[3];
+  int varflag;                 // 1 to also output the variance of each field
+  int cdconc;                  // 1 to bin Cd as concentration, 0 as population
+  int binary;                  // 1 for binary, 0 for CSV output
+  int multifile;               // 1 if filename has a '*', one file per output
+
+  int nfield;
+  int *which,*argindex;        // field kind and species index
+  char **fieldname;
+
+  int nacc;                    // accumulators per bin: count, sum (, sumsq)
+  int ncol;                    // output columns per bin
+  double *acc,*accall;         // local and reduced accumulators
+  int *ibin;                   // bin of each owned atom, -1 if outside
+  int maxatom;
+
+  char *filename;
+  FILE *fp;
+
+  void add_field(const char *, int, int);
+  void bin_atoms();
+  void write_output();
+  void write_file_header(FILE *);
+  bigint nextvalid();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal fix ssa_tsdpd/bin command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: Fix ssa_tsdpd/bin requires atom_style ssa_tsdpd
+
+The C, Cd and rho fields are stored by this atom style.
+
+E: Invalid fix ssa_tsdpd/bin field
+
+Valid fields are vx, vy, vz, rho, e, C_[k], Cd_[k], C_[*] and Cd_[*].
+
+E: Fix ssa_tsdpd/bin species index is out of range
+
+C_[k] must be less than the number of tsdpd species and Cd_[k] less
+than the number of ssa species of the atom style.
+
+E: Fix ssa_tsdpd/bin does not support triclinic boxes
+
+Self-explanatory.
+
+E: Fix ssa_tsdpd/bin nz must be 1 for 2d simulation
+
+Self-explanatory.
+
+E: Fix ssa_tsdpd/bin bounds are invalid
+
+Each upper bound must be larger than the lower bound.
+
+E: Cannot open fix ssa_tsdpd/bin file %s
+
+The output file cannot be opened.  Check that the path and name are
+correct.
+
+E: Invalid timestep reset for fix ssa_tsdpd/bin
+
+Resetting the timestep has invalidated the sequence of timesteps this
+fix needs to process.
+
+*/
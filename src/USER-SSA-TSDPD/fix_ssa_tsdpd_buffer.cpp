@@ -122,9 +122,9 @@ void FixSsaTsdpdBuffer::post_integrate()
   int nlocal = atom->nlocal;
   double **x = atom->x;
   double **v = atom->v;
-  double **C = atom->C;
-  double **Q = atom->Q;
-  int **Cd = atom->Cd;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<int> Cd = atom->Cd;
+  int nssa = atom->num_ssa_species;   // stride between replicas of ctype
 
   if (igroup == atom->firstgroup) nlocal = atom->nfirst;
 
@@ -149,7 +149,8 @@ void FixSsaTsdpdBuffer::post_integrate()
           else if (ssa_case==1) {
             phi = (x[i][0]-xo)/(xL-xo);
             phi = B*phi*phi*phi;
-            Cd[i][ctype] = Cd[i][ctype] - ceil(phi*(Cd[i][ctype] - value_int));
+            for (int k = ctype; k < Cd.ncol; k += nssa)
+              Cd[i][k] = Cd[i][k] - ceil(phi*(Cd[i][k] - value_int));
           }
           else if (velocity_case==1) {
             phi = (x[i][0]-xo)/(xL-xo);
@@ -175,7 +176,8 @@ void FixSsaTsdpdBuffer::post_integrate()
           else if (ssa_case==1) {
             phi = (x[i][1]-yo)/(yL-yo);
             phi = B*phi*phi*phi;
-            Cd[i][ctype] = Cd[i][ctype] - ceil(phi*(Cd[i][ctype] - value_int));
+            for (int k = ctype; k < Cd.ncol; k += nssa)
+              Cd[i][k] = Cd[i][k] - ceil(phi*(Cd[i][k] - value_int));
           }
           else if (velocity_case==1) {
             phi = (x[i][1]-yo)/(yL-yo);
@@ -78,8 +78,8 @@ void FixSsaTsdpdChemRxnMassAction::post_force(int vflag)
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
   double **x = atom->x;
-  double **C = atom->C;
-  double **Q = atom->Q;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<double> Q = atom->Q;
   double flux;
   if (igroup == atom->firstgroup) nlocal = atom->nfirst;
 
@@ -0,0 +1,246 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+// Example: re-evaluate the admissible time step every 10 steps
+//#    label  group       style          N   Tmin   Tmax   [cfl C] [viscous C] [force C]
+//fix  dtfix  all  ssa_tsdpd/dt/reset   10   1e-8   1e-4   cfl 0.25 viscous 0.125 force 0.25
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fix_ssa_tsdpd_dt_reset.h"
+#include "atom.h"
+#include "update.h"
+#include "integrate.h"
+#include "force.h"
+#include "pair.h"
+#include "modify.h"
+#include "fix.h"
+#include "comm.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+#define BIG 1.0e20
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdDtReset::FixSsaTsdpdDtReset(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if (atom->rho_flag != 1)
+    error->all(FLERR,
+        "fix ssa_tsdpd/dt/reset command requires atom_style with density, e.g. ssa_tsdpd");
+
+  if (narg < 6) error->all(FLERR,"Illegal fix ssa_tsdpd/dt/reset command");
+
+  // set time_depend, else elapsed time accumulation can be messed up
+
+  time_depend = 1;
+  scalar_flag = 1;
+  vector_flag = 1;
+  size_vector = 3;
+  global_freq = 1;
+  extscalar = 0;
+  extvector = 0;
+
+  nevery = force->inumeric(FLERR,arg[3]);
+  if (nevery <= 0) error->all(FLERR,"Illegal fix ssa_tsdpd/dt/reset command");
+
+  minbound = maxbound = 1;
+  tmin = tmax = 0.0;
+  if (strcmp(arg[4],"NULL") == 0) minbound = 0;
+  else tmin = force->numeric(FLERR,arg[4]);
+  if (strcmp(arg[5],"NULL") == 0) maxbound = 0;
+  else tmax = force->numeric(FLERR,arg[5]);
+
+  if (minbound && tmin < 0.0) error->all(FLERR,"Illegal fix ssa_tsdpd/dt/reset command");
+  if (maxbound && tmax < 0.0) error->all(FLERR,"Illegal fix ssa_tsdpd/dt/reset command");
+  if (minbound && maxbound && tmin >= tmax)
+    error->all(FLERR,"Illegal fix ssa_tsdpd/dt/reset command");
+
+  // safety factors of Morris et al. (1997): CFL, viscous diffusion, body force
+
+  cfl_factor = 0.25;
+  visc_factor = 0.125;
+  force_factor = 0.25;
+
+  int iarg = 6;
+  while (iarg < narg) {
+    if (iarg+2 > narg) error->all(FLERR,"Illegal fix ssa_tsdpd/dt/reset command");
+    if (strcmp(arg[iarg],"cfl") == 0)
+      cfl_factor = force->numeric(FLERR,arg[iarg+1]);
+    else if (strcmp(arg[iarg],"viscous") == 0)
+      visc_factor = force->numeric(FLERR,arg[iarg+1]);
+    else if (strcmp(arg[iarg],"force") == 0)
+      force_factor = force->numeric(FLERR,arg[iarg+1]);
+    else error->all(FLERR,"Illegal fix ssa_tsdpd/dt/reset command");
+    iarg += 2;
+  }
+
+  // a factor of 0 switches the corresponding criterion off
+
+  if (cfl_factor < 0.0 || visc_factor < 0.0 || force_factor < 0.0)
+    error->all(FLERR,"Illegal fix ssa_tsdpd/dt/reset command");
+
+  soundspeed = NULL;
+  cut = viscosity = NULL;
+  dtlimit[0] = dtlimit[1] = dtlimit[2] = BIG;
+
+  laststep = update->ntimestep;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdDtReset::setmask()
+{
+  int mask = 0;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdDtReset::init()
+{
+  // set rRESPA flag
+
+  respaflag = 0;
+  if (strstr(update->integrate_style,"respa")) respaflag = 1;
+
+  // sound speed, smoothing length and viscosity come from the SDPD pair style
+
+  if (force->pair == NULL)
+    error->all(FLERR,"Fix ssa_tsdpd/dt/reset requires an ssa_tsdpd pair style");
+
+  // ssa_tsdpd/isph has no equation of state, the CFL limit then uses |v| only
+
+  int dim;
+  soundspeed = (double *) force->pair->extract("soundspeed",dim);
+  if (soundspeed != NULL && dim != 1)
+    error->all(FLERR,"Fix ssa_tsdpd/dt/reset requires an ssa_tsdpd pair style");
+  cut = (double **) force->pair->extract("cut",dim);
+  if (cut == NULL || dim != 2)
+    error->all(FLERR,"Fix ssa_tsdpd/dt/reset requires an ssa_tsdpd pair style");
+  viscosity = (double **) force->pair->extract("viscosity",dim);
+  if (viscosity == NULL || dim != 2)
+    error->all(FLERR,"Fix ssa_tsdpd/dt/reset requires an ssa_tsdpd pair style");
+
+  ftm2v = force->ftm2v;
+  dt = update->dt;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdDtReset::setup(int vflag)
+{
+  end_of_step();
+}
+
+/* ----------------------------------------------------------------------
+   dt = min over the group of
+     cfl     * h / (c0 + |v|)           (acoustic CFL)
+     viscous * h^2 rho / eta            (viscous diffusion)
+     force   * sqrt(h m / |f|)          (body force)
+   the new dt only takes effect from the next step on, so the SSA
+   diffusion (pair) and reaction (integrator) loops of a step always
+   advance over the same update->dt as the particle integration
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdDtReset::end_of_step()
+{
+  double h,cs,vsq,fsq,massinv,nu;
+  double dtmin[3],dtall[3];
+
+  double **v = atom->v;
+  double **f = atom->f;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  dtmin[0] = dtmin[1] = dtmin[2] = BIG;
+
+  for (int i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      int itype = type[i];
+      h = cut[itype][itype];
+      if (h <= 0.0) continue;
+
+      if (rmass) massinv = 1.0/rmass[i];
+      else massinv = 1.0/mass[type[i]];
+      vsq = v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2];
+      fsq = f[i][0]*f[i][0] + f[i][1]*f[i][1] + f[i][2]*f[i][2];
+
+      cs = soundspeed ? soundspeed[itype] : 0.0;
+      if (cfl_factor > 0.0 && cs + sqrt(vsq) > 0.0)
+        dtmin[0] = MIN(dtmin[0],cfl_factor*h/(cs + sqrt(vsq)));
+
+      if (visc_factor > 0.0 && rho[i] > 0.0 && viscosity[itype][itype] > 0.0) {
+        nu = viscosity[itype][itype]/rho[i];
+        dtmin[1] = MIN(dtmin[1],visc_factor*h*h/nu);
+      }
+
+      if (force_factor > 0.0 && fsq > 0.0)
+        dtmin[2] = MIN(dtmin[2],force_factor*sqrt(h/(ftm2v*sqrt(fsq)*massinv)));
+    }
+
+  MPI_Allreduce(dtmin,dtall,3,MPI_DOUBLE,MPI_MIN,world);
+
+  dtlimit[0] = dtall[0];
+  dtlimit[1] = dtall[1];
+  dtlimit[2] = dtall[2];
+
+  dt = MIN(dtall[0],MIN(dtall[1],dtall[2]));
+
+  // no criterion applied (e.g. empty group): keep the current step
+
+  if (dt >= BIG) dt = update->dt;
+
+  if (minbound) dt = MAX(dt,tmin);
+  if (maxbound) dt = MIN(dt,tmax);
+
+  // if timestep didn't change, just return
+  // else reset update->dt and other classes that depend on it
+  // rRESPA, pair style, fixes (ssa_tsdpd/verlet and ssa_tsdpd/stationary
+  // recompute dtv and dtf in their reset_dt())
+
+  if (dt == update->dt) return;
+
+  laststep = update->ntimestep;
+
+  update->update_time();
+  update->dt = dt;
+  if (respaflag) update->integrate->reset_dt();
+  if (force->pair) force->pair->reset_dt();
+  for (int i = 0; i < modify->nfix; i++) modify->fix[i]->reset_dt();
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixSsaTsdpdDtReset::compute_scalar()
+{
+  return (double) laststep;
+}
+
+/* ----------------------------------------------------------------------
+   limits of the CFL, viscous and force criteria from the last check
+------------------------------------------------------------------------- */
+
+double FixSsaTsdpdDtReset::compute_vector(int n)
+{
+  return dtlimit[n];
+}
@@ -0,0 +1,466 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+// Ensemble statistics of a multi-partition run, one realization per
+// partition. Start LAMMPS with -partition Px1 (or PxN) and the same input
+// in all partitions; the random streams of the ssa_tsdpd styles are seeded
+// per proc of the universe, so every partition draws its own numbers from
+// one seed keyword. Every Nevery steps the C/Cd fields of the atoms in the
+// group are collected on proc 0 of each partition, reduced over the procs 0
+// of the partitions and proc 0 of the universe writes their mean and sample
+// variance across the partitions. Nothing is written per partition.
+//
+// Example:
+//#   label group     style       Nevery  file      fields
+//fix  ens   all  ssa_tsdpd/ensemble  100  ens.csv   C_[0] Cd_[*] bin 50 50 1
+//
+// Keywords:
+//   bin nx ny nz                 = moments of the bin means of a partition,
+//                                  nx x ny x nz bins over the whole box
+//                                  (default moments per particle)
+//   cd population/concentration  = units of Cd (default as in atom_style)
+//
+// C_[*] expands to all tsdpd species and Cd_[*] to all SSA species of
+// replica 0; Cd_[q*Nssa+s] selects replica q of an atom_style with ensemble
+// replicas.
+//
+// Per particle the atoms of the partitions are matched by ID, which needs
+// consecutive IDs and the same atoms in all partitions. All partitions must
+// run the same timesteps, as each output is a collective of the universe.
+//
+// CSV columns: step,id,npart,<field>,<field>_var...
+//          or: step,ix,iy,iz,x,y,z,npart,<field>,<field>_var...
+//   npart is the # of partitions with the atom in the group or with atoms
+//   in the bin, x y z the bin center.
+
+#include <stdlib.h>
+#include <string.h>
+#include "fix_ssa_tsdpd_ensemble.h"
+#include "atom.h"
+#include "domain.h"
+#include "update.h"
+#include "force.h"
+#include "comm.h"
+#include "universe.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+enum{CONC,DISCRETE};
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdEnsemble::FixSsaTsdpdEnsemble(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg), which(NULL), argindex(NULL), fieldname(NULL),
+  acc(NULL), accworld(NULL), mom(NULL), momall(NULL), sendbuf(NULL),
+  recvbuf(NULL), recvcounts(NULL), displs(NULL), filename(NULL), fp(NULL)
+{
+  if (atom->tsdpd_flag != 1)
+    error->all(FLERR,"Fix ssa_tsdpd/ensemble requires atom_style ssa_tsdpd");
+
+  if (narg < 6) error->all(FLERR,"Illegal fix ssa_tsdpd/ensemble command");
+
+  nevery = force->inumeric(FLERR,arg[3]);
+  if (nevery <= 0) error->all(FLERR,"Illegal fix ssa_tsdpd/ensemble command");
+
+  int n = strlen(arg[4]) + 1;
+  filename = new char[n];
+  strcpy(filename,arg[4]);
+
+  // fields, C_[*] expands to all tsdpd species and Cd_[*] to the SSA
+  // species of replica 0, Cd_[k] may select any replica column
+
+  nfield = 0;
+  int iarg = 5;
+  while (iarg < narg) {
+    char *a = arg[iarg];
+    if (strncmp(a,"C_[",3) == 0 || strncmp(a,"Cd_[",4) == 0) {
+      int kind = (a[1] == 'd') ? DISCRETE : CONC;
+      int nspecies = (kind == CONC) ? atom->num_tdpd_species : atom->Cd.ncol;
+      char *ptr = strchr(a,'[');
+      if (a[strlen(a)-1] != ']')
+        error->all(FLERR,"Invalid fix ssa_tsdpd/ensemble field");
+      char name[32];
+      if (strcmp(ptr,"[*]") == 0) {
+        if (kind == DISCRETE) nspecies = atom->num_ssa_species;
+        for (int k = 0; k < nspecies; k++) {
+          sprintf(name,"%s%d]",kind == CONC ? "C_[" : "Cd_[",k);
+          add_field(name,kind,k);
+        }
+      } else {
+        int k = atoi(ptr+1);
+        if (k < 0 || k >= nspecies)
+          error->all(FLERR,
+                     "Fix ssa_tsdpd/ensemble species index is out of range");
+        add_field(a,kind,k);
+      }
+    } else break;
+    iarg++;
+  }
+  if (nfield == 0) error->all(FLERR,"Invalid fix ssa_tsdpd/ensemble field");
+
+  // optional keywords
+
+  binflag = 0;
+  nx = ny = nz = nbins = 0;
+  cdconc = atom->Cd_concentration_flag;
+
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"bin") == 0) {
+      if (iarg+4 > narg)
+        error->all(FLERR,"Illegal fix ssa_tsdpd/ensemble command");
+      nx = force->inumeric(FLERR,arg[iarg+1]);
+      ny = force->inumeric(FLERR,arg[iarg+2]);
+      nz = force->inumeric(FLERR,arg[iarg+3]);
+      if (nx <= 0 || ny <= 0 || nz <= 0)
+        error->all(FLERR,"Illegal fix ssa_tsdpd/ensemble command");
+      binflag = 1;
+      iarg += 4;
+    } else if (strcmp(arg[iarg],"cd") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal fix ssa_tsdpd/ensemble command");
+      if (strcmp(arg[iarg+1],"concentration") == 0) cdconc = 1;
+      else if (strcmp(arg[iarg+1],"population") == 0) cdconc = 0;
+      else error->all(FLERR,"Illegal fix ssa_tsdpd/ensemble command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal fix ssa_tsdpd/ensemble command");
+  }
+
+  nmom = 1 + 2*nfield;
+
+  if (binflag) {
+    if (domain->dimension == 2 && nz != 1)
+      error->all(FLERR,"Fix ssa_tsdpd/ensemble nz must be 1 for 2d simulation");
+    if (domain->triclinic)
+      error->all(FLERR,"Fix ssa_tsdpd/ensemble does not support triclinic boxes");
+    bigint nbig = (bigint) nx * ny * nz;
+    if (nbig*nmom > MAXSMALLINT)
+      error->all(FLERR,"Illegal fix ssa_tsdpd/ensemble command");
+    nbins = nbig;
+    memory->create(acc,nbins*(1+nfield),"ssa_tsdpd/ensemble:acc");
+    if (comm->me == 0)
+      memory->create(accworld,nbins*(1+nfield),"ssa_tsdpd/ensemble:accworld");
+  }
+
+  nrow = 0;
+  maxsend = 0;
+
+  // procs 0 of the partitions reduce the moments, rank 0 of roots is
+  // proc 0 of the universe
+
+  int color = (comm->me == 0) ? 0 : 1;
+  MPI_Comm_split(universe->uworld,color,0,&roots);
+
+  if (universe->me == 0) {
+    fp = fopen(filename,"w");
+    if (fp == NULL) {
+      char str[256];
+      snprintf(str,256,"Cannot open fix ssa_tsdpd/ensemble file %s",filename);
+      error->one(FLERR,str);
+    }
+    if (binflag) fprintf(fp,"step,ix,iy,iz,x,y,z,npart");
+    else fprintf(fp,"step,id,npart");
+    for (int m = 0; m < nfield; m++)
+      fprintf(fp,",%s,%s_var",fieldname[m],fieldname[m]);
+    fprintf(fp,"\n");
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdEnsemble::~FixSsaTsdpdEnsemble()
+{
+  for (int m = 0; m < nfield; m++) delete [] fieldname[m];
+  memory->sfree(fieldname);
+  memory->sfree(which);
+  memory->sfree(argindex);
+  memory->destroy(acc);
+  memory->destroy(accworld);
+  memory->destroy(mom);
+  memory->destroy(momall);
+  memory->destroy(sendbuf);
+  memory->destroy(recvbuf);
+  memory->destroy(recvcounts);
+  memory->destroy(displs);
+  MPI_Comm_free(&roots);
+  delete [] filename;
+  if (fp) fclose(fp);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdEnsemble::setmask()
+{
+  int mask = 0;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ----------------------------------------------------------------------
+   size the moments on proc 0 of each partition,
+     per particle all partitions must hold the same atoms
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdEnsemble::init()
+{
+  int n = nbins;
+
+  if (!binflag) {
+    if (atom->tag_enable == 0)
+      error->all(FLERR,"Fix ssa_tsdpd/ensemble requires atom IDs");
+    if (!atom->tag_consecutive())
+      error->all(FLERR,"Fix ssa_tsdpd/ensemble requires consecutive atom IDs");
+
+    bigint natoms[2] = {atom->natoms,-atom->natoms};
+    bigint natoms_all[2];
+    MPI_Allreduce(natoms,natoms_all,2,MPI_LMP_BIGINT,MPI_MAX,universe->uworld);
+    if (natoms_all[0] != -natoms_all[1])
+      error->universe_all(FLERR,"Fix ssa_tsdpd/ensemble partitions have "
+                          "different numbers of atoms");
+    if (atom->natoms*nmom > MAXSMALLINT)
+      error->all(FLERR,"Too many atoms for fix ssa_tsdpd/ensemble");
+    n = atom->natoms;
+  }
+
+  if (n != nrow) {
+    nrow = n;
+    memory->destroy(mom);
+    memory->destroy(momall);
+    memory->destroy(recvbuf);
+    memory->destroy(recvcounts);
+    memory->destroy(displs);
+    if (comm->me == 0) {
+      memory->create(mom,nrow*nmom,"ssa_tsdpd/ensemble:mom");
+      if (!binflag) {
+        memory->create(recvbuf,nrow*(1+nfield),"ssa_tsdpd/ensemble:recvbuf");
+        memory->create(recvcounts,comm->nprocs,
+                       "ssa_tsdpd/ensemble:recvcounts");
+        memory->create(displs,comm->nprocs,"ssa_tsdpd/ensemble:displs");
+      }
+    }
+    if (universe->me == 0)
+      memory->create(momall,nrow*nmom,"ssa_tsdpd/ensemble:momall");
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdEnsemble::end_of_step()
+{
+  if (comm->me == 0) memset(mom,0,(bigint) nrow*nmom*sizeof(double));
+
+  if (binflag) moments_bin();
+  else moments_atom();
+
+  if (comm->me == 0)
+    MPI_Reduce(mom,momall,nrow*nmom,MPI_DOUBLE,MPI_SUM,0,roots);
+
+  if (universe->me == 0) write_output();
+}
+
+/* ----------------------------------------------------------------------
+   value of field m of owned atom i
+------------------------------------------------------------------------- */
+
+double FixSsaTsdpdEnsemble::field_value(int m, int i)
+{
+  int k = argindex[m];
+  if (which[m] == CONC) return atom->C[i][k];
+  double value = atom->Cd[i][k];
+  if (cdconc) value *= atom->rho[i] / atom->mass[atom->type[i]];
+  return value;
+}
+
+/* ----------------------------------------------------------------------
+   tag and values of the owned atoms in the group gathered on proc 0 of
+     the partition, which fills row tag-1 with 1, value and value^2
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdEnsemble::moments_atom()
+{
+  tagint *tag = atom->tag;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int nsend = 1 + nfield;
+  int i,m;
+
+  if (nlocal > maxsend) {
+    maxsend = atom->nmax;
+    memory->destroy(sendbuf);
+    memory->create(sendbuf,maxsend*nsend,"ssa_tsdpd/ensemble:sendbuf");
+  }
+
+  int n = 0;
+  for (i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit)) continue;
+    sendbuf[n++] = tag[i];
+    for (m = 0; m < nfield; m++) sendbuf[n++] = field_value(m,i);
+  }
+
+  MPI_Gather(&n,1,MPI_INT,recvcounts,1,MPI_INT,0,world);
+  int ntotal = 0;
+  if (comm->me == 0)
+    for (int iproc = 0; iproc < comm->nprocs; iproc++) {
+      displs[iproc] = ntotal;
+      ntotal += recvcounts[iproc];
+    }
+  MPI_Gatherv(sendbuf,n,MPI_DOUBLE,recvbuf,recvcounts,displs,MPI_DOUBLE,
+              0,world);
+  if (comm->me) return;
+
+  for (int j = 0; j < ntotal; j += nsend) {
+    tagint itag = static_cast<tagint> (recvbuf[j]);
+    double *row = &mom[(bigint) (itag-1)*nmom];
+    row[0] = 1.0;
+    for (m = 0; m < nfield; m++) {
+      double value = recvbuf[j+1+m];
+      row[1+2*m] = value;
+      row[2+2*m] = value*value;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   bin means of the partition on its proc 0, which alone fills the rows
+     of non-empty bins with 1, mean and mean^2
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdEnsemble::moments_bin()
+{
+  double **x = atom->x;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int nacc = 1 + nfield;
+  int i,m,d;
+
+  double dinv[3],prd[3];
+  int nb[3] = {nx,ny,nz};
+  int *periodicity = domain->periodicity;
+  double *boxlo = domain->boxlo;
+  double *boxhi = domain->boxhi;
+  for (d = 0; d < 3; d++) {
+    prd[d] = domain->prd[d];
+    dinv[d] = nb[d] / prd[d];
+  }
+
+  memset(acc,0,(bigint) nbins*nacc*sizeof(double));
+
+  for (i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit)) continue;
+    int index[3];
+    for (d = 0; d < 3; d++) {
+      double coord = x[i][d];
+      if (periodicity[d]) {
+        if (coord < boxlo[d]) coord += prd[d];
+        else if (coord >= boxhi[d]) coord -= prd[d];
+      }
+      if (coord < boxlo[d] || coord >= boxhi[d]) break;
+      index[d] = static_cast<int> ((coord - boxlo[d]) * dinv[d]);
+      if (index[d] >= nb[d]) index[d] = nb[d]-1;
+    }
+    if (d < 3) continue;
+    double *a = &acc[(bigint) ((index[2]*ny + index[1])*nx + index[0])*nacc];
+    a[0] += 1.0;
+    for (m = 0; m < nfield; m++) a[1+m] += field_value(m,i);
+  }
+
+  MPI_Reduce(acc,accworld,nbins*nacc,MPI_DOUBLE,MPI_SUM,0,world);
+  if (comm->me) return;
+
+  for (int ib = 0; ib < nbins; ib++) {
+    double *a = &accworld[(bigint) ib*nacc];
+    if (a[0] == 0.0) continue;
+    double *row = &mom[(bigint) ib*nmom];
+    row[0] = 1.0;
+    for (m = 0; m < nfield; m++) {
+      double mean = a[1+m] / a[0];
+      row[1+2*m] = mean;
+      row[2+2*m] = mean*mean;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   mean and sample variance across partitions, on proc 0 of the universe
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdEnsemble::write_output()
+{
+  double *blo = domain->boxlo;
+  double dx = domain->prd[0]/nx;
+  double dy = domain->prd[1]/ny;
+  double dz = domain->prd[2]/nz;
+
+  for (int r = 0; r < nrow; r++) {
+    double *row = &momall[(bigint) r*nmom];
+    double npart = row[0];
+    if (npart == 0.0) continue;
+
+    if (binflag) {
+      int ix = r % nx;
+      int iy = (r / nx) % ny;
+      int iz = r / (nx*ny);
+      fprintf(fp,BIGINT_FORMAT ",%d,%d,%d,%g,%g,%g,%d",update->ntimestep,
+              ix,iy,iz,blo[0]+(ix+0.5)*dx,blo[1]+(iy+0.5)*dy,
+              blo[2]+(iz+0.5)*dz,static_cast<int> (npart));
+    } else
+      fprintf(fp,BIGINT_FORMAT ",%d,%d",update->ntimestep,r+1,
+              static_cast<int> (npart));
+
+    for (int m = 0; m < nfield; m++) {
+      double sum = row[1+2*m];
+      double mean = sum / npart;
+      double var = 0.0;
+      if (npart > 1.0) var = (row[2+2*m] - mean*sum) / (npart-1.0);
+      fprintf(fp,",%.10g,%.10g",mean,var > 0.0 ? var : 0.0);
+    }
+    fprintf(fp,"\n");
+  }
+
+  fflush(fp);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdEnsemble::add_field(const char *name, int kind, int index)
+{
+  which = (int *)
+    memory->srealloc(which,(nfield+1)*sizeof(int),"ssa_tsdpd/ensemble:which");
+  argindex = (int *)
+    memory->srealloc(argindex,(nfield+1)*sizeof(int),
+                     "ssa_tsdpd/ensemble:argindex");
+  fieldname = (char **)
+    memory->srealloc(fieldname,(nfield+1)*sizeof(char *),
+                     "ssa_tsdpd/ensemble:fieldname");
+  which[nfield] = kind;
+  argindex[nfield] = index;
+  fieldname[nfield] = new char[strlen(name)+1];
+  strcpy(fieldname[nfield],name);
+  nfield++;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixSsaTsdpdEnsemble::memory_usage()
+{
+  double bytes = 0.0;
+  if (mom) bytes += (double) nrow*nmom * sizeof(double);
+  if (momall) bytes += (double) nrow*nmom * sizeof(double);
+  if (binflag) bytes += (double) nbins*(1+nfield) * sizeof(double);
+  if (accworld) bytes += (double) nbins*(1+nfield) * sizeof(double);
+  bytes += (double) maxsend*(1+nfield) * sizeof(double);
+  if (recvbuf) bytes += (double) nrow*(1+nfield) * sizeof(double);
+  return bytes;
+}
@@ -0,0 +1,123 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(ssa_tsdpd/ensemble,FixSsaTsdpdEnsemble)
+
+#else
+
+#ifndef LMP_FIX_SSA_TSDPD_ENSEMBLE_H
+#define LMP_FIX_SSA_TSDPD_ENSEMBLE_H
+
+#include <stdio.h>
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixSsaTsdpdEnsemble : public Fix {
+ public:
+  FixSsaTsdpdEnsemble(class LAMMPS *, int, char **);
+  ~FixSsaTsdpdEnsemble();
+  int setmask();
+  void init();
+  void end_of_step();
+  double memory_usage();
+
+ private:
+  int binflag;                 // 1 to reduce bin means, 0 per particle
+  int nx,ny,nz,nbins;
+  int cdconc;                  // 1 to reduce Cd as concentration
+  int nrow;                    // output rows, # of bins or of atoms
+
+  int nfield;
+  int *which,*argindex;        // field kind and species index
+  char **fieldname;
+
+  int nmom;                    // moments per row: # of partitions, sum, sumsq
+  double *acc,*accworld;       // bin sums of this proc and of the partition
+  double *mom,*momall;         // moments of this partition and reduced ones
+  MPI_Comm roots;              // procs 0 of all partitions
+
+  int maxsend;                 // per particle: tag and fields of owned atoms
+  double *sendbuf,*recvbuf;    // gathered on proc 0 of the partition
+  int *recvcounts,*displs;
+
+  char *filename;
+  FILE *fp;
+
+  void add_field(const char *, int, int);
+  double field_value(int, int);
+  void moments_atom();
+  void moments_bin();
+  void write_output();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal fix ssa_tsdpd/ensemble command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: Fix ssa_tsdpd/ensemble requires atom_style ssa_tsdpd
+
+The C and Cd fields are stored by this atom style.
+
+E: Invalid fix ssa_tsdpd/ensemble field
+
+Valid fields are C_[k], Cd_[k], C_[*] and Cd_[*].
+
+E: Fix ssa_tsdpd/ensemble species index is out of range
+
+C_[k] must be less than the number of tsdpd species and Cd_[k] less
+than the number of SSA species times the number of replicas.  Cd_[*]
+selects the SSA species of replica 0.
+
+E: Fix ssa_tsdpd/ensemble does not support triclinic boxes
+
+Self-explanatory.
+
+E: Fix ssa_tsdpd/ensemble nz must be 1 for 2d simulation
+
+Self-explanatory.
+
+E: Cannot open fix ssa_tsdpd/ensemble file %s
+
+The output file cannot be opened.  Check that the path and name are
+correct.
+
+E: Fix ssa_tsdpd/ensemble requires atom IDs
+
+Per particle moments match the atoms of the partitions by their ID.
+
+E: Fix ssa_tsdpd/ensemble requires consecutive atom IDs
+
+Per particle moments are kept in arrays indexed by atom ID.
+
+E: Fix ssa_tsdpd/ensemble partitions have different numbers of atoms
+
+Per particle moments need the same atoms in all partitions.  Use the
+bin keyword to reduce bin means instead.
+
+E: Too many atoms for fix ssa_tsdpd/ensemble
+
+The moments of all atoms are gathered and reduced with single MPI
+calls, which are limited to 2^31 values.  Use the bin keyword instead.
+
+*/
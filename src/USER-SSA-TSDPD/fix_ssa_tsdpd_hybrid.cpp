@@ -0,0 +1,276 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+// Adaptive hybrid representation of a chemical species. Each pair (c,s)
+// names a tDPD species c and an SSA species s of the same chemical. Every
+// Nevery steps each particle of the group, a voxel of the SSA, holds the
+// species either as the molecules Cd[s] (discrete) or as the continuous
+// C[c] (continuous), decided by its copy number
+//   n = Cd[s] + C[c]*mass*concentration_conversion
+// with hysteresis: a discrete particle turns continuous above Nhigh, a
+// continuous one discrete below Nlow. A continuous particle gets all of n
+// in C[c]; a discrete one gets floor(n) molecules and keeps the fraction
+// in C[c], so the amount of each particle is conserved exactly. Between
+// switches Cd jumping into continuous particles and C diffusing into
+// discrete ones are picked up by the next switch. For an unbiased hybrid
+// the SSA diffusion of s and the tDPD diffusion of c need the same
+// diffusivity, and the reactions of the chemical must be given for both.
+//
+// Example:
+//#   label group    style     Nevery Nlow Nhigh  c s [c s ...]
+//fix  hyb   all  ssa_tsdpd/hybrid  10    50   200   0 0  1 1
+//
+// Per-atom array: mode of each pair, 1 discrete, 0 continuous.
+// Global vector: # of discrete particles of each pair.
+
+#include <math.h>
+#include <string.h>
+#include "fix_ssa_tsdpd_hybrid.h"
+#include "atom.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+#define UNSET -1.0
+#define CONTINUOUS 0.0
+#define DISCRETE 1.0
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdHybrid::FixSsaTsdpdHybrid(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg), cindex(NULL), sindex(NULL), mode(NULL),
+  ndiscrete(NULL)
+{
+  if (atom->tsdpd_flag != 1)
+    error->all(FLERR,"Fix ssa_tsdpd/hybrid requires atom_style ssa_tsdpd");
+  if (atom->num_ssa_replicas != 1)
+    error->all(FLERR,"Fix ssa_tsdpd/hybrid requires ensemble 1");
+
+  if (narg < 8 || (narg-6) % 2)
+    error->all(FLERR,"Illegal fix ssa_tsdpd/hybrid command");
+
+  nevery = force->inumeric(FLERR,arg[3]);
+  nlow = force->numeric(FLERR,arg[4]);
+  nhigh = force->numeric(FLERR,arg[5]);
+  if (nevery <= 0) error->all(FLERR,"Illegal fix ssa_tsdpd/hybrid command");
+  if (nlow < 0.0 || nlow > nhigh || nhigh >= MAXSMALLINT)
+    error->all(FLERR,"Fix ssa_tsdpd/hybrid thresholds are invalid");
+
+  npair = (narg-6) / 2;
+  cindex = new int[npair];
+  sindex = new int[npair];
+  for (int p = 0; p < npair; p++) {
+    cindex[p] = force->inumeric(FLERR,arg[6+2*p]);
+    sindex[p] = force->inumeric(FLERR,arg[7+2*p]);
+    if (cindex[p] < 0 || cindex[p] >= atom->num_tdpd_species ||
+        sindex[p] < 0 || sindex[p] >= atom->num_ssa_species)
+      error->all(FLERR,"Fix ssa_tsdpd/hybrid species index is out of range");
+  }
+
+  global_freq = nevery;
+  vector_flag = 1;
+  size_vector = npair;
+  extvector = 1;
+  peratom_flag = 1;
+  size_peratom_cols = npair;
+  peratom_freq = nevery;
+  restart_peratom = 1;
+  create_attribute = 1;
+
+  ndiscrete = new double[npair];
+  for (int p = 0; p < npair; p++) ndiscrete[p] = 0.0;
+
+  // the mode of a particle migrates with it, the hysteresis needs it
+
+  grow_arrays(atom->nmax);
+  atom->add_callback(0);
+  atom->add_callback(1);
+  for (int i = 0; i < atom->nmax; i++) set_arrays(i);
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdHybrid::~FixSsaTsdpdHybrid()
+{
+  atom->delete_callback(id,0);
+  atom->delete_callback(id,1);
+  memory->destroy(mode);
+  delete [] cindex;
+  delete [] sindex;
+  delete [] ndiscrete;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdHybrid::setmask()
+{
+  int mask = 0;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ----------------------------------------------------------------------
+   particles without a mode get one before the run starts
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdHybrid::setup(int vflag)
+{
+  repartition();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdHybrid::end_of_step()
+{
+  repartition();
+}
+
+/* ----------------------------------------------------------------------
+   switch the representation of each pair of the owned atoms in the group
+   ghosts get the new C and Cd with the next forward communication
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdHybrid::repartition()
+{
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<int> Cd = atom->Cd;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  double conversion = atom->concentration_conversion;
+
+  double *count = new double[npair];
+  for (int p = 0; p < npair; p++) count[p] = 0.0;
+
+  for (int i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit)) continue;
+    double molecules = mass[type[i]] * conversion;
+    for (int p = 0; p < npair; p++) {
+      int c = cindex[p];
+      int s = sindex[p];
+      double n = Cd[i][s] + C[i][c]*molecules;
+
+      if (mode[i][p] == CONTINUOUS) {
+        if (n < nlow) mode[i][p] = DISCRETE;
+      } else if (n > nhigh) mode[i][p] = CONTINUOUS;
+      else mode[i][p] = DISCRETE;
+
+      if (mode[i][p] == CONTINUOUS) {
+        Cd[i][s] = 0;
+        C[i][c] = n/molecules;
+      } else {
+        double whole = n > 0.0 ? floor(n) : 0.0;
+        Cd[i][s] = static_cast<int> (whole);
+        C[i][c] = (n - whole)/molecules;
+        count[p] += 1.0;
+      }
+    }
+  }
+
+  MPI_Allreduce(count,ndiscrete,npair,MPI_DOUBLE,MPI_SUM,world);
+  delete [] count;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixSsaTsdpdHybrid::compute_vector(int n)
+{
+  return ndiscrete[n];
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdHybrid::grow_arrays(int nmax)
+{
+  memory->grow(mode,nmax,npair,"ssa_tsdpd/hybrid:mode");
+  array_atom = mode;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdHybrid::copy_arrays(int i, int j, int delflag)
+{
+  for (int p = 0; p < npair; p++) mode[j][p] = mode[i][p];
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdHybrid::set_arrays(int i)
+{
+  for (int p = 0; p < npair; p++) mode[i][p] = UNSET;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdHybrid::pack_exchange(int i, double *buf)
+{
+  for (int p = 0; p < npair; p++) buf[p] = mode[i][p];
+  return npair;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdHybrid::unpack_exchange(int nlocal, double *buf)
+{
+  for (int p = 0; p < npair; p++) mode[nlocal][p] = buf[p];
+  return npair;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdHybrid::pack_restart(int i, double *buf)
+{
+  buf[0] = npair + 1;
+  for (int p = 0; p < npair; p++) buf[p+1] = mode[i][p];
+  return npair + 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdHybrid::unpack_restart(int nlocal, int nth)
+{
+  double **extra = atom->extra;
+
+  // skip to Nth set of extra values
+
+  int m = 0;
+  for (int i = 0; i < nth; i++) m += static_cast<int> (extra[nlocal][m]);
+  m++;
+
+  for (int p = 0; p < npair; p++) mode[nlocal][p] = extra[nlocal][m++];
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdHybrid::size_restart(int nlocal)
+{
+  return npair + 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdHybrid::maxsize_restart()
+{
+  return npair + 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixSsaTsdpdHybrid::memory_usage()
+{
+  return (double) atom->nmax * npair * sizeof(double);
+}
@@ -0,0 +1,83 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(ssa_tsdpd/isph/projection,FixSsaTsdpdIsphProjection)
+
+#else
+
+#ifndef LMP_FIX_SSA_TSDPD_ISPH_PROJECTION_H
+#define LMP_FIX_SSA_TSDPD_ISPH_PROJECTION_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixSsaTsdpdIsphProjection : public Fix {
+ public:
+  FixSsaTsdpdIsphProjection(class LAMMPS *, int, char **);
+  ~FixSsaTsdpdIsphProjection();
+  int setmask();
+  void init();
+  void init_list(int, class NeighList *);
+  void setup(int);
+  void post_force(int);
+  double compute_vector(int);
+
+  int pack_forward_comm(int, int *, double *, int, int *);
+  void unpack_forward_comm(int, int, double *);
+  void grow_arrays(int);
+  void copy_arrays(int, int, int);
+  void set_arrays(int);
+  int pack_exchange(int, double *);
+  int unpack_exchange(int, double *);
+  double memory_usage();
+
+ private:
+  class NeighList *list;
+  double **cut;                 // per-pair smoothing length of the pair style
+  double tolerance;
+  int maxiter,solver;           // solver = CG or BICGSTAB
+  int niter;                    // iterations of the last solve
+  double residual;              // relative residual of the last solve
+
+  double *pressure;             // per-atom pressure, kept as warm start
+  int maxpressure;              // allocated length of pressure
+  double **vstar;               // predicted end-of-step velocity
+  double *rhs,*res,*rtilde,*zvec,*dir,*adir,*svec,*tvec,*diaginv;
+  int nmax;
+
+  double *aij;                  // Laplacian weights, one per neighbor pair
+  int naij;
+
+  int pinned;                   // local index of the atom with p = 0, or -1
+  double pindiag;               // diagonal of its row
+
+  double *commvec;              // vector or 3-column array currently
+  double **commarray;           // sent by forward comm, see commcols
+  int commcols;
+
+  void grow_work();
+  void build_operator();
+  void matvec(double *, double *);
+  double dot(double *, double *);
+  int solve_cg();
+  int solve_bicgstab();
+  void forward(double *);
+};
+
+}
+
+#endif
+#endif
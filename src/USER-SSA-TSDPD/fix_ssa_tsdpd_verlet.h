@@ -28,12 +28,15 @@ namespace LAMMPS_NS {
 class FixSsaTsdpd : public Fix {
  public:
   FixSsaTsdpd(class LAMMPS *, int, char **);
+  virtual ~FixSsaTsdpd();
   int setmask();
   virtual void init();
   virtual void setup_pre_force(int);
   virtual void initial_integrate(int);
   virtual void final_integrate();
   void reset_dt();
+  void write_restart(FILE *);
+  void restart(char *);
 
  private:
   class NeighList *list;
@@ -44,6 +47,12 @@ class FixSsaTsdpd : public Fix {
   class Pair *pair;
   unsigned int seed;
   class RanMars *random;
+  class RanMars **rep_random;   // stream of each SSA replica, [0] = random
+  int nrep_random;
+  class FixSsaTsdpdSsaRxnMassAction **rxnfix;   // reaction fix of each index
+  char *rng_restart;    // restart record of the streams until init()
+
+  int rng_streams(class RanMars **);
 };
 
 }
@@ -0,0 +1,762 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+ 
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pair_ssa_tsdpd_isph.h"
+#include "atom.h"
+#include "force.h"
+#include "comm.h"
+#include "universe.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "modify.h"
+#include "fix.h"
+#include "memory.h"
+#include "error.h"
+#include "domain.h"
+#include "update.h"
+#include "random_mars.h"
+#include "ssa_tsdpd_rng.h"
+#include "timer.h"
+#include "ssa_tsdpd_stats.h"
+#include "ssa_tsdpd_scratch.h"
+#include "ssa_tsdpd_dfsp.h"
+#include <unistd.h>
+#include <time.h>
+
+#define SEED_DEFAULT 4928459
+#define MAXSEED 900000000
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+PairSsaTsdpdIsph::PairSsaTsdpdIsph(LAMMPS *lmp) : Pair(lmp)
+{
+  restartinfo = 0;
+  first = 1;
+  shardlow_flag = 0;
+  random = NULL;
+  rep_random = NULL;
+  dfsp_flag = 0;
+  nrep_random = 0;
+  scratch = new SsaTsdpdScratch(lmp);
+}
+
+/* ---------------------------------------------------------------------- */
+
+PairSsaTsdpdIsph::~PairSsaTsdpdIsph() {
+  if (allocated) {
+    memory->destroy(setflag);
+    memory->destroy(cutsq);
+    memory->destroy(cut);
+    memory->destroy(rho0);
+    memory->destroy(viscosity);
+    memory->destroy(kappa);
+    memory->destroy(cutc);
+  }
+    SsaTsdpdRng::destroy_replicas(rep_random,nrep_random);
+    if (random) delete random;
+    delete scratch;
+}
+
+
+void PairSsaTsdpdIsph::compute(int eflag, int vflag) {
+  int i, j, ii, jj, inum, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
+  
+  //printf("PairSsaTsdpdIsph::compute() inum=%i\n",inum);
+
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double vxtmp, vytmp, vztmp, imass, jmass, fvisc, h, ih, ihsq, velx, vely, velz;
+  double rsq, wfd = 0.0, wf, delVdotDelR, deltaE;
+
+  if (eflag || vflag)
+    ev_setup(eflag, vflag);
+  else
+    evflag = vflag_fdotr = 0;
+
+
+  double **v = atom->vest;
+  double **x = atom->x;
+  double **f = atom->f;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  double *de = atom->de;
+  double *e = atom->e;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<double> Q = atom->Q;
+  SpeciesArray<int> Cd = atom->Cd;
+  SpeciesArray<int> Qd = atom->Qd;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+  int newton_pair = force->newton_pair;
+  int dimension = domain->dimension;
+  double kBoltzmann = force->boltz;
+  double dtinv = 1.0 / update->dt;
+  int nmax = atom->nmax;
+
+
+  if (first) {
+    for (i = 1; i <= atom->ntypes; i++) {
+      for (j = 1; i <= atom->ntypes; i++) {
+        if (cutsq[i][j] > 1.e-32) {
+          if (!setflag[i][i] || !setflag[j][j]) {
+            if (comm->me == 0) {
+              printf(
+                  "SsaTsdpd particle types %d and %d interact with cutoff=%g, but not all of their single particle properties are set.\n",
+                  i, j, sqrt(cutsq[i][j]));
+            }
+          }
+        }
+      }
+    }
+    first = 0;
+  }
+
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  timer->sub_start(Timer::SDPD_FORCE);
+
+
+  // per-step temporaries come from the scratch block
+
+  scratch->reset();
+  bigint maxentry = 0;
+  if (atom->num_ssa_species > 0)
+    for (ii = 0; ii < inum; ii++) maxentry += 2*numneigh[ilist[ii]];
+  SsaTsdpdIndexSets dfsp_D_matrix_index;   // non-zero columns of each row
+  dfsp_D_matrix_index.init(scratch,nmax,maxentry);
+  double *dfsp_D = scratch->get<double>(maxentry);        // value of each entry
+  double **dfsp_kappa = scratch->get<double *>(maxentry); // SSA kappas of an entry
+  int *dfsp_back = scratch->get<int>(maxentry);           // entry (j,i) of (i,j)
+  double *dfsp_D_diag = scratch->get<double>(nmax);
+  double *dfsp_a_i = scratch->zero<double>(nmax);         // ghosts stay 0
+  
+  
+
+ // loop over neighbors of my atoms
+
+  // species transport is fused into the force loop, with timer full it
+  // runs in a second pass so TDPD_TRANSPORT is measured apart from SDPD_FORCE
+
+  int species = (atom->num_tdpd_species > 0 || atom->num_ssa_species > 0);
+  int npass = (species && timer->has_full()) ? 2 : 1;
+
+  for (int pass = 0; pass < npass; pass++) {
+    int forces = (pass == 0);
+    int transport = species && (pass == npass-1);
+    if (!forces) timer->sub_start(Timer::TDPD_TRANSPORT);
+    //printf("\tStarting i loop\n");
+    for (ii = 0; ii < inum; ii++) {
+
+      i = ilist[ii]; 
+
+      //printf("\t\ti=%i\n",i);
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
+      vxtmp = v[i][0];
+      vytmp = v[i][1];
+      vztmp = v[i][2];
+      itype = type[i];
+      jlist = firstneigh[i];
+      jnum = numneigh[i];
+      imass = mass[itype];
+
+
+      // no equation of state: the pressure force is added by the
+      // projection in fix ssa_tsdpd/isph/projection
+
+       for (jj = 0; jj < jnum; jj++) {
+        j = jlist[jj];
+        j &= NEIGHMASK;
+  
+        delx = xtmp - x[j][0];
+        dely = ytmp - x[j][1];
+        delz = ztmp - x[j][2];
+        rsq = delx * delx + dely * dely + delz * delz;
+        jtype = type[j];
+        jmass = mass[jtype];
+
+        if (rsq >= cutsq[itype][jtype]) continue;
+        double r = sqrt(rsq);
+
+        if (forces) {
+          h = cut[itype][jtype];     // for Lucy kernel
+
+          if (domain->dimension == 3) { // Kernel, 3d (1/r * dwdr) 
+            //Lucy kernel (3D)
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
+            wf = h - sqrt(rsq);
+            wf  = 2.088908628081126 * wf * wf * wf * ihsq * ihsq * (h + 3.*r);
+
+          } else if (domain->dimension == 2){ // Kernel, 2d (1/r * dwdr)
+            /*
+            //Lucy kernel (2D)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq;
+            wf = h - sqrt(rsq);
+            wf  = 1.591549430918954 * wf * wf * wf * ihsq * ihsq * (h + 3.*r);
+            */
+
+            /*
+            // Wendland C2 (2d)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wf  = 2.*h - r;
+            wfd = -0.348151438013521 * ihsq * ihsq * ihsq * ih * wf * wf * wf;
+            wf  = 0.034815143801352 * ihsq * ihsq* ihsq * ih * wf * wf* wf * wf * (2.*r + h); 
+            */
+
+            /*
+            // Wendland C4 (2d)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq); 
+            wf  = 2.*h - r;
+            wfd = -0.007460387957433 * 7. * ihsq * ihsq * ihsq * ihsq * ihsq * wf * wf * wf * wf * wf *(2.*h + 5.*r);
+            wf  = 0.011190581936149 * ihsq * ihsq* ihsq * ihsq * ihsq * wf * wf* wf * wf * wf * wf * ( (35./12.)*rsq + 3.*r*h + h*h); 
+            */
+
+            ///*
+            // Wendland C6 (2d)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wf  = 2.*h - r;
+            wfd = 0.886720397226274 * ihsq*ihsq*ihsq*ihsq*ihsq*ihsq*ih* ( -5.5*h*h*h*h*h*h*h*h*h + 16.5*h*h*h*h*h*h*h*rsq -43.3125*h*h*h*h*h*rsq*rsq + 57.75*h*h*h*h*rsq*rsq*r -36.0938*h*h*h*rsq*rsq*rsq +12.375*h*h*rsq*rsq*rsq*r -2.25586*h*rsq*rsq*rsq*rsq + 0.171875*rsq*rsq*rsq*rsq*r );
+            wf  = 2.*h - r;
+            wf  = 0.003463751551665 * ihsq * ihsq* ihsq * ihsq * ihsq * ihsq * ih * wf * wf* wf * wf * wf * wf * wf * wf * (h*h*h + 4.*r*h*h + 6.25*rsq*h + 4.*rsq*r);
+            //*/
+
+            /*
+            // quintic Wendland (2d)
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq); 
+            wf  = 2.*h - r;
+            wfd = - 0.0348151438013521 * ihsq * 10.* r * (2.*h-r) * (2.*h-r) * (2.*h-r) *ihsq*ihsq*ih/(r + 1e-12);
+            wf  = 2.-r*ih;
+            wf  = 0.0348151438013521 * ihsq * wf*wf*wf*wf * (1.+2.*r*ih);
+            */
+
+          } else if (domain->dimension == 1){ // Kernel, 1d (1/r * dwdr)
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wfd = -15.0 * wfd * wfd * ihsq * ihsq * ih; //Lucy (1d)
+            wf  = 1.-r*ih;
+            wf  = (5./4.) * ih * (wf*wf*wf) * (1.+3.*r*ih);
+          }
+
+
+          velx=vxtmp - v[j][0];
+          vely=vytmp - v[j][1];
+          velz=vztmp - v[j][2];
+
+
+          // dot product of velocity delta and distance vector
+          delVdotDelR = delx * velx + dely * vely + delz * velz;
+
+
+          // Espanol Viscosity (Espanol, 2003)
+          fvisc = wfd / (rho[i] * rho[j]);
+          fvisc *= imass * jmass ; 
+
+        
+          // no pressure contribution in the pair force
+          fpair = 0.0;
+
+        
+          // viscous and random forces, integrated pairwise by fix
+          // ssa_tsdpd/shardlow instead when that fix is defined
+          double f_random[3] = {0};
+          if (shardlow_flag) {
+            fvisc = 0.0;
+          } else {
+            // random force calculation
+            // independent increments of a Wiener process matrix
+            double wiener[3][3] = {0};
+            for (int l=0; l<dimension; l++){
+                for (int m=0; m<dimension; m++){
+                    wiener[l][m] = random->gaussian();
+                }
+            }
+
+
+            // symmetric part
+            wiener[0][1] = wiener[1][0] = (wiener[0][1] + wiener[1][0]) / 2.;
+            wiener[0][2] = wiener[2][0] = (wiener[0][2] + wiener[2][0]) / 2.;
+            wiener[1][2] = wiener[2][1] = (wiener[1][2] + wiener[2][1]) / 2.;
+
+            // traceless part
+            double trace_over_dim = (wiener[0][0] + wiener[1][1] + wiener[2][2]) / dimension;
+            wiener[0][0] -= trace_over_dim;
+            wiener[1][1] -= trace_over_dim;
+            wiener[2][2] -= trace_over_dim;
+
+            double prefactor = sqrt (-4. * kBoltzmann* e[i] * fvisc * dtinv) / (r+0.01*h);
+            for (int l=0; l<dimension; ++l)  f_random[l] = prefactor * (wiener[l][0]*delx + wiener[l][1]*dely + wiener[l][2]*delz);
+
+
+            // final viscous force
+            fvisc *= (5.0/3.0)*viscosity[itype][jtype];
+
+            if (delVdotDelR > 0.0) {
+              fvisc = 0.0;
+            }
+          }
+
+          //Momentum evaluation
+          // final forces (Vásquez-Quesada et. al., 2009, JCP), pressure from the projection
+          f[i][0] += fvisc * (velx + delVdotDelR * delx / (rsq+0.01*h*h) ) + f_random[0];
+          f[i][1] += fvisc * (vely + delVdotDelR * dely / (rsq+0.01*h*h) ) + f_random[1];
+          f[i][2] += fvisc * (velz + delVdotDelR * delz / (rsq+0.01*h*h) ) + f_random[2];
+
+          // density is held at rho0 (incompressible), no drho evaluation
+
+          //Energy evaluation
+          deltaE = -0.5 * fvisc * (velx*velx + vely*vely + velz*velz);
+          de[i] += deltaE;
+
+
+          // Reactions in neighbors (j particles)
+          if (newton_pair || j < nlocal) {
+            //Momentum evaluation
+            f[j][0] -= fvisc * (velx + delVdotDelR * delx / (rsq + 0.01*h*h) ) + f_random[0];
+            f[j][1] -= fvisc * (vely + delVdotDelR * dely / (rsq + 0.01*h*h) ) + f_random[1];
+            f[j][2] -= fvisc * (velz + delVdotDelR * delz / (rsq + 0.01*h*h) ) + f_random[2];
+
+            // Energy evaluation
+            de[j] += deltaE;
+
+          }
+
+
+  
+ 
+          if (evflag)
+            ev_tally(i, j, nlocal, newton_pair, 0.0, 0.0, fpair, delx, dely, delz);
+        }
+
+        // transport of species
+
+
+        if (transport && r < cutc[itype][jtype]) {
+
+          h = cutc[itype][jtype];
+
+          if (domain->dimension == 3) { // Kernel, 3d (1/r * dwdr) 
+            //Lucy kernel (3D)
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
+
+          } else if (domain->dimension == 2){ // Kernel, 2d (1/r * dwdr)
+            /*
+            //Lucy kernel (2D)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq;
+            wf = h - sqrt(rsq);
+            wf  = 1.591549430918954 * wf * wf * wf * ihsq * ihsq * (h + 3.*r);
+            */
+
+            /*
+            // Wendland C2 (2d)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wf  = 2.*h - r;
+            wfd = -0.348151438013521 * ihsq * ihsq * ihsq * ih * wf * wf * wf;
+            wf  = 0.034815143801352 * ihsq * ihsq* ihsq * ih * wf * wf* wf * wf * (2.*r + h); 
+            */
+
+            /*
+            // Wendland C4 (2d)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq); 
+            wf  = 2.*h - r;
+            wfd = -0.007460387957433 * 7. * ihsq * ihsq * ihsq * ihsq * ihsq * wf * wf * wf * wf * wf *(2.*h + 5.*r);
+            wf  = 0.011190581936149 * ihsq * ihsq* ihsq * ihsq * ihsq * wf * wf* wf * wf * wf * wf * ( (35./12.)*rsq + 3.*r*h + h*h); 
+            */
+
+            ///*
+            // Wendland C6 (2d)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wfd = 0.886720397226274 * ihsq*ihsq*ihsq*ihsq*ihsq*ihsq*ih* ( -5.5*h*h*h*h*h*h*h*h*h + 16.5*h*h*h*h*h*h*h*rsq -43.3125*h*h*h*h*h*rsq*rsq + 57.75*h*h*h*h*rsq*rsq*r -36.0938*h*h*h*rsq*rsq*rsq +12.375*h*h*rsq*rsq*rsq*r -2.25586*h*rsq*rsq*rsq*rsq + 0.171875*rsq*rsq*rsq*rsq*r );
+            //*/
+
+            /*
+            // quintic Wendland (2d)
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq); 
+            wf  = 2.*h - r;
+            wfd = - 0.0348151438013521 * ihsq * 10.* r * (2.*h-r) * (2.*h-r) * (2.*h-r) *ihsq*ihsq*ih/(r + 1e-12);
+            wf  = 2.-r*ih;
+            wf  = 0.0348151438013521 * ihsq * wf*wf*wf*wf * (1.+2.*r*ih);
+            */
+
+          } else if (domain->dimension == 1){ // Kernel, 1d (1/r * dwdr)
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wfd = -15.0 * wfd * wfd * ihsq * ihsq * ih; //Lucy (1d)
+          }
+
+
+              //double dQc_base = 2.0* ((imass*jmass)/(imass+jmass)) * ((rho[i]+rho[j])/(rho[i]*rho[j])) * wfd; // (Tartakovsky et. al., 2007, JCP)
+              double dQc_base = 2.0* ((imass*jmass)/(imass+jmass)) * ((rho[i]+rho[j])/(rho[i]*rho[j])) * rsq * wfd / (rsq + 0.01*h*h); // (Tartakovsky et. al., 2007, JCP)
+
+              //printf("\t\t\tAssigning D matrix[%i][%i]\n",i,j);
+              if (atom->num_ssa_species>0){              
+                int e = dfsp_D_matrix_index.insert(i,j);
+                dfsp_D[e] = - dQc_base;
+                dfsp_kappa[e] = kappa[itype][jtype] + atom->num_tdpd_species;
+                int eb = dfsp_D_matrix_index.insert(j,i);
+                dfsp_D[eb] = - dQc_base;
+                dfsp_kappa[eb] = kappa[itype][jtype] + atom->num_tdpd_species;
+                dfsp_back[e] = eb;
+                dfsp_back[eb] = e;
+              }
+
+
+            
+        
+            for(int k=0; k < atom->num_tdpd_species; ++k){
+                    double dQc = (kappa[itype][jtype][k]) * ( C[i][k] - C[j][k] ) * dQc_base;
+                    Q[i][k] += (dQc);
+                    if (newton_pair || j < nlocal)  Q[j][k] -= dQc;
+            }
+
+        }
+      }
+    }
+
+    timer->sub_stamp(forces ? Timer::SDPD_FORCE : Timer::TDPD_TRANSPORT);
+  }
+
+  if (vflag_fdotr) virial_fdotr_compute();
+  //printf("\tend of  i loop\n");
+
+
+  
+  //printf("Starting SSA diffusion\n");
+  // Second Step: Calculate SSA Diffusion
+  // Find Diagional element values
+  if (atom->num_ssa_species > 0){
+    timer->sub_start(Timer::SSA_DIFFUSION);
+    SsaTsdpdStats *stats = atom->ssa_stats;
+    if (stats) stats->start();
+    int it;
+    for (ii = 0; ii < inum; ii++) {
+      i = ilist[ii];
+      double total = 0;
+      for (it = dfsp_D_matrix_index.head[i]; it >= 0; it = dfsp_D_matrix_index.next[it]) {
+          total += dfsp_D[it];
+      }
+      dfsp_D_diag[i] = -total;    // minus the row sum
+    }    
+
+  double tt,a0,sum_d,sum_d2,r1,r2,r3;
+//  double* a_i = new double[inum];
+  int k;
+  int nssa = atom->num_ssa_species;
+  int nrep = atom->num_ssa_replicas;
+  if (dfsp_flag) {
+    SsaTsdpdDfsp dfsp(scratch,&dfsp_D_matrix_index,dfsp_D,dfsp_kappa,dfsp_back);
+    for (int s = 0; s < nssa; s++)
+      dfsp.diffuse(s,update->dt,inum,ilist,rep_random,nrep,Cd,Qd,stats);
+  } else
+  for(int sq=0;sq<nssa*nrep;sq++){  // Calculate each species seperatly
+    // replica q of species s is column c of Cd, Qd and has a stream of its
+    // own, the replicas of one species follow each other
+    int s = sq / nrep;
+    int q = sq % nrep;
+    int c = q*nssa + s;
+    RanMars *rng = rep_random[q];
+    // species s of all voxels, unit stride in the species-major layout
+    int *cd = Cd.species(c);
+    int cstride = Cd.astride;
+    // the per-voxel base propensities only depend on the geometry,
+    // all replicas of species s use those of the first one
+    if (q == 0) {
+      for (ii = 0; ii < inum; ii++) {
+        i = ilist[ii];
+        dfsp_a_i[i] = 0;
+        for (it = dfsp_D_matrix_index.head[i]; it >= 0; it = dfsp_D_matrix_index.next[it]) {
+          dfsp_a_i[i] += dfsp_kappa[it][s] * dfsp_D[it]; // Note, "dfsp_a_i" is the per-voxel base propensity (must multiply Cd[i][s]);
+        }
+      }
+    }
+    // sum each voxel propensity to get total propensity
+    a0 = 0;
+    for (ii = 0; ii < inum; ii++) {
+      i = ilist[ii];
+      a0 += dfsp_a_i[i] * cd[i*cstride];
+      if (stats) stats->propensity(i,dfsp_a_i[i] * cd[i*cstride]);
+    }
+    // Find time to first reaction
+    tt=0;
+    r1 = rng->uniform();
+    tt += -log(1.0-r1)/a0 ;
+    //printf("SSA_Diffusion[s=%i] Cd[%i][%i]=%i tt=%e a0=%e r1=%e\n",s,i,s,Cd[i][s],tt,a0,r1);
+    // Loop over time
+    while(tt < update->dt){
+        // find which voxel the diffusion event occured
+        r2 = a0 * rng->uniform();
+        sum_d = 0;
+        for(k=0; k < inum; k++){
+            sum_d += dfsp_a_i[k] * cd[k*cstride];
+            if(sum_d > r2) break;
+            //printf("\t k=%i sum_d=%e r2=%e\n",k,sum_d,r2);
+        }
+        int src_vox = k;
+        if (stats) stats->diffusion(src_vox,s);
+        // find which voxel it moved to
+        r3 = dfsp_a_i[k] * rng->uniform();
+        sum_d2=0;
+        for (it = dfsp_D_matrix_index.head[src_vox]; it >= 0; it = dfsp_D_matrix_index.next[it]) {
+            j = dfsp_D_matrix_index.col[it];
+            sum_d2 += dfsp_kappa[it][s] * dfsp_D[it];
+            if(sum_d2 > r3) break;
+        }
+        int dest_vox = j;
+        // Move molecule  //TODO: which way is better? Computing Cd directly, or passing molecule diffusion via Qd? (I guess Qd is better).
+        //Cd[src_vox][s]--;
+        //Cd[dest_vox][s]++;
+   	Qd[src_vox][c]--;
+        Qd[dest_vox][c]++;
+        // Find delta in propensities
+        a0 += (dfsp_a_i[dest_vox] - dfsp_a_i[src_vox]);
+        
+        //printf("SSA_Diffusion[s=%i] tt=%e %i -> %i.  Now a0=%e",s,tt,src_vox,dest_vox,a0);
+        // Find time to next reaction
+        r1 = rng->uniform();
+        tt += -log(1.0-r1)/(a0);
+        //printf(" tt=%e\n",tt);
+    }
+  }
+
+//  delete[] a_i;
+  
+    timer->sub_stamp(Timer::SSA_DIFFUSION);
+  }
+  
+
+
+
+}
+
+/* ----------------------------------------------------------------------
+ allocate all arrays
+ ------------------------------------------------------------------------- */
+
+void PairSsaTsdpdIsph::allocate() {
+  allocated = 1;
+  int n = atom->ntypes;
+
+  memory->create(setflag, n + 1, n + 1, "pair:setflag");
+  for (int i = 1; i <= n; i++)
+    for (int j = i; j <= n; j++)
+      setflag[i][j] = 0;
+
+  memory->create(cutsq, n + 1, n + 1, "pair:cutsq");
+
+  memory->create(rho0, n + 1, "pair:rho0");
+  memory->create(cut, n + 1, n + 1, "pair:cut");
+  memory->create(viscosity, n + 1, n + 1, "pair:viscosity");
+
+  memory->create(kappa,n+1,n+1, atom->num_tdpd_species + atom->num_ssa_species,"pair:kappa"); //added  
+  memory->create(cutc, n + 1, n + 1, "pair:cutc");
+
+}
+
+/* ----------------------------------------------------------------------
+   global settings
+ ------------------------------------------------------------------------- */
+
+void PairSsaTsdpdIsph::settings(int narg, char **arg) {
+  if (narg % 2)
+    error->all(FLERR,
+        "Illegal number of setting arguments for pair_style ssa_tsdpd/isph");
+
+  // the streams do not depend on the clock, so a restart can continue them
+  // proc p of the universe draws from seed + p
+
+  int seed_all = SEED_DEFAULT;
+  dfsp_flag = 0;
+  for (int iarg = 0; iarg < narg; iarg += 2) {
+    if (strcmp(arg[iarg],"seed") == 0) {
+      seed_all = force->inumeric(FLERR,arg[iarg+1]);
+      if (seed_all <= 0 || seed_all > MAXSEED - universe->nprocs)
+        error->all(FLERR,"Illegal pair_style ssa_tsdpd/isph command");
+    } else if (strcmp(arg[iarg],"diffusion") == 0) {
+      if (strcmp(arg[iarg+1],"ssa") == 0) dfsp_flag = 0;
+      else if (strcmp(arg[iarg+1],"dfsp") == 0) dfsp_flag = 1;
+      else error->all(FLERR,"Illegal pair_style ssa_tsdpd/isph command");
+    } else error->all(FLERR,"Illegal pair_style ssa_tsdpd/isph command");
+  }
+
+  seed = seed_all + universe->me;
+  SsaTsdpdRng::destroy_replicas(rep_random,nrep_random);
+  delete random;
+  random = new RanMars(lmp,seed);
+  nrep_random = atom->num_ssa_replicas;
+  rep_random = SsaTsdpdRng::create_replicas(lmp,random,seed,nrep_random);
+}
+
+/* ----------------------------------------------------------------------
+ set coeffs for one or more type pairs
+ ------------------------------------------------------------------------- */
+
+void PairSsaTsdpdIsph::coeff(int narg, char **arg) {
+  if (narg != 6 + atom->num_tdpd_species + atom->num_ssa_species)
+    error->all(FLERR,
+        "Incorrect args for pair_style ssa_tsdpd/isph coefficients");
+  if (!allocated)
+    allocate();
+
+  int ilo, ihi, jlo, jhi;
+  force->bounds(FLERR,arg[0], atom->ntypes, ilo, ihi);
+  force->bounds(FLERR,arg[1], atom->ntypes, jlo, jhi);
+
+  // no sound speed: rho0 eta h cutc kappa[0..]
+  double rho0_one = force->numeric(FLERR,arg[2]);
+  double viscosity_one = force->numeric(FLERR,arg[3]);
+  double cut_one = force->numeric(FLERR,arg[4]);
+  double cutc_one = force->numeric(FLERR,arg[5]);
+
+  double kappa_one[atom->num_tdpd_species + atom->num_ssa_species];
+  for (int k=0; k < atom->num_tdpd_species + atom->num_ssa_species; k++){
+    kappa_one[k] = atof(arg[6+k]);
+  }
+
+
+  int count = 0;
+  for (int i = ilo; i <= ihi; i++) {
+    rho0[i] = rho0_one;
+    for (int j = MAX(jlo,i); j <= jhi; j++) {
+      viscosity[i][j] = viscosity_one;
+      cut[i][j] = cut_one;
+      cutc[i][j] = cutc_one;
+
+      for (int k=0; k < atom->num_tdpd_species + atom->num_ssa_species; k++) {
+        kappa[i][j][k] = kappa_one[k];
+      }
+
+      setflag[i][j] = 1;
+      count++;
+    }
+  }
+
+  if (count == 0)
+    error->all(FLERR,"Incorrect args for pair coefficients");
+}
+
+/* ----------------------------------------------------------------------
+   init specific to this pair style
+------------------------------------------------------------------------- */
+
+void PairSsaTsdpdIsph::init_style() {
+  neighbor->request(this,instance_me);
+
+  // viscous and random terms are left to fix ssa_tsdpd/shardlow if defined
+
+  shardlow_flag = 0;
+  for (int i = 0; i < modify->nfix; i++)
+    if (strcmp(modify->fix[i]->style,"ssa_tsdpd/shardlow") == 0) shardlow_flag = 1;
+}
+
+/* ----------------------------------------------------------------------
+ init for one type pair i,j and corresponding j,i
+ ------------------------------------------------------------------------- */
+
+double PairSsaTsdpdIsph::init_one(int i, int j) {
+
+  if (setflag[i][j] == 0) {
+    error->all(FLERR,"Not all pair ssa_tsdpd/isph coeffs are not set");
+  }
+
+  cut[j][i] = cut[i][j];
+  viscosity[j][i] = viscosity[i][j];
+
+  for(int k=0; k < atom->num_tdpd_species + atom->num_ssa_species; k++) {
+    kappa[j][i][k] = kappa[i][j][k];
+  }
+
+  cutc[j][i] = cutc[i][j];
+
+
+  return cut[i][j];
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairSsaTsdpdIsph::single(int i, int j, int itype, int jtype,
+    double rsq, double factor_coul, double factor_lj, double &fforce) {
+  fforce = 0.0;
+
+  return 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void *PairSsaTsdpdIsph::extract(const char *str, int &dim) {
+  dim = 0;
+  if (strcmp(str,"random") == 0) return (void *) random;
+  dim = 1;
+  if (strcmp(str,"random_replicas") == 0) return (void *) rep_random;
+  if (strcmp(str,"rho0") == 0) return (void *) rho0;
+  dim = 2;
+  if (strcmp(str,"cut") == 0) return (void *) cut;
+  if (strcmp(str,"viscosity") == 0) return (void *) viscosity;
+  return NULL;
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of the per-step scratch block
+------------------------------------------------------------------------- */
+
+double PairSsaTsdpdIsph::memory_usage()
+{
+  double bytes = Pair::memory_usage();
+  bytes += scratch->memory_usage();
+  return bytes;
+}
@@ -13,20 +13,29 @@
  
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include "pair_ssa_tsdpd_iwc.h"
 #include "atom.h"
 #include "force.h"
 #include "comm.h"
+#include "universe.h"
 #include "neigh_list.h"
 #include "memory.h"
 #include "error.h"
 #include "domain.h"
 #include "update.h"
 #include "random_mars.h"
-#include <set>
+#include "ssa_tsdpd_rng.h"
+#include "timer.h"
+#include "ssa_tsdpd_stats.h"
+#include "ssa_tsdpd_scratch.h"
+#include "ssa_tsdpd_dfsp.h"
 #include <unistd.h>
 #include <time.h>
 
+#define SEED_DEFAULT 4928459
+#define MAXSEED 900000000
+
 using namespace LAMMPS_NS;
 
 /* ---------------------------------------------------------------------- */
@@ -36,6 +45,10 @@ PairSsaTsdpdIwc::PairSsaTsdpdIwc(LAMMPS *lmp) : Pair(lmp)
   restartinfo = 0;
   first = 1;
   random = NULL;
+  rep_random = NULL;
+  dfsp_flag = 0;
+  nrep_random = 0;
+  scratch = new SsaTsdpdScratch(lmp);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -52,7 +65,9 @@ PairSsaTsdpdIwc::~PairSsaTsdpdIwc() {
     memory->destroy(kappa);
     memory->destroy(cutc);
   }
+    SsaTsdpdRng::destroy_replicas(rep_random,nrep_random);
     if (random) delete random;
+    delete scratch;
 }
 
 
@@ -83,20 +98,16 @@ void PairSsaTsdpdIwc::compute(int eflag, int vflag) {
   double *de = atom->de;
   double *e = atom->e;
   double *drho = atom->drho;
-  double **C = atom->C;
-  double **Q = atom->Q;
-  int **Cd = atom->Cd;
-  int **Qd = atom->Qd;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<double> Q = atom->Q;
+  SpeciesArray<int> Cd = atom->Cd;
+  SpeciesArray<int> Qd = atom->Qd;
   int *type = atom->type;
   int nlocal = atom->nlocal;
   int newton_pair = force->newton_pair;
   int dimension = domain->dimension;
   double kBoltzmann = force->boltz;
   double dtinv = 1.0 / update->dt;
-  double *dfsp_D_matrix = atom->dfsp_D_matrix;
-  double *dfsp_D_diag = atom->dfsp_D_diag;
-  double *dfsp_Diffusion_coeff = atom->dfsp_Diffusion_coeff;
-  double *dfsp_a_i = atom->dfsp_a_i;
   int nmax = atom->nmax;
 
 
@@ -122,19 +133,30 @@ void PairSsaTsdpdIwc::compute(int eflag, int vflag) {
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
+  timer->sub_start(Timer::SDPD_FORCE);
+
 
-// New version of allocation (dfsp_D_matrix is now allocated at the atom_vec_ssa_tsdpd file)
-  std::set<int>* dfsp_D_matrix_index = new std::set<int>[nmax];   // set for each column to store which elements are non-zero
-  int inumsq = inum*inum;
+  // per-step temporaries come from the scratch block
+
+  scratch->reset();
+  bigint maxentry = 0;
+  if (atom->num_ssa_species > 0)
+    for (ii = 0; ii < inum; ii++) maxentry += 2*numneigh[ilist[ii]];
+  SsaTsdpdIndexSets dfsp_D_matrix_index;   // non-zero columns of each row
+  dfsp_D_matrix_index.init(scratch,nmax,maxentry);
+  double *dfsp_D = scratch->get<double>(maxentry);        // value of each entry
+  double **dfsp_kappa = scratch->get<double *>(maxentry); // SSA kappas of an entry
+  int *dfsp_back = scratch->get<int>(maxentry);           // entry (j,i) of (i,j)
+  double *dfsp_D_diag = scratch->get<double>(nmax);
+  double *dfsp_a_i = scratch->zero<double>(nmax);         // ghosts stay 0
   
    //allocate M
-   double *M11 = new double[nmax];
-   double *M12 = new double[nmax];
-   double *M21 = new double[nmax];
-   double *M22 = new double[nmax];
+   double *M11 = scratch->zero<double>(nmax);
+   double *M12 = scratch->zero<double>(nmax);
+   double *M21 = scratch->zero<double>(nmax);
+   double *M22 = scratch->zero<double>(nmax);
 
   
- //TODO: Create dfsp_D_diag, dfsp_Diffusion_coeff at atom_vec_ssa_tsdpd file. Also, we have to think in a better way of working with dfsp_D_matrix_index (std library seems slow)
 
  // loop over neighbors of my atoms
 
@@ -283,302 +305,320 @@ void PairSsaTsdpdIwc::compute(int eflag, int vflag) {
    }
  }
   
-  for (ii = 0; ii < inum; ii++) {
+  // species transport is fused into the force loop, with timer full it
+  // runs in a second pass so TDPD_TRANSPORT is measured apart from SDPD_FORCE
 
-    i = ilist[ii]; 
-
-    //printf("\t\ti=%i\n",i);
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-    vxtmp = v[i][0];
-    vytmp = v[i][1];
-    vztmp = v[i][2];
-    itype = type[i];
-    jlist = firstneigh[i];
-    jnum = numneigh[i];
-    imass = mass[itype];
+  int species = (atom->num_tdpd_species > 0 || atom->num_ssa_species > 0);
+  int npass = (species && timer->has_full()) ? 2 : 1;
 
+  for (int pass = 0; pass < npass; pass++) {
+    int forces = (pass == 0);
+    int transport = species && (pass == npass-1);
+    if (!forces) timer->sub_start(Timer::TDPD_TRANSPORT);
+    for (ii = 0; ii < inum; ii++) {
 
-    // compute pressure of atom i with Tait EOS
-    tmp = rho[i] / rho0[itype];
-    fi = tmp * tmp * tmp;
-    //fi = B[itype] * (fi * fi * tmp - 1.0)  / (rho[i] * rho[i]); //P0 = background pressure = 100
-    fi = B[itype] * (fi * fi * tmp - 1.0)  / (rho[i] * rho[j]); //P0 = background pressure = 100
-
-     for (jj = 0; jj < jnum; jj++) {
-      j = jlist[jj];
-      j &= NEIGHMASK;
+      i = ilist[ii]; 
+
+      //printf("\t\ti=%i\n",i);
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
+      vxtmp = v[i][0];
+      vytmp = v[i][1];
+      vztmp = v[i][2];
+      itype = type[i];
+      jlist = firstneigh[i];
+      jnum = numneigh[i];
+      imass = mass[itype];
+
+
+      // compute pressure of atom i with Tait EOS
+      tmp = rho[i] / rho0[itype];
+      fi = tmp * tmp * tmp;
+      //fi = B[itype] * (fi * fi * tmp - 1.0)  / (rho[i] * rho[i]); //P0 = background pressure = 100
+      fi = B[itype] * (fi * fi * tmp - 1.0)  / (rho[i] * rho[j]); //P0 = background pressure = 100
+
+       for (jj = 0; jj < jnum; jj++) {
+        j = jlist[jj];
+        j &= NEIGHMASK;
   
-      delx = xtmp - x[j][0];
-      dely = ytmp - x[j][1];
-      delz = ztmp - x[j][2];
-      rsq = delx * delx + dely * dely + delz * delz;
-      jtype = type[j];
-      jmass = mass[jtype];
-
-
-      if (rsq < cutsq[itype][jtype] ) {
-        h = cut[itype][jtype];     // for Lucy kernel
+        delx = xtmp - x[j][0];
+        dely = ytmp - x[j][1];
+        delz = ztmp - x[j][2];
+        rsq = delx * delx + dely * dely + delz * delz;
+        jtype = type[j];
+        jmass = mass[jtype];
+
+        if (rsq >= cutsq[itype][jtype]) continue;
         double r = sqrt(rsq);
 
+        if (forces) {
+          h = cut[itype][jtype];     // for Lucy kernel
 
-        if (domain->dimension == 3) { // Kernel, 3d (1/r * dwdr) 
-          //Lucy kernel (3D)
-          ih = 1.0 / h;
-          ihsq = ih * ih;
-          wfd = h - sqrt(rsq);
-          wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
-          wf = h - sqrt(rsq);
-          wf  = 2.088908628081126 * wf * wf * wf * ihsq * ihsq * (h + 3.*r);
 
-        } else if (domain->dimension == 2){ // Kernel, 2d (1/r * dwdr)
-          /*
-          //Lucy kernel (2D)
-          h = 0.5 * h;
-          ih = 1.0 / h;
-          ihsq = ih * ih;
-          wfd = h - sqrt(rsq);
-          wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq;
-          wf = h - sqrt(rsq);
-          wf  = 1.591549430918954 * wf * wf * wf * ihsq * ihsq * (h + 3.*r);
-          */
+          if (domain->dimension == 3) { // Kernel, 3d (1/r * dwdr) 
+            //Lucy kernel (3D)
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
+            wf = h - sqrt(rsq);
+            wf  = 2.088908628081126 * wf * wf * wf * ihsq * ihsq * (h + 3.*r);
 
-          /*
-          // Wendland C2 (2d)
-          h = 0.5 * h;
-          ih = 1.0 / h;
-          ihsq = ih * ih;
-          wfd = h - sqrt(rsq);
-          wf  = 2.*h - r;
-          wfd = -0.348151438013521 * ihsq * ihsq * ihsq * ih * wf * wf * wf;
-          wf  = 0.034815143801352 * ihsq * ihsq* ihsq * ih * wf * wf* wf * wf * (2.*r + h); 
-          */
+          } else if (domain->dimension == 2){ // Kernel, 2d (1/r * dwdr)
+            /*
+            //Lucy kernel (2D)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq;
+            wf = h - sqrt(rsq);
+            wf  = 1.591549430918954 * wf * wf * wf * ihsq * ihsq * (h + 3.*r);
+            */
 
-          /*
-          // Wendland C4 (2d)
-          h = 0.5 * h;
-          ih = 1.0 / h;
-          ihsq = ih * ih;
-          wfd = h - sqrt(rsq); 
-          wf  = 2.*h - r;
-          wfd = -0.007460387957433 * 7. * ihsq * ihsq * ihsq * ihsq * ihsq * wf * wf * wf * wf * wf *(2.*h + 5.*r);
-          wf  = 0.011190581936149 * ihsq * ihsq* ihsq * ihsq * ihsq * wf * wf* wf * wf * wf * wf * ( (35./12.)*rsq + 3.*r*h + h*h); 
-          */
+            /*
+            // Wendland C2 (2d)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wf  = 2.*h - r;
+            wfd = -0.348151438013521 * ihsq * ihsq * ihsq * ih * wf * wf * wf;
+            wf  = 0.034815143801352 * ihsq * ihsq* ihsq * ih * wf * wf* wf * wf * (2.*r + h); 
+            */
 
-          ///*
-          // Wendland C6 (2d)
-          h = 0.5 * h;
-          ih = 1.0 / h;
-          ihsq = ih * ih;
-          wfd = h - sqrt(rsq);
-          wf  = 2.*h - r;
-          wfd = 0.886720397226274 * ihsq*ihsq*ihsq*ihsq*ihsq*ihsq*ih* ( -5.5*h*h*h*h*h*h*h*h*h + 16.5*h*h*h*h*h*h*h*rsq -43.3125*h*h*h*h*h*rsq*rsq + 57.75*h*h*h*h*rsq*rsq*r -36.0938*h*h*h*rsq*rsq*rsq +12.375*h*h*rsq*rsq*rsq*r -2.25586*h*rsq*rsq*rsq*rsq + 0.171875*rsq*rsq*rsq*rsq*r );
-          wf  = 2.*h - r;
-          wf  = 0.003463751551665 * ihsq * ihsq* ihsq * ihsq * ihsq * ihsq * ih * wf * wf* wf * wf * wf * wf * wf * wf * (h*h*h + 4.*r*h*h + 6.25*rsq*h + 4.*rsq*r);
-          //*/
+            /*
+            // Wendland C4 (2d)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq); 
+            wf  = 2.*h - r;
+            wfd = -0.007460387957433 * 7. * ihsq * ihsq * ihsq * ihsq * ihsq * wf * wf * wf * wf * wf *(2.*h + 5.*r);
+            wf  = 0.011190581936149 * ihsq * ihsq* ihsq * ihsq * ihsq * wf * wf* wf * wf * wf * wf * ( (35./12.)*rsq + 3.*r*h + h*h); 
+            */
 
-          /*
-          // quintic Wendland (2d)
-          ih = 1.0 / h;
-          ihsq = ih * ih;
-          wfd = h - sqrt(rsq); 
-          wf  = 2.*h - r;
-          wfd = - 0.0348151438013521 * ihsq * 10.* r * (2.*h-r) * (2.*h-r) * (2.*h-r) *ihsq*ihsq*ih/(r + 1e-12);
-          wf  = 2.-r*ih;
-          wf  = 0.0348151438013521 * ihsq * wf*wf*wf*wf * (1.+2.*r*ih);
-          */
+            ///*
+            // Wendland C6 (2d)
+            h = 0.5 * h;
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wf  = 2.*h - r;
+            wfd = 0.886720397226274 * ihsq*ihsq*ihsq*ihsq*ihsq*ihsq*ih* ( -5.5*h*h*h*h*h*h*h*h*h + 16.5*h*h*h*h*h*h*h*rsq -43.3125*h*h*h*h*h*rsq*rsq + 57.75*h*h*h*h*rsq*rsq*r -36.0938*h*h*h*rsq*rsq*rsq +12.375*h*h*rsq*rsq*rsq*r -2.25586*h*rsq*rsq*rsq*rsq + 0.171875*rsq*rsq*rsq*rsq*r );
+            wf  = 2.*h - r;
+            wf  = 0.003463751551665 * ihsq * ihsq* ihsq * ihsq * ihsq * ihsq * ih * wf * wf* wf * wf * wf * wf * wf * wf * (h*h*h + 4.*r*h*h + 6.25*rsq*h + 4.*rsq*r);
+            //*/
 
-        } else if (domain->dimension == 1){ // Kernel, 1d (1/r * dwdr)
-          ih = 1.0 / h;
-          ihsq = ih * ih;
-          wfd = h - sqrt(rsq);
-          wfd = -15.0 * wfd * wfd * ihsq * ihsq * ih; //Lucy (1d)
-        }
+            /*
+            // quintic Wendland (2d)
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq); 
+            wf  = 2.*h - r;
+            wfd = - 0.0348151438013521 * ihsq * 10.* r * (2.*h-r) * (2.*h-r) * (2.*h-r) *ihsq*ihsq*ih/(r + 1e-12);
+            wf  = 2.-r*ih;
+            wf  = 0.0348151438013521 * ihsq * wf*wf*wf*wf * (1.+2.*r*ih);
+            */
 
+          } else if (domain->dimension == 1){ // Kernel, 1d (1/r * dwdr)
+            ih = 1.0 / h;
+            ihsq = ih * ih;
+            wfd = h - sqrt(rsq);
+            wfd = -15.0 * wfd * wfd * ihsq * ihsq * ih; //Lucy (1d)
+          }
 
 
-        //inverse of the kernel correction matrix
-        double factor = (M11[i] * M22[i] - M12[i] * M21[i]);
-        if (abs(factor)<1e-16) { //near singular, so use identity matrix
-	  factor = 1;
-          M11[i] = 1;
-          M22[i] = 1;
-          M12[i] = 0;
-          M21[i] = 0;
-        }
 
-        double det_M = 1. / factor;
+          //inverse of the kernel correction matrix
+          double factor = (M11[i] * M22[i] - M12[i] * M21[i]);
+          if (abs(factor)<1e-16) { //near singular, so use identity matrix
+  	  factor = 1;
+            M11[i] = 1;
+            M22[i] = 1;
+            M12[i] = 0;
+            M21[i] = 0;
+          }
+
+          double det_M = 1. / factor;
  
-        double L11,L12,L21,L22;
-        L11 = det_M * ( M22[i]);
-        L12 = det_M * (-M12[i]);
-        L21 = det_M * (-M21[i]);
-        L22 = det_M * ( M11[i]);
+          double L11,L12,L21,L22;
+          L11 = det_M * ( M22[i]);
+          L12 = det_M * (-M12[i]);
+          L21 = det_M * (-M21[i]);
+          L22 = det_M * ( M11[i]);
 
 
-        double delxo = delx;
-        double delyo = dely;       
+          double delxo = delx;
+          double delyo = dely;       
 
-        //correct delx and dely
-        double xcorr = (L11*delx + L12*dely);
-        double ycorr = (L21*delx + L22*dely);
-        //printf("xcorr = %f, ycorr = %f, delxo = %f, delyo = %f, M11 = %f, M12 = %f, M21 = %f, M22 = %f, det_M = %f \n", xcorr, ycorr, delxo, delyo, M11[i], M12[i], M21[i], M22[i],det_M);
-        //delx = (L11*delx + L12*dely);
-        //dely = (L21*delx + L22*dely);
+          //correct delx and dely
+          double xcorr = (L11*delx + L12*dely);
+          double ycorr = (L21*delx + L22*dely);
+          //printf("xcorr = %f, ycorr = %f, delxo = %f, delyo = %f, M11 = %f, M12 = %f, M21 = %f, M22 = %f, det_M = %f \n", xcorr, ycorr, delxo, delyo, M11[i], M12[i], M21[i], M22[i],det_M);
+          //delx = (L11*delx + L12*dely);
+          //dely = (L21*delx + L22*dely);
 
-        //if ( abs(corr_x) < 1e-4) corr_x = 1.;
-        //if ( abs(corr_y) < 1e-4) corr_y = 1.;
+          //if ( abs(corr_x) < 1e-4) corr_x = 1.;
+          //if ( abs(corr_y) < 1e-4) corr_y = 1.;
 
 
-        // compute pressure  of atom j with Tait EOS
-        tmp = rho[j] / rho0[jtype];
-        fj = tmp * tmp * tmp;
-        //fj = B[jtype] * (fj * fj * tmp - 1.0) / (rho[j] * rho[j]);
-        fj = B[jtype] * (fj * fj * tmp - 1.0) / (rho[i] * rho[j]);
-        //if (fj < 0.0) fj = 0;
+          // compute pressure  of atom j with Tait EOS
+          tmp = rho[j] / rho0[jtype];
+          fj = tmp * tmp * tmp;
+          //fj = B[jtype] * (fj * fj * tmp - 1.0) / (rho[j] * rho[j]);
+          fj = B[jtype] * (fj * fj * tmp - 1.0) / (rho[i] * rho[j]);
+          //if (fj < 0.0) fj = 0;
 
-        velx=vxtmp - v[j][0];
-        vely=vytmp - v[j][1];
-        velz=vztmp - v[j][2];
+          velx=vxtmp - v[j][0];
+          vely=vytmp - v[j][1];
+          velz=vztmp - v[j][2];
 
-        // dot product of velocity delta and distance vector
-        delVdotDelR = delx * velx + dely * vely + delz * velz;
+          // dot product of velocity delta and distance vector
+          delVdotDelR = delx * velx + dely * vely + delz * velz;
 
 
-        // Espanol Viscosity (Espanol, 2003)
-        fvisc = wfd / (rho[i] * rho[j]);
-        fvisc *= imass * jmass ; 
+          // Espanol Viscosity (Espanol, 2003)
+          fvisc = wfd / (rho[i] * rho[j]);
+          fvisc *= imass * jmass ; 
 
         
-        // total pair force
-        //fpair = -imass * jmass * (fi + fj) * wfd;
-        fpair = -imass * jmass * (-fi + fj) * wfd;
+          // total pair force
+          //fpair = -imass * jmass * (fi + fj) * wfd;
+          fpair = -imass * jmass * (-fi + fj) * wfd;
 
         
-        // random force calculation
-        // independent increments of a Wiener process matrix
-        double wiener[3][3] = {0};
-        for (int l=0; l<dimension; l++){
-            for (int m=0; m<dimension; m++){
-                wiener[l][m] = random->gaussian();
-            }
-        }
+          // random force calculation
+          // independent increments of a Wiener process matrix
+          double wiener[3][3] = {0};
+          for (int l=0; l<dimension; l++){
+              for (int m=0; m<dimension; m++){
+                  wiener[l][m] = random->gaussian();
+              }
+          }
 
 
-        // symmetric part
-        wiener[0][1] = wiener[1][0] = (wiener[0][1] + wiener[1][0]) / 2.;
-        wiener[0][2] = wiener[2][0] = (wiener[0][2] + wiener[2][0]) / 2.;
-        wiener[1][2] = wiener[2][1] = (wiener[1][2] + wiener[2][1]) / 2.;
+          // symmetric part
+          wiener[0][1] = wiener[1][0] = (wiener[0][1] + wiener[1][0]) / 2.;
+          wiener[0][2] = wiener[2][0] = (wiener[0][2] + wiener[2][0]) / 2.;
+          wiener[1][2] = wiener[2][1] = (wiener[1][2] + wiener[2][1]) / 2.;
 
-        // traceless part
-        double trace_over_dim = (wiener[0][0] + wiener[1][1] + wiener[2][2]) / dimension;
-        wiener[0][0] -= trace_over_dim;
-        wiener[1][1] -= trace_over_dim;
-        wiener[2][2] -= trace_over_dim;
+          // traceless part
+          double trace_over_dim = (wiener[0][0] + wiener[1][1] + wiener[2][2]) / dimension;
+          wiener[0][0] -= trace_over_dim;
+          wiener[1][1] -= trace_over_dim;
+          wiener[2][2] -= trace_over_dim;
 
-        double prefactor = sqrt (-4. * kBoltzmann* e[i] * fvisc * dtinv) / (r+0.01*h);
-        double f_random[3] = {0};
+          double prefactor = sqrt (-4. * kBoltzmann* e[i] * fvisc * dtinv) / (r+0.01*h);
+          double f_random[3] = {0};
 
 
-        for (int l=0; l<dimension; ++l)  f_random[l] = prefactor * (wiener[l][0]*delx + wiener[l][1]*dely + wiener[l][2]*delz);
+          for (int l=0; l<dimension; ++l)  f_random[l] = prefactor * (wiener[l][0]*delx + wiener[l][1]*dely + wiener[l][2]*delz);
 
 
-        // final viscous force
-        fvisc *= (5.0/3.0)*viscosity[itype][jtype];
+          // final viscous force
+          fvisc *= (5.0/3.0)*viscosity[itype][jtype];
 
-        if (delVdotDelR > 0.0) {
-		  fvisc = 0.0;
-	    }
+          if (delVdotDelR > 0.0) {
+  		  fvisc = 0.0;
+  	    }
 
 
-        //Momentum evaluation
-        /*
-        // kernel correction applied to the model of Vásquez-Quesada et al., (2009) + XSPH term (Monaghan, 1992)
-        double eps_xsph = 0.2;
-        f[i][0] += xcorr * fpair + fvisc * (velx + delVdotDelR * xcorr / (rsq+0.01*h*h) ) + f_random[0] - eps_xsph * imass*jmass*velx * wf/(0.5* (rho[i] + rho[j]));
-        f[i][1] += ycorr * fpair + fvisc * (vely + delVdotDelR * ycorr / (rsq+0.01*h*h) ) + f_random[1] - eps_xsph * imass*jmass*vely * wf/(0.5* (rho[i] + rho[j]));
-        f[i][2] += delz  * fpair + fvisc * (velz + delVdotDelR * delz  / (rsq+0.01*h*h) ) + f_random[2] - eps_xsph * imass*jmass*velz * wf/(0.5* (rho[i] + rho[j]));
-        */  
-        ///*
-        // kernel correction applied to the model of Vásquez-Quesada et al., (2009)
-        f[i][0] += xcorr * fpair + fvisc * (velx + delVdotDelR * xcorr / (rsq+0.01*h*h) ) + f_random[0];
-        f[i][1] += ycorr * fpair + fvisc * (vely + delVdotDelR * ycorr / (rsq+0.01*h*h) ) + f_random[1];
-        f[i][2] += delz  * fpair + fvisc * (velz + delVdotDelR * delz  / (rsq+0.01*h*h) ) + f_random[2];
-        //*/
-       
-        
-        //Density evaluation
-        /*
-        //artificial density diffusion: Molteni (2009) (disregards singularities)
-        drho[i] += jmass * delVdotDelR * wfd - 0.1 * h * soundspeed[itype] * jmass * 2.0*(rho[j]/rho[i] - 1.0)  * wfd;
-        */
-        /*
-        //classical density formulation
-        drho[i] += jmass * delVdotDelR * wfd;
-        */
-        /*
-        //artificial density diffusion: Molteni (2009)
-        drho[i] += jmass * delVdotDelR * wfd - 0.1 * h * soundspeed[itype] * jmass * 2.0*( ((imass/rho[i]) / ( jmass/rho[j] )) - 1.0) * (rsq/(rsq+0.01*h*h)) * wfd;
-        */
-        
-        ///*
-        // kernel correction applied to the classical density formulation
-        drho[i] += rho[i] * jmass * (velx*xcorr + vely*ycorr + velz*delz) * wfd / rho[j];
-        //*/
-        
-
-        // Energy evaluation
-        deltaE = -0.5 *(fpair * delVdotDelR + fvisc * (velx*velx + vely*vely + velz*velz));
-        de[i] += deltaE;
-        
-
-        // Reactions in neighbors (j particles)
-        if (newton_pair || j < nlocal) {
-
           //Momentum evaluation
           /*
           // kernel correction applied to the model of Vásquez-Quesada et al., (2009) + XSPH term (Monaghan, 1992)
-          double eps_xsph = 0.2; 
-     	  f[j][0] -= -delx * fpair + fvisc * (velx + delVdotDelR * delx / (rsq + 0.01*h*h) ) + f_random[0] - eps_xsph * imass*jmass*velx * wf/(0.5* (rho[i] + rho[j]));
-          f[j][1] -= -dely * fpair + fvisc * (vely + delVdotDelR * dely / (rsq + 0.01*h*h) ) + f_random[1] - eps_xsph * imass*jmass*vely * wf/(0.5* (rho[i] + rho[j]));
-          f[j][2] -= -delz * fpair + fvisc * (velz + delVdotDelR * delz / (rsq + 0.01*h*h) ) + f_random[2] - eps_xsph * imass*jmass*velz * wf/(0.5* (rho[i] + rho[j]));
-          */
+          double eps_xsph = 0.2;
+          f[i][0] += xcorr * fpair + fvisc * (velx + delVdotDelR * xcorr / (rsq+0.01*h*h) ) + f_random[0] - eps_xsph * imass*jmass*velx * wf/(0.5* (rho[i] + rho[j]));
+          f[i][1] += ycorr * fpair + fvisc * (vely + delVdotDelR * ycorr / (rsq+0.01*h*h) ) + f_random[1] - eps_xsph * imass*jmass*vely * wf/(0.5* (rho[i] + rho[j]));
+          f[i][2] += delz  * fpair + fvisc * (velz + delVdotDelR * delz  / (rsq+0.01*h*h) ) + f_random[2] - eps_xsph * imass*jmass*velz * wf/(0.5* (rho[i] + rho[j]));
+          */  
           ///*
           // kernel correction applied to the model of Vásquez-Quesada et al., (2009)
-     	  f[j][0] -= -xcorr * fpair + fvisc * (velx + delVdotDelR * xcorr / (rsq + 0.01*h*h) ) + f_random[0];
-          f[j][1] -= -ycorr * fpair + fvisc * (vely + delVdotDelR * ycorr / (rsq + 0.01*h*h) ) + f_random[1];
-          f[j][2] -= -delz  * fpair + fvisc * (velz + delVdotDelR * delz  / (rsq + 0.01*h*h) ) + f_random[2];
+          f[i][0] += xcorr * fpair + fvisc * (velx + delVdotDelR * xcorr / (rsq+0.01*h*h) ) + f_random[0];
+          f[i][1] += ycorr * fpair + fvisc * (vely + delVdotDelR * ycorr / (rsq+0.01*h*h) ) + f_random[1];
+          f[i][2] += delz  * fpair + fvisc * (velz + delVdotDelR * delz  / (rsq+0.01*h*h) ) + f_random[2];
           //*/
-
-
+       
+        
           //Density evaluation
           /*
-          // artificial density diffusion: Molteni (2009) (disregards singularities)
-          drho[j] += imass * delVdotDelR * wfd - 0.1 * h * soundspeed[jtype] * imass * 2.0*(rho[i]/rho[j] - 1.0) * wfd; 
+          //artificial density diffusion: Molteni (2009) (disregards singularities)
+          drho[i] += jmass * delVdotDelR * wfd - 0.1 * h * soundspeed[itype] * jmass * 2.0*(rho[j]/rho[i] - 1.0)  * wfd;
           */
           /*
-          // classical density formulation
-          drho[j] += imass * delVdotDelR * wfd;
+          //classical density formulation
+          drho[i] += jmass * delVdotDelR * wfd;
           */
           /*
-          // artificial density diffusion: Molteni (2009)
-          drho[j] += imass * delVdotDelR * wfd - 0.1 * h * soundspeed[jtype] * imass * 2.0*( ((jmass/rho[j]) / ( imass/rho[i] )) - 1.0) * (rsq/(rsq+0.01*h*h)) * wfd;
+          //artificial density diffusion: Molteni (2009)
+          drho[i] += jmass * delVdotDelR * wfd - 0.1 * h * soundspeed[itype] * jmass * 2.0*( ((imass/rho[i]) / ( jmass/rho[j] )) - 1.0) * (rsq/(rsq+0.01*h*h)) * wfd;
           */
+        
           ///*
-          // kernel correction applied to the classical density formulation 
-          drho[j] += rho[j] * imass * (velx*xcorr + vely*ycorr + velz*delz) * wfd / rho[i];  
+          // kernel correction applied to the classical density formulation
+          drho[i] += rho[i] * jmass * (velx*xcorr + vely*ycorr + velz*delz) * wfd / rho[j];
           //*/
+        
+
+          // Energy evaluation
+          deltaE = -0.5 *(fpair * delVdotDelR + fvisc * (velx*velx + vely*vely + velz*velz));
+          de[i] += deltaE;
+        
+
+          // Reactions in neighbors (j particles)
+          if (newton_pair || j < nlocal) {
+
+            //Momentum evaluation
+            /*
+            // kernel correction applied to the model of Vásquez-Quesada et al., (2009) + XSPH term (Monaghan, 1992)
+            double eps_xsph = 0.2; 
+       	  f[j][0] -= -delx * fpair + fvisc * (velx + delVdotDelR * delx / (rsq + 0.01*h*h) ) + f_random[0] - eps_xsph * imass*jmass*velx * wf/(0.5* (rho[i] + rho[j]));
+            f[j][1] -= -dely * fpair + fvisc * (vely + delVdotDelR * dely / (rsq + 0.01*h*h) ) + f_random[1] - eps_xsph * imass*jmass*vely * wf/(0.5* (rho[i] + rho[j]));
+            f[j][2] -= -delz * fpair + fvisc * (velz + delVdotDelR * delz / (rsq + 0.01*h*h) ) + f_random[2] - eps_xsph * imass*jmass*velz * wf/(0.5* (rho[i] + rho[j]));
+            */
+            ///*
+            // kernel correction applied to the model of Vásquez-Quesada et al., (2009)
+       	  f[j][0] -= -xcorr * fpair + fvisc * (velx + delVdotDelR * xcorr / (rsq + 0.01*h*h) ) + f_random[0];
+            f[j][1] -= -ycorr * fpair + fvisc * (vely + delVdotDelR * ycorr / (rsq + 0.01*h*h) ) + f_random[1];
+            f[j][2] -= -delz  * fpair + fvisc * (velz + delVdotDelR * delz  / (rsq + 0.01*h*h) ) + f_random[2];
+            //*/
+
+
+            //Density evaluation
+            /*
+            // artificial density diffusion: Molteni (2009) (disregards singularities)
+            drho[j] += imass * delVdotDelR * wfd - 0.1 * h * soundspeed[jtype] * imass * 2.0*(rho[i]/rho[j] - 1.0) * wfd; 
+            */
+            /*
+            // classical density formulation
+            drho[j] += imass * delVdotDelR * wfd;
+            */
+            /*
+            // artificial density diffusion: Molteni (2009)
+            drho[j] += imass * delVdotDelR * wfd - 0.1 * h * soundspeed[jtype] * imass * 2.0*( ((jmass/rho[j]) / ( imass/rho[i] )) - 1.0) * (rsq/(rsq+0.01*h*h)) * wfd;
+            */
+            ///*
+            // kernel correction applied to the classical density formulation 
+            drho[j] += rho[j] * imass * (velx*xcorr + vely*ycorr + velz*delz) * wfd / rho[i];  
+            //*/
        
  
-          //Energy evaluation
-          de[j] += deltaE;
+            //Energy evaluation
+            de[j] += deltaE;
+          }
+
+  
+ 
+          if (evflag)
+            ev_tally(i, j, nlocal, newton_pair, 0.0, 0.0, fpair, delx, dely, delz);
         }
 
         // transport of species
-        if (r < cutc[itype][jtype]) {
 
-          double r = sqrt(rsq);
+
+        if (transport && r < cutc[itype][jtype]) {
+
           h = cutc[itype][jtype];
 
           if (domain->dimension == 3) { // Kernel, 3d (1/r * dwdr) 
@@ -587,8 +627,6 @@ void PairSsaTsdpdIwc::compute(int eflag, int vflag) {
             ihsq = ih * ih;
             wfd = h - sqrt(rsq);
             wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
-            wf = h - sqrt(rsq);
-            wf  = 2.088908628081126 * wf * wf * wf * ihsq * ihsq * (h + 3.*r);
 
           } else if (domain->dimension == 2){ // Kernel, 2d (1/r * dwdr)
             /*
@@ -630,10 +668,7 @@ void PairSsaTsdpdIwc::compute(int eflag, int vflag) {
             ih = 1.0 / h;
             ihsq = ih * ih;
             wfd = h - sqrt(rsq);
-            wf  = 2.*h - r;
             wfd = 0.886720397226274 * ihsq*ihsq*ihsq*ihsq*ihsq*ihsq*ih* ( -5.5*h*h*h*h*h*h*h*h*h + 16.5*h*h*h*h*h*h*h*rsq -43.3125*h*h*h*h*h*rsq*rsq + 57.75*h*h*h*h*rsq*rsq*r -36.0938*h*h*h*rsq*rsq*rsq +12.375*h*h*rsq*rsq*rsq*r -2.25586*h*rsq*rsq*rsq*rsq + 0.171875*rsq*rsq*rsq*rsq*r );
-            wf  = 2.*h - r;
-            wf  = 0.003463751551665 * ihsq * ihsq* ihsq * ihsq * ihsq * ihsq * ih * wf * wf* wf * wf * wf * wf * wf * wf * (h*h*h + 4.*r*h*h + 6.25*rsq*h + 4.*rsq*r);
             //*/
 
             /*
@@ -662,18 +697,17 @@ void PairSsaTsdpdIwc::compute(int eflag, int vflag) {
 
               //printf("\t\t\tAssigning D matrix[%i][%i]\n",i,j);
               if (atom->num_ssa_species>0){              
-                dfsp_D_matrix[i*inum+j] = - dQc_base;
-                dfsp_D_matrix_index[i].insert(j);
-                dfsp_D_matrix[j*inum+i] = - dQc_base;
-                dfsp_D_matrix_index[j].insert(i);
+                int e = dfsp_D_matrix_index.insert(i,j);
+                dfsp_D[e] = - dQc_base;
+                dfsp_kappa[e] = kappa[itype][jtype] + atom->num_tdpd_species;
+                int eb = dfsp_D_matrix_index.insert(j,i);
+                dfsp_D[eb] = - dQc_base;
+                dfsp_kappa[eb] = kappa[itype][jtype] + atom->num_tdpd_species;
+                dfsp_back[e] = eb;
+                dfsp_back[eb] = e;
               }
 
 
-	    // TODO: dfsp_Diffusion_coeff seems redundant here. kappa[itype][jtype][s] is already allocated.
-            for(int s=0;s<atom->num_ssa_species;s++){
-                dfsp_Diffusion_coeff[i*inum+j+s*inumsq] = kappa[itype][jtype][s];
-                dfsp_Diffusion_coeff[j*inum+i+s*inumsq] = kappa[itype][jtype][s];
-           }
             
         
             for(int k=0; k < atom->num_tdpd_species; ++k){
@@ -683,17 +717,12 @@ void PairSsaTsdpdIwc::compute(int eflag, int vflag) {
             }
 
         }
-  
- 
-        if (evflag)
-          ev_tally(i, j, nlocal, newton_pair, 0.0, 0.0, fpair, delx, dely, delz);
       }
+    }
 
-   }
-
+    timer->sub_stamp(forces ? Timer::SDPD_FORCE : Timer::TDPD_TRANSPORT);
   }
 
-  
   if (vflag_fdotr) virial_fdotr_compute();
   //printf("\tend of  i loop\n");
 
@@ -703,68 +732,94 @@ void PairSsaTsdpdIwc::compute(int eflag, int vflag) {
   // Second Step: Calculate SSA Diffusion
   // Find Diagional element values
   if (atom->num_ssa_species > 0){
-    std::set<int>::iterator it;
+    timer->sub_start(Timer::SSA_DIFFUSION);
+    SsaTsdpdStats *stats = atom->ssa_stats;
+    if (stats) stats->start();
+    int it;
     for (ii = 0; ii < inum; ii++) {
       i = ilist[ii];
       double total = 0;
-      for (it=dfsp_D_matrix_index[i].begin(); it!=dfsp_D_matrix_index[i].end(); ++it){  // Using a set::iterator
-          total += *it;
+      for (it = dfsp_D_matrix_index.head[i]; it >= 0; it = dfsp_D_matrix_index.next[it]) {
+          total += dfsp_D[it];
       }
-      dfsp_D_diag[i] = total;
+      dfsp_D_diag[i] = -total;    // minus the row sum
     }    
 
   double tt,a0,sum_d,sum_d2,r1,r2,r3,a_i_src_orig,a_i_dest_orig;
 //  double* a_i = new double[inum];
   int k;
-  for(int s=0;s<atom->num_ssa_species;s++){  // Calculate each species seperatly
+  int nssa = atom->num_ssa_species;
+  int nrep = atom->num_ssa_replicas;
+  if (dfsp_flag) {
+    SsaTsdpdDfsp dfsp(scratch,&dfsp_D_matrix_index,dfsp_D,dfsp_kappa,dfsp_back);
+    for (int s = 0; s < nssa; s++)
+      dfsp.diffuse(s,update->dt,inum,ilist,rep_random,nrep,Cd,Qd,stats);
+  } else
+  for(int sq=0;sq<nssa*nrep;sq++){  // Calculate each species seperatly
+    // replica q of species s is column c of Cd, Qd and has a stream of its
+    // own, the replicas of one species follow each other
+    int s = sq / nrep;
+    int q = sq % nrep;
+    int c = q*nssa + s;
+    RanMars *rng = rep_random[q];
+    // species s of all voxels, unit stride in the species-major layout
+    int *cd = Cd.species(c);
+    int cstride = Cd.astride;
+    // the per-voxel base propensities only depend on the geometry,
+    // all replicas of species s use those of the first one
+    if (q == 0) {
+      for (ii = 0; ii < inum; ii++) {
+        i = ilist[ii];
+        dfsp_a_i[i] = 0;
+        for (it = dfsp_D_matrix_index.head[i]; it >= 0; it = dfsp_D_matrix_index.next[it]) {
+          dfsp_a_i[i] += dfsp_kappa[it][s] * dfsp_D[it]; // Note, "dfsp_a_i" is the per-voxel base propensity (must multiply Cd[i][s]);
+        }
+      }
+    }
     // sum each voxel propensity to get total propensity
     a0 = 0;
     for (ii = 0; ii < inum; ii++) {
       i = ilist[ii];
-      dfsp_a_i[i] = 0;
-      for (it=dfsp_D_matrix_index[i].begin(); it!=dfsp_D_matrix_index[i].end(); ++it){  // iterator over outbound connections
-        j = *it;
-
-        dfsp_a_i[i] += dfsp_Diffusion_coeff[i*inum+j+s*inumsq] * dfsp_D_matrix[i*inum+j]; // Note, "dfsp_a_i" is the per-voxel base propensity (must multiply Cd[i][s]);
-      }
-      a0 += dfsp_a_i[i] * Cd[i][s];
+      a0 += dfsp_a_i[i] * cd[i*cstride];
+      if (stats) stats->propensity(i,dfsp_a_i[i] * cd[i*cstride]);
     }
     // Find time to first reaction
     tt=0;
-    r1 = random->uniform();
+    r1 = rng->uniform();
     tt += -log(1.0-r1)/a0 ;
     //printf("SSA_Diffusion[s=%i] Cd[%i][%i]=%i tt=%e a0=%e r1=%e\n",s,i,s,Cd[i][s],tt,a0,r1);
     // Loop over time
     while(tt < update->dt){
         // find which voxel the diffusion event occured
-        r2 = a0 * random->uniform();
+        r2 = a0 * rng->uniform();
         sum_d = 0;
         for(k=0; k < inum; k++){
-            sum_d += dfsp_a_i[k] * Cd[k][s];
+            sum_d += dfsp_a_i[k] * cd[k*cstride];
             if(sum_d > r2) break;
             //printf("\t k=%i sum_d=%e r2=%e\n",k,sum_d,r2);
         }
         int src_vox = k;
+        if (stats) stats->diffusion(src_vox,s);
         // find which voxel it moved to
-        r3 = dfsp_a_i[k] * random->uniform();
+        r3 = dfsp_a_i[k] * rng->uniform();
         sum_d2=0;
-        for (it=dfsp_D_matrix_index[src_vox].begin(); it!=dfsp_D_matrix_index[src_vox].end(); ++it){
-            j = *it;
-            sum_d2 += dfsp_Diffusion_coeff[src_vox*inum+j+s*inumsq] * dfsp_D_matrix[src_vox*inum+j];
+        for (it = dfsp_D_matrix_index.head[src_vox]; it >= 0; it = dfsp_D_matrix_index.next[it]) {
+            j = dfsp_D_matrix_index.col[it];
+            sum_d2 += dfsp_kappa[it][s] * dfsp_D[it];
             if(sum_d2 > r3) break;
         }
         int dest_vox = j;
         // Move molecule  //TODO: which way is better? Computing Cd directly, or passing molecule diffusion via Qd? (I guess Qd is better).
         //Cd[src_vox][s]--;
         //Cd[dest_vox][s]++;
-   	Qd[src_vox][s]--;
-        Qd[dest_vox][s]++;
+   	Qd[src_vox][c]--;
+        Qd[dest_vox][c]++;
         // Find delta in propensities
         a0 += (dfsp_a_i[dest_vox] - dfsp_a_i[src_vox]);
         
         //printf("SSA_Diffusion[s=%i] tt=%e %i -> %i.  Now a0=%e",s,tt,src_vox,dest_vox,a0);
         // Find time to next reaction
-        r1 = random->uniform();
+        r1 = rng->uniform();
         tt += -log(1.0-r1)/(a0);
         //printf(" tt=%e\n",tt);
     }
@@ -772,13 +827,8 @@ void PairSsaTsdpdIwc::compute(int eflag, int vflag) {
 
 //  delete[] a_i;
   
+    timer->sub_stamp(Timer::SSA_DIFFUSION);
   }
-  // Dealocate the arrays.  TODO: move to the destructor
-  delete[] dfsp_D_matrix_index;
-  delete[] M11;
-  delete[] M12;
-  delete[] M21;
-  delete[] M22;
   
 
 }
@@ -814,19 +864,33 @@ void PairSsaTsdpdIwc::allocate() {
  ------------------------------------------------------------------------- */
 
 void PairSsaTsdpdIwc::settings(int narg, char **arg) {
-  if (narg != 0)
+  if (narg % 2)
     error->all(FLERR,
         "Illegal number of setting arguments for pair_style ssa_tsdpd/iwc");
 
-  // seed is immune to underflow/overflow because it is unsigned
-//  seed = comm->nprocs + comm->me + atom->nlocal;
-//  if (narg == 3) seed += force->inumeric (FLERR, arg[2]);
-//  random = new RanMars (lmp, seed);
-
-  srand(clock());
-  seed = comm->nprocs + comm->me + atom->nlocal + rand()%100;
-  random = new RanMars (lmp,seed);
+  // the streams do not depend on the clock, so a restart can continue them
+  // proc p of the universe draws from seed + p
+
+  int seed_all = SEED_DEFAULT;
+  dfsp_flag = 0;
+  for (int iarg = 0; iarg < narg; iarg += 2) {
+    if (strcmp(arg[iarg],"seed") == 0) {
+      seed_all = force->inumeric(FLERR,arg[iarg+1]);
+      if (seed_all <= 0 || seed_all > MAXSEED - universe->nprocs)
+        error->all(FLERR,"Illegal pair_style ssa_tsdpd/iwc command");
+    } else if (strcmp(arg[iarg],"diffusion") == 0) {
+      if (strcmp(arg[iarg+1],"ssa") == 0) dfsp_flag = 0;
+      else if (strcmp(arg[iarg+1],"dfsp") == 0) dfsp_flag = 1;
+      else error->all(FLERR,"Illegal pair_style ssa_tsdpd/iwc command");
+    } else error->all(FLERR,"Illegal pair_style ssa_tsdpd/iwc command");
+  }
 
+  seed = seed_all + universe->me;
+  SsaTsdpdRng::destroy_replicas(rep_random,nrep_random);
+  delete random;
+  random = new RanMars(lmp,seed);
+  nrep_random = atom->num_ssa_replicas;
+  rep_random = SsaTsdpdRng::create_replicas(lmp,random,seed,nrep_random);
 }
 
 /* ----------------------------------------------------------------------
@@ -912,3 +976,29 @@ double PairSsaTsdpdIwc::single(int i, int j, int itype, int jtype,
 
   return 0.0;
 }
+
+/* ---------------------------------------------------------------------- */
+
+void *PairSsaTsdpdIwc::extract(const char *str, int &dim) {
+  dim = 0;
+  if (strcmp(str,"random") == 0) return (void *) random;
+  dim = 1;
+  if (strcmp(str,"random_replicas") == 0) return (void *) rep_random;
+  if (strcmp(str,"soundspeed") == 0) return (void *) soundspeed;
+  if (strcmp(str,"rho0") == 0) return (void *) rho0;
+  dim = 2;
+  if (strcmp(str,"cut") == 0) return (void *) cut;
+  if (strcmp(str,"viscosity") == 0) return (void *) viscosity;
+  return NULL;
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of the per-step scratch block
+------------------------------------------------------------------------- */
+
+double PairSsaTsdpdIwc::memory_usage()
+{
+  double bytes = Pair::memory_usage();
+  bytes += scratch->memory_usage();
+  return bytes;
+}
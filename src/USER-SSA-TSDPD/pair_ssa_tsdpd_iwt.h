@@ -33,7 +33,11 @@ class PairSsaTsdpdIwt : public Pair {
   void coeff(int, char **);
   virtual double init_one(int, int);
   virtual double single(int, int, int, int, double, double, double, double &);
+  void *extract(const char *, int &);
+  double memory_usage();
   class RanMars *random;
+  class RanMars **rep_random;   // stream of each SSA replica, [0] = random
+  int nrep_random;
 
  protected:
   double *rho0, *soundspeed, *B;
@@ -43,6 +47,8 @@ class PairSsaTsdpdIwt : public Pair {
   double **cutc; //added
   int first;
   unsigned int seed;
+  int dfsp_flag;                    // 1 to diffuse Cd by DFSP, 0 by jumps
+  class SsaTsdpdScratch *scratch;   // per-step temporaries
 
   void allocate();
 };
@@ -31,9 +31,14 @@ class PairSsaTsdpdWc : public Pair {
   virtual void compute(int, int);
   void settings(int, char **);
   void coeff(int, char **);
+  virtual void init_style();
   virtual double init_one(int, int);
   virtual double single(int, int, int, int, double, double, double, double &);
+  void *extract(const char *, int &);
+  double memory_usage();
   class RanMars *random;
+  class RanMars **rep_random;   // stream of each SSA replica, [0] = random
+  int nrep_random;
 
  protected:
   double *rho0, *soundspeed, *B;
@@ -42,7 +47,10 @@ class PairSsaTsdpdWc : public Pair {
   double ***kappa; //added
   double **cutc; //added
   int first;
+  int shardlow_flag;   // 1 if fix ssa_tsdpd/shardlow integrates viscous/random terms
   unsigned int seed;
+  int dfsp_flag;                    // 1 to diffuse Cd by DFSP, 0 by jumps
+  class SsaTsdpdScratch *scratch;   // per-step temporaries
 
   void allocate();
 };
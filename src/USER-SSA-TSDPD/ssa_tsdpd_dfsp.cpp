@@ -0,0 +1,216 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include <math.h>
+#include "ssa_tsdpd_dfsp.h"
+#include "ssa_tsdpd_scratch.h"
+#include "ssa_tsdpd_stats.h"
+#include "random_mars.h"
+
+using namespace LAMMPS_NS;
+
+#define THETA 0.5       // largest rate * substep of the Taylor series
+#define TOLERANCE 1.0e-13
+#define MAXTERM 30
+#define BTRS_MEAN 10.0  // smallest n*p sampled by rejection
+
+/* ---------------------------------------------------------------------- */
+
+SsaTsdpdDfsp::SsaTsdpdDfsp(SsaTsdpdScratch *scratch_in,
+                           SsaTsdpdIndexSets *graph_in, double *D_in,
+                           double **kappa_in, int *back_in) :
+  scratch(scratch_in), graph(graph_in), D(D_in), kappa(kappa_in),
+  back(back_in), prob(NULL), term(NULL), next(NULL), rate_out(NULL),
+  rate_in(NULL), voxel(NULL), maxstar(0) {}
+
+/* ----------------------------------------------------------------------
+   move the molecules of species s of all replicas for one step of dt
+   columns q*nssa+s of Cd are read, the moves are added to Qd
+------------------------------------------------------------------------- */
+
+void SsaTsdpdDfsp::diffuse(int s, double dt, int inum, int *ilist,
+                           RanMars **rng, int nrep, SpeciesArray<int> &Cd,
+                           SpeciesArray<int> &Qd, SsaTsdpdStats *stats)
+{
+  int ii,i,it,n,q;
+  int nssa = Cd.ncol / nrep;
+
+  // work arrays for the largest star, valid until the next scratch reset
+
+  if (maxstar == 0) {
+    for (ii = 0; ii < inum; ii++) {
+      i = ilist[ii];
+      n = 1;
+      for (it = graph->head[i]; it >= 0; it = graph->next[it]) n++;
+      if (n > maxstar) maxstar = n;
+    }
+    prob = scratch->get<double>(maxstar);
+    term = scratch->get<double>(maxstar);
+    next = scratch->get<double>(maxstar);
+    rate_out = scratch->get<double>(maxstar);
+    rate_in = scratch->get<double>(maxstar);
+    voxel = scratch->get<int>(maxstar);
+  }
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    for (q = 0; q < nrep; q++)
+      if (Cd[i][q*nssa+s] > 0) break;
+    if (q == nrep) continue;
+
+    n = star(i,s,dt);
+
+    for (q = 0; q < nrep; q++) {
+      int c = q*nssa + s;
+      int left = Cd[i][c];
+      if (stats) stats->propensity(i,rate_out[0]*left);
+      if (left == 0) continue;
+
+      // multinomial draw as a chain of binomials over the neighbors,
+      //   the molecules left over stay in i
+
+      double pleft = 1.0;
+      int moved = 0;
+      for (int k = 1; k < n && left > 0 && pleft > 0.0; k++) {
+        int m;
+        if (prob[k] >= pleft) m = left;
+        else m = binomial(rng[q],left,prob[k]/pleft);
+        pleft -= prob[k];
+        if (m == 0) continue;
+        Qd[voxel[k]][c] += m;
+        left -= m;
+        moved += m;
+      }
+      Qd[i][c] -= moved;
+      if (stats && moved) stats->diffusion(i,s,moved);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   probabilities of a molecule of species s starting in voxel i to be in
+     voxel[k] of the star of i after dt, voxel[0] = i
+   p' = A p on the star: p0' = -a p0 + sum_k b_k pk, pk' = c_k p0 - b_k pk
+     with c_k the rate i -> k, b_k the rate k -> i and a = sum_k c_k
+   rate_out[0] = a, returns the # of voxels of the star
+------------------------------------------------------------------------- */
+
+int SsaTsdpdDfsp::star(int i, int s, double dt)
+{
+  int k,m,it;
+
+  int n = 1;
+  double a = 0.0;
+  double rmax = 0.0;
+  voxel[0] = i;
+  for (it = graph->head[i]; it >= 0; it = graph->next[it]) {
+    voxel[n] = graph->col[it];
+    rate_out[n] = kappa[it][s] * D[it];
+    rate_in[n] = kappa[back[it]][s] * D[back[it]];
+    a += rate_out[n];
+    if (rate_in[n] > rmax) rmax = rate_in[n];
+    n++;
+  }
+  rate_out[0] = a;
+  if (a > rmax) rmax = a;
+
+  prob[0] = 1.0;
+  for (k = 1; k < n; k++) prob[k] = 0.0;
+  if (rmax <= 0.0) return n;
+
+  // exp(dt A) in substeps short enough for the Taylor series to converge
+  //   fast, each term is (h A)^m p / m!
+
+  int nsub = static_cast<int> (ceil(dt*rmax/THETA));
+  if (nsub < 1) nsub = 1;
+  double h = dt/nsub;
+
+  for (int sub = 0; sub < nsub; sub++) {
+    for (k = 0; k < n; k++) term[k] = prob[k];
+    for (m = 1; m <= MAXTERM; m++) {
+      double hm = h/m;
+      double sum = -a*term[0];
+      for (k = 1; k < n; k++) sum += rate_in[k]*term[k];
+      next[0] = hm*sum;
+      double norm = fabs(next[0]);
+      for (k = 1; k < n; k++) {
+        next[k] = hm*(rate_out[k]*term[0] - rate_in[k]*term[k]);
+        norm += fabs(next[k]);
+      }
+      for (k = 0; k < n; k++) {
+        term[k] = next[k];
+        prob[k] += term[k];
+      }
+      if (norm < TOLERANCE) break;
+    }
+  }
+
+  // truncation leaves round-off sized negative entries
+
+  double total = 0.0;
+  for (k = 0; k < n; k++) {
+    if (prob[k] < 0.0) prob[k] = 0.0;
+    total += prob[k];
+  }
+  for (k = 0; k < n; k++) prob[k] /= total;
+
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   inversion for a small mean, else the BTRS transformed rejection of
+     Hormann (1993), J Stat Comput Simul 46, 101
+------------------------------------------------------------------------- */
+
+int SsaTsdpdDfsp::binomial(RanMars *rng, int n, double p)
+{
+  if (n <= 0 || p <= 0.0) return 0;
+  if (p >= 1.0) return n;
+  if (p > 0.5) return n - binomial(rng,n,1.0-p);
+
+  double q = 1.0 - p;
+
+  if (n*p < BTRS_MEAN) {
+    double ratio = p/q;
+    double f = exp(n*log1p(-p));
+    double u = rng->uniform();
+    int k = 0;
+    while (u > f && k < n) {
+      u -= f;
+      k++;
+      f *= ratio*(n-k+1)/k;
+    }
+    return k;
+  }
+
+  double spq = sqrt(n*p*q);
+  double b = 1.15 + 2.53*spq;
+  double a = -0.0873 + 0.0248*b + 0.01*p;
+  double c = n*p + 0.5;
+  double vr = 0.92 - 4.2/b;
+  double alpha = (2.83 + 5.1/b)*spq;
+  double lpq = log(p/q);
+  int mode = static_cast<int> ((n+1)*p);
+  double h = lgamma(mode+1.0) + lgamma(n-mode+1.0);
+
+  while (1) {
+    double u = rng->uniform() - 0.5;
+    double v = rng->uniform();
+    double us = 0.5 - fabs(u);
+    int k = static_cast<int> (floor((2.0*a/us + b)*u + c));
+    if (k < 0 || k > n) continue;
+    if (us >= 0.07 && v <= vr) return k;
+    v = log(v*alpha/(a/(us*us) + b));
+    if (v <= h - lgamma(k+1.0) - lgamma(n-k+1.0) + (k-mode)*lpq) return k;
+  }
+}
@@ -0,0 +1,35 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_SSA_TSDPD_PRECISION_H
+#define LMP_SSA_TSDPD_PRECISION_H
+
+// precision of the per-pair math in the SDPD pair styles
+// compile with -DSSA_TSDPD_MIXED (e.g. in LMP_INC of the machine makefile)
+//   to evaluate relative positions, kernel values, equation of state
+//   and random stress in single precision
+// per-atom quantities (f, drho, de, Q) are always accumulated in double
+
+namespace LAMMPS_NS {
+
+#ifdef SSA_TSDPD_MIXED
+typedef float sdpd_flt_t;
+#else
+typedef double sdpd_flt_t;
+#endif
+
+typedef double sdpd_acc_t;
+
+}
+
+#endif
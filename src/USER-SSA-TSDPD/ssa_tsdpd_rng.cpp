@@ -0,0 +1,113 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include <mpi.h>
+#include "ssa_tsdpd_rng.h"
+#include "lammps.h"
+#include "random_mars.h"
+#include "comm.h"
+#include "universe.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define MAXSEED 900000000
+
+/* ----------------------------------------------------------------------
+   a stream given as NULL is written as all zeroes, so that records of
+     one fix style always have the same layout
+------------------------------------------------------------------------- */
+
+void SsaTsdpdRng::write_restart(LAMMPS *lmp, FILE *fp,
+                                RanMars **streams, int nstream)
+{
+  int me = lmp->comm->me;
+  int nprocs = lmp->comm->nprocs;
+  int nstate = RanMars::size_state();
+  int nmine = nstream*nstate;
+
+  double *mine;
+  lmp->memory->create(mine,nmine,"ssa_tsdpd:rng_state");
+  for (int k = 0; k < nstream; k++) {
+    if (streams[k]) streams[k]->get_state(&mine[k*nstate]);
+    else for (int m = 0; m < nstate; m++) mine[k*nstate+m] = 0.0;
+  }
+
+  double *list = NULL;
+  bigint n = 2 + (bigint) nprocs*nmine;
+  if (me == 0) {
+    lmp->memory->create(list,n,"ssa_tsdpd:rng_list");
+    list[0] = nprocs;
+    list[1] = nstream;
+  }
+  MPI_Gather(mine,nmine,MPI_DOUBLE,me == 0 ? &list[2] : NULL,nmine,
+             MPI_DOUBLE,0,lmp->world);
+
+  bigint nbytes = n * (bigint) sizeof(double);
+  if (nbytes > MAXSMALLINT)
+    lmp->error->all(FLERR,"Too many random streams for restart file");
+
+  if (me == 0) {
+    int size = nbytes;
+    fwrite(&size,sizeof(int),1,fp);
+    fwrite(list,sizeof(double),n,fp);
+    lmp->memory->destroy(list);
+  }
+  lmp->memory->destroy(mine);
+}
+
+/* ----------------------------------------------------------------------
+   a zero state, i.e. i97 = 0, was a NULL stream when written and leaves
+     the stream as it is
+------------------------------------------------------------------------- */
+
+int SsaTsdpdRng::restart(LAMMPS *lmp, char *buf, RanMars **streams,
+                         int nstream)
+{
+  double *list = (double *) buf;
+  int nprocs = static_cast<int> (list[0]);
+  int nsaved = static_cast<int> (list[1]);
+  if (nprocs != lmp->comm->nprocs || nsaved != nstream) return 0;
+
+  int nstate = RanMars::size_state();
+  double *mine = &list[2 + (bigint) lmp->comm->me*nstream*nstate];
+  for (int k = 0; k < nstream; k++)
+    if (streams[k] && mine[k*nstate+97] != 0.0)
+      streams[k]->set_state(&mine[k*nstate]);
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   seeds beyond the range of RanMars wrap around to 1
+------------------------------------------------------------------------- */
+
+RanMars **SsaTsdpdRng::create_replicas(LAMMPS *lmp, RanMars *first,
+                                       int seed, int nrep)
+{
+  RanMars **streams = new RanMars*[nrep];
+  streams[0] = first;
+  bigint nprocs = lmp->universe->nprocs;
+  for (int q = 1; q < nrep; q++)
+    streams[q] = new RanMars(lmp,(seed - 1 + q*nprocs) % MAXSEED + 1);
+  return streams;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void SsaTsdpdRng::destroy_replicas(RanMars **streams, int nrep)
+{
+  if (streams == NULL) return;
+  for (int q = 1; q < nrep; q++) delete streams[q];
+  delete [] streams;
+}
@@ -0,0 +1,98 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_SSA_TSDPD_SCRATCH_H
+#define LMP_SSA_TSDPD_SCRATCH_H
+
+#include <string.h>
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+// temporaries of one compute() of an ssa_tsdpd pair style
+// get() hands out pieces of one block and reset() takes them all back,
+//   so a step does no allocation once the block has reached the largest
+//   demand of a step, set by atom->nmax and the # of neighbor pairs
+// a request that does not fit comes from an extra chunk, the next
+//   reset() frees the chunks and regrows the block to the peak demand
+
+class SsaTsdpdScratch : protected Pointers {
+ public:
+  SsaTsdpdScratch(class LAMMPS *);
+  ~SsaTsdpdScratch();
+  void reset();
+  double memory_usage();
+
+  // n uninitialized values, valid until the next reset()
+
+  template<class T> T *get(bigint n) {
+    return (T *) alloc(n*sizeof(T));
+  }
+  template<class T> T *zero(bigint n) {
+    T *ptr = get<T>(n);
+    memset(ptr,0,n*sizeof(T));
+    return ptr;
+  }
+
+ private:
+  char *block;          // reused memory
+  bigint size;          // bytes of block
+  bigint used;          // bytes of block handed out since reset()
+  bigint demand;        // bytes requested since reset()
+  char **extra;         // chunks that did not fit into block
+  int nextra,maxextra;
+  bigint extrabytes;
+
+  void *alloc(bigint);
+};
+
+// sorted sets of indices j of rows i = 0..n-1, kept in scratch memory
+// replaces an array of std::set<int> with the same iteration order:
+//   for (e = head[i]; e >= 0; e = next[e]) j = col[e];
+// insert() returns the entry e of (i,j), so values of the sparse matrix
+//   can be kept in parallel arrays indexed by e
+// init() needs an upper bound on the # of insert() calls of the step
+
+class SsaTsdpdIndexSets {
+ public:
+  int *head;            // first entry of row i, -1 if empty
+  int *next;            // next entry of the same row, -1 at the end
+  int *col;             // index j of an entry
+
+  SsaTsdpdIndexSets() : head(NULL), next(NULL), col(NULL), nentry(0) {}
+
+  void init(SsaTsdpdScratch *scratch, int nrow, bigint maxentry) {
+    head = scratch->get<int>(nrow);
+    next = scratch->get<int>(maxentry);
+    col = scratch->get<int>(maxentry);
+    for (int i = 0; i < nrow; i++) head[i] = -1;
+    nentry = 0;
+  }
+
+  int insert(int i, int j) {
+    int *link = &head[i];
+    while (*link >= 0 && col[*link] < j) link = &next[*link];
+    if (*link >= 0 && col[*link] == j) return *link;
+    col[nentry] = j;
+    next[nentry] = *link;
+    *link = nentry;
+    return nentry++;
+  }
+
+ private:
+  int nentry;
+};
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "ssa_tsdpd_stats.h"
+#include "atom.h"
+#include "update.h"
+#include "timer.h"
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+SsaTsdpdStats::SsaTsdpdStats(LAMMPS *lmp) : Pointers(lmp)
+{
+  step = -1;
+  nspecies = atom->num_ssa_species;
+  nreaction = atom->num_ssa_reactions;
+  nmax = 0;
+  events = a0 = NULL;
+  species_events = new double[nspecies+1];
+  reaction_events = new double[nreaction+1];
+  for (int s = 0; s < nspecies; s++) species_events[s] = 0.0;
+  for (int r = 0; r < nreaction; r++) reaction_events[r] = 0.0;
+  wall_start = 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+SsaTsdpdStats::~SsaTsdpdStats()
+{
+  memory->destroy(events);
+  memory->destroy(a0);
+  delete [] species_events;
+  delete [] reaction_events;
+}
+
+/* ----------------------------------------------------------------------
+   called by every SSA loop before it records anything
+   clears the counters on the first call of a timestep
+------------------------------------------------------------------------- */
+
+void SsaTsdpdStats::start()
+{
+  if (step == update->ntimestep) return;
+  step = update->ntimestep;
+
+  if (atom->nmax > nmax) {
+    nmax = atom->nmax;
+    memory->destroy(events);
+    memory->destroy(a0);
+    memory->create(events,nmax,"ssa_tsdpd/stats:events");
+    memory->create(a0,nmax,"ssa_tsdpd/stats:a0");
+  }
+
+  for (int i = 0; i < nmax; i++) events[i] = a0[i] = 0.0;
+  for (int s = 0; s < nspecies; s++) species_events[s] = 0.0;
+  for (int r = 0; r < nreaction; r++) reaction_events[r] = 0.0;
+
+  wall_start = timer->get_wall(Timer::SSA_DIFFUSION) +
+    timer->get_wall(Timer::SSA_REACTION);
+}
+
+/* ---------------------------------------------------------------------- */
+
+double SsaTsdpdStats::memory_usage()
+{
+  return 2.0 * nmax * sizeof(double);
+}
@@ -54,6 +54,68 @@ using namespace MathConst;
 
 enum{LAYOUT_UNIFORM,LAYOUT_NONUNIFORM,LAYOUT_TILED};    // several files
 
+// bin of the sort grid and its index along a space-filling curve
+
+struct SortKey {
+  bigint key;
+  int bin;
+};
+
+/* ----------------------------------------------------------------------
+   index of grid point c along a Z-order (Morton) or Hilbert curve
+   through a 2^nbits grid in ndim = 2 or 3 dimensions
+   Hilbert uses Skilling's transform of the coords into the transposed
+     index (AIP Conf. Proc. 707, 381 (2004)), Morton skips it
+   both then interleave the bits, most significant bit and x first
+------------------------------------------------------------------------- */
+
+static bigint curve_index(int *c, int ndim, int nbits, int hilbert)
+{
+  unsigned int x[3],p,q,t;
+  int d;
+
+  for (d = 0; d < ndim; d++) x[d] = c[d];
+
+  if (hilbert && nbits > 1) {
+    unsigned int mbit = 1U << (nbits-1);
+    for (q = mbit; q > 1; q >>= 1) {
+      p = q - 1;
+      for (d = 0; d < ndim; d++) {
+        if (x[d] & q) x[0] ^= p;
+        else {
+          t = (x[0] ^ x[d]) & p;
+          x[0] ^= t;
+          x[d] ^= t;
+        }
+      }
+    }
+    for (d = 1; d < ndim; d++) x[d] ^= x[d-1];
+    t = 0;
+    for (q = mbit; q > 1; q >>= 1)
+      if (x[ndim-1] & q) t ^= q - 1;
+    for (d = 0; d < ndim; d++) x[d] ^= t;
+  }
+
+  bigint key = 0;
+  for (int b = nbits-1; b >= 0; b--)
+    for (d = 0; d < ndim; d++)
+      key = (key << 1) | ((x[d] >> b) & 1U);
+  return key;
+}
+
+/* ----------------------------------------------------------------------
+   comparison function invoked by qsort() in setup_sort_order()
+------------------------------------------------------------------------- */
+
+static int compare_sortkey(const void *iptr, const void *jptr)
+{
+  bigint i = ((const SortKey *) iptr)->key;
+  bigint j = ((const SortKey *) jptr)->key;
+  if (i < j) return -1;
+  if (i > j) return 1;
+  return 0;
+}
+
 /* ---------------------------------------------------------------------- */
 
 Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
@@ -68,8 +130,12 @@ Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
   sortfreq = 1000;
   nextsort = 0;
   userbinsize = 0.0;
+  sortorder = SORT_BIN;
+  sortuser = 0;
   maxbin = maxnext = 0;
   binhead = NULL;
+  binorder = NULL;
+  binorderdim[0] = binorderdim[1] = binorderdim[2] = binorderdim[3] = -1;
   next = permute = NULL;
 
   // initialize atom arrays
@@ -79,14 +145,13 @@ Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
   type = mask = NULL;
   image = NULL;
   x = v = f = NULL;
-  C = Q = NULL;  //Concentration, Flux
-  Cd = Qd = NULL;  //Concentration (discrete), Flux (discrete)
+  species_layout = ATOM_MAJOR;  // layout of C, Q (Concentration, Flux)
+                                // and Cd, Qd (discrete)
+  num_ssa_replicas = 1;         // one SSA realization unless ensemble
   ssa_rxn_propensity = NULL; // SSA reaction propensities
   d_ssa_rxn_prop_d_c = NULL; // SSA reaction jacobian
   ssa_stoich_matrix = NULL; // SSA stoich matrix
-  dfsp_D_matrix = NULL;   
-  dfsp_D_diag = NULL;   
-  dfsp_Diffusion_coeff = NULL;   
+  ssa_stats = NULL; // SSA event counters, owned by compute ssa_tsdpd/ssa/stats
   modified_mass_type = 0; //modified mass species type (SDPD)
   modified_mass = 0.0; //modified mass (SDPD)
   concentration_conversion = 0.0; //concentration conversion ( [molecules] / [volumetric concentration units] )
@@ -260,6 +325,7 @@ Atom::~Atom()
 
   delete [] firstgroupname;
   memory->destroy(binhead);
+  memory->destroy(binorder);
   memory->destroy(next);
   memory->destroy(permute);
 
@@ -274,19 +340,15 @@ Atom::~Atom()
   memory->destroy(v);
   memory->destroy(f);
   
-  memory->destroy(C);  //added
-  memory->destroy(Q);  //added
+  C.destroy(memory);  //added
+  Q.destroy(memory);  //added
   
-  memory->destroy(Cd);  //added
-  memory->destroy(Qd);  //added
+  Cd.destroy(memory);  //added
+  Qd.destroy(memory);  //added
   
   memory->destroy(ssa_rxn_propensity); //added
   memory->destroy(d_ssa_rxn_prop_d_c); //added
   memory->destroy(ssa_stoich_matrix); //added
-  memory->destroy(dfsp_D_matrix); //added
-  memory->destroy(dfsp_D_diag); //added
-  memory->destroy(dfsp_Diffusion_coeff); //added
-  memory->destroy(dfsp_a_i); //added
 
   memory->destroy(Aetd); //added (ETD)
   memory->destroy(Betd); //added (ETD)
@@ -421,6 +483,8 @@ void Atom::settings(Atom *old)
   map_style = old->map_style;
   sortfreq = old->sortfreq;
   userbinsize = old->userbinsize;
+  sortorder = old->sortorder;
+  sortuser = old->sortuser;
   if (old->firstgroupname) {
     int n = strlen(old->firstgroupname) + 1;
     firstgroupname = new char[n];
@@ -649,7 +713,16 @@ void Atom::modify_params(int narg, char **arg)
       if (sortfreq >= 0 && firstgroupname)
         error->all(FLERR,"Atom_modify sort and first options "
                    "cannot be used together");
+      sortuser |= 1;
       iarg += 3;
+    } else if (strcmp(arg[iarg],"sort_order") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal atom_modify command");
+      if (strcmp(arg[iarg+1],"bin") == 0) sortorder = SORT_BIN;
+      else if (strcmp(arg[iarg+1],"morton") == 0) sortorder = SORT_MORTON;
+      else if (strcmp(arg[iarg+1],"hilbert") == 0) sortorder = SORT_HILBERT;
+      else error->all(FLERR,"Illegal atom_modify command");
+      sortuser |= 2;
+      iarg += 2;
     } else error->all(FLERR,"Illegal atom_modify command");
   }
 }
@@ -1840,15 +1913,23 @@ void Atom::sort()
   // permute = desired permutation of atoms
   // permute[I] = J means Ith new atom will be Jth old atom
 
+  // bins are visited in the order of binorder, see setup_sort_order()
+
   n = 0;
   for (m = 0; m < nbins; m++) {
-    i = binhead[m];
+    i = binhead[binorder[m]];
     while (i >= 0) {
       permute[n++] = i;
       i = next[i];
     }
   }
 
+  // an atom style that can apply the whole permutation to its arrays
+  // at once does so, only per-atom arrays of fixes are then left to move
+
+  int avecflag = avec->reorder(nlocal,permute);
+  if (avecflag && nextra_grow == 0) return;
+
   // current = current permutation, just reuse next vector
   // current[I] = J means Ith current atom is Jth old atom
 
@@ -1864,13 +1945,13 @@ void Atom::sort()
 
   for (i = 0; i < nlocal; i++) {
     if (current[i] == permute[i]) continue;
-    avec->copy(i,nlocal,0);
+    sort_copy(avecflag,i,nlocal);
     empty = i;
     while (permute[empty] != i) {
-      avec->copy(permute[empty],empty,0);
+      sort_copy(avecflag,permute[empty],empty);
       empty = current[empty] = permute[empty];
     }
-    avec->copy(nlocal,empty,0);
+    sort_copy(avecflag,nlocal,empty);
     current[empty] = permute[empty];
   }
 
@@ -1938,9 +2019,84 @@ void Atom::setup_sort_bins()
 
   if (nbins > maxbin) {
     memory->destroy(binhead);
+    memory->destroy(binorder);
     maxbin = nbins;
     memory->create(binhead,maxbin,"atom:binhead");
+    memory->create(binorder,maxbin,"atom:binorder");
+    binorderdim[3] = -1;
   }
+
+  setup_sort_order();
+}
+
+/* ----------------------------------------------------------------------
+   set binorder = order in which sort() visits the bins
+   SORT_BIN = row-major with x fastest
+   SORT_MORTON, SORT_HILBERT = position of each bin along a Z-order or
+     Hilbert curve through the smallest 2^b grid that holds all bins,
+     atoms close in memory are then close in space in every dimension,
+     Hilbert without the long jumps of Z-order
+   only recomputed when the bin grid or the order changes
+------------------------------------------------------------------------- */
+
+void Atom::setup_sort_order()
+{
+  if (binorderdim[0] == nbinx && binorderdim[1] == nbiny &&
+      binorderdim[2] == nbinz && binorderdim[3] == sortorder) return;
+
+  binorderdim[0] = nbinx;
+  binorderdim[1] = nbiny;
+  binorderdim[2] = nbinz;
+  binorderdim[3] = sortorder;
+
+  if (sortorder == SORT_BIN) {
+    for (int m = 0; m < nbins; m++) binorder[m] = m;
+    return;
+  }
+
+  int ndim = domain->dimension;
+  int nbinmax = MAX(nbinx,nbiny);
+  nbinmax = MAX(nbinmax,nbinz);
+  int nbits = 0;
+  while ((1 << nbits) < nbinmax) nbits++;
+  if (ndim*nbits > 62)
+    error->one(FLERR,"Atom sorting order along a space-filling curve "
+               "needs too many bits");
+
+  SortKey *keys = (SortKey *)
+    memory->smalloc(nbins*sizeof(SortKey),"atom:sortkeys");
+
+  int m,ix,iy,iz;
+  int c[3];
+  for (iz = 0; iz < nbinz; iz++)
+    for (iy = 0; iy < nbiny; iy++)
+      for (ix = 0; ix < nbinx; ix++) {
+        m = iz*nbiny*nbinx + iy*nbinx + ix;
+        c[0] = ix;
+        c[1] = iy;
+        c[2] = iz;
+        keys[m].key = curve_index(c,ndim,nbits,sortorder == SORT_HILBERT);
+        keys[m].bin = m;
+      }
+
+  qsort(keys,nbins,sizeof(SortKey),compare_sortkey);
+  for (m = 0; m < nbins; m++) binorder[m] = keys[m].bin;
+  memory->sfree(keys);
+}
+
+/* ----------------------------------------------------------------------
+   move atom I to J during sort()
+   avecflag = 1 if the atom style has already reordered its own arrays
+------------------------------------------------------------------------- */
+
+void Atom::sort_copy(int avecflag, int i, int j)
+{
+  if (!avecflag) {
+    avec->copy(i,j,0);
+    return;
+  }
+  for (int iextra = 0; iextra < nextra_grow; iextra++)
+    modify->fix[extra_grow[iextra]]->copy_arrays(i,j,0);
 }
 
 /* ----------------------------------------------------------------------
@@ -2190,9 +2346,50 @@ void *Atom::extract(char *name)
 
   if (strcmp(name,"dpdTheta") == 0) return (void *) dpdTheta;
 
+  // species arrays return their first datum, see extract_species()
+
+  if (strcmp(name,"C") == 0) return (void *) C.data;
+  if (strcmp(name,"Q") == 0) return (void *) Q.data;
+  if (strcmp(name,"Cd") == 0) return (void *) Cd.data;
+  if (strcmp(name,"Qd") == 0) return (void *) Qd.data;
+  if (strcmp(name,"ssa_rxn_propensity") == 0)
+    return (void *) ssa_rxn_propensity;
+
   return NULL;
 }
 
+/* ----------------------------------------------------------------------
+   extract a per-atom, per-species array without copying it
+   returns ptr to its first datum, NULL if name is not C, Q, Cd, Qd
+     or the array is not allocated
+   type = 0 for int (Cd,Qd), 1 for double (C,Q)
+   dims = # of rows, # of species, atom stride, species stride
+     value of atom i and species k is ptr[i*dims[2] + k*dims[3]]
+     strides depend on species_layout and on the # of rows of the array
+------------------------------------------------------------------------- */
+
+void *Atom::extract_species(const char *name, int *type, int *dims)
+{
+  void *ptr;
+
+  if (strcmp(name,"C") == 0) {
+    *type = 1;
+    ptr = species_dims(C,dims);
+  } else if (strcmp(name,"Q") == 0) {
+    *type = 1;
+    ptr = species_dims(Q,dims);
+  } else if (strcmp(name,"Cd") == 0) {
+    *type = 0;
+    ptr = species_dims(Cd,dims);
+  } else if (strcmp(name,"Qd") == 0) {
+    *type = 0;
+    ptr = species_dims(Qd,dims);
+  } else return NULL;
+
+  if (dims[1] == 0) return NULL;
+  return ptr;
+}
+
 /* ----------------------------------------------------------------------
    return # of bytes of allocated memory
    call to avec tallies per-atom vectors
@@ -15,6 +15,7 @@
 #define LMP_ATOM_H
 
 #include "pointers.h"
+#include "species_array.h"
 #include <map>
 #include <string>
 
@@ -67,13 +68,15 @@ class Atom : protected Pointers {
 
 
   // USER-SSA-TDPD package
-  double **C, **Q;     // added (C = concentration, Q = source term)
-  int **Cd, **Qd;   // added (Cd = discrete concentration, Qd = discrete source term)
+  SpeciesArray<double> C, Q;     // added (C = concentration, Q = source term)
+  SpeciesArray<int> Cd, Qd;   // added (Cd = discrete concentration, Qd = discrete source term)
+  int species_layout;  // ATOM_MAJOR or SPECIES_MAJOR storage of C, Q, Cd, Qd
   double **ssa_rxn_propensity, ***d_ssa_rxn_prop_d_c;  // SSA reaction propensities, SSA reaction jacobian
   int ***ssa_stoich_matrix; // SSA reaction species change matrix
   double **Aetd, **Betd, **Cetd; // added (for exponential time differencing)  
   int num_tdpd_species, num_ssa_species, num_ssa_reactions; //added for SSA
-  double *dfsp_D_matrix, *dfsp_D_diag, *dfsp_Diffusion_coeff, *dfsp_a_i; //added for SSA
+  int num_ssa_replicas;    // SSA realizations of Cd, Qd per atom, ensemble keyword
+  class SsaTsdpdStats *ssa_stats;  // SSA event counters, set by compute ssa_tsdpd/ssa/stats
   double modified_mass; //added (modified mass in SDPD)
   int modified_mass_type; //added (modified mass in SDPD)
   double concentration_conversion; //added (to convert C to Cd in SDPD) 
@@ -209,9 +212,13 @@ class Atom : protected Pointers {
 
   // spatial sorting of atoms
 
+  enum{SORT_BIN,SORT_MORTON,SORT_HILBERT};
+
   int sortfreq;             // sort atoms every this many steps, 0 = off
   bigint nextsort;          // next timestep to sort on
   double userbinsize;       // requested sort bin size
+  int sortorder;            // order of the bins, SORT_BIN/MORTON/HILBERT
+  int sortuser;             // bits set by atom_modify sort 1, sort_order 2
 
   // indices of atoms with same ID
 
@@ -284,6 +291,7 @@ class Atom : protected Pointers {
   virtual void sync_modify(ExecutionSpace, unsigned int, unsigned int) {}
 
   void *extract(char *);
+  void *extract_species(const char *, int *, int *);
 
   inline int* get_map_array() {return map_array;};
   inline int get_map_size() {return map_tag_max+1;};
@@ -337,6 +345,8 @@ class Atom : protected Pointers {
   int maxbin;                     // max # of bins
   int maxnext;                    // max size of next,permute
   int *binhead;                   // 1st atom in each bin
+  int *binorder;                  // bins in the order atoms are stored
+  int binorderdim[4];             // nbinx,nbiny,nbinz,order of binorder
   int *next;                      // next atom in bin
   int *permute;                   // permutation vector
   double bininvx,bininvy,bininvz; // inverse actual bin sizes
@@ -346,10 +356,19 @@ class Atom : protected Pointers {
   char *memstr;                   // string of array names already counted
 
   void setup_sort_bins();
+  void setup_sort_order();
+  void sort_copy(int, int, int);
   int next_prime(int);
 
  private:
   template <typename T> static AtomVec *avec_creator(LAMMPS *);
+
+  template <typename T> static void *species_dims(SpeciesArray<T> &a,
+                                                  int *dims) {
+    dims[0] = a.nrow; dims[1] = a.ncol;
+    dims[2] = a.astride; dims[3] = a.sstride;
+    return (void *) a.data;
+  }
 };
 
 }
@@ -519,6 +538,12 @@ be set in the data file or by the mass command before running a
 simulation.  They must also be set before using the velocity
 command.
 
+E: Atom sorting order along a space-filling curve needs too many bits
+
+The sub-domain has so many sorting bins in one dimension that the
+Morton or Hilbert index does not fit in 64 bits.  Use a larger bin
+size in the atom_modify sort command or atom_modify sort_order bin.
+
 E: Reuse of molecule template ID
 
 The template IDs must be unique.
@@ -86,4 +86,11 @@
 #define VEST_MASK      0x00200000
 #define CV_MASK        0x00400000
 
+// SSA-tDPD
+
+#define TDPD_C_MASK    0x00800000
+#define TDPD_Q_MASK    0x01000000
+#define SSA_CD_MASK    0x02000000
+#define SSA_QD_MASK    0x04000000
+
 #endif
@@ -59,6 +59,7 @@ class AtomVec : protected Pointers {
   virtual void grow(int) = 0;
   virtual void grow_reset() = 0;
   virtual void copy(int, int, int) = 0;
+  virtual int reorder(int, int *) {return 0;}
   virtual void clear_bonus() {}
   virtual void force_clear(int, size_t) {}
 
@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+// Per-particle mean and sample variance of the SSA species over the
+// replicas of atom_style ssa_tsdpd ... ensemble R, at the current step.
+// The replicas share the trajectory of the particle, so the moments are
+// those of the chemistry conditioned on one hydrodynamic realization.
+//
+// Example:
+//atom_style ssa_tsdpd 0 2 1 ensemble 16
+//...
+//compute  ens  all  ssa_tsdpd/cd/ensemble  cd concentration
+//dump     d    all  custom 100 ens.txt id x y c_ens[1] c_ens[2] c_ens[3] c_ens[4]
+//
+// Keywords:
+//   cd population/concentration  = units of Cd (default as in atom_style)
+// Per-atom array, per SSA species: mean, variance (0 for one replica).
+
+#include <string.h>
+#include "compute_ssa_tsdpd_cd_ensemble.h"
+#include "atom.h"
+#include "update.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+ComputeSsaTsdpdCdEnsemble::ComputeSsaTsdpdCdEnsemble(LAMMPS *lmp, int narg,
+                                                     char **arg) :
+  Compute(lmp, narg, arg), moments(NULL)
+{
+  if (atom->tsdpd_flag != 1)
+    error->all(FLERR,"Compute ssa_tsdpd/cd/ensemble requires "
+               "atom_style ssa_tsdpd");
+  if (atom->num_ssa_species == 0)
+    error->all(FLERR,"Compute ssa_tsdpd/cd/ensemble requires SSA species");
+
+  cdconc = atom->Cd_concentration_flag;
+  int iarg = 3;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"cd") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal compute ssa_tsdpd/cd/ensemble command");
+      if (strcmp(arg[iarg+1],"concentration") == 0) cdconc = 1;
+      else if (strcmp(arg[iarg+1],"population") == 0) cdconc = 0;
+      else error->all(FLERR,"Illegal compute ssa_tsdpd/cd/ensemble command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal compute ssa_tsdpd/cd/ensemble command");
+  }
+
+  peratom_flag = 1;
+  size_peratom_cols = 2*atom->num_ssa_species;
+
+  nmax = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+ComputeSsaTsdpdCdEnsemble::~ComputeSsaTsdpdCdEnsemble()
+{
+  memory->destroy(moments);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeSsaTsdpdCdEnsemble::compute_peratom()
+{
+  invoked_peratom = update->ntimestep;
+
+  if (atom->nmax > nmax) {
+    memory->destroy(moments);
+    nmax = atom->nmax;
+    memory->create(moments,nmax,size_peratom_cols,
+                   "ssa_tsdpd/cd/ensemble:moments");
+    array_atom = moments;
+  }
+
+  SpeciesArray<int> Cd = atom->Cd;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int nssa = atom->num_ssa_species;
+  int nrep = atom->num_ssa_replicas;
+
+  for (int i = 0; i < nlocal; i++) {
+    double *m = moments[i];
+    if (!(mask[i] & groupbit)) {
+      for (int s = 0; s < size_peratom_cols; s++) m[s] = 0.0;
+      continue;
+    }
+    double scale = cdconc ? rho[i] / mass[type[i]] : 1.0;
+    for (int s = 0; s < nssa; s++) {
+      double sum = 0.0;
+      for (int q = 0; q < nrep; q++) sum += Cd[i][q*nssa+s];
+      double mean = sum/nrep;
+      double var = 0.0;
+      for (int q = 0; q < nrep; q++) {
+        double del = Cd[i][q*nssa+s] - mean;
+        var += del*del;
+      }
+      m[2*s] = mean*scale;
+      m[2*s+1] = nrep > 1 ? var/(nrep-1)*scale*scale : 0.0;
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double ComputeSsaTsdpdCdEnsemble::memory_usage()
+{
+  return (double) nmax*size_peratom_cols*sizeof(double);
+}
@@ -0,0 +1,62 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef COMPUTE_CLASS
+
+ComputeStyle(ssa_tsdpd/cd/ensemble,ComputeSsaTsdpdCdEnsemble)
+
+#else
+
+#ifndef LMP_COMPUTE_SSA_TSDPD_CD_ENSEMBLE_H
+#define LMP_COMPUTE_SSA_TSDPD_CD_ENSEMBLE_H
+
+#include "compute.h"
+
+namespace LAMMPS_NS {
+
+class ComputeSsaTsdpdCdEnsemble : public Compute {
+ public:
+  ComputeSsaTsdpdCdEnsemble(class LAMMPS *, int, char **);
+  ~ComputeSsaTsdpdCdEnsemble();
+  void init() {}
+  void compute_peratom();
+  double memory_usage();
+
+ private:
+  int nmax;
+  int cdconc;           // 1 to convert populations to concentrations
+  double **moments;     // per atom: mean and variance of each SSA species
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Compute ssa_tsdpd/cd/ensemble requires atom_style ssa_tsdpd
+
+The replicas of the SSA species are stored by this atom style.
+
+E: Compute ssa_tsdpd/cd/ensemble requires SSA species
+
+The atom style defines no SSA species to average.
+
+*/
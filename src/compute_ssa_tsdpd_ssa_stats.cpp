@@ -0,0 +1,159 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+// Event counts and propensities of the SSA diffusion (pair styles) and
+// SSA reaction (fix ssa_tsdpd/verlet) loops during the last timestep.
+//
+// Example:
+//#        label   group        style
+//compute  ssa      all   ssa_tsdpd/ssa/stats
+//thermo_style custom step c_ssa[1] c_ssa[2] c_ssa[3] c_ssa[4] c_ssa[5]
+//dump     ev all custom 1000 ev.txt id x y c_ssa[1] c_ssa[2]
+//
+// Global vector: jumps per SSA species, firings per SSA reaction, total
+// propensity a0, max # of events of one voxel, SSA wall time of the step
+// (max over procs, needs timer normal or full).
+// Per-atom array: # of events (jumps out of + reactions in the voxel), a0.
+
+#include <string.h>
+#include "compute_ssa_tsdpd_ssa_stats.h"
+#include "ssa_tsdpd_stats.h"
+#include "atom.h"
+#include "update.h"
+#include "comm.h"
+#include "timer.h"
+#include "lammps.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+ComputeSsaTsdpdSsaStats::ComputeSsaTsdpdSsaStats(LAMMPS *lmp, int narg,
+                                                 char **arg) :
+  Compute(lmp, narg, arg), stats(NULL), peratom(NULL)
+{
+  if (atom->tsdpd_flag != 1)
+    error->all(FLERR,"Compute ssa_tsdpd/ssa/stats requires atom_style ssa_tsdpd");
+  if (narg != 3) error->all(FLERR,"Illegal compute ssa_tsdpd/ssa/stats command");
+  if (atom->ssa_stats)
+    error->all(FLERR,"Only one compute ssa_tsdpd/ssa/stats can be defined");
+
+  nspecies = atom->num_ssa_species;
+  nreaction = atom->num_ssa_reactions;
+
+  vector_flag = 1;
+  size_vector = nspecies + nreaction + 3;
+  extvector = 0;
+  peratom_flag = 1;
+  size_peratom_cols = 2;
+
+  vector = new double[size_vector];
+
+  stats = new SsaTsdpdStats(lmp);
+  atom->ssa_stats = stats;
+
+  nmax = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+ComputeSsaTsdpdSsaStats::~ComputeSsaTsdpdSsaStats()
+{
+  if (atom->ssa_stats == stats) atom->ssa_stats = NULL;
+  delete stats;
+  delete [] vector;
+  memory->destroy(peratom);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeSsaTsdpdSsaStats::init()
+{
+  if (lmp->kokkos && comm->me == 0)
+    error->warning(FLERR,"Compute ssa_tsdpd/ssa/stats does not count "
+                   "events of KOKKOS styles");
+}
+
+/* ----------------------------------------------------------------------
+   counters are zero if no SSA loop ran in the current step
+------------------------------------------------------------------------- */
+
+void ComputeSsaTsdpdSsaStats::compute_vector()
+{
+  invoked_vector = update->ntimestep;
+
+  int current = (stats->step == update->ntimestep);
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int n = nspecies + nreaction;
+
+  double *local = new double[n+1];
+  for (int m = 0; m <= n; m++) local[m] = 0.0;
+  double vmax = 0.0, wall = 0.0;
+
+  if (current) {
+    for (int s = 0; s < nspecies; s++) local[s] = stats->species_events[s];
+    for (int r = 0; r < nreaction; r++)
+      local[nspecies+r] = stats->reaction_events[r];
+    for (int i = 0; i < nlocal; i++) {
+      if (!(mask[i] & groupbit)) continue;
+      local[n] += stats->a0[i];
+      if (stats->events[i] > vmax) vmax = stats->events[i];
+    }
+    wall = timer->get_wall(Timer::SSA_DIFFUSION) +
+      timer->get_wall(Timer::SSA_REACTION) - stats->wall_start;
+    if (wall < 0.0) wall = 0.0;
+  }
+
+  MPI_Allreduce(local,vector,n+1,MPI_DOUBLE,MPI_SUM,world);
+  MPI_Allreduce(&vmax,&vector[n+1],1,MPI_DOUBLE,MPI_MAX,world);
+  MPI_Allreduce(&wall,&vector[n+2],1,MPI_DOUBLE,MPI_MAX,world);
+
+  delete [] local;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeSsaTsdpdSsaStats::compute_peratom()
+{
+  invoked_peratom = update->ntimestep;
+
+  if (atom->nmax > nmax) {
+    memory->destroy(peratom);
+    nmax = atom->nmax;
+    memory->create(peratom,nmax,2,"ssa_tsdpd/ssa/stats:peratom");
+    array_atom = peratom;
+  }
+
+  int current = (stats->step == update->ntimestep);
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  for (int i = 0; i < nlocal; i++) {
+    if (current && (mask[i] & groupbit)) {
+      peratom[i][0] = stats->events[i];
+      peratom[i][1] = stats->a0[i];
+    } else peratom[i][0] = peratom[i][1] = 0.0;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double ComputeSsaTsdpdSsaStats::memory_usage()
+{
+  double bytes = (double) nmax*2 * sizeof(double);
+  bytes += stats->memory_usage();
+  return bytes;
+}
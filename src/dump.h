@@ -41,6 +41,7 @@ class Dump : protected Pointers {
   virtual ~Dump();
   void init();
   virtual void write();
+  virtual void post_run() {}
 
   virtual int pack_forward_comm(int, int *, double *, int, int *) {return 0;}
   virtual void unpack_forward_comm(int, int, double *) {}
@@ -21,6 +21,7 @@ DumpStyle(ssa_tsdpd,DumpSsaTsdpd)
 #define DUMP_SSA_TSDPD_H
 
 #include "dump.h"
+#include "dump_ssa_tsdpd_async.h"
 
 namespace LAMMPS_NS {
 
@@ -28,6 +29,8 @@ class DumpSsaTsdpd : public Dump {
  public:
   DumpSsaTsdpd(class LAMMPS *, int, char **);
   virtual ~DumpSsaTsdpd();
+  virtual void write();
+  virtual void post_run();
 
  protected:
   int nevery;                // dump frequency for output
@@ -90,6 +93,13 @@ class DumpSsaTsdpd : public Dump {
   int ntypes;                // # of atom types
   char **typenames;          // array of element names for each type
 
+  int async_flag;            // 1 if an i/o thread writes the snapshots
+  int async_depth;           // max # of snapshots queued for i/o thread
+  class DumpSsaTsdpdAsync *async;  // queue on filewriter procs, else NULL
+  char *hbuf;                // header staged for the i/o thread
+  int nhbuf,maxhbuf;         // # of bytes in hbuf and its size
+  int hstage;                // 1 if header functions write to hbuf
+
   // private methods
 
   virtual void init_style();
@@ -107,12 +117,21 @@ class DumpSsaTsdpd : public Dump {
   int add_custom(char *, int);
   virtual int modify_param(int, char **);
 
+  void init_async();
+  int modify_param_async(int, char **);
+  virtual void write_async();
+  virtual void write_job(DumpSsaTsdpdAsync::Job *);
+  static void async_callback(void *, DumpSsaTsdpdAsync::Job *);
+
   typedef void (DumpSsaTsdpd::*FnPtrHeader)(bigint);
   FnPtrHeader header_choice;           // ptr to write header functions
   void header_binary(bigint);
   void header_binary_triclinic(bigint);
   void header_item(bigint);
   void header_item_triclinic(bigint);
+  void header_write(const void *, int);
+  void header_printf(const char *, ...);
+  void grow_header(int);
 
   typedef int (DumpSsaTsdpd::*FnPtrConvert)(int, double *);
   FnPtrConvert convert_choice;          // ptr to convert data functions
@@ -169,6 +188,8 @@ class DumpSsaTsdpd : public Dump {
 
   void pack_C(int); //added
   void pack_Cd(int); //added
+  void pack_Cdmean(int);
+  void pack_Cdvar(int);
 
   void pack_vx(int);
   void pack_vy(int);
@@ -379,4 +400,14 @@ E: Invalid dump_modify threshold operator
 
 Operator keyword used for threshold specification in not recognized.
 
+W: Dump_modify async needs -DSSA_TSDPD_ASYNC, snapshots are written synchronously
+
+LAMMPS was built without the i/o thread, the async keyword has no
+effect.
+
+E: Cannot stage dump header
+
+A line of the snapshot header handed to the i/o thread could not be
+formatted.
+
 */
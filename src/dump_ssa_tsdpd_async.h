@@ -0,0 +1,79 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_DUMP_SSA_TSDPD_ASYNC_H
+#define LMP_DUMP_SSA_TSDPD_ASYNC_H
+
+#include <stdio.h>
+#include "pointers.h"
+
+#if defined(SSA_TSDPD_ASYNC)
+#include <pthread.h>
+#endif
+
+// prototype for c wrapper that runs the i/o thread
+extern "C" void *dump_ssa_tsdpd_async_worker(void *);
+
+namespace LAMMPS_NS {
+
+// bounded queue of staged dump snapshots written by a separate i/o thread
+// a dump fills a slot on its filewriter proc and submits it,
+//   the i/o thread formats and writes it while the run continues
+// without -DSSA_TSDPD_ASYNC a submitted slot is written right away
+
+class DumpSsaTsdpdAsync : protected Pointers {
+ public:
+  struct Job {
+    bigint ntimestep;          // timestep of snapshot
+    bigint n;                  // # of bytes or atoms in data
+    double box[24];            // box bounds or corners of snapshot
+    FILE *fp;                  // file to write data to, NULL if none
+    int closeflag;             // 0 = keep fp open, 1 = fclose, 2 = pclose
+    int flushflag;             // 1 = fflush fp after writing
+    bigint nbytes;             // # of bytes of data in use
+    bigint maxbytes;           // allocated size of data
+    char *data;                // staged snapshot
+  };
+
+  typedef void (*FnPtrJob)(void *, Job *);
+
+  DumpSsaTsdpdAsync(class LAMMPS *, FnPtrJob, void *, int);
+  ~DumpSsaTsdpdAsync();
+
+  Job *acquire();                         // wait for a free slot
+  void append(Job *, const void *, bigint);  // add bytes to acquired slot
+  void submit();                          // queue the acquired slot
+  void flush();                           // wait until queue is empty
+  void run();                             // i/o thread loop
+  bigint memory_usage();
+
+ private:
+  FnPtrJob callback;         // writes one slot
+  void *ptr;                 // passed to callback
+  int depth;                 // # of slots
+  Job *jobs;
+  int head;                  // oldest queued slot
+  int nqueued;               // # of queued or in-progress slots
+  int quit;                  // 1 when i/o thread should exit
+
+#if defined(SSA_TSDPD_ASYNC)
+  pthread_mutex_t mutex;
+  pthread_cond_t cond_work;  // signalled when a slot is queued
+  pthread_cond_t cond_free;  // signalled when a slot is written
+  pthread_t iothread;
+#endif
+};
+
+}
+
+#endif
@@ -0,0 +1,405 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dump_ssa_tsdpd_col.h"
+#include "domain.h"
+#include "update.h"
+#include "memory.h"
+#include "error.h"
+
+#if defined(SSA_TSDPD_ZLIB)
+#include <zlib.h>
+#endif
+
+using namespace LAMMPS_NS;
+
+enum{INT,DOUBLE,STRING,BIGINT};    // same as in DumpSsaTsdpd
+enum{RAW,FAST,ZLIB};
+
+// on-disk field types and codecs, see tools/ssa_tsdpd_col/README
+
+enum{COL_INT32,COL_INT64,COL_FLOAT32,COL_FLOAT64};
+enum{COL_RAW,COL_VARINT,COL_XOR,COL_SHUFFLE};
+#define COL_DEFLATE 16
+
+#define COL_VERSION 1
+#define FRAMEHEAD 16
+#define FRAMETAIL 16
+#define INDEXHEAD 104
+#define INDEXFIELD 24
+
+static const char *magic_file = "SSACOL01";
+static const char *magic_frame = "FRM1";
+static const char *magic_index = "IDX1";
+
+/* ---------------------------------------------------------------------- */
+
+static unsigned char *put(unsigned char *p, const void *src, int n)
+{
+  memcpy(p,src,n);
+  return p + n;
+}
+
+/* ---------------------------------------------------------------------- */
+
+DumpSsaTsdpdCol::DumpSsaTsdpdCol(LAMMPS *lmp, int narg, char **arg) :
+  DumpSsaTsdpd(lmp, narg, arg), fname(NULL), ftype(NULL), fcodec(NULL),
+  foffset(NULL), fbytes(NULL), rows(NULL), frame(NULL), scratch(NULL)
+{
+  if (compressed)
+    error->all(FLERR,"Dump ssa_tsdpd/col cannot write compressed files");
+
+  buffer_allow = 0;
+  buffer_flag = 0;
+
+  // earg is not kept after the constructor
+
+  fname = new char*[nfield];
+  for (int i = 0; i < nfield; i++) {
+    if (vtype[i] == STRING)
+      error->all(FLERR,"Dump ssa_tsdpd/col does not support the element field");
+    fname[i] = new char[strlen(earg[i])+1];
+    strcpy(fname[i],earg[i]);
+  }
+
+  ftype = new int[nfield];
+  fcodec = new int[nfield];
+  foffset = new bigint[nfield];
+  fbytes = new bigint[nfield];
+
+#if defined(SSA_TSDPD_ZLIB)
+  codec = ZLIB;
+#else
+  codec = FAST;
+#endif
+  single = 0;
+
+  nwrite = 0;
+  nrows = maxrows = 0;
+  nframe = maxframe = 0;
+  maxscratch = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+DumpSsaTsdpdCol::~DumpSsaTsdpdCol()
+{
+  for (int i = 0; i < nfield; i++) delete [] fname[i];
+  delete [] fname;
+  delete [] ftype;
+  delete [] fcodec;
+  delete [] foffset;
+  delete [] fbytes;
+  memory->sfree(rows);
+  memory->sfree(frame);
+  memory->sfree(scratch);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpSsaTsdpdCol::init_style()
+{
+  if (async_flag)
+    error->all(FLERR,"Dump ssa_tsdpd/col does not support dump_modify async");
+
+  DumpSsaTsdpd::init_style();
+}
+
+/* ----------------------------------------------------------------------
+   open file as usual, new files start with the file header
+   file header = magic, int32 1 to check byte order, int32 version,
+     int32 nfield, then int32 type, int32 length and name of each field,
+     zero padded to a multiple of 8 bytes
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdCol::openfile()
+{
+  Dump::openfile();
+  if (!filewriter || fp == NULL) return;
+
+  fseek(fp,0,SEEK_END);
+  if (ftell(fp) > 0) return;
+
+  int one = 1;
+  int version = COL_VERSION;
+  char zero[8] = {0,0,0,0,0,0,0,0};
+
+  fwrite(magic_file,sizeof(char),8,fp);
+  fwrite(&one,sizeof(int),1,fp);
+  fwrite(&version,sizeof(int),1,fp);
+  fwrite(&nfield,sizeof(int),1,fp);
+  bigint nbytes = 20;
+
+  for (int i = 0; i < nfield; i++) {
+    int type;
+    if (vtype[i] == INT) type = COL_INT32;
+    else if (vtype[i] == BIGINT) type = COL_INT64;
+    else type = single ? COL_FLOAT32 : COL_FLOAT64;
+    int n = strlen(fname[i]);
+    fwrite(&type,sizeof(int),1,fp);
+    fwrite(&n,sizeof(int),1,fp);
+    fwrite(fname[i],sizeof(char),n,fp);
+    nbytes += 8 + n;
+  }
+
+  if (nbytes % 8) fwrite(zero,sizeof(char),8 - nbytes % 8,fp);
+}
+
+/* ----------------------------------------------------------------------
+   start staging a new frame of NDUMP rows
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdCol::write_header(bigint ndump)
+{
+  if (ndump*size_one > maxrows) {
+    maxrows = ndump*size_one;
+    rows = (double *)
+      memory->srealloc(rows,maxrows*sizeof(double),"dump:rows");
+  }
+  nrows = 0;
+  nwrite = 0;
+}
+
+/* ----------------------------------------------------------------------
+   stage rows of one proc, encode and write the frame after the last one
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdCol::write_data(int n, double *mybuf)
+{
+  if (n) memcpy(&rows[nrows*size_one],mybuf,(bigint) n*size_one*sizeof(double));
+  nrows += n;
+  if (++nwrite == nclusterprocs) write_frame();
+}
+
+/* ----------------------------------------------------------------------
+   encode all fields of the staged rows into one frame and write it
+   frame = "FRM1", uint32 0, uint64 frame size, 8-byte aligned chunks,
+     index, uint64 index offset, "IDX1", uint32 0
+   index = int64 timestep, int64 # of atoms, int32 triclinic, int32 nfield,
+     9 doubles xlo xhi ylo yhi zlo zhi xy xz yz, double time,
+     then uint64 offset, uint64 size, int32 codec, int32 type per field
+   all offsets are relative to the start of the frame
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdCol::write_frame()
+{
+  grow_frame(FRAMEHEAD);
+  nframe = FRAMEHEAD;
+
+  for (int k = 0; k < nfield; k++) encode_field(k);
+
+  bigint indexoffset = nframe;
+  grow_frame(nframe + INDEXHEAD + INDEXFIELD*nfield + FRAMETAIL);
+
+  int triclinic = domain->triclinic;
+  double box[10];
+  box[0] = boxxlo; box[1] = boxxhi;
+  box[2] = boxylo; box[3] = boxyhi;
+  box[4] = boxzlo; box[5] = boxzhi;
+  box[6] = triclinic ? boxxy : 0.0;
+  box[7] = triclinic ? boxxz : 0.0;
+  box[8] = triclinic ? boxyz : 0.0;
+  box[9] = update->atime + (update->ntimestep - update->atimestep)*update->dt;
+
+  int64_t i64 = update->ntimestep;
+  int zero = 0;
+  unsigned char *p = &frame[nframe];
+  p = put(p,&i64,8);
+  i64 = nrows;
+  p = put(p,&i64,8);
+  p = put(p,&triclinic,4);
+  p = put(p,&nfield,4);
+  p = put(p,box,10*sizeof(double));
+
+  for (int k = 0; k < nfield; k++) {
+    uint64_t u64 = foffset[k];
+    p = put(p,&u64,8);
+    u64 = fbytes[k];
+    p = put(p,&u64,8);
+    p = put(p,&fcodec[k],4);
+    p = put(p,&ftype[k],4);
+  }
+
+  uint64_t u64 = indexoffset;
+  p = put(p,&u64,8);
+  p = put(p,magic_index,4);
+  p = put(p,&zero,4);
+  nframe = p - frame;
+
+  p = frame;
+  p = put(p,magic_frame,4);
+  p = put(p,&zero,4);
+  u64 = nframe;
+  p = put(p,&u64,8);
+
+  fwrite(frame,sizeof(unsigned char),nframe,fp);
+}
+
+/* ----------------------------------------------------------------------
+   append chunk of field K to frame
+   COL_VARINT = zigzag deltas to previous row as LEB128 varints
+   COL_XOR = values XORed with previous row, first a byte per row with
+     the # of nonzero low bytes, then those bytes, lowest first
+   COL_SHUFFLE = byte 0 of all rows, then byte 1, etc
+   COL_DEFLATE = result passed through zlib compress()
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdCol::encode_field(int k)
+{
+  bigint i;
+  int j;
+
+  if (vtype[k] == INT) ftype[k] = COL_INT32;
+  else if (vtype[k] == BIGINT) ftype[k] = COL_INT64;
+  else ftype[k] = single ? COL_FLOAT32 : COL_FLOAT64;
+
+  int integer = (ftype[k] == COL_INT32 || ftype[k] == COL_INT64);
+  int w = (ftype[k] == COL_INT32 || ftype[k] == COL_FLOAT32) ? 4 : 8;
+
+  if (codec == RAW) fcodec[k] = COL_RAW;
+  else if (codec == FAST) fcodec[k] = integer ? COL_VARINT : COL_XOR;
+  else fcodec[k] = (integer ? COL_VARINT : COL_SHUFFLE) | COL_DEFLATE;
+  int base = fcodec[k] & ~COL_DEFLATE;
+
+  // column values as unsigned bits, so encoding does not depend on byte order
+
+  grow_scratch(nrows*10);
+  unsigned char *s = (base == COL_XOR) ? &scratch[nrows] : scratch;
+  uint64_t bits,prev = 0;
+
+  for (i = 0; i < nrows; i++) {
+    double value = rows[i*size_one+k];
+    if (integer) {
+      int64_t ivalue = static_cast<int64_t> (value);
+      bits = (uint64_t) ivalue;
+      if (w == 4) bits &= 0xffffffffULL;
+    } else if (w == 4) {
+      float fvalue = value;
+      uint32_t b32;
+      memcpy(&b32,&fvalue,4);
+      bits = b32;
+    } else memcpy(&bits,&value,8);
+
+    if (base == COL_RAW || base == COL_SHUFFLE) {
+      if (base == COL_RAW) {
+        for (j = 0; j < w; j++) *s++ = (bits >> 8*j) & 0xff;
+      } else {
+        for (j = 0; j < w; j++) scratch[j*nrows+i] = (bits >> 8*j) & 0xff;
+      }
+
+    } else if (base == COL_VARINT) {
+      int64_t ivalue = static_cast<int64_t> (value);
+      int64_t delta = ivalue - (int64_t) prev;
+      prev = (uint64_t) ivalue;
+      uint64_t z = ((uint64_t) delta << 1) ^ (uint64_t) (delta >> 63);
+      while (z >= 0x80) {
+        *s++ = (z & 0x7f) | 0x80;
+        z >>= 7;
+      }
+      *s++ = z;
+
+    } else {
+      uint64_t x = bits ^ prev;
+      prev = bits;
+      int c = 0;
+      for (uint64_t y = x; y; y >>= 8) c++;
+      scratch[i] = c;
+      for (j = 0; j < c; j++) *s++ = (x >> 8*j) & 0xff;
+    }
+  }
+
+  bigint len;
+  if (base == COL_SHUFFLE) len = nrows*w;
+  else len = s - scratch;
+
+  foffset[k] = nframe;
+
+  if (fcodec[k] & COL_DEFLATE) {
+#if defined(SSA_TSDPD_ZLIB)
+    uLongf nz = compressBound(len);
+    grow_frame(nframe + nz + 8);
+    if (compress(&frame[nframe],&nz,scratch,len) != Z_OK)
+      error->one(FLERR,"Cannot compress dump ssa_tsdpd/col field");
+    len = nz;
+#endif
+  } else {
+    grow_frame(nframe + len + 8);
+    memcpy(&frame[nframe],scratch,len);
+  }
+
+  fbytes[k] = len;
+  nframe += len;
+  while (nframe % 8) frame[nframe++] = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpSsaTsdpdCol::grow_frame(bigint n)
+{
+  if (n <= maxframe) return;
+  maxframe = n + n/4;
+  frame = (unsigned char *)
+    memory->srealloc(frame,maxframe,"dump:frame");
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpSsaTsdpdCol::grow_scratch(bigint n)
+{
+  if (n <= maxscratch) return;
+  maxscratch = n;
+  memory->sfree(scratch);
+  scratch = (unsigned char *) memory->smalloc(maxscratch,"dump:scratch");
+}
+
+/* ---------------------------------------------------------------------- */
+
+int DumpSsaTsdpdCol::modify_param(int narg, char **arg)
+{
+  if (strcmp(arg[0],"codec") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    if (strcmp(arg[1],"raw") == 0) codec = RAW;
+    else if (strcmp(arg[1],"fast") == 0) codec = FAST;
+    else if (strcmp(arg[1],"zlib") == 0) {
+#if defined(SSA_TSDPD_ZLIB)
+      codec = ZLIB;
+#else
+      error->all(FLERR,"Dump_modify codec zlib requires -DSSA_TSDPD_ZLIB");
+#endif
+    } else error->all(FLERR,"Illegal dump_modify command");
+    return 2;
+  }
+
+  if (strcmp(arg[0],"precision") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    if (strcmp(arg[1],"single") == 0) single = 1;
+    else if (strcmp(arg[1],"double") == 0) single = 0;
+    else error->all(FLERR,"Illegal dump_modify command");
+    return 2;
+  }
+
+  return DumpSsaTsdpd::modify_param(narg,arg);
+}
+
+/* ---------------------------------------------------------------------- */
+
+bigint DumpSsaTsdpdCol::memory_usage()
+{
+  bigint bytes = DumpSsaTsdpd::memory_usage();
+  bytes += maxrows * sizeof(double);
+  bytes += maxframe + maxscratch;
+  return bytes;
+}
@@ -168,7 +168,11 @@ DumpSsaTsdpdVTK::DumpSsaTsdpdVTK(LAMMPS *lmp, int narg, char **arg) :
 
 DumpSsaTsdpdVTK::~DumpSsaTsdpdVTK()
 {
-	
+  // i/o thread may still use the vtk containers and filenames
+
+  delete async;
+  async = NULL;
+
   delete [] filecurrent;
   delete [] domainfilecurrent;
   delete [] parallelfilecurrent;
@@ -248,8 +252,8 @@ void DumpSsaTsdpdVTK::init_style()
     if (iregion == -1)
       error->all(FLERR,"Region ID for dump custom/vtk does not exist");
   }
-  
 
+  init_async();
 }
 
 /* ---------------------------------------------------------------------- */
@@ -268,9 +272,6 @@ void DumpSsaTsdpdVTK::header_vtk(bigint)
 
 int DumpSsaTsdpdVTK::count()
 {
-	
-  n_calls_ = 0;
-
   int i;
   ;
   // grow choose and variable vbuf arrays if needed
@@ -823,7 +824,14 @@ int DumpSsaTsdpdVTK::count()
 
 void DumpSsaTsdpdVTK::write()
 {
-	
+  if (async_flag) {
+    write_async();
+    return;
+  }
+
+  snapstep = update->ntimestep;
+  n_calls_ = 0;
+
   // simulation box bounds
 
   if (domain->triclinic == 0) {
@@ -919,6 +927,106 @@ void DumpSsaTsdpdVTK::write()
   
 }
 
+/* ----------------------------------------------------------------------
+   same as write(), but the filewriter copies the data of its cluster
+     and the box of this snapshot into a slot of the async queue
+   building the vtk arrays and writing the files is left to the i/o thread
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdVTK::write_async()
+{
+  nme = count();
+
+  bigint bnme = nme;
+  MPI_Allreduce(&bnme,&ntotal,1,MPI_LMP_BIGINT,MPI_SUM,world);
+
+  int nmax;
+  if (multiproc != nprocs) MPI_Allreduce(&nme,&nmax,1,MPI_INT,MPI_MAX,world);
+  else nmax = nme;
+
+  if (nmax > maxbuf) {
+    if ((bigint) nmax * size_one > MAXSMALLINT)
+      error->all(FLERR,"Too much per-proc info for dump");
+    maxbuf = nmax;
+    memory->destroy(buf);
+    memory->create(buf,maxbuf*size_one,"dump:buf");
+  }
+
+  if (sort_flag && sortcol == 0 && nmax > maxids) {
+    maxids = nmax;
+    memory->destroy(ids);
+    memory->create(ids,maxids,"dump:ids");
+  }
+
+  if (sort_flag && sortcol == 0) pack(ids);
+  else pack(NULL);
+  if (sort_flag) sort();
+
+  int tmp,nlines;
+  MPI_Status status;
+  MPI_Request request;
+
+  if (filewriter) {
+    DumpSsaTsdpdAsync::Job *job = async->acquire();
+
+    for (int iproc = 0; iproc < nclusterprocs; iproc++) {
+      if (iproc) {
+        MPI_Irecv(buf,maxbuf*size_one,MPI_DOUBLE,me+iproc,0,world,&request);
+        MPI_Send(&tmp,0,MPI_INT,me+iproc,0,world);
+        MPI_Wait(&request,&status);
+        MPI_Get_count(&status,MPI_DOUBLE,&nlines);
+        nlines /= size_one;
+      } else nlines = nme;
+
+      async->append(job,buf,(bigint) nlines*size_one*sizeof(double));
+      job->n += nlines;
+    }
+
+    job->ntimestep = update->ntimestep;
+    if (domain->triclinic == 0) {
+      job->box[0] = domain->boxlo[0];
+      job->box[1] = domain->boxhi[0];
+      job->box[2] = domain->boxlo[1];
+      job->box[3] = domain->boxhi[1];
+      job->box[4] = domain->boxlo[2];
+      job->box[5] = domain->boxhi[2];
+    } else {
+      domain->box_corners();
+      memcpy(job->box,&domain->corners[0][0],24*sizeof(double));
+    }
+    async->submit();
+
+  } else {
+    MPI_Recv(&tmp,0,MPI_INT,fileproc,0,world,&status);
+    MPI_Rsend(buf,nme*size_one,MPI_DOUBLE,fileproc,0,world);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   called by the i/o thread, write one staged snapshot
+   the main thread does not touch the box, filename and vtk container
+     members while async output is on, so the i/o thread owns them
+------------------------------------------------------------------------- */
+
+void DumpSsaTsdpdVTK::write_job(DumpSsaTsdpdAsync::Job *job)
+{
+  snapstep = job->ntimestep;
+
+  if (domain->triclinic == 0) {
+    boxxlo = job->box[0];
+    boxxhi = job->box[1];
+    boxylo = job->box[2];
+    boxyhi = job->box[3];
+    boxzlo = job->box[4];
+    boxzhi = job->box[5];
+  } else boxcorners = (double (*)[3]) job->box;
+
+  // all data of the cluster arrives as one chunk
+
+  n_calls_ = nclusterprocs - 1;
+  write_data((int) job->n,(double *) job->data);
+}
+
 /* ---------------------------------------------------------------------- */
 
 void DumpSsaTsdpdVTK::pack(tagint *ids)
@@ -984,12 +1092,12 @@ void DumpSsaTsdpdVTK::setFileCurrent() {
     *ptr = '\0';
     if (padflag == 0) {
       sprintf(filecurrent,"%s" BIGINT_FORMAT "%s",
-              filestar,update->ntimestep,ptr+1);
+              filestar,snapstep,ptr+1);
     } else {
       char bif[8],pad[16];
       strcpy(bif,BIGINT_FORMAT);
       sprintf(pad,"%%s%%0%d%s%%s",padflag,&bif[1]);
-      sprintf(filecurrent,pad,filestar,update->ntimestep,ptr+1);
+      sprintf(filecurrent,pad,filestar,snapstep,ptr+1);
     }
     *ptr = '*';
   }
@@ -1021,12 +1129,12 @@ void DumpSsaTsdpdVTK::setFileCurrent() {
       *ptr = '\0';
       if (padflag == 0) {
         sprintf(domainfilecurrent,"%s" BIGINT_FORMAT "%s",
-                filestar,update->ntimestep,ptr+1);
+                filestar,snapstep,ptr+1);
       } else {
         char bif[8],pad[16];
         strcpy(bif,BIGINT_FORMAT);
         sprintf(pad,"%%s%%0%d%s%%s",padflag,&bif[1]);
-        sprintf(domainfilecurrent,pad,filestar,update->ntimestep,ptr+1);
+        sprintf(domainfilecurrent,pad,filestar,snapstep,ptr+1);
       }
       *ptr = '*';
     }
@@ -1069,12 +1177,12 @@ void DumpSsaTsdpdVTK::setFileCurrent() {
       *ptr = '\0';
       if (padflag == 0) {
         sprintf(parallelfilecurrent,"%s" BIGINT_FORMAT "%s",
-                filestar,update->ntimestep,ptr+1);
+                filestar,snapstep,ptr+1);
       } else {
         char bif[8],pad[16];
         strcpy(bif,BIGINT_FORMAT);
         sprintf(pad,"%%s%%0%d%s%%s",padflag,&bif[1]);
-        sprintf(parallelfilecurrent,pad,filestar,update->ntimestep,ptr+1);
+        sprintf(parallelfilecurrent,pad,filestar,snapstep,ptr+1);
       }
       *ptr = '*';
     }
@@ -1808,7 +1916,7 @@ int DumpSsaTsdpdVTK::parse_fields(int narg, char **arg)
       if (ptr) {
         if (suffix[strlen(suffix)-1] != ']')
           error->all(FLERR,"Invalid attribute in dump ssa_tsdpd/vtk command");
-	if (atoi(ptr+1) > atom->num_ssa_species - 1)
+	if (atoi(ptr+1) > atom->Cd.ncol - 1)
 	  error->all(FLERR,"Argument in Cd_[] is greater than the number of SSA species");
         argindex[i] = atoi(ptr+1);
         *ptr = '\0';
@@ -2129,6 +2237,9 @@ int DumpSsaTsdpdVTK::add_custom(char *id, int flag)
 
 int DumpSsaTsdpdVTK::modify_param(int narg, char **arg)
 {
+  int n = modify_param_async(narg,arg);
+  if (n) return n;
+
   if (strcmp(arg[0],"region") == 0) {
     if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
     if (strcmp(arg[1],"none") == 0) iregion = -1;
@@ -2509,7 +2620,7 @@ void DumpSsaTsdpdVTK::pack_custom(int n)
 //added
 void DumpSsaTsdpdVTK::pack_C(int n)
 {
-  double **C = atom->C;
+  SpeciesArray<double> C = atom->C;
   int index = argindex[current_pack_choice_key];
   
   for (int i = 0; i < nchoose; i++){
@@ -2523,7 +2634,7 @@ void DumpSsaTsdpdVTK::pack_C(int n)
 //added
 void DumpSsaTsdpdVTK::pack_Cd(int n)
 {
-  int **Cd = atom->Cd;
+  SpeciesArray<int> Cd = atom->Cd;
   int index = argindex[current_pack_choice_key];
   double *mass = atom->mass;
   double *rho = atom->rho;
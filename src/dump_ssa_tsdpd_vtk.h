@@ -117,12 +117,15 @@ class DumpSsaTsdpdVTK : public DumpSsaTsdpd {
 
   int n_calls_;
   double (*boxcorners)[3]; // corners of triclinic domain box
+  bigint snapstep;         // timestep of snapshot being written
   char *filecurrent;
   char *domainfilecurrent;
   char *parallelfilecurrent;
   char *multiname_ex;
 
   void setFileCurrent();
+  virtual void write_async();
+  virtual void write_job(DumpSsaTsdpdAsync::Job *);
   void buf2arrays(int, double *); // transfer data from buf array to vtk arrays
   void reset_vtk_data_containers();
 
@@ -521,6 +521,45 @@ void Finish::end(int flag)
       if (screen) fprintf(screen,fmt,time,time/time_loop*100.0);
       if (logfile) fprintf(logfile,fmt,time,time/time_loop*100.0);
     }
+
+    // SSA and tDPD sub-sections, already included in Pair and Modify
+    // only printed if any of them was stamped on any proc
+    // the pair styles fuse tDPD transport into the SDPD force loop and only
+    // run it as a separate pass with timer full, so tDPD needs timer full
+
+    time = timer->get_wall(Timer::SDPD_FORCE) +
+      timer->get_wall(Timer::TDPD_TRANSPORT) +
+      timer->get_wall(Timer::SSA_DIFFUSION) +
+      timer->get_wall(Timer::SSA_REACTION);
+    MPI_Allreduce(&time,&tmp,1,MPI_DOUBLE,MPI_MAX,world);
+
+    if (tmp > 0.0) {
+      const char *hdr;
+      if (timer->has_full())
+        hdr = "\nSSA/tDPD breakdown (included in Pair and Modify):\n"
+          "Section |  min time  |  avg time  |  max time  "
+          "|%varavg|  %CPU | %total\n"
+          "-----------------------------------------------"
+          "------------------------\n";
+      else
+        hdr = "\nSSA/tDPD breakdown (included in Pair and Modify):\n"
+          "Section |  min time  |  avg time  |  max time  |%varavg| %total\n"
+          "---------------------------------------------------------------\n";
+      if (me == 0) {
+        if (screen)  fputs(hdr,screen);
+        if (logfile) fputs(hdr,logfile);
+      }
+
+      mpi_timings("SDPD",timer,Timer::SDPD_FORCE,world,nprocs,
+                  nthreads,me,time_loop,screen,logfile);
+      if (timer->has_full())
+        mpi_timings("tDPD",timer,Timer::TDPD_TRANSPORT,world,nprocs,
+                    nthreads,me,time_loop,screen,logfile);
+      mpi_timings("SSA diff",timer,Timer::SSA_DIFFUSION,world,nprocs,
+                  nthreads,me,time_loop,screen,logfile);
+      mpi_timings("SSA rxn",timer,Timer::SSA_REACTION,world,nprocs,
+                  nthreads,me,time_loop,screen,logfile);
+    }
   }
 
 #ifdef LMP_USER_OMP
@@ -682,14 +682,15 @@ void FixAveChunk::end_of_step()
     // Added (Kernel interpolation of velocity and concentration)
 
     } else if (which[m] == V_K || which[m] == C_K ) {
-      double **attribute;
+      SpeciesArray<double> attribute;
       double **x = atom->x;
       double **v = atom->v;
       int ncoord_c = cchunk->ncoord;
       double **coord_c = cchunk->coord;
       double xtmp,ytmp,ztmp,delx,dely,delz,r,wrx,wry,wrz,wr;
  
-      if (which[m] == V_K) attribute = atom->v;
+      if (which[m] == V_K)
+        attribute.wrap(atom->v ? atom->v[0] : NULL,atom->nmax,3,3);
       else attribute = atom->C;
 
       for (i = 0; i < nlocal; i++)
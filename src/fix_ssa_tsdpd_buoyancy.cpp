@@ -116,8 +116,8 @@ void FixSsaTsdpdBuoyancy::post_force(int vflag)
   int *type = atom->type;
   double *mass = atom->mass;
   double *rho = atom->rho;
-  double **C = atom->C;
-  int **Cd = atom->Cd;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<int> Cd = atom->Cd;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
@@ -128,7 +128,12 @@ void FixSsaTsdpdBuoyancy::post_force(int vflag)
         f[i][rank_coordinate] += mass[type[i]]* acceleration * (C[i][rank_buoyancy] - C_ref);
       }
       else if (boussinesq_ssa_flag == 1) {
-        f[i][rank_coordinate] += mass[type[i]]* acceleration * (Cd[i][rank_buoyancy] / atom->concentration_conversion / mass[type[i]]- C_ref) ;
+        // the replicas share one flow, which feels their mean
+        double cd = 0.0;
+        for (int k = rank_buoyancy; k < Cd.ncol; k += atom->num_ssa_species)
+          cd += Cd[i][k];
+        cd /= atom->num_ssa_replicas;
+        f[i][rank_coordinate] += mass[type[i]]* acceleration * (cd / atom->concentration_conversion / mass[type[i]]- C_ref) ;
       }
       else if (gravity_flag == 1) {
         f[i][rank_coordinate] += mass[type[i]]* acceleration;
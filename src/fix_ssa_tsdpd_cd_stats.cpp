@@ -0,0 +1,135 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+#include "fix_ssa_tsdpd_cd_stats.h"
+#include "atom.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+/* ----------------------------------------------------------------------
+   syntax: id group SSA_TSDPD_CD_STATS peratom 1 nvalues nevery
+   the fields are passed afterwards by set_fields()
+------------------------------------------------------------------------- */
+
+FixSsaTsdpdCdStats::FixSsaTsdpdCdStats(LAMMPS *lmp, int narg, char **arg) :
+  FixStore(lmp, 6, arg), which(NULL), argindex(NULL)
+{
+  if (narg != 7) error->all(FLERR,"Illegal fix SSA_TSDPD_CD_STATS command");
+
+  nevery = force->inumeric(FLERR,arg[6]);
+  if (nevery <= 0) error->all(FLERR,"Illegal fix SSA_TSDPD_CD_STATS command");
+
+  create_attribute = 1;
+  nfield = 0;
+  nhist = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdCdStats::~FixSsaTsdpdCdStats()
+{
+  delete [] which;
+  delete [] argindex;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdCdStats::setmask()
+{
+  int mask = 0;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdCdStats::set_fields(int n, int *kind, int *index, int conc,
+                                    int nbin, double lo, double hi)
+{
+  delete [] which;
+  delete [] argindex;
+  nfield = n;
+  which = new int[n];
+  argindex = new int[n];
+  for (int m = 0; m < n; m++) {
+    which[m] = kind[m];
+    argindex[m] = index[m];
+  }
+  cdconc = conc;
+  nhist = nbin;
+  hlo = lo;
+  hinv = nbin ? nbin/(hi-lo) : 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   one Welford update of every field of every atom in the group
+   astore[i] = count, then per field mean, M2 and histogram counts
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdCdStats::end_of_step()
+{
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<int> Cd = atom->Cd;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int w = width();
+
+  for (int i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit)) continue;
+    double *s = astore[i];
+    double n = s[0] += 1.0;
+    double ninv = 1.0/n;
+
+    for (int m = 0; m < nfield; m++) {
+      int k = argindex[m];
+      double value;
+      if (which[m] == CONC) value = C[i][k];
+      else {
+        value = Cd[i][k];
+        if (cdconc) value *= rho[i] / mass[type[i]];
+      }
+
+      double *f = &s[1 + m*w];
+      double delta = value - f[0];
+      f[0] += delta*ninv;
+      f[1] += delta*(value - f[0]);
+
+      if (nhist) {
+        // values outside the range are counted in the first and last bin
+        double b = (value - hlo)*hinv;
+        int ibin = 0;
+        if (b >= nhist) ibin = nhist-1;
+        else if (b > 0.0) ibin = static_cast<int> (b);
+        f[2+ibin] += 1.0;
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   atoms created during the run start with empty statistics
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdCdStats::set_arrays(int i)
+{
+  for (int j = 0; j < nvalues; j++) astore[i][j] = 0.0;
+}
@@ -0,0 +1,64 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(SSA_TSDPD_CD_STATS,FixSsaTsdpdCdStats)
+
+#else
+
+#ifndef LMP_FIX_SSA_TSDPD_CD_STATS_H
+#define LMP_FIX_SSA_TSDPD_CD_STATS_H
+
+#include "fix_store.h"
+
+namespace LAMMPS_NS {
+
+// per-atom Welford accumulators of compute ssa_tsdpd/cd/stats
+// created by the compute, the FixStore base carries the accumulators
+//   with the atoms through exchange and restart files
+
+class FixSsaTsdpdCdStats : public FixStore {
+ public:
+  enum{CONC,DISCRETE};
+
+  FixSsaTsdpdCdStats(class LAMMPS *, int, char **);
+  ~FixSsaTsdpdCdStats();
+  int setmask();
+  void end_of_step();
+  void set_arrays(int);
+
+  void set_fields(int, int *, int *, int, int, double, double);
+  int width() const { return 2 + nhist; }   // values per field
+
+ private:
+  int nfield;
+  int *which,*argindex;
+  int cdconc;                // 1 to sample Cd as concentration
+  int nhist;                 // # of histogram bins per field, 0 if none
+  double hlo,hinv;           // histogram lower bound and bins per unit
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal fix SSA_TSDPD_CD_STATS command
+
+This fix is created by compute ssa_tsdpd/cd/stats and should not be
+defined in an input script.
+
+*/
@@ -0,0 +1,54 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(ssa_tsdpd/dt/reset,FixSsaTsdpdDtReset)
+
+#else
+
+#ifndef LMP_FIX_SSA_TSDPD_DT_RESET_H
+#define LMP_FIX_SSA_TSDPD_DT_RESET_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixSsaTsdpdDtReset : public Fix {
+ public:
+  FixSsaTsdpdDtReset(class LAMMPS *, int, char **);
+  ~FixSsaTsdpdDtReset() {}
+  int setmask();
+  void init();
+  void setup(int);
+  void end_of_step();
+  double compute_scalar();
+  double compute_vector(int);
+
+ private:
+  bigint laststep;
+  int minbound,maxbound;
+  double tmin,tmax;
+  double cfl_factor,visc_factor,force_factor; // safety factors of the three criteria
+  double dtlimit[3];                          // last CFL, viscous and force limits
+  double *soundspeed;                         // per-type sound speed of the pair style
+  double **cut,**viscosity;                   // per-pair smoothing length and viscosity
+  double ftm2v;
+  double dt;
+  int respaflag;
+};
+
+}
+
+#endif
+#endif
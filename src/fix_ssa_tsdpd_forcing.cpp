@@ -137,9 +137,9 @@ void FixSsaTsdpdForcing::post_integrate()
   int nlocal = atom->nlocal;
   double **x = atom->x;
   double **v = atom->v;
-  double **C = atom->C;
-  double **Q = atom->Q;
-  int **Cd = atom->Cd;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<int> Cd = atom->Cd;
+  int nssa = atom->num_ssa_species;   // stride between replicas of ctype
 
   if (igroup == atom->firstgroup) nlocal = atom->nfirst;
 
@@ -155,7 +155,8 @@ void FixSsaTsdpdForcing::post_integrate()
 		    rsq = drx*drx + dry*dry;
 		    if(rsq < radius_sq) {
 			if (tsdpd_case==1) C[i][ctype] = value;
-			if (ssa_case==1) Cd[i][ctype] = value_int;
+			if (ssa_case==1)
+			  for (int k = ctype; k < Cd.ncol; k += nssa) Cd[i][k] = value_int;
 			if (velocity_case==1) v[i][vtype] = value;
                         
 		    }
@@ -165,7 +166,8 @@ void FixSsaTsdpdForcing::post_integrate()
 		    dry = x[i][1] - center[1];
 		    if(fabs(drx) < length && fabs(dry) < width){
 			if (tsdpd_case==1) C[i][ctype] = value; 
-			if (ssa_case==1) Cd[i][ctype] = value_int;
+			if (ssa_case==1)
+			  for (int k = ctype; k < Cd.ncol; k += nssa) Cd[i][k] = value_int;
 			if (velocity_case==1) v[i][vtype] = value;
 		    }
 		}
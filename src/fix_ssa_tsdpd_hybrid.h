@@ -0,0 +1,88 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(ssa_tsdpd/hybrid,FixSsaTsdpdHybrid)
+
+#else
+
+#ifndef LMP_FIX_SSA_TSDPD_HYBRID_H
+#define LMP_FIX_SSA_TSDPD_HYBRID_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixSsaTsdpdHybrid : public Fix {
+ public:
+  FixSsaTsdpdHybrid(class LAMMPS *, int, char **);
+  ~FixSsaTsdpdHybrid();
+  int setmask();
+  void setup(int);
+  void end_of_step();
+  double compute_vector(int);
+  double memory_usage();
+
+  void grow_arrays(int);
+  void copy_arrays(int, int, int);
+  void set_arrays(int);
+  int pack_exchange(int, double *);
+  int unpack_exchange(int, double *);
+  int pack_restart(int, double *);
+  void unpack_restart(int, int);
+  int size_restart(int);
+  int maxsize_restart();
+
+ private:
+  double nlow,nhigh;           // switch to SSA below nlow, to tDPD above nhigh
+  int npair;
+  int *cindex,*sindex;         // tDPD and SSA species of each pair
+  double **mode;               // per atom and pair: DISCRETE, CONTINUOUS
+                               //   or UNSET before the first switch
+  double *ndiscrete;           // # of atoms in the group with SSA species
+
+  void repartition();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal fix ssa_tsdpd/hybrid command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.
+
+E: Fix ssa_tsdpd/hybrid requires atom_style ssa_tsdpd
+
+The C and Cd species are stored by this atom style.
+
+E: Fix ssa_tsdpd/hybrid requires ensemble 1
+
+Replicas of the SSA species have no single continuous counterpart.
+
+E: Fix ssa_tsdpd/hybrid species index is out of range
+
+Each pair is a tDPD species index and an SSA species index, starting
+at 0.
+
+E: Fix ssa_tsdpd/hybrid thresholds are invalid
+
+The lower copy number must not exceed the upper one, and the upper one
+must fit into the integer populations of Cd.
+
+*/
@@ -0,0 +1,703 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+// Pressure projection for the incompressible pair style ssa_tsdpd/isph
+// (Cummins & Rudman, 1999). After the pair forces (viscous + thermal
+// fluctuations, no EOS) are known, the end-of-step velocity predicted by
+// fix ssa_tsdpd/verlet is made divergence-free by solving the pressure
+// Poisson equation on the particle graph and adding the pressure force.
+//
+// Example:
+//#    label   group         style              [tol T] [maxiter N] [solver cg/bicgstab]
+//fix  proj    all   ssa_tsdpd/isph/projection   tol 1e-6 maxiter 500 solver cg
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fix_ssa_tsdpd_isph_projection.h"
+#include "atom.h"
+#include "comm.h"
+#include "domain.h"
+#include "force.h"
+#include "pair.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "neigh_request.h"
+#include "update.h"
+#include "ssa_tsdpd_kernel.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+enum{CG,BICGSTAB};
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdIsphProjection::FixSsaTsdpdIsphProjection(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if (atom->rho_flag != 1)
+    error->all(FLERR,
+        "fix ssa_tsdpd/isph/projection command requires atom_style with density, e.g. ssa_tsdpd");
+
+  tolerance = 1.0e-6;
+  maxiter = 500;
+  solver = CG;
+
+  int iarg = 3;
+  while (iarg < narg) {
+    if (iarg+2 > narg) error->all(FLERR,"Illegal fix ssa_tsdpd/isph/projection command");
+    if (strcmp(arg[iarg],"tol") == 0) {
+      tolerance = force->numeric(FLERR,arg[iarg+1]);
+      if (tolerance <= 0.0) error->all(FLERR,"Illegal fix ssa_tsdpd/isph/projection command");
+    } else if (strcmp(arg[iarg],"maxiter") == 0) {
+      maxiter = force->inumeric(FLERR,arg[iarg+1]);
+      if (maxiter <= 0) error->all(FLERR,"Illegal fix ssa_tsdpd/isph/projection command");
+    } else if (strcmp(arg[iarg],"solver") == 0) {
+      if (strcmp(arg[iarg+1],"cg") == 0) solver = CG;
+      else if (strcmp(arg[iarg+1],"bicgstab") == 0) solver = BICGSTAB;
+      else error->all(FLERR,"Illegal fix ssa_tsdpd/isph/projection command");
+    } else error->all(FLERR,"Illegal fix ssa_tsdpd/isph/projection command");
+    iarg += 2;
+  }
+
+  vector_flag = 1;
+  size_vector = 2;
+  global_freq = 1;
+  extvector = 0;
+  peratom_flag = 1;
+  size_peratom_cols = 0;
+  peratom_freq = 1;
+  comm_forward = 3;
+  create_attribute = 1;
+
+  list = NULL;
+  cut = NULL;
+  niter = 0;
+  residual = 0.0;
+
+  vstar = NULL;
+  rhs = res = rtilde = zvec = dir = adir = svec = tvec = diaginv = NULL;
+  nmax = 0;
+  aij = NULL;
+  naij = 0;
+  commvec = NULL;
+  commarray = NULL;
+  commcols = 1;
+  pinned = -1;
+  pindiag = 1.0;
+
+  // per-atom pressure migrates with the atoms so every solve is warm-started
+
+  pressure = NULL;
+  maxpressure = 0;
+  grow_arrays(atom->nmax);
+  atom->add_callback(0);
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdIsphProjection::~FixSsaTsdpdIsphProjection()
+{
+  atom->delete_callback(id,0);
+  memory->destroy(pressure);
+  memory->destroy(vstar);
+  memory->destroy(rhs);
+  memory->destroy(res);
+  memory->destroy(rtilde);
+  memory->destroy(zvec);
+  memory->destroy(dir);
+  memory->destroy(adir);
+  memory->destroy(svec);
+  memory->destroy(tvec);
+  memory->destroy(diaginv);
+  memory->destroy(aij);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdIsphProjection::setmask()
+{
+  int mask = 0;
+  mask |= POST_FORCE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::init()
+{
+  if (force->pair == NULL || force->pair_match("ssa_tsdpd/isph",0) == NULL)
+    error->all(FLERR,"Fix ssa_tsdpd/isph/projection requires pair_style ssa_tsdpd/isph");
+
+  int dim;
+  cut = (double **) force->pair->extract("cut",dim);
+  if (cut == NULL || dim != 2)
+    error->all(FLERR,"Fix ssa_tsdpd/isph/projection requires pair_style ssa_tsdpd/isph");
+
+  if (!force->newton_pair && comm->me == 0)
+    error->warning(FLERR,"Fix ssa_tsdpd/isph/projection uses a full neighbor list, "
+                   "newton_pair setting has no effect on it");
+
+  // full neighbor list: every owned atom sees all of its neighbors,
+  // so only forward communication of ghost values is needed
+
+  int irequest = neighbor->request(this,instance_me);
+  neighbor->requests[irequest]->pair = 0;
+  neighbor->requests[irequest]->fix = 1;
+  neighbor->requests[irequest]->half = 0;
+  neighbor->requests[irequest]->full = 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::init_list(int id, NeighList *ptr)
+{
+  list = ptr;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::setup(int vflag)
+{
+  post_force(vflag);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::grow_work()
+{
+  if (atom->nmax <= nmax) return;
+  nmax = atom->nmax;
+  memory->destroy(vstar);
+  memory->destroy(rhs);
+  memory->destroy(res);
+  memory->destroy(rtilde);
+  memory->destroy(zvec);
+  memory->destroy(dir);
+  memory->destroy(adir);
+  memory->destroy(svec);
+  memory->destroy(tvec);
+  memory->destroy(diaginv);
+  memory->create(vstar,nmax,3,"isph/projection:vstar");
+  memory->create(rhs,nmax,"isph/projection:rhs");
+  memory->create(res,nmax,"isph/projection:res");
+  memory->create(rtilde,nmax,"isph/projection:rtilde");
+  memory->create(zvec,nmax,"isph/projection:zvec");
+  memory->create(dir,nmax,"isph/projection:dir");
+  memory->create(adir,nmax,"isph/projection:adir");
+  memory->create(svec,nmax,"isph/projection:svec");
+  memory->create(tvec,nmax,"isph/projection:tvec");
+  memory->create(diaginv,nmax,"isph/projection:diaginv");
+}
+
+/* ----------------------------------------------------------------------
+   send values of owned atoms to their ghost images
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::forward(double *vec)
+{
+  commvec = vec;
+  commcols = 1;
+  comm->forward_comm_fix(this,1);
+}
+
+/* ----------------------------------------------------------------------
+   Laplacian weights a_ij >= 0 of  -div(1/rho grad p)_i = sum_j a_ij (p_i - p_j)
+   (Cummins & Rudman, 1999), and the right-hand side -div(v*)_i / dtf
+   cg uses the symmetrized mass (m_i+m_j)/2, bicgstab the SPH form m_j
+   bicgstab replaces the row of the group atom with the smallest ID
+     by p_i = 0, see below
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::build_operator()
+{
+  int i,j,ii,jj,jnum,itype,jtype;
+  double delx,dely,delz,rsq,h,wfd,imass,jmass,mij,delVdotDelR;
+
+  double **x = atom->x;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  tagint *tag = atom->tag;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  double dtf = 0.5 * update->dt * force->ftm2v;
+
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+
+  // without Dirichlet boundaries the operator is singular, its null
+  // space are the constant pressures
+  // A is symmetric for cg, so a right-hand side with zero mean is
+  //   consistent and cg converges to one of the solutions
+  // the SPH operator of bicgstab is not, the mean of its right-hand
+  //   side is no valid compatibility condition, so the pressure of one
+  //   atom is pinned to 0 instead
+
+  pinned = -1;
+  if (solver == BICGSTAB) {
+    tagint tagmin = MAXTAGINT;
+    for (i = 0; i < nlocal; i++)
+      if ((mask[i] & groupbit) && tag[i] < tagmin) tagmin = tag[i];
+    tagint tagall;
+    MPI_Allreduce(&tagmin,&tagall,1,MPI_LMP_TAGINT,MPI_MIN,world);
+    for (i = 0; i < nlocal; i++)
+      if ((mask[i] & groupbit) && tag[i] == tagall) pinned = i;
+  }
+
+  int ntotal = 0;
+  for (ii = 0; ii < inum; ii++) ntotal += numneigh[ilist[ii]];
+  if (ntotal > naij) {
+    naij = ntotal;
+    memory->destroy(aij);
+    memory->create(aij,naij,"isph/projection:aij");
+  }
+
+  int n = 0;
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    rhs[i] = 0.0;
+    diaginv[i] = 0.0;
+    if (!(mask[i] & groupbit)) continue;
+
+    itype = type[i];
+    imass = rmass ? rmass[i] : mass[itype];
+    int *jlist = firstneigh[i];
+    jnum = numneigh[i];
+    double diag = 0.0;
+    double div = 0.0;
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj] & NEIGHMASK;
+      aij[n] = 0.0;
+      if (mask[j] & groupbit) {
+        delx = x[i][0] - x[j][0];
+        dely = x[i][1] - x[j][1];
+        delz = x[i][2] - x[j][2];
+        rsq = delx*delx + dely*dely + delz*delz;
+        jtype = type[j];
+        h = cut[itype][jtype];
+        if (rsq < h*h) {
+          wfd = SsaTsdpdKernel::gradient(domain->dimension,rsq,h);
+          jmass = rmass ? rmass[j] : mass[jtype];
+          mij = (solver == CG) ? 0.5*(imass + jmass) : jmass;
+          aij[n] = -mij * 8.0 / ((rho[i]+rho[j])*(rho[i]+rho[j])) *
+            wfd * rsq / (rsq + 0.01*h*h);
+          diag += aij[n];
+
+          delVdotDelR = delx*(vstar[i][0]-vstar[j][0]) +
+            dely*(vstar[i][1]-vstar[j][1]) + delz*(vstar[i][2]-vstar[j][2]);
+          div -= jmass * delVdotDelR * wfd;
+        }
+      }
+      n++;
+    }
+
+    rhs[i] = -div / (rho[i] * dtf);
+    diaginv[i] = (diag > 0.0) ? 1.0/diag : 0.0;
+
+    // the pinned row is diag * p_i = 0, scaled like its neighbors
+
+    if (i == pinned) {
+      rhs[i] = 0.0;
+      pindiag = (diag > 0.0) ? diag : 1.0;
+      diaginv[i] = 1.0/pindiag;
+    }
+  }
+
+  if (solver == BICGSTAB) return;
+
+  double local[2],global[2];
+  local[0] = local[1] = 0.0;
+  for (i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      local[0] += rhs[i];
+      local[1] += 1.0;
+    }
+  MPI_Allreduce(local,global,2,MPI_DOUBLE,MPI_SUM,world);
+  if (global[1] > 0.0) {
+    double mean = global[0]/global[1];
+    for (i = 0; i < nlocal; i++)
+      if (mask[i] & groupbit) rhs[i] -= mean;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   y = A x over owned atoms of the group, x is refreshed on ghosts first
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::matvec(double *xvec, double *yvec)
+{
+  int i,j,ii,jj,jnum;
+  int *mask = atom->mask;
+
+  forward(xvec);
+
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+
+  int n = 0;
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    jnum = numneigh[i];
+    yvec[i] = 0.0;
+    if (!(mask[i] & groupbit)) continue;
+    if (i == pinned) {
+      yvec[i] = pindiag * xvec[i];
+      n += jnum;
+      continue;
+    }
+    int *jlist = firstneigh[i];
+    double sum = 0.0;
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj] & NEIGHMASK;
+      sum += aij[n++] * (xvec[i] - xvec[j]);
+    }
+    yvec[i] = sum;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixSsaTsdpdIsphProjection::dot(double *a, double *b)
+{
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  double local = 0.0;
+  double global;
+  for (int i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) local += a[i]*b[i];
+  MPI_Allreduce(&local,&global,1,MPI_DOUBLE,MPI_SUM,world);
+  return global;
+}
+
+/* ----------------------------------------------------------------------
+   Jacobi-preconditioned conjugate gradient, warm-started from pressure
+------------------------------------------------------------------------- */
+
+int FixSsaTsdpdIsphProjection::solve_cg()
+{
+  int i;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  double *p = pressure;
+
+  double bnorm = sqrt(dot(rhs,rhs));
+  if (bnorm == 0.0) {
+    for (i = 0; i < nlocal; i++) p[i] = 0.0;
+    residual = 0.0;
+    return 0;
+  }
+
+  matvec(p,adir);
+  for (i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit)) {
+      res[i] = zvec[i] = dir[i] = 0.0;
+      continue;
+    }
+    res[i] = rhs[i] - adir[i];
+    zvec[i] = diaginv[i]*res[i];
+    dir[i] = zvec[i];
+  }
+  double rz = dot(res,zvec);
+
+  int iter;
+  for (iter = 0; iter < maxiter; iter++) {
+    residual = sqrt(dot(res,res))/bnorm;
+    if (residual < tolerance) break;
+
+    matvec(dir,adir);
+    double dad = dot(dir,adir);
+    if (dad <= 0.0) break;
+    double alpha = rz/dad;
+    for (i = 0; i < nlocal; i++) {
+      if (!(mask[i] & groupbit)) continue;
+      p[i] += alpha*dir[i];
+      res[i] -= alpha*adir[i];
+      zvec[i] = diaginv[i]*res[i];
+    }
+    double rznew = dot(res,zvec);
+    double beta = rznew/rz;
+    rz = rznew;
+    for (i = 0; i < nlocal; i++)
+      if (mask[i] & groupbit) dir[i] = zvec[i] + beta*dir[i];
+  }
+
+  return iter;
+}
+
+/* ----------------------------------------------------------------------
+   right Jacobi-preconditioned BiCGStab for the non-symmetric SPH operator
+------------------------------------------------------------------------- */
+
+int FixSsaTsdpdIsphProjection::solve_bicgstab()
+{
+  int i;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  double *p = pressure;
+
+  double bnorm = sqrt(dot(rhs,rhs));
+  if (bnorm == 0.0) {
+    for (i = 0; i < nlocal; i++) p[i] = 0.0;
+    residual = 0.0;
+    return 0;
+  }
+
+  matvec(p,adir);
+  for (i = 0; i < nlocal; i++) {
+    if (mask[i] & groupbit) res[i] = rhs[i] - adir[i];
+    else res[i] = 0.0;
+    rtilde[i] = res[i];
+    dir[i] = adir[i] = 0.0;
+  }
+
+  double rho_old = 1.0, alpha = 1.0, omega = 1.0;
+
+  int iter;
+  for (iter = 0; iter < maxiter; iter++) {
+    residual = sqrt(dot(res,res))/bnorm;
+    if (residual < tolerance) break;
+
+    double rho_new = dot(rtilde,res);
+    if (rho_new == 0.0) break;
+    double beta = (rho_new/rho_old) * (alpha/omega);
+    rho_old = rho_new;
+
+    for (i = 0; i < nlocal; i++) {
+      if (!(mask[i] & groupbit)) {
+        dir[i] = zvec[i] = 0.0;
+        continue;
+      }
+      dir[i] = res[i] + beta*(dir[i] - omega*adir[i]);
+      zvec[i] = diaginv[i]*dir[i];
+    }
+    matvec(zvec,adir);
+    double rtv = dot(rtilde,adir);
+    if (rtv == 0.0) break;
+    alpha = rho_new/rtv;
+
+    for (i = 0; i < nlocal; i++) {
+      if (!(mask[i] & groupbit)) {
+        svec[i] = 0.0;
+        continue;
+      }
+      svec[i] = res[i] - alpha*adir[i];
+      p[i] += alpha*zvec[i];
+      zvec[i] = diaginv[i]*svec[i];
+    }
+    if (sqrt(dot(svec,svec))/bnorm < tolerance) {
+      for (i = 0; i < nlocal; i++) res[i] = svec[i];
+      continue;
+    }
+
+    matvec(zvec,tvec);
+    double tt = dot(tvec,tvec);
+    omega = (tt > 0.0) ? dot(tvec,svec)/tt : 0.0;
+    for (i = 0; i < nlocal; i++) {
+      if (!(mask[i] & groupbit)) continue;
+      p[i] += omega*zvec[i];
+      res[i] = svec[i] - omega*tvec[i];
+    }
+    if (omega == 0.0) break;
+  }
+
+  return iter;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::post_force(int vflag)
+{
+  int i,j,ii,jj,jnum,itype,jtype;
+  double delx,dely,delz,rsq,h,wfd,imass,jmass,fpair;
+
+  double **x = atom->x;
+  double **v = atom->v;
+  double **f = atom->f;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  double dtf = 0.5 * update->dt * force->ftm2v;
+
+  grow_work();
+
+  // velocity ssa_tsdpd/verlet would produce at the end of this step
+
+  for (i = 0; i < nlocal; i++) {
+    if (mask[i] & groupbit) {
+      imass = rmass ? rmass[i] : mass[type[i]];
+      vstar[i][0] = v[i][0] + dtf * f[i][0] / imass;
+      vstar[i][1] = v[i][1] + dtf * f[i][1] / imass;
+      vstar[i][2] = v[i][2] + dtf * f[i][2] / imass;
+    } else vstar[i][0] = vstar[i][1] = vstar[i][2] = 0.0;
+  }
+  commarray = vstar;
+  commcols = 3;
+  comm->forward_comm_fix(this,3);
+
+  build_operator();
+
+  if (solver == CG) niter = solve_cg();
+  else niter = solve_bicgstab();
+
+  // pressure force, antisymmetric in i,j so momentum is conserved
+
+  forward(pressure);
+
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    if (!(mask[i] & groupbit)) continue;
+    itype = type[i];
+    imass = rmass ? rmass[i] : mass[itype];
+    int *jlist = firstneigh[i];
+    jnum = numneigh[i];
+    double pi = pressure[i] / (rho[i]*rho[i]);
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj] & NEIGHMASK;
+      if (!(mask[j] & groupbit)) continue;
+      delx = x[i][0] - x[j][0];
+      dely = x[i][1] - x[j][1];
+      delz = x[i][2] - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+      jtype = type[j];
+      h = cut[itype][jtype];
+      if (rsq >= h*h) continue;
+      wfd = SsaTsdpdKernel::gradient(domain->dimension,rsq,h);
+      jmass = rmass ? rmass[j] : mass[jtype];
+      fpair = -imass * jmass * (pi + pressure[j]/(rho[j]*rho[j])) * wfd;
+      f[i][0] += delx * fpair;
+      f[i][1] += dely * fpair;
+      f[i][2] += delz * fpair;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   iterations and relative residual of the last pressure solve
+------------------------------------------------------------------------- */
+
+double FixSsaTsdpdIsphProjection::compute_vector(int n)
+{
+  if (n == 0) return (double) niter;
+  return residual;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdIsphProjection::pack_forward_comm(int n, int *list, double *buf,
+                                                 int pbc_flag, int *pbc)
+{
+  int i,j,m;
+
+  m = 0;
+  if (commcols == 3) {
+    for (i = 0; i < n; i++) {
+      j = list[i];
+      buf[m++] = commarray[j][0];
+      buf[m++] = commarray[j][1];
+      buf[m++] = commarray[j][2];
+    }
+  } else {
+    for (i = 0; i < n; i++) buf[m++] = commvec[list[i]];
+  }
+  return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::unpack_forward_comm(int n, int first, double *buf)
+{
+  int i,m,last;
+
+  m = 0;
+  last = first + n;
+  if (commcols == 3) {
+    for (i = first; i < last; i++) {
+      commarray[i][0] = buf[m++];
+      commarray[i][1] = buf[m++];
+      commarray[i][2] = buf[m++];
+    }
+  } else {
+    for (i = first; i < last; i++) commvec[i] = buf[m++];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::grow_arrays(int nmax_new)
+{
+  // new entries start the solve from 0, create_atoms sets no attributes
+
+  memory->grow(pressure,nmax_new,"isph/projection:pressure");
+  for (int i = maxpressure; i < nmax_new; i++) pressure[i] = 0.0;
+  maxpressure = nmax_new;
+  vector_atom = pressure;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::set_arrays(int i)
+{
+  pressure[i] = 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdIsphProjection::copy_arrays(int i, int j, int delflag)
+{
+  pressure[j] = pressure[i];
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdIsphProjection::pack_exchange(int i, double *buf)
+{
+  buf[0] = pressure[i];
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdIsphProjection::unpack_exchange(int nlocal, double *buf)
+{
+  pressure[nlocal] = buf[0];
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixSsaTsdpdIsphProjection::memory_usage()
+{
+  double bytes = atom->nmax * sizeof(double);
+  bytes += nmax * 12 * sizeof(double);
+  bytes += naij * sizeof(double);
+  return bytes;
+}
@@ -0,0 +1,556 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+// Shardlow splitting for the SDPD viscous (Espanol, 2003) and random stress
+// terms of pair_style ssa_tsdpd/wc and ssa_tsdpd/isph. The pairs are swept
+// in the active interaction regions (AIR) of the USER-DPD SSA neighbor list
+// (nbin_ssa, npair_half_bin_newton_ssa), as in fix shardlow, so the USER-DPD
+// package must be installed. Each pair update is explicit for the first and
+// implicit for the second half step and conserves momentum exactly, so the
+// viscous stability limit on dt is lifted.
+//
+// Example (must come before the integrator):
+//#    label  group        style          seed
+//fix  ssa    all   ssa_tsdpd/shardlow   48279
+//fix  int    all   ssa_tsdpd/verlet
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fix_ssa_tsdpd_shardlow.h"
+#include "atom.h"
+#include "force.h"
+#include "pair.h"
+#include "update.h"
+#include "comm.h"
+#include "universe.h"
+#include "domain.h"
+#include "modify.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "neigh_request.h"
+#include "random_mars.h"
+#include "ssa_tsdpd_kernel.h"
+#include "memory.h"
+#include "error.h"
+#include "info.h"
+#include "ssa_tsdpd_rng.h"
+
+using namespace LAMMPS_NS;
+using namespace FixConst;
+
+#define EPSILON 1.0e-10
+#define EPSILON_SQUARED ((EPSILON) * (EPSILON))
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdShardlow::FixSsaTsdpdShardlow(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg), random(NULL), cut(NULL), viscosity(NULL), v_t0(NULL),
+  maxv_t0(0)
+{
+  if (atom->rho_flag != 1)
+    error->all(FLERR,
+        "fix ssa_tsdpd/shardlow command requires atom_style with density, e.g. ssa_tsdpd");
+
+  if (narg != 4) error->all(FLERR,"Illegal fix ssa_tsdpd/shardlow command");
+
+  seed = force->inumeric(FLERR,arg[3]);
+  if (seed <= 0) error->all(FLERR,"Illegal fix ssa_tsdpd/shardlow command");
+
+  if (force->pair_match("ssa_tsdpd/wc",1) == NULL &&
+      force->pair_match("ssa_tsdpd/isph",1) == NULL)
+    error->all(FLERR,"Fix ssa_tsdpd/shardlow requires pair_style ssa_tsdpd/wc or ssa_tsdpd/isph");
+
+  // the SSA neighbor list comes with fix shardlow in the USER-DPD package,
+  // without it the run would only fail at the neighbor list setup
+
+  Info info(lmp);
+  if (!info.is_available("fix","shardlow"))
+    error->all(FLERR,"Fix ssa_tsdpd/shardlow requires the USER-DPD package");
+
+  random = new RanMars(lmp,seed + universe->me);
+  restart_global = 1;
+
+  comm_forward = 3;
+  comm_reverse = 3;
+
+  // Setup the ssaAIR array
+  atom->ssaAIR = NULL;
+  grow_arrays(atom->nmax);
+  memset(atom->ssaAIR, 0, sizeof(int)*atom->nlocal);
+
+  // Setup callbacks for maintaining atom->ssaAIR[]
+  atom->add_callback(0); // grow (aka exchange)
+  atom->add_callback(1); // restart
+  atom->add_callback(2); // border
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpdShardlow::~FixSsaTsdpdShardlow()
+{
+  atom->delete_callback(id, 0);
+  atom->delete_callback(id, 1);
+  atom->delete_callback(id, 2);
+
+  memory->destroy(atom->ssaAIR);
+  memory->destroy(v_t0);
+  delete random;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdShardlow::setmask()
+{
+  int mask = 0;
+  mask |= INITIAL_INTEGRATE;
+  mask |= PRE_EXCHANGE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::init()
+{
+  if (!force->newton_pair)
+    error->all(FLERR,"Fix ssa_tsdpd/shardlow requires newton pair on");
+
+  int dim;
+  cut = (double **) force->pair->extract("cut",dim);
+  viscosity = (double **) force->pair->extract("viscosity",dim);
+  if (cut == NULL || viscosity == NULL)
+    error->all(FLERR,"Fix ssa_tsdpd/shardlow requires pair_style ssa_tsdpd/wc or ssa_tsdpd/isph");
+
+  int irequest = neighbor->request(this,instance_me);
+  neighbor->requests[irequest]->pair = 0;
+  neighbor->requests[irequest]->fix  = 1;
+  neighbor->requests[irequest]->ssa  = 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::init_list(int id, NeighList *ptr)
+{
+  list = ptr;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::pre_exchange()
+{
+  memset(atom->ssaAIR, 0, sizeof(int)*atom->nlocal);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::setup_pre_exchange()
+{
+  memset(atom->ssaAIR, 0, sizeof(int)*atom->nlocal);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::setup(int vflag)
+{
+  bool fixShardlow = false;
+
+  for (int i = 0; i < modify->nfix; i++) {
+    if (strcmp(modify->fix[i]->style,"ssa_tsdpd/shardlow") == 0) fixShardlow = true;
+    if (strcmp(modify->fix[i]->style,"ssa_tsdpd/verlet") == 0 && !fixShardlow)
+      error->all(FLERR,"Fix ssa_tsdpd/shardlow must be defined before fix ssa_tsdpd/verlet");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   Pairwise update of the SDPD viscous force
+     F_ij = -gamma_ij (v_ij + kappa_ij (e_ij . v_ij) e_ij)
+     gamma_ij = -(5/3) eta m_i m_j (1/r dW/dr) / (rho_i rho_j)
+     kappa_ij = r^2 / (r^2 + 0.01 h^2)
+   and of the traceless symmetric random stress, with the same amplitude
+   and the same compression-only viscosity as the pair styles
+   first half step explicit, second half step implicit (exact inverse
+   of I + c (I + kappa e e^T)), same random impulse in both halves
+
+   NOTE: only implemented for orthogonal boxes, not triclinic
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::ssa_update(int i, int *jlist, int jlen)
+{
+  double **x = atom->x;
+  double **v = atom->v;
+  double *rho = atom->rho;
+  double *e = atom->e;
+  double *rmass = atom->rmass;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  const int dimension = domain->dimension;
+
+  const double kBoltzmann = force->boltz;
+  const double ftm2v = force->ftm2v;
+  const double dt = update->dt;
+  const double halfdt = 0.5*dt;
+
+  const double xtmp = x[i][0];
+  const double ytmp = x[i][1];
+  const double ztmp = x[i][2];
+
+  // load velocity for i from memory
+  double vxi = v[i][0];
+  double vyi = v[i][1];
+  double vzi = v[i][2];
+
+  int itype = type[i];
+  const double mass_i = (rmass) ? rmass[i] : mass[itype];
+  const double massinv_i = 1.0 / mass_i;
+
+  // Loop over Directional Neighbors only
+  for (int jj = 0; jj < jlen; jj++) {
+    int j = jlist[jj] & NEIGHMASK;
+    int jtype = type[j];
+
+    double delx = xtmp - x[j][0];
+    double dely = ytmp - x[j][1];
+    double delz = ztmp - x[j][2];
+    double rsq = delx*delx + dely*dely + delz*delz;
+    double h = cut[itype][jtype];
+
+    if ((rsq >= h*h) || (rsq < EPSILON_SQUARED)) continue;
+
+    double r = sqrt(rsq);
+    double rinv = 1.0/r;
+    double ex = delx*rinv;
+    double ey = dely*rinv;
+    double ez = delz*rinv;
+
+    double wfd = SsaTsdpdKernel::gradient(domain->dimension,rsq,h);
+
+    double mass_j = (rmass) ? rmass[j] : mass[jtype];
+    double massinv_j = 1.0 / mass_j;
+    double fvisc = mass_i * mass_j * wfd / (rho[i] * rho[j]);
+
+    // random impulse over dt, split evenly over the two half steps
+    double wiener[3][3] = {{0.0}};
+    for (int l = 0; l < dimension; l++)
+      for (int m = 0; m < dimension; m++)
+        wiener[l][m] = random->gaussian();
+
+    wiener[0][1] = wiener[1][0] = (wiener[0][1] + wiener[1][0]) / 2.;
+    wiener[0][2] = wiener[2][0] = (wiener[0][2] + wiener[2][0]) / 2.;
+    wiener[1][2] = wiener[2][1] = (wiener[1][2] + wiener[2][1]) / 2.;
+
+    double trace_over_dim = (wiener[0][0] + wiener[1][1] + wiener[2][2]) / dimension;
+    wiener[0][0] -= trace_over_dim;
+    wiener[1][1] -= trace_over_dim;
+    wiener[2][2] -= trace_over_dim;
+
+    double prefactor = 0.5 * sqrt(-4. * kBoltzmann * e[i] * fvisc * dt) / (r + 0.01*h);
+    double prand[3] = {0.0, 0.0, 0.0};
+    for (int l = 0; l < dimension; l++)
+      prand[l] = prefactor * (wiener[l][0]*delx + wiener[l][1]*dely + wiener[l][2]*delz);
+
+    double vxj = v[j][0];
+    double vyj = v[j][1];
+    double vzj = v[j][2];
+
+    // Compute the initial velocity difference between atom i and atom j
+    double delvx = vxi - vxj;
+    double delvy = vyi - vyj;
+    double delvz = vzi - vzj;
+    double dot_e = ex*delvx + ey*delvy + ez*delvz;
+
+    double kappa = rsq / (rsq + 0.01*h*h);
+    double gammaFactor = -(5.0/3.0) * viscosity[itype][jtype] * fvisc * halfdt;
+    if (dot_e > 0.0) gammaFactor = 0.0;
+
+    // Compute momentum change between t and t+dt/2
+    double dpx = prand[0] - gammaFactor*(delvx + kappa*dot_e*ex);
+    double dpy = prand[1] - gammaFactor*(delvy + kappa*dot_e*ey);
+    double dpz = prand[2] - gammaFactor*(delvz + kappa*dot_e*ez);
+
+    // Update the velocity on i and j
+    vxi += dpx*ftm2v*massinv_i;
+    vyi += dpy*ftm2v*massinv_i;
+    vzi += dpz*ftm2v*massinv_i;
+    vxj -= dpx*ftm2v*massinv_j;
+    vyj -= dpy*ftm2v*massinv_j;
+    vzj -= dpz*ftm2v*massinv_j;
+
+    // Compute the new velocity diff
+    delvx = vxi - vxj;
+    delvy = vyi - vyj;
+    delvz = vzi - vzj;
+    dot_e = ex*delvx + ey*delvy + ez*delvz;
+
+    // Compute the momentum change between t+dt/2 and t+dt implicitly
+    double bx = prand[0] - gammaFactor*(delvx + kappa*dot_e*ex);
+    double by = prand[1] - gammaFactor*(delvy + kappa*dot_e*ey);
+    double bz = prand[2] - gammaFactor*(delvz + kappa*dot_e*ez);
+    double c = gammaFactor*ftm2v*(massinv_i + massinv_j);
+    double alpha = c*kappa / (1.0 + c + c*kappa);
+    double dot_b = ex*bx + ey*by + ez*bz;
+    double inv_1p_c = 1.0 / (1.0 + c);
+    dpx = (bx - alpha*dot_b*ex) * inv_1p_c;
+    dpy = (by - alpha*dot_b*ey) * inv_1p_c;
+    dpz = (bz - alpha*dot_b*ez) * inv_1p_c;
+
+    // Update the velocity on i and j
+    vxi += dpx*ftm2v*massinv_i;
+    vyi += dpy*ftm2v*massinv_i;
+    vzi += dpz*ftm2v*massinv_i;
+    vxj -= dpx*ftm2v*massinv_j;
+    vyj -= dpy*ftm2v*massinv_j;
+    vzj -= dpz*ftm2v*massinv_j;
+
+    // Store updated velocity for j
+    v[j][0] = vxj;
+    v[j][1] = vyj;
+    v[j][2] = vzj;
+  }
+  // store updated velocity for i
+  v[i][0] = vxi;
+  v[i][1] = vyi;
+  v[i][2] = vzi;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::initial_integrate(int vflag)
+{
+  int i,ii,inum;
+  int *ilist;
+
+  int airnum;
+
+  // NOTE: this logic is specific to orthogonal boxes, not triclinic
+
+  // Enforce the constraint that ghosts must be contained in the nearest sub-domains
+  double bbx = domain->subhi[0] - domain->sublo[0];
+  double bby = domain->subhi[1] - domain->sublo[1];
+  double bbz = domain->subhi[2] - domain->sublo[2];
+
+  double rcut = 2.0*neighbor->cutneighmax;
+
+  if (domain->triclinic)
+    error->all(FLERR,"Fix ssa_tsdpd/shardlow does not yet support triclinic geometries");
+
+  if (rcut >= bbx || rcut >= bby || (domain->dimension == 3 && rcut >= bbz))
+    error->all(FLERR,"Shardlow algorithm requires sub-domain length > 2*(rcut+skin). Either reduce the number of processors requested, or change the cutoff/skin\n");
+
+  // v_t0 holds the velocities of the ghosts as last received
+
+  if (atom->nmax > maxv_t0) {
+    maxv_t0 = atom->nmax;
+    memory->destroy(v_t0);
+    memory->create(v_t0,maxv_t0,3,"ssa_tsdpd/shardlow:v_t0");
+  }
+
+  inum = list->inum;
+  ilist = list->ilist;
+
+  //Loop over all 14 directions (8 stages)
+  for (airnum = 1; airnum <=8; airnum++){
+
+    // Communicate the updated velocities to all nodes
+    if (airnum > 1) comm->forward_comm_fix(this);
+
+    // Loop over neighbors of my atoms
+    for (ii = 0; ii < inum; ii++) {
+      i = ilist[ii];
+      int start = (airnum < 2) ? 0 : list->ndxAIR_ssa[i][airnum - 2];
+      int len = list->ndxAIR_ssa[i][airnum - 1] - start;
+      if (len > 0) ssa_update(i, &(list->firstneigh[i][start]), len);
+    }
+
+    // Communicate the ghost deltas to the atom owners
+    if (airnum > 1) comm->reverse_comm_fix(this);
+
+  }  //End Loop over all directions For airnum = Top, Top-Right, Right, Bottom-Right, Back
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdShardlow::pack_forward_comm(int n, int *list, double *buf, int pbc_flag, int *pbc)
+{
+  int ii,jj,m;
+  double **v  = atom->v;
+
+  m = 0;
+  for (ii = 0; ii < n; ii++) {
+    jj = list[ii];
+    buf[m++] = v[jj][0];
+    buf[m++] = v[jj][1];
+    buf[m++] = v[jj][2];
+  }
+  return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::unpack_forward_comm(int n, int first, double *buf)
+{
+  int ii,m,last;
+  double **v  = atom->v;
+
+  m = 0;
+  last = first + n ;
+  for (ii = first; ii < last; ii++) {
+    v_t0[ii][0] = v[ii][0] = buf[m++];
+    v_t0[ii][1] = v[ii][1] = buf[m++];
+    v_t0[ii][2] = v[ii][2] = buf[m++];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixSsaTsdpdShardlow::pack_reverse_comm(int n, int first, double *buf)
+{
+  int i,m,last;
+  double **v  = atom->v;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++) {
+    buf[m++] = v[i][0] - v_t0[i][0];
+    buf[m++] = v[i][1] - v_t0[i][1];
+    buf[m++] = v[i][2] - v_t0[i][2];
+  }
+  return m;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::unpack_reverse_comm(int n, int *list, double *buf)
+{
+  int i,j,m;
+  double **v  = atom->v;
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+
+    v[j][0] += buf[m++];
+    v[j][1] += buf[m++];
+    v[j][2] += buf[m++];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   convert atom coords into the ssa active interaction region number
+------------------------------------------------------------------------- */
+
+int FixSsaTsdpdShardlow::coord2ssaAIR(double *x)
+{
+  int ix, iy, iz;
+
+  ix = iy = iz = 0;
+  if (x[2] < domain->sublo[2]) iz = -1;
+  if (x[2] >= domain->subhi[2]) iz = 1;
+  if (x[1] < domain->sublo[1]) iy = -1;
+  if (x[1] >= domain->subhi[1]) iy = 1;
+  if (x[0] < domain->sublo[0]) ix = -1;
+  if (x[0] >= domain->subhi[0]) ix = 1;
+
+  if(iz < 0){
+    return -1;
+  } else if(iz == 0){
+    if( iy<0 ) return -1; // bottom left/middle/right
+    if( (iy==0) && (ix<0)  ) return -1; // left atoms
+    if( (iy==0) && (ix==0) ) return 0; // Locally owned atoms
+    if( (iy==0) && (ix>0)  ) return 3; // Right atoms
+    if( (iy>0)  && (ix==0) ) return 2; // Top-middle atoms
+    if( (iy>0)  && (ix!=0) ) return 4; // Top-right and top-left atoms
+  } else { // iz > 0
+    if((ix==0) && (iy==0)) return 5; // Back atoms
+    if((ix==0) && (iy!=0)) return 6; // Top-back and bottom-back atoms
+    if((ix!=0) && (iy==0)) return 7; // Left-back and right-back atoms
+    if((ix!=0) && (iy!=0)) return 8; // Back corner atoms
+  }
+
+  return -2;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::grow_arrays(int nmax)
+{
+  memory->grow(atom->ssaAIR,nmax,"fix_ssa_tsdpd_shardlow:ssaAIR");
+}
+
+void FixSsaTsdpdShardlow::copy_arrays(int i, int j, int delflag)
+{
+  atom->ssaAIR[j] = atom->ssaAIR[i];
+}
+
+void FixSsaTsdpdShardlow::set_arrays(int i)
+{
+  atom->ssaAIR[i] = 0; /* coord2ssaAIR(x[i]) */
+}
+
+int FixSsaTsdpdShardlow::pack_border(int n, int *list, double *buf)
+{
+  for (int i = 0; i < n; i++) {
+    int j = list[i];
+    if (atom->ssaAIR[j] == 0) atom->ssaAIR[j] = 1; // not purely local anymore
+  }
+  return 0;
+}
+
+int FixSsaTsdpdShardlow::unpack_border(int n, int first, double *buf)
+{
+  int i,last = first + n;
+  for (i = first; i < last; i++) {
+    atom->ssaAIR[i] = coord2ssaAIR(atom->x[i]);
+  }
+  return 0;
+}
+
+int FixSsaTsdpdShardlow::unpack_exchange(int i, double *buf)
+{
+  atom->ssaAIR[i] = 0; /* coord2ssaAIR(x[i]) */
+  return 0;
+}
+
+void FixSsaTsdpdShardlow::unpack_restart(int i, int nth)
+{
+  atom->ssaAIR[i] = 0; /* coord2ssaAIR(x[i]) */
+}
+
+/* ----------------------------------------------------------------------
+   pack the random streams of all procs into restart file
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::write_restart(FILE *fp)
+{
+  SsaTsdpdRng::write_restart(lmp,fp,&random,1);
+}
+
+/* ----------------------------------------------------------------------
+   continue the streams of the run that wrote the restart file
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpdShardlow::restart(char *buf)
+{
+  if (!SsaTsdpdRng::restart(lmp,buf,&random,1) && comm->me == 0)
+    error->warning(FLERR,"Fix ssa_tsdpd/shardlow random streams not restored "
+                   "from restart file, # of procs differs");
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixSsaTsdpdShardlow::memory_usage()
+{
+  double bytes = 0.0;
+  bytes += memory->usage(atom->ssaAIR,atom->nmax);
+  bytes += memory->usage(v_t0,maxv_t0,3);
+  return bytes;
+}
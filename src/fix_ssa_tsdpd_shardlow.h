@@ -0,0 +1,120 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(ssa_tsdpd/shardlow,FixSsaTsdpdShardlow)
+
+#else
+
+#ifndef LMP_FIX_SSA_TSDPD_SHARDLOW_H
+#define LMP_FIX_SSA_TSDPD_SHARDLOW_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixSsaTsdpdShardlow : public Fix {
+ public:
+  class NeighList *list; // The SSA specific neighbor list
+
+  FixSsaTsdpdShardlow(class LAMMPS *, int, char **);
+  ~FixSsaTsdpdShardlow();
+  int setmask();
+  void init();
+  void init_list(int, class NeighList *);
+  void setup(int);
+  void initial_integrate(int);
+  void setup_pre_exchange();
+  void pre_exchange();
+
+  void grow_arrays(int);
+  void copy_arrays(int, int, int);
+  void set_arrays(int);
+
+  int pack_border(int, int *, double *);
+  int unpack_border(int, int, double *);
+  int unpack_exchange(int, double *);
+  void unpack_restart(int, int);
+  void write_restart(FILE *);
+  void restart(char *);
+
+  double memory_usage();
+
+ protected:
+  int pack_reverse_comm(int, int, double *);
+  void unpack_reverse_comm(int, int *, double *);
+  int pack_forward_comm(int , int *, double *, int, int *);
+  void unpack_forward_comm(int , int , double *);
+
+  class RanMars *random;
+  double **cut,**viscosity;     // per-pair smoothing length and viscosity of the pair style
+  double **v_t0;                // ghost velocities before each AIR sweep
+  int maxv_t0;
+
+ private:
+  int seed;
+
+  int coord2ssaAIR(double *);           // map atom coord to an AIR number
+  void ssa_update(int, int *, int);     // pairwise viscous + random update
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Fix ssa_tsdpd/shardlow requires pair_style ssa_tsdpd/wc or ssa_tsdpd/isph
+
+Only these pair styles hand their viscous and random terms to the fix.
+
+E: Fix ssa_tsdpd/shardlow requires the USER-DPD package
+
+The SSA neighbor list the fix sweeps is built by classes of the USER-DPD
+package, which must be installed as well.
+
+E: Fix ssa_tsdpd/shardlow requires newton pair on
+
+The SSA neighbor list of the USER-DPD package is a newton-on half list.
+
+E: Fix ssa_tsdpd/shardlow must be defined before fix ssa_tsdpd/verlet
+
+The pairwise velocity update has to run before the velocity-Verlet
+half step of the same timestep.
+
+E: Fix ssa_tsdpd/shardlow does not yet support triclinic geometries
+
+Self-explanatory.
+
+E: Shardlow algorithm requires sub-domain length > 2*(rcut+skin). Either
+reduce the number of processors requested, or change the cutoff/skin
+
+The Shardlow splitting algorithm requires the size of the sub-domain lengths
+to be are larger than twice the cutoff+skin.  Generally, the domain decomposition
+is dependant on the number of processors requested.
+
+W: Fix ssa_tsdpd/shardlow random streams not restored from restart file, # of procs differs
+
+Each processor continues the random stream it had when the restart file
+was written, this is only possible with the same number of processors.
+With another number the streams start again from the seed.
+
+*/
@@ -10,6 +10,7 @@
 #include "comm.h"
 #include "domain.h"
 #include "memory.h"
+#include "timer.h"
 #include "iostream"
 
 using namespace LAMMPS_NS;
@@ -30,27 +31,29 @@ FixSsaTsdpdSsaRxnMassAction::FixSsaTsdpdSsaRxnMassAction(LAMMPS *lmp, int narg,
   int i;
   int arg_index = 3;
   
-  rxn_index = atof(arg[arg_index++]);
+  rxn_index = atoi(arg[arg_index++]);
+  if (rxn_index < 0 || rxn_index >= atom->num_ssa_reactions)
+        error->all(FLERR,"Illegal fix ssa_tsdpd_ssa_rxn_mass_action command -- reaction index out of range.\n");
   
   k_rate = atof(arg[arg_index++]);
   num_reactants = atoi(arg[arg_index++]);
-  if(num_reactants > atom->num_tdpd_species) 
-        error->all(FLERR,"Illegal fix ssa_tsdpd_ssa_rxn_mass_action command -- number of reactant species greater than number of species.\n");
-  if(num_reactants > 2) 
+  if(num_reactants < 0 || num_reactants > 2) 
         error->all(FLERR,"Illegal fix ssa_tsdpd_ssa_rxn_mass_action command -- mass action reactions can have at most 2 reactants.\n");
   if(num_reactants > 0){
     for(i=0;i<num_reactants;i++){
       reactants[i] = atoi(arg[arg_index++]);
+      if(reactants[i] < 0 || reactants[i] >= atom->num_ssa_species)
+        error->all(FLERR,"Illegal fix ssa_tsdpd_ssa_rxn_mass_action command -- reactant species out of range.\n");
     }
   }
   num_products = atoi(arg[arg_index++]);
-  if(num_products > atom->num_tdpd_species) 
-        error->all(FLERR,"Illegal fix ssa_tsdpd_ssa_rxn_mass_action command -- number of product species greater than number of species.\n");
-  if(num_products > 4) 
+  if(num_products < 0 || num_products > 4) 
         error->all(FLERR,"Illegal fix ssa_tsdpd_ssa_rxn_mass_action command -- maximum number of product limited to 4 .\n");
   if(num_products > 0){
     for(i=0;i<num_products;i++){
       products[i] = atoi(arg[arg_index++]);
+      if(products[i] < 0 || products[i] >= atom->num_ssa_species)
+        error->all(FLERR,"Illegal fix ssa_tsdpd_ssa_rxn_mass_action command -- product species out of range.\n");
     }
   }
 
@@ -81,8 +84,7 @@ void FixSsaTsdpdSsaRxnMassAction::post_force(int vflag)
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
   double **x = atom->x;
-  int **C = atom->Cd;
-  int **Q = atom->Qd;
+  SpeciesArray<int> C = atom->Cd;
   
   double *rho = atom->rho;
   double *mass = atom->mass;
@@ -94,42 +96,50 @@ void FixSsaTsdpdSsaRxnMassAction::post_force(int vflag)
   
   if (igroup == atom->firstgroup) nlocal = atom->nfirst;
 
+  timer->sub_start(Timer::SSA_REACTION);
 
   for (int i = 0; i < nlocal; i++) {
     if (mask[i] & groupbit) {
-        //volume = 1.0; // TODO: find the volume of each voxel
-        itype = type[i];
-	volume = mass[itype] / rho[i];
-
-      if(num_reactants==2){
-        if(reactants[0] == reactants[1]){
-            ssa_rxn_propensity[i][rxn_index] = k_rate/volume/2.0*C[i][reactants[0]]*(C[i][reactants[0]] - 1);
-            d_ssa_rxn_prop_d_c[i][rxn_index][reactants[0]] = k_rate/volume;
-            ssa_stoich_matrix[i][rxn_index][reactants[0]] = -2;
-        }else{
-            ssa_rxn_propensity[i][rxn_index] = k_rate/volume/2.0*C[i][reactants[0]]*C[i][reactants[1]];
-            d_ssa_rxn_prop_d_c[i][rxn_index][reactants[0]] = k_rate/volume/2.0;
-            d_ssa_rxn_prop_d_c[i][rxn_index][reactants[1]] = k_rate/volume/2.0;
-            ssa_stoich_matrix[i][rxn_index][reactants[0]] = -1;
-            ssa_stoich_matrix[i][rxn_index][reactants[1]] = -1;
-        }
+      itype = type[i];
+      volume = mass[itype] / rho[i];
+
+      ssa_rxn_propensity[i][rxn_index] = propensity(C[i],volume);
+
+      // net stoichiometry, and which species the propensity depends on
+
+      for(int s=0;s<atom->num_ssa_species;s++){
+        ssa_stoich_matrix[i][rxn_index][s] = 0;
+        d_ssa_rxn_prop_d_c[i][rxn_index][s] = 0.0;
+      }
+      if(num_reactants==2 && reactants[0] == reactants[1]){
+        d_ssa_rxn_prop_d_c[i][rxn_index][reactants[0]] = k_rate/volume;
+      }else if(num_reactants==2){
+        d_ssa_rxn_prop_d_c[i][rxn_index][reactants[0]] = k_rate/volume/2.0;
+        d_ssa_rxn_prop_d_c[i][rxn_index][reactants[1]] = k_rate/volume/2.0;
       }else if(num_reactants==1){
-        ssa_rxn_propensity[i][rxn_index] = k_rate*C[i][reactants[0]];
         d_ssa_rxn_prop_d_c[i][rxn_index][reactants[0]] = k_rate;
-        ssa_stoich_matrix[i][rxn_index][reactants[0]] = -1;
-      }else if(num_reactants==0){
-        ssa_rxn_propensity[i][rxn_index]  = k_rate*volume;
-      }else{
-        error->all(FLERR,"Illegal fix ssa_tsdpd_ssa_rxn_mass_action post_integrate, illegal number of reactants.");
-      }
-      if(num_products > 0){
-        for(int j=0;j<num_products;j++){
-          ssa_stoich_matrix[i][rxn_index][products[j]] = 0;
-        }
-        for(int j=0;j<num_products;j++){
-          ssa_stoich_matrix[i][rxn_index][products[j]] += 1;
-        }
       }
+      for(int j=0;j<num_reactants;j++) ssa_stoich_matrix[i][rxn_index][reactants[j]] -= 1;
+      for(int j=0;j<num_products;j++) ssa_stoich_matrix[i][rxn_index][products[j]] += 1;
     }
   }
+
+  timer->sub_stamp(Timer::SSA_REACTION);
+}
+
+/* ----------------------------------------------------------------------
+   propensity for the copy numbers cd of a voxel of the given volume,
+   used by the integrators to update it after each firing
+------------------------------------------------------------------------- */
+
+double FixSsaTsdpdSsaRxnMassAction::propensity(SpeciesArray<int>::Row cd,
+                                                double volume) const
+{
+  if(num_reactants==2){
+    if(reactants[0] == reactants[1])
+      return k_rate/volume/2.0*cd[reactants[0]]*(cd[reactants[0]] - 1);
+    return k_rate/volume/2.0*cd[reactants[0]]*cd[reactants[1]];
+  }
+  if(num_reactants==1) return k_rate*cd[reactants[0]];
+  return k_rate*volume;
 }
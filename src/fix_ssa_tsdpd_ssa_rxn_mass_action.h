@@ -8,6 +8,7 @@ FixStyle(ssa_tsdpd/ssa_rxn_mass_action,FixSsaTsdpdSsaRxnMassAction)
 #define FIX_SSA_TSDPD_SSA_MASS_ACTION_H
 
 #include "fix.h"
+#include "species_array.h"
 
 namespace LAMMPS_NS {
 
@@ -18,9 +19,11 @@ class FixSsaTsdpdSsaRxnMassAction : public Fix {
   int setmask();
   virtual void init();
   virtual void post_force(int);
+  double propensity(SpeciesArray<int>::Row, double) const;
 
- protected:
   int rxn_index;
+
+ protected:
   int num_reactants;
   int num_products;
   int reactants[2];
@@ -28,11 +28,14 @@ namespace LAMMPS_NS {
 class FixSsaTsdpdStationary : public Fix {
  public:
   FixSsaTsdpdStationary(class LAMMPS *, int, char **);
+  virtual ~FixSsaTsdpdStationary();
   int setmask();
   virtual void init();
   virtual void initial_integrate(int);
   virtual void final_integrate();
   void reset_dt();
+  void write_restart(FILE *);
+  void restart(char *);
 
  private:
   class NeighList *list;
@@ -43,6 +46,12 @@ class FixSsaTsdpdStationary : public Fix {
   class Pair *pair;
   unsigned int seed;
   class RanMars *random;
+  class RanMars **rep_random;   // stream of each SSA replica, [0] = random
+  int nrep_random;
+  class FixSsaTsdpdSsaRxnMassAction **rxnfix;   // reaction fix of each index
+  char *rng_restart;    // restart record of the streams until init()
+
+  int rng_streams(class RanMars **);
 };
 
 }
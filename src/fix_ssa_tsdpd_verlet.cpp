@@ -19,6 +19,7 @@
 #include <string.h>
 #include "atom.h"
 #include "comm.h"
+#include "universe.h"
 #include "force.h"
 #include "neighbor.h"
 #include "neigh_list.h"
@@ -29,10 +30,18 @@
 #include "memory.h"
 #include "error.h"
 #include "pair.h"
+#include "modify.h"
+#include "timer.h"
+#include "ssa_tsdpd_stats.h"
+#include "fix_ssa_tsdpd_ssa_rxn_mass_action.h"
+#include "ssa_tsdpd_rng.h"
 
 using namespace LAMMPS_NS;
 using namespace FixConst;
 
+#define SEED_DEFAULT 7362891
+#define MAXSEED 900000000
+
 /* ---------------------------------------------------------------------- */
 
 FixSsaTsdpd::FixSsaTsdpd(LAMMPS *lmp, int narg, char **arg) :
@@ -42,16 +51,40 @@ FixSsaTsdpd::FixSsaTsdpd(LAMMPS *lmp, int narg, char **arg) :
     error->all(FLERR,
         "fix ssa_tsdpd/verlet command requires atom_style with both energy and density");
 
-  if (narg != 3)
+  if (narg != 3 && narg != 5)
     error->all(FLERR,"Illegal number of arguments for fix ssa_tsdpd/verlet command");
 
   time_integrate = 1;
+  restart_global = 1;
+
+  // proc p of the universe draws from seed + p, with a fixed default
+  // seed, so each partition of a -partition run has streams of its own
+
+  int seed_all = SEED_DEFAULT;
+  if (narg == 5) {
+    if (strcmp(arg[3],"seed") != 0)
+      error->all(FLERR,"Illegal fix ssa_tsdpd/verlet command");
+    seed_all = force->inumeric(FLERR,arg[4]);
+    if (seed_all <= 0 || seed_all > MAXSEED - universe->nprocs)
+      error->all(FLERR,"Illegal fix ssa_tsdpd/verlet command");
+  }
+  seed = seed_all + universe->me;
 
-  // seed is immune to underflow/overflow because it is unsigned
-  seed = comm->nprocs + comm->me + atom->nlocal;
-  //if (narg == 3) seed += force->inumeric (FLERR, arg[2]);
   random = new RanMars (lmp, seed);
+  nrep_random = atom->num_ssa_replicas;
+  rep_random = SsaTsdpdRng::create_replicas(lmp,random,seed,nrep_random);
+  rxnfix = NULL;
+  rng_restart = NULL;
+
+}
 
+/* ---------------------------------------------------------------------- */
+
+FixSsaTsdpd::~FixSsaTsdpd() {
+  SsaTsdpdRng::destroy_replicas(rep_random,nrep_random);
+  delete random;
+  delete [] rxnfix;
+  memory->sfree(rng_restart);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -69,6 +102,32 @@ int FixSsaTsdpd::setmask() {
 void FixSsaTsdpd::init() {
   dtv = update->dt;
   dtf = 0.5 * update->dt * force->ftm2v;
+
+  // streams of a restart file, once the pair style has its stream
+
+  if (rng_restart) {
+    RanMars **streams = new RanMars*[2*nrep_random];
+    int nstream = rng_streams(streams);
+    if (!SsaTsdpdRng::restart(lmp,rng_restart,streams,nstream) &&
+        comm->me == 0)
+      error->warning(FLERR,"Fix ssa_tsdpd/verlet random streams not restored "
+                     "from restart file, # of procs or replicas differs");
+    delete [] streams;
+    memory->sfree(rng_restart);
+    rng_restart = NULL;
+  }
+
+  // reaction fixes, to update the propensities after each firing
+
+  delete [] rxnfix;
+  rxnfix = new FixSsaTsdpdSsaRxnMassAction*[atom->num_ssa_reactions];
+  for (int r = 0; r < atom->num_ssa_reactions; r++) rxnfix[r] = NULL;
+  for (int m = 0; m < modify->nfix; m++)
+    if (strcmp(modify->fix[m]->style,"ssa_tsdpd/ssa_rxn_mass_action") == 0) {
+      FixSsaTsdpdSsaRxnMassAction *fix =
+        (FixSsaTsdpdSsaRxnMassAction *) modify->fix[m];
+      rxnfix[fix->rxn_index] = fix;
+    }
 }
 
 void FixSsaTsdpd::setup_pre_force(int vflag)
@@ -110,16 +169,15 @@ void FixSsaTsdpd::initial_integrate(int vflag) {
   int rmass_flag = atom->rmass_flag;
 
   double dtCm;
-  double **C = atom->C;
-  double **Q = atom->Q;
-  int **Cd = atom->Cd;
-  int **Qd = atom->Qd;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<double> Q = atom->Q;
 
   int *type = atom->type;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
   int i;
   double dtfm;
+  int atom_major = (atom->species_layout == ATOM_MAJOR);
 
   if (igroup == atom->firstgroup)
     nlocal = atom->nfirst;
@@ -148,10 +206,11 @@ void FixSsaTsdpd::initial_integrate(int vflag) {
 
 	
       dtCm = 0.5*update->dt;      
-      for (int k = 0; k < atom->num_tdpd_species; k++){
+      if (atom_major)
+        for (int k = 0; k < atom->num_tdpd_species; k++){
 		C[i][k] += Q[i][k] *dtf;
 		C[i][k] = C[i][k] > 0 ? C[i][k] : 0.0;
-      }
+        }
 
       //e[i] += dtf * de[i]; // half-step update of particle internal energy
       rho[i] += dtf * drho[i]; // ... and density
@@ -159,6 +218,21 @@ void FixSsaTsdpd::initial_integrate(int vflag) {
 
 
 
+    }
+  }
+
+  // species-major layout: one unit-stride sweep per species,
+  // written as a select so that the loop vectorizes
+
+  if (!atom_major) {
+    for (int k = 0; k < atom->num_tdpd_species; k++) {
+      double *c = C.species(k);
+      double *q = Q.species(k);
+      for (int i = 0; i < nlocal; i++) {
+        double ci = c[i] + q[i]*dtf;
+        ci = ci > 0 ? ci : 0.0;
+        c[i] = (mask[i] & groupbit) ? ci : c[i];
+      }
     }
   }
 }
@@ -178,10 +252,10 @@ void FixSsaTsdpd::final_integrate() {
   double *drho = atom->drho;
 
   double dtCm;
-  double **C = atom->C;
-  double **Q = atom->Q;
-  int **Cd = atom->Cd;
-  int **Qd = atom->Qd;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<double> Q = atom->Q;
+  SpeciesArray<int> Cd = atom->Cd;
+  SpeciesArray<int> Qd = atom->Qd;
 
 
   int *type = atom->type;
@@ -193,7 +267,8 @@ void FixSsaTsdpd::final_integrate() {
   double dtfm;
   double *rmass = atom->rmass;
   int rmass_flag = atom->rmass_flag;
-  int r,ro,k;
+  int k;
+  int atom_major = (atom->species_layout == ATOM_MAJOR);
 
   for (int i = 0; i < nlocal; i++) {
     if (mask[i] & groupbit) {
@@ -210,65 +285,112 @@ void FixSsaTsdpd::final_integrate() {
 
 
       dtCm = 0.5*update->dt;      
-      for (k = 0; k < atom->num_tdpd_species; k++){
+      if (atom_major) {
+        for (k = 0; k < atom->num_tdpd_species; k++){
 		C[i][k] += Q[i][k] *dtf;
 		C[i][k] = C[i][k] > 0 ? C[i][k] : 0.0;  // enforce positivity, but this method can lead to instabilities
-      }
+        }
 
 
-      // TODO: Convert Qd to Cd flux here
-      for (int s=0; s<atom->num_ssa_species; s++){
+        // TODO: Convert Qd to Cd flux here
+        for (int s=0; s<Cd.ncol; s++){
           Cd[i][s] += Qd[i][s];
 	  Cd[i][s] = Cd[i][s] > 0 ? Cd[i][s] : 0;
           //printf("Cd[%d][%d] = %d, Qd[%d][%d] = %d \n",i,s,Cd[i][s],i,s,Qd[i][s] );
+        }
+      }
+
+
+      //e[i] += dtf * de[i];
+      rho[i] += dtf * drho[i];
+    }
+  }
+
+  // species-major layout, as in initial_integrate()
+
+  if (!atom_major) {
+    for (int k = 0; k < atom->num_tdpd_species; k++) {
+      double *c = C.species(k);
+      double *q = Q.species(k);
+      for (int i = 0; i < nlocal; i++) {
+        double ci = c[i] + q[i]*dtf;
+        ci = ci > 0 ? ci : 0.0;
+        c[i] = (mask[i] & groupbit) ? ci : c[i];
+      }
+    }
+    for (int s = 0; s < Cd.ncol; s++) {
+      int *cd = Cd.species(s);
+      int *qd = Qd.species(s);
+      for (int i = 0; i < nlocal; i++) {
+        int ci = cd[i] + qd[i];
+        ci = ci > 0 ? ci : 0;
+        cd[i] = (mask[i] & groupbit) ? ci : cd[i];
       }
+    }
+  }
+
+  // SSA reactions, in a separate loop so they are timed on their own
+
+  if (atom->num_ssa_species == 0 || atom->num_ssa_reactions == 0) return;
+
+  timer->sub_start(Timer::SSA_REACTION);
+  SsaTsdpdStats *stats = atom->ssa_stats;
+  if (stats) stats->start();
+
+  int nrxn = atom->num_ssa_reactions;
+  int nssa = atom->num_ssa_species;
+
+  for (int i = 0; i < nlocal; i++) {
+    if (mask[i] & groupbit) {
+      double volume = mass[type[i]] / rho[i];
+      int **stoich = atom->ssa_stoich_matrix[i];
+      double *a = atom->ssa_rxn_propensity[i];
+
+      // each replica reacts on its own, with a stream of its own
+      // replica 0 goes last, so a[] keeps its propensities
 
+      for (int q = nrep_random-1; q >= 0; q--) {
+        SpeciesArray<int>::Row cd = Cd.row(i,q*nssa);
+        RanMars *rng = rep_random[q];
+
+        // propensities of the populations after this step's diffusion,
+        // a reaction without a ssa_rxn_mass_action fix never fires
 
-      // Calculate SSA reactions here
-      
-       if (atom->num_ssa_species > 0) {
-        double tt=0;
         double a0 = 0.0;
-        for(r=0;r<atom->num_ssa_reactions;r++) a0 += atom->ssa_rxn_propensity[i][r];
-        if(a0 > 0.0){
-            double r1 = random->uniform();
-            double r2 = random->uniform();
-            tt += -log(1.0-r1)/a0;
-            double old_a;
-            double delta_a0=0.0;
-            double a_sum = 0;
-
-            while(tt < update->dt){
-              //find next reaction to fire
-              for(r=0;r<atom->num_ssa_reactions;r++){
-                  if((a_sum += atom->ssa_rxn_propensity[i][r]) > r2*a0) break;
-              }
-              // Change species populations for reaction r
-              for(int s=0;s<atom->num_ssa_species;s++){
-                Cd[i][s] += atom->ssa_stoich_matrix[i][r][s];
-                // Change reaction propensities
-                for(ro=0;ro<atom->num_ssa_reactions;ro++){
-                  if(atom->d_ssa_rxn_prop_d_c[i][ro][s] != 0){
-                    old_a = atom->ssa_rxn_propensity[i][ro];
-                    atom->ssa_rxn_propensity[i][ro] += atom->d_ssa_rxn_prop_d_c[i][ro][s];
-                    delta_a0 += (atom->ssa_rxn_propensity[i][ro] - old_a);
-                  }
-                }
-              }
-              // Update total propensity
-              a0 += delta_a0;
-              // Roll new random numbers
-              r1 = random->uniform();
-              r2 = random->uniform();
-              // Calcuate time to next reaction
-              tt += -log(1.0-r1)/a0;
+        for (int r = 0; r < nrxn; r++) {
+          a[r] = rxnfix[r] ? rxnfix[r]->propensity(cd,volume) : 0.0;
+          a0 += a[r];
+        }
+        if (stats) stats->propensity(i,a0);
+        if (a0 <= 0.0) continue;
+
+        // Gillespie direct method over the step,
+        // the propensities are recomputed after each firing
+
+        double tt = -log(1.0-rng->uniform())/a0;
+        while (tt < update->dt) {
+          double r2 = a0*rng->uniform();
+          double a_sum = 0.0;
+          int r;
+          for (r = 0; r < nrxn-1; r++)
+            if ((a_sum += a[r]) > r2) break;
+          if (stats) stats->reaction(i,r);
+
+          for (int s = 0; s < nssa; s++) cd[s] += stoich[r][s];
+
+          a0 = 0.0;
+          for (int ro = 0; ro < nrxn; ro++) {
+            a[ro] = rxnfix[ro] ? rxnfix[ro]->propensity(cd,volume) : 0.0;
+            a0 += a[ro];
           }
+          if (a0 <= 0.0) break;
+          tt += -log(1.0-rng->uniform())/a0;
         }
       }
-      //e[i] += dtf * de[i];
-      rho[i] += dtf * drho[i];
     }
   }
+
+  timer->sub_stamp(Timer::SSA_REACTION);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -277,3 +399,50 @@ void FixSsaTsdpd::reset_dt() {
   dtv = update->dt;
   dtf = 0.5 * update->dt * force->ftm2v;
 }
+
+/* ----------------------------------------------------------------------
+   random streams of this fix and of the pair style, one of each per SSA
+     replica, NULL if the pair style has none
+   returns the # of streams
+------------------------------------------------------------------------- */
+
+int FixSsaTsdpd::rng_streams(RanMars **streams)
+{
+  int dim;
+  RanMars **pair_streams = NULL;
+  if (force->pair)
+    pair_streams = (RanMars **) force->pair->extract("random_replicas",dim);
+  for (int q = 0; q < nrep_random; q++) {
+    streams[q] = rep_random[q];
+    streams[nrep_random+q] = pair_streams ? pair_streams[q] : NULL;
+  }
+  return 2*nrep_random;
+}
+
+/* ----------------------------------------------------------------------
+   pack the random streams of all procs into restart file
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpd::write_restart(FILE *fp)
+{
+  RanMars **streams = new RanMars*[2*nrep_random];
+  int nstream = rng_streams(streams);
+  SsaTsdpdRng::write_restart(lmp,fp,streams,nstream);
+  delete [] streams;
+}
+
+/* ----------------------------------------------------------------------
+   keep the streams of a restart file until init(),
+     the pair style may be defined after this fix
+------------------------------------------------------------------------- */
+
+void FixSsaTsdpd::restart(char *buf)
+{
+  double *list = (double *) buf;
+  bigint nbytes = sizeof(double) * (2 + static_cast<bigint> (list[0]) *
+                                    static_cast<int> (list[1]) *
+                                    RanMars::size_state());
+  memory->sfree(rng_restart);
+  rng_restart = (char *) memory->smalloc(nbytes,"ssa_tsdpd:rng_restart");
+  memcpy(rng_restart,buf,nbytes);
+}
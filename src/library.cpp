@@ -299,6 +299,59 @@ void lammps_free(void *ptr)
   free(ptr);
 }
 
+// ----------------------------------------------------------------------
+// helpers for species arrays, which use the strides of their layout
+// ----------------------------------------------------------------------
+
+static int species_name(const char *name)
+{
+  if (strcmp(name,"C") == 0 || strcmp(name,"Q") == 0 ||
+      strcmp(name,"Cd") == 0 || strcmp(name,"Qd") == 0) return 1;
+  return 0;
+}
+
+template <class T>
+static void gather_species(LAMMPS *lmp, T *vptr, int *dims, int natoms,
+                           T *data, MPI_Datatype datatype)
+{
+  int count = dims[1];
+  int astride = dims[2];
+  int sstride = dims[3];
+
+  T *copy;
+  lmp->memory->create(copy,count*natoms,"lib/gather:copy");
+  for (int i = 0; i < count*natoms; i++) copy[i] = 0;
+
+  tagint *tag = lmp->atom->tag;
+  int nlocal = lmp->atom->nlocal;
+
+  for (int i = 0; i < nlocal; i++) {
+    T *src = &vptr[(bigint) i*astride];
+    T *dst = &copy[count*(tag[i]-1)];
+    for (int k = 0; k < count; k++) dst[k] = src[(bigint) k*sstride];
+  }
+
+  MPI_Allreduce(copy,data,count*natoms,datatype,MPI_SUM,lmp->world);
+  lmp->memory->destroy(copy);
+}
+
+template <class T>
+static void scatter_species(LAMMPS *lmp, T *vptr, int *dims, int natoms,
+                            T *data)
+{
+  int count = dims[1];
+  int astride = dims[2];
+  int sstride = dims[3];
+  int m;
+
+  for (int i = 0; i < natoms; i++)
+    if ((m = lmp->atom->map(i+1)) >= 0) {
+      T *dst = &vptr[(bigint) m*astride];
+      T *src = &data[count*i];
+      for (int k = 0; k < count; k++) dst[(bigint) k*sstride] = src[k];
+    }
+}
+
 // ----------------------------------------------------------------------
 // library API functions to extract info from LAMMPS or set info in LAMMPS
 // ----------------------------------------------------------------------
@@ -368,6 +421,17 @@ void *lammps_extract_global(void *ptr, char *name)
 
   if (strcmp(name,"q_flag") == 0) return (void *) &lmp->atom->q_flag;
 
+  if (strcmp(name,"num_tdpd_species") == 0)
+    return (void *) &lmp->atom->num_tdpd_species;
+  if (strcmp(name,"num_ssa_species") == 0)
+    return (void *) &lmp->atom->num_ssa_species;
+  if (strcmp(name,"num_ssa_reactions") == 0)
+    return (void *) &lmp->atom->num_ssa_reactions;
+  if (strcmp(name,"num_ssa_replicas") == 0)
+    return (void *) &lmp->atom->num_ssa_replicas;
+  if (strcmp(name,"species_layout") == 0)
+    return (void *) &lmp->atom->species_layout;
+
   // update->atime can be referenced as a pointer
   // thermo "timer" data cannot be, since it is computed on request
   // lammps_get_thermo() can access all thermo keywords by value
@@ -427,6 +491,23 @@ void *lammps_extract_atom(void *ptr, char *name)
   return lmp->atom->extract(name);
 }
 
+/* ----------------------------------------------------------------------
+   extract a pointer to a per-atom, per-species array: C, Q, Cd or Qd
+   type = 0 for int (Cd,Qd), 1 for double (C,Q)
+   dims = # of rows, # of species, atom stride, species stride
+     value of atom i and species k is ptr[i*dims[2] + k*dims[3]]
+     strides are not fixed, they depend on the species layout
+   returns a NULL if name is not a species array or it is not allocated
+   the returned pointer and dims are not permanent, LAMMPS may reallocate
+     the arrays when atoms migrate or the layout pads to a new # of atoms
+------------------------------------------------------------------------- */
+
+void *lammps_extract_species(void *ptr, char *name, int *type, int *dims)
+{
+  LAMMPS *lmp = (LAMMPS *) ptr;
+  return lmp->atom->extract_species(name,type,dims);
+}
+
 /* ----------------------------------------------------------------------
    extract a pointer to an internal LAMMPS compute-based entity
    the compute is invoked if its value(s) is not current
@@ -757,6 +838,13 @@ void lammps_gather_atoms(void *ptr, char *name,
       return;
     }
 
+    // species arrays are not stored as per-atom arrays
+
+    if (species_name(name)) {
+      lammps_gather_species(ptr,name,type,count,data);
+      return;
+    }
+
     int natoms = static_cast<int> (lmp->atom->natoms);
 
     int i,j,offset;
@@ -867,6 +955,11 @@ void lammps_scatter_atoms(void *ptr, char *name,
       return;
     }
 
+    if (species_name(name)) {
+      lammps_scatter_species(ptr,name,type,count,data);
+      return;
+    }
+
     int natoms = static_cast<int> (lmp->atom->natoms);
 
     int i,j,m,offset;
@@ -936,6 +1029,98 @@ void lammps_scatter_atoms(void *ptr, char *name,
   END_CAPTURE
 }
 
+/* ----------------------------------------------------------------------
+   gather a per-atom, per-species array across all processors
+   same arguments and ordering as lammps_gather_atoms()
+   name = C, Q, Cd or Qd
+   type must be 0 for Cd,Qd and 1 for C,Q
+   count must be the # of species of the array,
+     times num_ssa_replicas for Cd,Qd
+------------------------------------------------------------------------- */
+
+void lammps_gather_species(void *ptr, char *name,
+                           int type, int count, void *data)
+{
+  LAMMPS *lmp = (LAMMPS *) ptr;
+
+  BEGIN_CAPTURE
+  {
+    int flag = 0;
+    if (lmp->atom->tag_enable == 0 || lmp->atom->tag_consecutive() == 0)
+      flag = 1;
+    if (lmp->atom->natoms > MAXSMALLINT) flag = 1;
+    if (flag) {
+      if (lmp->comm->me == 0)
+        lmp->error->warning(FLERR,"Library error in lammps_gather_species");
+      return;
+    }
+
+    int stype,dims[4];
+    void *vptr = lmp->atom->extract_species(name,&stype,dims);
+    if (vptr == NULL || stype != type || dims[1] != count) {
+      if (lmp->comm->me == 0)
+        lmp->error->warning(FLERR,"lammps_gather_species: "
+                            "unknown species array or mismatched type/count");
+      return;
+    }
+
+    // copy = Natom x count values, ordered by atom ID
+    // MPI_Allreduce with MPI_SUM to merge into data
+
+    int natoms = static_cast<int> (lmp->atom->natoms);
+
+    if (type == 0)
+      gather_species(lmp,(int *) vptr,dims,natoms,(int *) data,MPI_INT);
+    else
+      gather_species(lmp,(double *) vptr,dims,natoms,(double *) data,
+                     MPI_DOUBLE);
+  }
+  END_CAPTURE
+}
+
+/* ----------------------------------------------------------------------
+   scatter a per-atom, per-species array across all processors
+   same arguments and ordering as lammps_scatter_atoms()
+   name = C, Q, Cd or Qd, type and count as in lammps_gather_species()
+------------------------------------------------------------------------- */
+
+void lammps_scatter_species(void *ptr, char *name,
+                            int type, int count, void *data)
+{
+  LAMMPS *lmp = (LAMMPS *) ptr;
+
+  BEGIN_CAPTURE
+  {
+    int flag = 0;
+    if (lmp->atom->tag_enable == 0 || lmp->atom->tag_consecutive() == 0)
+      flag = 1;
+    if (lmp->atom->natoms > MAXSMALLINT) flag = 1;
+    if (lmp->atom->map_style == 0) flag = 1;
+    if (flag) {
+      if (lmp->comm->me == 0)
+        lmp->error->warning(FLERR,"Library error in lammps_scatter_species");
+      return;
+    }
+
+    int stype,dims[4];
+    void *vptr = lmp->atom->extract_species(name,&stype,dims);
+    if (vptr == NULL || stype != type || dims[1] != count) {
+      if (lmp->comm->me == 0)
+        lmp->error->warning(FLERR,"lammps_scatter_species: "
+                            "unknown species array or mismatched type/count");
+      return;
+    }
+
+    int natoms = static_cast<int> (lmp->atom->natoms);
+
+    if (type == 0)
+      scatter_species(lmp,(int *) vptr,dims,natoms,(int *) data);
+    else
+      scatter_species(lmp,(double *) vptr,dims,natoms,(double *) data);
+  }
+  END_CAPTURE
+}
+
 /* ----------------------------------------------------------------------
    create N atoms and assign them to procs based on coords
    id = atom IDs (optional, NULL will generate 1 to N)
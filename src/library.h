@@ -39,6 +39,7 @@ void *lammps_extract_global(void *, char *);
 void lammps_extract_box(void *, double *, double *, 
                         double *, double *, double *, int *, int *);
 void *lammps_extract_atom(void *, char *);
+void *lammps_extract_species(void *, char *, int *, int *);
 void *lammps_extract_compute(void *, char *, int, int);
 void *lammps_extract_fix(void *, char *, int, int, int, int);
 void *lammps_extract_variable(void *, char *, char *);
@@ -50,6 +51,8 @@ double lammps_get_thermo(void *, char *);
 int lammps_get_natoms(void *);
 void lammps_gather_atoms(void *, char *, int, int, void *);
 void lammps_scatter_atoms(void *, char *, int, int, void *);
+void lammps_gather_species(void *, char *, int, int, void *);
+void lammps_scatter_species(void *, char *, int, int, void *);
 
 // lammps_create_atoms() takes tagint and imageint as args
 // ifdef insures they are compatible with rest of LAMMPS
@@ -86,4 +89,25 @@ This library function cannot be used if atom IDs are not defined or
 are not consecutively numbered, or if no atom map is defined.  See the
 atom_modify command for details about atom maps.
 
+W: Library error in lammps_gather_species
+
+This library function cannot be used if atom IDs are not defined
+or are not consecutively numbered.
+
+W: Library error in lammps_scatter_species
+
+This library function cannot be used if atom IDs are not defined or
+are not consecutively numbered, or if no atom map is defined.
+
+W: lammps_gather_species: unknown species array or mismatched type/count
+
+The name must be C, Q, Cd or Qd of an atom style that allocates it.
+The type must be 1 for C and Q, 0 for Cd and Qd, and the count must
+be the number of species of the array.  For Cd and Qd this is the
+number of SSA species times the number of ensemble replicas.
+
+W: lammps_scatter_species: unknown species array or mismatched type/count
+
+See the lammps_gather_species warning.
+
 */
@@ -16,6 +16,7 @@
 #include "domain.h"
 #include "update.h"
 #include "min.h"
+#include "output.h"
 #include "finish.h"
 #include "timer.h"
 #include "error.h"
@@ -66,6 +67,7 @@ void Minimize::command(int narg, char **arg)
   timer->barrier_stop();
 
   update->minimize->cleanup();
+  output->post_run();
 
   Finish finish(lmp);
   finish.end(1);
@@ -167,6 +167,15 @@ void Output::init()
   }
 }
 
+/* ----------------------------------------------------------------------
+   let dumps complete any output still pending at end of run/min
+------------------------------------------------------------------------- */
+
+void Output::post_run()
+{
+  for (int i = 0; i < ndump; i++) dump[i]->post_run();
+}
+
 /* ----------------------------------------------------------------------
    perform output for setup of run/min
    do dump first, so memory_usage will include dump allocation
@@ -72,6 +72,7 @@ class Output : protected Pointers {
   void write_dump(bigint);           // force output of dump snapshots
   void write_restart(bigint);        // force output of a restart file
   void reset_timestep(bigint);       // reset next timestep for all output
+  void post_run();                   // finish pending output at end of run
 
   void add_dump(int, char **);       // add a Dump to Dump list
   void modify_dump(int, char **);    // modify a Dump
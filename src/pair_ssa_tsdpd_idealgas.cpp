@@ -13,20 +13,29 @@
  
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include "pair_ssa_tsdpd_idealgas.h"
 #include "atom.h"
 #include "force.h"
 #include "comm.h"
+#include "universe.h"
 #include "neigh_list.h"
 #include "memory.h"
 #include "error.h"
 #include "domain.h"
 #include "update.h"
 #include "random_mars.h"
-#include <set>
+#include "ssa_tsdpd_rng.h"
+#include "timer.h"
+#include "ssa_tsdpd_stats.h"
+#include "ssa_tsdpd_scratch.h"
+#include "ssa_tsdpd_dfsp.h"
 #include <unistd.h>
 #include <time.h>
 
+#define SEED_DEFAULT 4928459
+#define MAXSEED 900000000
+
 using namespace LAMMPS_NS;
 
 /* ---------------------------------------------------------------------- */
@@ -36,6 +45,10 @@ PairSsaTsdpdIdealGas::PairSsaTsdpdIdealGas(LAMMPS *lmp) : Pair(lmp)
   restartinfo = 0;
   first = 1;
   random = NULL;
+  rep_random = NULL;
+  dfsp_flag = 0;
+  nrep_random = 0;
+  scratch = new SsaTsdpdScratch(lmp);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -52,7 +65,9 @@ PairSsaTsdpdIdealGas::~PairSsaTsdpdIdealGas() {
     memory->destroy(kappa);
     memory->destroy(cutc);
   }
+    SsaTsdpdRng::destroy_replicas(rep_random,nrep_random);
     if (random) delete random;
+    delete scratch;
 }
 
 
@@ -83,19 +98,16 @@ void PairSsaTsdpdIdealGas::compute(int eflag, int vflag) {
   double *de = atom->de;
   double *e = atom->e;
   double *drho = atom->drho;
-  double **C = atom->C;
-  double **Q = atom->Q;
-  int **Cd = atom->Cd;
-  int **Qd = atom->Qd;
+  SpeciesArray<double> C = atom->C;
+  SpeciesArray<double> Q = atom->Q;
+  SpeciesArray<int> Cd = atom->Cd;
+  SpeciesArray<int> Qd = atom->Qd;
   int *type = atom->type;
   int nlocal = atom->nlocal;
   int newton_pair = force->newton_pair;
   int dimension = domain->dimension;
   double kBoltzmann = force->boltz;
   double dtinv = 1.0 / update->dt;
-  double *dfsp_D_matrix = atom->dfsp_D_matrix;
-  double *dfsp_D_diag = atom->dfsp_D_diag;
-  double *dfsp_Diffusion_coeff = atom->dfsp_Diffusion_coeff;
   int nmax = atom->nmax;
 
 
@@ -121,163 +133,190 @@ void PairSsaTsdpdIdealGas::compute(int eflag, int vflag) {
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
+  timer->sub_start(Timer::SDPD_FORCE);
+
+
+  // per-step temporaries come from the scratch block
 
-// New version of allocation (dfsp_D_matrix is now allocated at the atom_vec_ssa_tsdpd file)
-    std::set<int>* dfsp_D_matrix_index = new std::set<int>[nmax];   // set for each column to store which elements are non-zero
-    int inumsq = inum*inum;
+  scratch->reset();
+  bigint maxentry = 0;
+  if (atom->num_ssa_species > 0)
+    for (ii = 0; ii < inum; ii++) maxentry += 2*numneigh[ilist[ii]];
+  SsaTsdpdIndexSets dfsp_D_matrix_index;   // non-zero columns of each row
+  dfsp_D_matrix_index.init(scratch,nmax,maxentry);
+  double *dfsp_D = scratch->get<double>(maxentry);        // value of each entry
+  double **dfsp_kappa = scratch->get<double *>(maxentry); // SSA kappas of an entry
+  int *dfsp_back = scratch->get<int>(maxentry);           // entry (j,i) of (i,j)
+  double *dfsp_D_diag = scratch->get<double>(nmax);
 
- //TODO: Create dfsp_D_diag, dfsp_Diffusion_coeff at atom_vec_ssa_tsdpd file. Also, we have to think in a better way of working with dfsp_D_matrix_index (std library seems slow)
 
  // loop over neighbors of my atoms
 
 
-  //printf("\tStarting i loop\n");
-  for (ii = 0; ii < inum; ii++) {
+  // species transport is fused into the force loop, with timer full it
+  // runs in a second pass so TDPD_TRANSPORT is measured apart from SDPD_FORCE
+
+  int species = (atom->num_tdpd_species > 0 || atom->num_ssa_species > 0);
+  int npass = (species && timer->has_full()) ? 2 : 1;
 
-    i = ilist[ii]; 
+  for (int pass = 0; pass < npass; pass++) {
+    int forces = (pass == 0);
+    int transport = species && (pass == npass-1);
+    if (!forces) timer->sub_start(Timer::TDPD_TRANSPORT);
+    //printf("\tStarting i loop\n");
+    for (ii = 0; ii < inum; ii++) {
+
+      i = ilist[ii]; 
 
-    //printf("\t\ti=%i\n",i);
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-    vxtmp = v[i][0];
-    vytmp = v[i][1];
-    vztmp = v[i][2];
-    itype = type[i];
-    jlist = firstneigh[i];
-    jnum = numneigh[i];
-    imass = mass[itype];
+      //printf("\t\ti=%i\n",i);
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
+      vxtmp = v[i][0];
+      vytmp = v[i][1];
+      vztmp = v[i][2];
+      itype = type[i];
+      jlist = firstneigh[i];
+      jnum = numneigh[i];
+      imass = mass[itype];
 
 
-    // compute pressure of atom i with ideal gas EOS
-    //tmp = rho[i] / rho0[itype];
+      // compute pressure of atom i with ideal gas EOS
+      //tmp = rho[i] / rho0[itype];
 
-    fi = 0.4 * e[i] / imass / rho[i]; // ideal gas EOS; this expression is fi = pressure/rho^2
-    ci = sqrt(0.4*e[i]/imass); //speed of sound with heat capacity ratio gamma = 1.4
+      fi = 0.4 * e[i] / imass / rho[i]; // ideal gas EOS; this expression is fi = pressure/rho^2
+      ci = sqrt(0.4*e[i]/imass); //speed of sound with heat capacity ratio gamma = 1.4
 
-     for (jj = 0; jj < jnum; jj++) {
-      j = jlist[jj];
-      j &= NEIGHMASK;
+       for (jj = 0; jj < jnum; jj++) {
+        j = jlist[jj];
+        j &= NEIGHMASK;
   
-      delx = xtmp - x[j][0];
-      dely = ytmp - x[j][1];
-      delz = ztmp - x[j][2];
-      rsq = delx * delx + dely * dely + delz * delz;
-      jtype = type[j];
-      jmass = mass[jtype];
-
-      if (rsq < 4.0*cutsq[itype][jtype] ) {
-        h = 2.0*cut[itype][jtype];
-//      if (rsq < cutsq[itype][jtype] ) {
-//        h = cut[itype][jtype];
-
-        ih = 1.0 / h;
-        ihsq = ih * ih;
+        delx = xtmp - x[j][0];
+        dely = ytmp - x[j][1];
+        delz = ztmp - x[j][2];
+        rsq = delx * delx + dely * dely + delz * delz;
+        jtype = type[j];
+        jmass = mass[jtype];
+
+        if (rsq >= 4.0*cutsq[itype][jtype]) continue;
         double r = sqrt(rsq);
 
-        wfd = h - sqrt(rsq);
-        if (domain->dimension == 3) {
-          // Kernel, 3d (1/r * dwdr)
-          wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih; // Lucy (3d)
-        } else if (domain->dimension == 2){
-          // Kernel, 2d (1/r * dwdr)
-          //wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq; //Lucy (2d)
-	  //wfd = -44.563384065730695*ihsq*ihsq*ihsq*ih*wfd*wfd*wfd; //Wendland C2 (2d)
- 	  //wfd = -53.476060878876837*ihsq*ihsq*ihsq*ihsq*ihsq*wfd*wfd*wfd*wfd*wfd*(h+5.0*r); //Wendland C4 (2d)
- 	  wfd = -78.031394955912120*ihsq*ihsq*ihsq*ihsq*ihsq*ihsq*ih*wfd*wfd*wfd*wfd*wfd*wfd*wfd*(h*h + 7.0*h*r + 16.0*rsq); //Wendland C6(2d)
-        } else if (domain->dimension == 1){
-          // Kernel, 1d (1/r * dwdr)
-          wfd = -15.0 * wfd * wfd * ihsq * ihsq * ih; //Lucy (1d)
-        }
+        if (forces) {
+          h = 2.0*cut[itype][jtype];
+  //      if (rsq < cutsq[itype][jtype] ) {
+  //        h = cut[itype][jtype];
+
+          ih = 1.0 / h;
+          ihsq = ih * ih;
+
+          wfd = h - sqrt(rsq);
+          if (domain->dimension == 3) {
+            // Kernel, 3d (1/r * dwdr)
+            wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih; // Lucy (3d)
+          } else if (domain->dimension == 2){
+            // Kernel, 2d (1/r * dwdr)
+            //wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq; //Lucy (2d)
+  	  //wfd = -44.563384065730695*ihsq*ihsq*ihsq*ih*wfd*wfd*wfd; //Wendland C2 (2d)
+   	  //wfd = -53.476060878876837*ihsq*ihsq*ihsq*ihsq*ihsq*wfd*wfd*wfd*wfd*wfd*(h+5.0*r); //Wendland C4 (2d)
+   	  wfd = -78.031394955912120*ihsq*ihsq*ihsq*ihsq*ihsq*ihsq*ih*wfd*wfd*wfd*wfd*wfd*wfd*wfd*(h*h + 7.0*h*r + 16.0*rsq); //Wendland C6(2d)
+          } else if (domain->dimension == 1){
+            // Kernel, 1d (1/r * dwdr)
+            wfd = -15.0 * wfd * wfd * ihsq * ihsq * ih; //Lucy (1d)
+          }
 
 
-        // compute pressure  of atom j with ideal gas EOS
-        fj = 0.4*e[j]/jmass/rho[j];
+          // compute pressure  of atom j with ideal gas EOS
+          fj = 0.4*e[j]/jmass/rho[j];
+          cj = sqrt(0.4*e[j]/jmass);  // also needed by drho[j] below
 
-        velx=vxtmp - v[j][0];
-        vely=vytmp - v[j][1];
-        velz=vztmp - v[j][2];
+          velx=vxtmp - v[j][0];
+          vely=vytmp - v[j][1];
+          velz=vztmp - v[j][2];
 
 
-        // dot product of velocity delta and distance vector
-        delVdotDelR = delx * velx + dely * vely + delz * velz;
+          // dot product of velocity delta and distance vector
+          delVdotDelR = delx * velx + dely * vely + delz * velz;
 
 
-        // Artificial viscosity (Managhan, 1992)
-        fvisc = wfd / (rho[i] * rho[j]);
-        fvisc *= imass * jmass ;
+          // Artificial viscosity (Managhan, 1992)
+          fvisc = wfd / (rho[i] * rho[j]);
+          fvisc *= imass * jmass ;
 
-        if (delVdotDelR < 0.) {
-	  cj = sqrt(0.4*e[j]/jmass);
-          mu = h * delVdotDelR / (rsq + 0.01 * h * h);
-          fvisc = -viscosity[itype][jtype] * (ci + cj) * mu / (rho[i] + rho[j]);
-        } else {
-          fvisc = 0.;
-        }
+          if (delVdotDelR < 0.) {
+            mu = h * delVdotDelR / (rsq + 0.01 * h * h);
+            fvisc = -viscosity[itype][jtype] * (ci + cj) * mu / (rho[i] + rho[j]);
+          } else {
+            fvisc = 0.;
+          }
 
 
-        // total pair force
-        fpair = -imass * jmass * (fi + fj + fvisc) * wfd;
+          // total pair force
+          fpair = -imass * jmass * (fi + fj + fvisc) * wfd;
 
         
-        // random force calculation
-        // independent increments of a Wiener process matrix
-        double wiener[3][3] = {0};
-        for (int l=0; l<dimension; l++){
-            for (int m=0; m<dimension; m++){
-                wiener[l][m] = random->gaussian();
-            }
-        }
+          // random force calculation
+          // independent increments of a Wiener process matrix
+          double wiener[3][3] = {0};
+          for (int l=0; l<dimension; l++){
+              for (int m=0; m<dimension; m++){
+                  wiener[l][m] = random->gaussian();
+              }
+          }
 
 
-        // symmetric part
-        wiener[0][1] = wiener[1][0] = (wiener[0][1] + wiener[1][0]) / 2.;
-        wiener[0][2] = wiener[2][0] = (wiener[0][2] + wiener[2][0]) / 2.;
-        wiener[1][2] = wiener[2][1] = (wiener[1][2] + wiener[2][1]) / 2.;
+          // symmetric part
+          wiener[0][1] = wiener[1][0] = (wiener[0][1] + wiener[1][0]) / 2.;
+          wiener[0][2] = wiener[2][0] = (wiener[0][2] + wiener[2][0]) / 2.;
+          wiener[1][2] = wiener[2][1] = (wiener[1][2] + wiener[2][1]) / 2.;
 
-        // traceless part
-        double trace_over_dim = (wiener[0][0] + wiener[1][1] + wiener[2][2]) / dimension;
-        wiener[0][0] -= trace_over_dim;
-        wiener[1][1] -= trace_over_dim;
-        wiener[2][2] -= trace_over_dim;
+          // traceless part
+          double trace_over_dim = (wiener[0][0] + wiener[1][1] + wiener[2][2]) / dimension;
+          wiener[0][0] -= trace_over_dim;
+          wiener[1][1] -= trace_over_dim;
+          wiener[2][2] -= trace_over_dim;
 
-        double prefactor = sqrt (-4. * kBoltzmann* e[i] * fvisc * dtinv) / r;
-        double f_random[3] = {0};
+          double prefactor = sqrt (-4. * kBoltzmann* e[i] * fvisc * dtinv) / r;
+          double f_random[3] = {0};
 
 
-        for (int l=0; l<dimension; ++l)  f_random[l] = prefactor * (wiener[l][0]*delx + wiener[l][1]*dely + wiener[l][2]*delz);
+          for (int l=0; l<dimension; ++l)  f_random[l] = prefactor * (wiener[l][0]*delx + wiener[l][1]*dely + wiener[l][2]*delz);
 
 
-        // final forces
-        f[i][0] += delx * fpair;  //+ f_random[0];
-        f[i][1] += dely * fpair;  //+ f_random[1];
-        f[i][2] += delz * fpair;  //+ f_random[2];
+          // final forces
+          f[i][0] += delx * fpair;  //+ f_random[0];
+          f[i][1] += dely * fpair;  //+ f_random[1];
+          f[i][2] += delz * fpair;  //+ f_random[2];
 
 
-        // density
-        drho[i] += jmass * delVdotDelR * wfd - 0.1 * h * ci * jmass * 2.0*(rho[j]/rho[i] - 1.0)  * wfd;
+          // density
+          drho[i] += jmass * delVdotDelR * wfd - 0.1 * h * ci * jmass * 2.0*(rho[j]/rho[i] - 1.0)  * wfd;
 
-        // drho[i] += rho0[itype] *(1.0 - 1e-6*(C[i][0] - 1.0));
+          // drho[i] += rho0[itype] *(1.0 - 1e-6*(C[i][0] - 1.0));
 
 
-        // thermal energy
-        deltaE = -0.5 *(fpair * delVdotDelR + fvisc * (velx*velx + vely*vely + velz*velz));
-        de[i] += deltaE;
+          // thermal energy
+          deltaE = -0.5 *(fpair * delVdotDelR + fvisc * (velx*velx + vely*vely + velz*velz));
+          de[i] += deltaE;
 
 
-        // Reactions in neighbors (j particles)
-        if (newton_pair || j < nlocal) {
-     	  f[j][0] -= delx * fpair;  //+ f_random[0]; 
-          f[j][1] -= dely * fpair;  //+ f_random[1];
-          f[j][2] -= delz * fpair;  //+ f_random[2];
-          de[j] += deltaE;
-          drho[j] += imass * delVdotDelR * wfd - 0.1 * h * cj * imass * 2.0*(rho[i]/rho[j] - 1.0) * wfd;
-         // drho[j] += rho0[jtype] *(1.0 - 1e-6*(C[j][0] - 1.0) );
-        }
+          // Reactions in neighbors (j particles)
+          if (newton_pair || j < nlocal) {
+       	  f[j][0] -= delx * fpair;  //+ f_random[0]; 
+            f[j][1] -= dely * fpair;  //+ f_random[1];
+            f[j][2] -= delz * fpair;  //+ f_random[2];
+            de[j] += deltaE;
+            drho[j] += imass * delVdotDelR * wfd - 0.1 * h * cj * imass * 2.0*(rho[i]/rho[j] - 1.0) * wfd;
+           // drho[j] += rho0[jtype] *(1.0 - 1e-6*(C[j][0] - 1.0) );
+          }
+
 
+  
+          if (evflag)
+            ev_tally(i, j, nlocal, newton_pair, 0.0, 0.0, fpair, delx, dely, delz);
+        }
 
-         // transport of species
-        if (r < 2.0*cutc[itype][jtype]) {
+        // transport of species
+        if (transport && r < 2.0*cutc[itype][jtype]) {
             h = 2.0*cutc[itype][jtype];
 //        if (r < cutc[itype][jtype]) {
 //            h = cutc[itype][jtype];
@@ -307,16 +346,15 @@ void PairSsaTsdpdIdealGas::compute(int eflag, int vflag) {
               //printf("\t\t\tAssigning D matrix[%i][%i]\n",i,j);
 
 	      if (atom->num_ssa_species > 0) {
-                dfsp_D_matrix[i*inum+j] = - dQc_base;
-                dfsp_D_matrix_index[i].insert(j);
-                dfsp_D_matrix[j*inum+i] = - dQc_base;
-                dfsp_D_matrix_index[j].insert(i);
+                int e = dfsp_D_matrix_index.insert(i,j);
+                dfsp_D[e] = - dQc_base;
+                dfsp_kappa[e] = kappa[itype][jtype] + atom->num_tdpd_species;
+                int eb = dfsp_D_matrix_index.insert(j,i);
+                dfsp_D[eb] = - dQc_base;
+                dfsp_kappa[eb] = kappa[itype][jtype] + atom->num_tdpd_species;
+                dfsp_back[e] = eb;
+                dfsp_back[eb] = e;
   
-   	        // TODO: dfsp_Diffusion_coeff seems redundant here. kappa[itype][jtype][s] is already allocated.
-                for(int s=0;s<atom->num_ssa_species;s++){
-                  dfsp_Diffusion_coeff[i*inum+j+s*inumsq] = kappa[itype][jtype][s];
-                  dfsp_Diffusion_coeff[j*inum+i+s*inumsq] = kappa[itype][jtype][s];
-                }
               }
 
             
@@ -327,11 +365,10 @@ void PairSsaTsdpdIdealGas::compute(int eflag, int vflag) {
             }
 
         }
-  
-        if (evflag)
-          ev_tally(i, j, nlocal, newton_pair, 0.0, 0.0, fpair, delx, dely, delz);
       }
-   }
+    }
+
+    timer->sub_stamp(forces ? Timer::SDPD_FORCE : Timer::TDPD_TRANSPORT);
   }
 
   if (vflag_fdotr) virial_fdotr_compute();
@@ -340,81 +377,107 @@ void PairSsaTsdpdIdealGas::compute(int eflag, int vflag) {
 
 
   if (atom->num_ssa_species > 0) {
+  timer->sub_start(Timer::SSA_DIFFUSION);
+  SsaTsdpdStats *stats = atom->ssa_stats;
+  if (stats) stats->start();
  
   //printf("Starting SSA diffusion\n");
   // Second Step: Calculate SSA Diffusion
   // Find Diagional element values
-  std::set<int>::iterator it;
+  int it;
   for (ii = 0; ii < inum; ii++) {
     i = ilist[ii];
     double total = 0;
-    for (it=dfsp_D_matrix_index[i].begin(); it!=dfsp_D_matrix_index[i].end(); ++it){  // Using a set::iterator
-        total += *it;
+    for (it = dfsp_D_matrix_index.head[i]; it >= 0; it = dfsp_D_matrix_index.next[it]) {
+        total += dfsp_D[it];
     }
-    dfsp_D_diag[i] = total;
+    dfsp_D_diag[i] = -total;    // minus the row sum
   }
     
   double tt,a0,sum_d,sum_d2,r1,r2,r3,a_i_src_orig,a_i_dest_orig;
-  double* a_i = new double[inum];
+  // ghost entries stay 0, a molecule that jumps to a ghost voxel
+  // leaves the propensity of this processor
+  double *a_i = scratch->zero<double>(nmax);
   int k;
-  for(int s=0;s<atom->num_ssa_species;s++){  // Calculate each species seperatly
+  int nssa = atom->num_ssa_species;
+  int nrep = atom->num_ssa_replicas;
+  if (dfsp_flag) {
+    SsaTsdpdDfsp dfsp(scratch,&dfsp_D_matrix_index,dfsp_D,dfsp_kappa,dfsp_back);
+    for (int s = 0; s < nssa; s++)
+      dfsp.diffuse(s,update->dt,inum,ilist,rep_random,nrep,Cd,Qd,stats);
+  } else
+  for(int sq=0;sq<nssa*nrep;sq++){  // Calculate each species seperatly
+    // replica q of species s is column c of Cd, Qd and has a stream of its
+    // own, the replicas of one species follow each other
+    int s = sq / nrep;
+    int q = sq % nrep;
+    int c = q*nssa + s;
+    RanMars *rng = rep_random[q];
+    // species s of all voxels, unit stride in the species-major layout
+    int *cd = Cd.species(c);
+    int cstride = Cd.astride;
+    // the per-voxel base propensities only depend on the geometry,
+    // all replicas of species s use those of the first one
+    if (q == 0) {
+      for (ii = 0; ii < inum; ii++) {
+        i = ilist[ii];
+        a_i[i] = 0;
+        for (it = dfsp_D_matrix_index.head[i]; it >= 0; it = dfsp_D_matrix_index.next[it]) {
+          a_i[i] += dfsp_kappa[it][s] * dfsp_D[it]; // Note, "a_i" is the per-voxel base propensity (must multiply Cd[i][s]);
+        }
+      }
+    }
     // sum each voxel propensity to get total propensity
     a0 = 0;
     for (ii = 0; ii < inum; ii++) {
       i = ilist[ii];
-      a_i[i] = 0;
-      for (it=dfsp_D_matrix_index[i].begin(); it!=dfsp_D_matrix_index[i].end(); ++it){  // iterator over outbound connections
-        j = *it;
-
-        a_i[i] += dfsp_Diffusion_coeff[i*inum+j+s*inumsq] * dfsp_D_matrix[i*inum+j]; // Note, "a_i" is the per-voxel base propensity (must multiply Cd[i][s]);
-      }
-      a0 += a_i[i] * Cd[i][s];
+      a0 += a_i[i] * cd[i*cstride];
+      if (stats) stats->propensity(i,a_i[i] * cd[i*cstride]);
     }
     // Find time to first reaction
     tt=0;
-    r1 = random->uniform();
+    r1 = rng->uniform();
     tt += -log(1.0-r1)/a0 ;
     //printf("SSA_Diffusion[s=%i] Cd[%i][%i]=%i tt=%e a0=%e r1=%e\n",s,i,s,Cd[i][s],tt,a0,r1);
     // Loop over time
     while(tt < update->dt){
         // find which voxel the diffusion event occured
-        r2 = a0 * random->uniform();
+        r2 = a0 * rng->uniform();
         sum_d = 0;
         for(k=0; k < inum; k++){
-            sum_d += a_i[k] * Cd[k][s];
+            sum_d += a_i[k] * cd[k*cstride];
             if(sum_d > r2) break;
             //printf("\t k=%i sum_d=%e r2=%e\n",k,sum_d,r2);
         }
         int src_vox = k;
+        if (stats) stats->diffusion(src_vox,s);
         // find which voxel it moved to
-        r3 = a_i[k] * random->uniform();
+        r3 = a_i[k] * rng->uniform();
         sum_d2=0;
-        for (it=dfsp_D_matrix_index[src_vox].begin(); it!=dfsp_D_matrix_index[src_vox].end(); ++it){
-            j = *it;
-            sum_d2 += dfsp_Diffusion_coeff[src_vox*inum+j+s*inumsq] * dfsp_D_matrix[src_vox*inum+j];
+        for (it = dfsp_D_matrix_index.head[src_vox]; it >= 0; it = dfsp_D_matrix_index.next[it]) {
+            j = dfsp_D_matrix_index.col[it];
+            sum_d2 += dfsp_kappa[it][s] * dfsp_D[it];
             if(sum_d2 > r3) break;
         }
         int dest_vox = j;
         // Move molecule  //TODO: which way is better? Computing Cd directly, or passing molecule diffusion via Qd? (I guess Qd is better).
         //Cd[src_vox][s]--;
         //Cd[dest_vox][s]++;
-   	Qd[src_vox][s]--;
-        Qd[dest_vox][s]++;
+   	Qd[src_vox][c]--;
+        Qd[dest_vox][c]++;
         // Find delta in propensities
         a0 += (a_i[dest_vox] - a_i[src_vox]);
         
         //printf("SSA_Diffusion[s=%i] tt=%e %i -> %i.  Now a0=%e",s,tt,src_vox,dest_vox,a0);
         // Find time to next reaction
-        r1 = random->uniform();
+        r1 = rng->uniform();
         tt += -log(1.0-r1)/(a0);
         //printf(" tt=%e\n",tt);
     }
-  delete[] a_i;
   }
-  delete[] dfsp_D_matrix_index;
   
-  // TODO: implement full DFSP diffusion here
 
+  timer->sub_stamp(Timer::SSA_DIFFUSION);
   }
 
 }
@@ -450,19 +513,33 @@ void PairSsaTsdpdIdealGas::allocate() {
  ------------------------------------------------------------------------- */
 
 void PairSsaTsdpdIdealGas::settings(int narg, char **arg) {
-  if (narg != 0)
+  if (narg % 2)
     error->all(FLERR,
         "Illegal number of setting arguments for pair_style ssa_tsdpd/idealgas");
 
-  // seed is immune to underflow/overflow because it is unsigned
-//  seed = comm->nprocs + comm->me + atom->nlocal;
-//  if (narg == 3) seed += force->inumeric (FLERR, arg[2]);
-//  random = new RanMars (lmp, seed);
-
-  srand(clock());
-  seed = comm->nprocs + comm->me + atom->nlocal + rand()%100;
-  random = new RanMars (lmp,seed);
+  // the streams do not depend on the clock, so a restart can continue them
+  // proc p of the universe draws from seed + p
+
+  int seed_all = SEED_DEFAULT;
+  dfsp_flag = 0;
+  for (int iarg = 0; iarg < narg; iarg += 2) {
+    if (strcmp(arg[iarg],"seed") == 0) {
+      seed_all = force->inumeric(FLERR,arg[iarg+1]);
+      if (seed_all <= 0 || seed_all > MAXSEED - universe->nprocs)
+        error->all(FLERR,"Illegal pair_style ssa_tsdpd/idealgas command");
+    } else if (strcmp(arg[iarg],"diffusion") == 0) {
+      if (strcmp(arg[iarg+1],"ssa") == 0) dfsp_flag = 0;
+      else if (strcmp(arg[iarg+1],"dfsp") == 0) dfsp_flag = 1;
+      else error->all(FLERR,"Illegal pair_style ssa_tsdpd/idealgas command");
+    } else error->all(FLERR,"Illegal pair_style ssa_tsdpd/idealgas command");
+  }
 
+  seed = seed_all + universe->me;
+  SsaTsdpdRng::destroy_replicas(rep_random,nrep_random);
+  delete random;
+  random = new RanMars(lmp,seed);
+  nrep_random = atom->num_ssa_replicas;
+  rep_random = SsaTsdpdRng::create_replicas(lmp,random,seed,nrep_random);
 }
 
 /* ----------------------------------------------------------------------
@@ -548,3 +625,29 @@ double PairSsaTsdpdIdealGas::single(int i, int j, int itype, int jtype,
 
   return 0.0;
 }
+
+/* ---------------------------------------------------------------------- */
+
+void *PairSsaTsdpdIdealGas::extract(const char *str, int &dim) {
+  dim = 0;
+  if (strcmp(str,"random") == 0) return (void *) random;
+  dim = 1;
+  if (strcmp(str,"random_replicas") == 0) return (void *) rep_random;
+  if (strcmp(str,"soundspeed") == 0) return (void *) soundspeed;
+  if (strcmp(str,"rho0") == 0) return (void *) rho0;
+  dim = 2;
+  if (strcmp(str,"cut") == 0) return (void *) cut;
+  if (strcmp(str,"viscosity") == 0) return (void *) viscosity;
+  return NULL;
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of the per-step scratch block
+------------------------------------------------------------------------- */
+
+double PairSsaTsdpdIdealGas::memory_usage()
+{
+  double bytes = Pair::memory_usage();
+  bytes += scratch->memory_usage();
+  return bytes;
+}
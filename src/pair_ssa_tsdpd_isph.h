@@ -0,0 +1,61 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(ssa_tsdpd/isph,PairSsaTsdpdIsph)
+
+#else
+
+#ifndef LMP_PAIR_SSA_TSDPD_ISPH_H
+#define LMP_PAIR_SSA_TSDPD_ISPH_H
+
+#include "pair.h"
+
+namespace LAMMPS_NS {
+
+class PairSsaTsdpdIsph : public Pair {
+ public:
+  PairSsaTsdpdIsph(class LAMMPS *);
+  virtual ~PairSsaTsdpdIsph();
+  virtual void compute(int, int);
+  void settings(int, char **);
+  void coeff(int, char **);
+  virtual void init_style();
+  virtual double init_one(int, int);
+  virtual double single(int, int, int, int, double, double, double, double &);
+  void *extract(const char *, int &);
+  double memory_usage();
+  class RanMars *random;
+  class RanMars **rep_random;   // stream of each SSA replica, [0] = random
+  int nrep_random;
+
+ protected:
+  double *rho0;
+  double **cut,**viscosity;
+  double *temperature; //added
+  double ***kappa; //added
+  double **cutc; //added
+  int first;
+  int shardlow_flag;   // 1 if fix ssa_tsdpd/shardlow integrates viscous/random terms
+  unsigned int seed;
+  int dfsp_flag;                    // 1 to diffuse Cd by DFSP, 0 by jumps
+  class SsaTsdpdScratch *scratch;   // per-step temporaries
+
+  void allocate();
+};
+
+}
+
+#endif
+#endif
@@ -113,3 +113,32 @@ double RanMars::gaussian()
   }
   return first;
 }
+
+/* ----------------------------------------------------------------------
+   store the state of the generator, u[1-97] then i97, j97, c, save, second
+   cd and cm are constants
+------------------------------------------------------------------------- */
+
+void RanMars::get_state(double *state)
+{
+  for (int i = 0; i < 97; i++) state[i] = u[i+1];
+  state[97] = i97;
+  state[98] = j97;
+  state[99] = c;
+  state[100] = save;
+  state[101] = second;
+}
+
+/* ----------------------------------------------------------------------
+   continue the sequence of a state stored by get_state()
+------------------------------------------------------------------------- */
+
+void RanMars::set_state(double *state)
+{
+  for (int i = 0; i < 97; i++) u[i+1] = state[i];
+  i97 = static_cast<int> (state[97]);
+  j97 = static_cast<int> (state[98]);
+  c = state[99];
+  save = static_cast<int> (state[100]);
+  second = state[101];
+}
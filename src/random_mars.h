@@ -25,6 +25,12 @@ class RanMars : protected Pointers {
   double uniform();
   double gaussian();
 
+  // state in size_state() doubles, e.g. for restart files
+
+  static int size_state() { return 97 + 5; }
+  void get_state(double *);
+  void set_state(double *);
+
  private:
   int save;
   double second;
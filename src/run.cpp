@@ -184,6 +184,7 @@ void Run::command(int narg, char **arg)
     timer->barrier_stop();
 
     update->integrate->cleanup();
+    output->post_run();
 
     Finish finish(lmp);
     finish.end(postflag);
@@ -225,6 +226,7 @@ void Run::command(int narg, char **arg)
       timer->barrier_stop();
 
       update->integrate->cleanup();
+      output->post_run();
 
       Finish finish(lmp);
       if (postflag || nleft <= nsteps) finish.end(1);
@@ -752,9 +752,11 @@ void Set::set(int keyword)
 	if (dvalue >=0.0) atom->C[i][ivalue] = dvalue;
 	 }
 
-    // set concentration for SSA species (stochastic)
+    // set concentration for SSA species (stochastic), in every replica
     else if (keyword == SSATSDPD_CD) {
-	if (ivalue2 >=0) atom->Cd[i][ivalue] = ivalue2;
+	if (ivalue2 >=0)
+	  for (int k = ivalue; k < atom->Cd.ncol; k += atom->num_ssa_species)
+	    atom->Cd[i][k] = ivalue2;
 	 }
 
     // set shape of ellipsoidal particle
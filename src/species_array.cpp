@@ -0,0 +1,157 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include <string.h>
+#include "species_array.h"
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+
+#define MIN(A,B) ((A) < (B) ? (A) : (B))
+
+/* ----------------------------------------------------------------------
+   (re)allocate n atoms x ns species in layout
+   atom-major reallocs in place, species-major copies each species
+     into a new block with the leading dimension padded to SPECIES_PAD
+   the layout is not meant to change between calls
+------------------------------------------------------------------------- */
+
+template<class T>
+void SpeciesArray<T>::grow(Memory *memory, int n, int ns, int which,
+                           const char *name)
+{
+  if (!owned) data = NULL;
+
+  if (which == ATOM_MAJOR) {
+    data = (T *) memory->srealloc(data,sizeof(T)*((bigint) n)*ns,name);
+    astride = ns;
+    sstride = 1;
+  } else {
+    int ld = (n + SPECIES_PAD-1) / SPECIES_PAD * SPECIES_PAD;
+    T *newdata = (T *) memory->smalloc(sizeof(T)*((bigint) ld)*ns,name);
+    if (data) {
+      int ncopy = MIN(n,nrow);
+      int nspec = MIN(ns,ncol);
+      for (int k = 0; k < nspec; k++) {
+        T *dst = &newdata[(bigint) k*ld];
+        for (int i = 0; i < ncopy; i++) dst[i] = (*this)(i,k);
+      }
+      memory->sfree(data);
+    }
+    data = newdata;
+    astride = 1;
+    sstride = ld;
+  }
+
+  nrow = n;
+  ncol = ns;
+  layout = which;
+  owned = 1;
+}
+
+/* ----------------------------------------------------------------------
+   view n x ns atom-major data allocated elsewhere, e.g. a Kokkos host view
+   stride = distance between consecutive atoms
+------------------------------------------------------------------------- */
+
+template<class T>
+void SpeciesArray<T>::wrap(T *ptr, int n, int ns, int stride)
+{
+  data = ptr;
+  nrow = n;
+  ncol = ns;
+  astride = stride;
+  sstride = 1;
+  layout = ATOM_MAJOR;
+  owned = 0;
+}
+
+/* ----------------------------------------------------------------------
+   zero atoms 0 to n-1 of all species
+------------------------------------------------------------------------- */
+
+template<class T>
+void SpeciesArray<T>::zero(int n)
+{
+  if (n <= 0 || ncol == 0) return;
+
+  if (astride == 1) {
+    for (int k = 0; k < ncol; k++)
+      memset(&data[(bigint) k*sstride],0,sizeof(T)*n);
+  } else if (astride == ncol) {
+    memset(data,0,sizeof(T)*((bigint) n)*ncol);
+  } else {
+    for (int i = 0; i < n; i++)
+      for (int k = 0; k < ncol; k++) (*this)(i,k) = 0;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   permute atoms 0 to n-1, new atom i = old atom perm[i]
+   species-major gathers one species at a time through buf,
+     atom-major gathers whole atoms
+------------------------------------------------------------------------- */
+
+template<class T>
+void SpeciesArray<T>::reorder(int n, int *perm, T *buf)
+{
+  if (n <= 0 || ncol == 0) return;
+
+  int i,k;
+
+  if (astride == 1) {
+    for (k = 0; k < ncol; k++) {
+      T *s = &data[(bigint) k*sstride];
+      for (i = 0; i < n; i++) buf[i] = s[perm[i]];
+      memcpy(s,buf,sizeof(T)*n);
+    }
+  } else {
+    T *b = buf;
+    for (i = 0; i < n; i++) {
+      T *s = atom(perm[i]);
+      for (k = 0; k < ncol; k++) *b++ = s[(bigint) k*sstride];
+    }
+    b = buf;
+    for (i = 0; i < n; i++) {
+      T *s = atom(i);
+      for (k = 0; k < ncol; k++) s[(bigint) k*sstride] = *b++;
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template<class T>
+void SpeciesArray<T>::destroy(Memory *memory)
+{
+  if (owned) memory->sfree(data);
+  data = NULL;
+  nrow = ncol = 0;
+  astride = 0;
+  sstride = 1;
+  owned = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+template<class T>
+bigint SpeciesArray<T>::usage() const
+{
+  if (layout == ATOM_MAJOR) return sizeof(T) * ((bigint) nrow) * ncol;
+  return sizeof(T) * ((bigint) sstride) * ncol;
+}
+
+namespace LAMMPS_NS {
+template class SpeciesArray<double>;
+template class SpeciesArray<int>;
+}
@@ -0,0 +1,96 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+SpeciesArray = templated view of a per-atom, per-species array
+  stores the values of all atoms and species in one contiguous block
+  in one of two layouts
+    ATOM_MAJOR = all species of one atom are adjacent, as memory->grow()
+    SPECIES_MAJOR = all atoms of one species are adjacent, each species
+                    padded to a multiple of SPECIES_PAD datums so that
+                    every species starts aligned with LAMMPS_MEMALIGN
+usage:
+  a[i][k] = value of atom i and species k in either layout
+  a.species(k) = ptr to species k, stride a.astride between atoms
+  a.atom(i) = ptr to atom i, stride a.sstride between species
+  a.row(i,k)[m] = value of atom i and species k+m, e.g. one SSA replica
+  copies are shallow, like a double ** from memory->grow(),
+    and go stale when the array is grown
+methods:
+  grow(memory,n,ns,layout,name) = (re)allocate n atoms x ns species,
+    keeps the values of the first min(n,old n) atoms
+  wrap(ptr,n,ns,stride) = view atom-major data owned by someone else
+  zero(n) = set atoms 0 to n-1 of all species to 0, one memset per block
+  reorder(n,perm,buf) = atom i becomes old atom perm[i] for i < n,
+    buf = scratch space for n x ns values
+  destroy(memory) = free owned data, reset to empty
+  usage() = bytes of allocated or viewed memory
+------------------------------------------------------------------------- */
+
+#ifndef LMP_SPECIES_ARRAY_H
+#define LMP_SPECIES_ARRAY_H
+
+#include <stddef.h>
+#include "lmptype.h"
+
+namespace LAMMPS_NS {
+
+enum SpeciesLayout {ATOM_MAJOR,SPECIES_MAJOR};
+
+#define SPECIES_PAD 16
+
+template<class T>
+class SpeciesArray {
+ public:
+  T *data;          // first datum, NULL if nothing is allocated
+  int nrow,ncol;    // # of atoms and species
+  int astride;      // distance between atoms i and i+1 of one species
+  int sstride;      // distance between species k and k+1 of one atom
+  int layout;       // ATOM_MAJOR or SPECIES_MAJOR
+  int owned;        // 1 if data is freed by destroy()
+
+  class Row {
+   public:
+    Row(T *p, int s) : ptr(p), stride(s) {}
+    T &operator[](int k) const { return ptr[(bigint) k*stride]; }
+   private:
+    T *ptr;
+    int stride;
+  };
+
+  SpeciesArray() : data(NULL), nrow(0), ncol(0), astride(0), sstride(1),
+    layout(ATOM_MAJOR), owned(0) {}
+
+  Row operator[](int i) const {
+    return Row(data + (bigint) i*astride,sstride);
+  }
+  T &operator()(int i, int k) const {
+    return data[(bigint) i*astride + (bigint) k*sstride];
+  }
+  T *species(int k) const { return data + (bigint) k*sstride; }
+  T *atom(int i) const { return data + (bigint) i*astride; }
+  Row row(int i, int k) const {
+    return Row(data + (bigint) i*astride + (bigint) k*sstride,sstride);
+  }
+
+  void grow(class Memory *, int, int, int, const char *);
+  void wrap(T *, int, int, int);
+  void zero(int);
+  void reorder(int, int *, T *);
+  void destroy(class Memory *);
+  bigint usage() const;
+};
+
+}
+
+#endif
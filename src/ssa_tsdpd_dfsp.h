@@ -0,0 +1,68 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_SSA_TSDPD_DFSP_H
+#define LMP_SSA_TSDPD_DFSP_H
+
+#include "species_array.h"
+
+namespace LAMMPS_NS {
+
+// diffusive finite state projection (DFSP, Drawert et al., 2010) of the
+//   SSA diffusion of one step, used by the pair styles with the keyword
+//   diffusion dfsp instead of the direct SSA over single jumps
+// the jump graph is the one of the direct SSA: entry e = (i,j) of D has
+//   the rate D[e]*kappa[e][s] of a molecule of species s from i to j,
+//   back[e] is the entry (j,i)
+// diffuse() projects the diffusion operator onto the star of each owned
+//   voxel i, i and its neighbors j with the jumps i -> j and j -> i,
+//   integrates the probability vector of a molecule starting in i over
+//   dt with a truncated Taylor series of the exponential, and moves the
+//   molecules of i to the voxels of the star with one multinomial draw
+// all molecules are moved from the populations at the start of the step,
+//   at most one hop each, so populations stay non-negative and the
+//   amount of each species is conserved
+// the probabilities depend on the species only, replicas reuse them
+
+class RanMars;
+class SsaTsdpdScratch;
+class SsaTsdpdIndexSets;
+class SsaTsdpdStats;
+
+class SsaTsdpdDfsp {
+ public:
+  SsaTsdpdDfsp(SsaTsdpdScratch *, SsaTsdpdIndexSets *, double *,
+               double **, int *);
+  void diffuse(int, double, int, int *, RanMars **, int,
+               SpeciesArray<int> &, SpeciesArray<int> &, SsaTsdpdStats *);
+
+  // # of successes of n trials with probability p, exact for all n, p
+
+  static int binomial(RanMars *, int, double);
+
+ private:
+  SsaTsdpdScratch *scratch;
+  SsaTsdpdIndexSets *graph;
+  double *D;
+  double **kappa;
+  int *back;
+
+  int star(int, int, double);
+  double *prob,*term,*next,*rate_out,*rate_in;
+  int *voxel;
+  int maxstar;
+};
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_SSA_TSDPD_KERNEL_H
+#define LMP_SSA_TSDPD_KERNEL_H
+
+#include <math.h>
+
+// smoothing kernel of pair_style ssa_tsdpd/wc and ssa_tsdpd/isph for
+//   the fixes that loop over the same pairs outside the pair style
+// h is the cutoff: Lucy in 1d and 3d, Wendland C6 with support h in 2d
+
+namespace LAMMPS_NS {
+
+namespace SsaTsdpdKernel {
+
+  // wfd = (1/r) dW/dr at distance sqrt(rsq)
+
+  static inline double gradient(int dimension, double rsq, double h)
+  {
+    double ih,ihsq,wfd;
+    double r = sqrt(rsq);
+
+    if (dimension == 3) {
+      ih = 1.0 / h;
+      ihsq = ih * ih;
+      wfd = h - r;
+      wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
+    } else if (dimension == 2) {
+      h = 0.5 * h;
+      ih = 1.0 / h;
+      ihsq = ih * ih;
+      wfd = 0.886720397226274 * ihsq*ihsq*ihsq*ihsq*ihsq*ihsq*ih* ( -5.5*h*h*h*h*h*h*h*h*h + 16.5*h*h*h*h*h*h*h*rsq -43.3125*h*h*h*h*h*rsq*rsq + 57.75*h*h*h*h*rsq*rsq*r -36.0938*h*h*h*rsq*rsq*rsq +12.375*h*h*rsq*rsq*rsq*r -2.25586*h*rsq*rsq*rsq*rsq + 0.171875*rsq*rsq*rsq*rsq*r );
+    } else {
+      ih = 1.0 / h;
+      ihsq = ih * ih;
+      wfd = h - r;
+      wfd = -15.0 * wfd * wfd * ihsq * ihsq * ih;
+    }
+    return wfd;
+  }
+
+}
+
+}
+
+#endif
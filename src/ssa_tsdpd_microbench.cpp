@@ -0,0 +1,1071 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+// microbenchmarks of the SDPD/tDPD/SSA inner loops
+// not part of the LAMMPS library, built next to lmp_machine by
+//   make mode=microbench machine
+// as ssa_tsdpd_microbench_machine, see usage() for the sections
+
+#include <mpi.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "lammps.h"
+#include "input.h"
+#include "atom.h"
+#include "force.h"
+#include "pair.h"
+#include "modify.h"
+#include "fix.h"
+#include "update.h"
+#include "timer.h"
+#include "neigh_list.h"
+#include "ssa_tsdpd_stats.h"
+#include "math_const.h"
+
+#if defined(__linux__)
+#define SSA_TSDPD_PERF
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+using namespace LAMMPS_NS;
+using namespace MathConst;
+
+enum{PAIR,DIFFUSION,REACTION,KERNEL,SELECT,NSECTION};
+static const char *section_names[NSECTION] =
+  {"pair","diffusion","reaction","kernel","select"};
+
+enum{CYCLES,INSTRUCTIONS,CACHE_MISSES,BRANCH_MISSES,NCOUNTER};
+static const char *counter_names[NCOUNTER] =
+  {"cycles","instructions","cache_misses","branch_misses"};
+
+struct Options {
+  int run[NSECTION];   // sections to run
+  int dimension;       // -d, 2 or 3
+  int n;               // -n, lattice points per direction
+  double hfac;         // -h, cutoff in lattice spacings
+  int ntdpd,nssa;      // -tdpd, -ssa, species of the pair section
+  double kappa;        // -kappa, diffusivity of all species
+  int cd;              // -cd, SSA copy number per voxel
+  double rate;         // -rate, reactions per voxel and step
+  int reps;            // -reps, calls of the LAMMPS loops
+  int nsel;            // -nsel, propensities of the select section
+  double nevent;       // -events, events of the select section
+  int counters;        // 0 with -nocounters
+  const char *layout;  // -layout, storage of the species arrays
+  char *json;          // -o, JSON report
+};
+
+struct Result {
+  const char *section;
+  char name[32];
+  const char *unit;
+  double count;              // # of pairs or events, summed over procs
+  double seconds;            // time of the loop, summed over procs
+  double counter[NCOUNTER];  // summed over procs, -1 if not available
+};
+
+static std::vector<Result> results;
+
+/* ----------------------------------------------------------------------
+   hardware counters of the calling thread via perf_event_open(),
+   user space only, value[] is -1 for counters that cannot be opened
+------------------------------------------------------------------------- */
+
+class Counters {
+ public:
+  double value[NCOUNTER];
+
+  Counters(int enable) {
+    for (int m = 0; m < NCOUNTER; m++) {
+      fd[m] = -1;
+      value[m] = -1.0;
+    }
+#ifdef SSA_TSDPD_PERF
+    if (!enable) return;
+    static const unsigned long long config[NCOUNTER] =
+      {PERF_COUNT_HW_CPU_CYCLES,PERF_COUNT_HW_INSTRUCTIONS,
+       PERF_COUNT_HW_CACHE_MISSES,PERF_COUNT_HW_BRANCH_MISSES};
+    for (int m = 0; m < NCOUNTER; m++) {
+      struct perf_event_attr pe;
+      memset(&pe,0,sizeof(pe));
+      pe.type = PERF_TYPE_HARDWARE;
+      pe.size = sizeof(pe);
+      pe.config = config[m];
+      pe.disabled = 1;
+      pe.exclude_kernel = 1;
+      pe.exclude_hv = 1;
+      fd[m] = syscall(__NR_perf_event_open,&pe,0,-1,-1,0);
+    }
+#endif
+  }
+
+  ~Counters() {
+#ifdef SSA_TSDPD_PERF
+    for (int m = 0; m < NCOUNTER; m++)
+      if (fd[m] >= 0) close(fd[m]);
+#endif
+  }
+
+  void start() {
+#ifdef SSA_TSDPD_PERF
+    for (int m = 0; m < NCOUNTER; m++) {
+      if (fd[m] < 0) continue;
+      ioctl(fd[m],PERF_EVENT_IOC_RESET,0);
+      ioctl(fd[m],PERF_EVENT_IOC_ENABLE,0);
+    }
+#endif
+  }
+
+  void stop() {
+#ifdef SSA_TSDPD_PERF
+    for (int m = 0; m < NCOUNTER; m++) {
+      if (fd[m] < 0) continue;
+      ioctl(fd[m],PERF_EVENT_IOC_DISABLE,0);
+      long long count;
+      if (read(fd[m],&count,sizeof(count)) == sizeof(count))
+        value[m] = count;
+      else value[m] = -1.0;
+    }
+#endif
+  }
+
+ private:
+  int fd[NCOUNTER];
+};
+
+/* ----------------------------------------------------------------------
+   xorshift64* generator for the sections that run without LAMMPS
+------------------------------------------------------------------------- */
+
+class Rng {
+ public:
+  Rng(uint64_t seed) : state(seed ? seed : 1) {}
+  double uniform() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return ((state * 2685821657736338717ULL) >> 11) * (1.0/9007199254740992.0);
+  }
+ private:
+  uint64_t state;
+};
+
+/* ----------------------------------------------------------------------
+   store one measurement, times and counts are summed over procs
+------------------------------------------------------------------------- */
+
+static void record(const char *section, const char *name, const char *unit,
+                   double count, double seconds, const Counters &c)
+{
+  Result r;
+  r.section = section;
+  strncpy(r.name,name,31);
+  r.name[31] = '\0';
+  r.unit = unit;
+
+  MPI_Allreduce(&count,&r.count,1,MPI_DOUBLE,MPI_SUM,MPI_COMM_WORLD);
+  MPI_Allreduce(&seconds,&r.seconds,1,MPI_DOUBLE,MPI_SUM,MPI_COMM_WORLD);
+
+  double missing[NCOUNTER],anymissing[NCOUNTER];
+  for (int m = 0; m < NCOUNTER; m++) missing[m] = (c.value[m] < 0.0);
+  MPI_Allreduce(missing,anymissing,NCOUNTER,MPI_DOUBLE,MPI_MAX,MPI_COMM_WORLD);
+  MPI_Allreduce((double *) c.value,r.counter,NCOUNTER,MPI_DOUBLE,MPI_SUM,
+                MPI_COMM_WORLD);
+  for (int m = 0; m < NCOUNTER; m++)
+    if (anymissing[m] > 0.0) r.counter[m] = -1.0;
+
+  results.push_back(r);
+}
+
+/* ----------------------------------------------------------------------
+   issue one LAMMPS input command
+------------------------------------------------------------------------- */
+
+static void command(LAMMPS *lmp, const char *format, ...)
+{
+  char line[1024];
+  va_list ap;
+  va_start(ap,format);
+  vsnprintf(line,sizeof(line),format,ap);
+  va_end(ap);
+  lmp->input->one(line);
+}
+
+/* ----------------------------------------------------------------------
+   periodic lattice of n^d particles of spacing 1/n with pair ssa_tsdpd/wt
+   and fix ssa_tsdpd/verlet, the caller adds fixes and does a run 0
+   the timestep is scaled as in bench/, so the SSA work per particle and
+   step does not depend on n
+------------------------------------------------------------------------- */
+
+static LAMMPS *create_lattice(const Options &o, int ntdpd, int nssa, int nrxn,
+                              double hfac, double kappa)
+{
+  char *args[] = {(char *) "microbench",(char *) "-log",(char *) "none",
+                  (char *) "-screen",(char *) "none"};
+  LAMMPS *lmp = new LAMMPS(5,args,MPI_COMM_WORLD);
+
+  double delta = 1.0/o.n;
+  double h = hfac*delta;
+
+  command(lmp,"dimension %d",o.dimension);
+  command(lmp,"units si");
+  command(lmp,"atom_style ssa_tsdpd %d %d %d population layout %s",
+          ntdpd,nssa,nrxn,o.layout);
+  command(lmp,"boundary p p p");
+  if (o.dimension == 2) {
+    command(lmp,"lattice sq %.17g",delta);
+    command(lmp,"region box block 0 %d 0 %d -0.5 0.5",o.n,o.n);
+  } else {
+    command(lmp,"lattice sc %.17g",delta);
+    command(lmp,"region box block 0 %d 0 %d 0 %d",o.n,o.n,o.n);
+  }
+  command(lmp,"create_box 1 box");
+  command(lmp,"create_atoms 1 box");
+  command(lmp,"mass 1 %.17g",1000.0*delta*delta*delta);
+
+  char coeff[1024];
+  int len = snprintf(coeff,sizeof(coeff),
+                     "pair_coeff * * 1000 0.1 1e-3 %.17g %.17g",h,h);
+  for (int k = 0; k < ntdpd+nssa && len < 1000; k++)
+    len += snprintf(coeff+len,sizeof(coeff)-len," %g",kappa);
+  command(lmp,"pair_style ssa_tsdpd/wt");
+  command(lmp,"%s",coeff);
+
+  command(lmp,"set group all ssa_tsdpd/rho 1000");
+  command(lmp,"set group all ssa_tsdpd/e 1.0");
+  for (int k = 0; k < ntdpd; k++)
+    command(lmp,"set group all ssa_tsdpd/C %d 1.0",k);
+  for (int s = 0; s < nssa; s++)
+    command(lmp,"set group all ssa_tsdpd/Cd %d %d",s,o.cd);
+
+  command(lmp,"fix integration all ssa_tsdpd/verlet");
+  if (nssa) command(lmp,"compute ssa all ssa_tsdpd/ssa/stats");
+
+  command(lmp,"neighbor %.17g bin",0.3*h);
+  command(lmp,"timestep %.17g",1e-3*(delta/0.05)*(delta/0.05));
+  command(lmp,"thermo 0");
+  command(lmp,"timer normal");
+  return lmp;
+}
+
+/* ----------------------------------------------------------------------
+   # of pairs of the pair neighbor list inside the cutoff
+------------------------------------------------------------------------- */
+
+static double count_pairs(LAMMPS *lmp)
+{
+  NeighList *list = lmp->force->pair->list;
+  double **x = lmp->atom->x;
+  int *type = lmp->atom->type;
+  double **cutsq = lmp->force->pair->cutsq;
+  double npair = 0.0;
+
+  for (int ii = 0; ii < list->inum; ii++) {
+    int i = list->ilist[ii];
+    int *jlist = list->firstneigh[i];
+    for (int jj = 0; jj < list->numneigh[i]; jj++) {
+      int j = jlist[jj] & NEIGHMASK;
+      double delx = x[i][0] - x[j][0];
+      double dely = x[i][1] - x[j][1];
+      double delz = x[i][2] - x[j][2];
+      if (delx*delx + dely*dely + delz*delz < cutsq[type[i]][type[j]])
+        npair += 1.0;
+    }
+  }
+  return npair;
+}
+
+
+/* ----------------------------------------------------------------------
+   pair section: PairSsaTsdpdWt::compute() with -tdpd species
+   the counters cover the whole compute(), the SDPD force and tDPD
+   transport loops are timed by their timer sub-sections in extra calls
+   with timer full, which runs them as separate passes
+------------------------------------------------------------------------- */
+
+static void bench_pair(const Options &o)
+{
+  LAMMPS *lmp = create_lattice(o,o.ntdpd,0,0,o.hfac,o.kappa);
+  command(lmp,"run 0");
+
+  Pair *pair = lmp->force->pair;
+  Timer *timer = lmp->timer;
+  double npair = count_pairs(lmp)*o.reps;
+
+  pair->compute(0,0);
+
+  Counters c(o.counters);
+  double t0 = MPI_Wtime();
+  c.start();
+  for (int rep = 0; rep < o.reps; rep++) pair->compute(0,0);
+  c.stop();
+  double seconds = MPI_Wtime() - t0;
+
+  Counters none(0);
+  record("pair","compute","pair",npair,seconds,c);
+
+  command(lmp,"timer full");
+  double force0 = timer->get_wall(Timer::SDPD_FORCE);
+  double transport0 = timer->get_wall(Timer::TDPD_TRANSPORT);
+  for (int rep = 0; rep < o.reps; rep++) pair->compute(0,0);
+  record("pair","sdpd_force","pair",npair,
+         timer->get_wall(Timer::SDPD_FORCE) - force0,none);
+  if (o.ntdpd)
+    record("pair","tdpd_transport","pair",npair,
+           timer->get_wall(Timer::TDPD_TRANSPORT) - transport0,none);
+  command(lmp,"timer normal");
+
+  delete lmp;
+}
+
+/* ----------------------------------------------------------------------
+   diffusion section: the SSA diffusion of PairSsaTsdpdWt::compute()
+   with -ssa species, the populations do not change between calls
+   (jumps go to Qd), so every call sees the same propensities
+   jump_matrix = the pass that builds the jump matrix, per pair,
+                 in extra calls with timer full
+   events      = the event loop, per jump
+   ssa         = both, as the difference to calls with the SSA species
+                 switched off, per jump, with the counters of that difference
+------------------------------------------------------------------------- */
+
+static void bench_diffusion(const Options &o)
+{
+  LAMMPS *lmp = create_lattice(o,0,o.nssa,o.nssa,o.hfac,o.kappa);
+  command(lmp,"run 0");
+
+  Atom *atom = lmp->atom;
+  Pair *pair = lmp->force->pair;
+  Timer *timer = lmp->timer;
+  SsaTsdpdStats *stats = atom->ssa_stats;
+  double npair = count_pairs(lmp)*o.reps;
+
+  lmp->update->ntimestep++;
+  pair->compute(0,0);
+
+  // reference: the same calls without the SSA species
+
+  int nssa = atom->num_ssa_species;
+  atom->num_ssa_species = 0;
+  Counters c0(o.counters);
+  double t0 = MPI_Wtime();
+  c0.start();
+  for (int rep = 0; rep < o.reps; rep++) pair->compute(0,0);
+  c0.stop();
+  double seconds0 = MPI_Wtime() - t0;
+  atom->num_ssa_species = nssa;
+
+  // stats clears its counters on the first call of a step
+
+  double events0 = timer->get_wall(Timer::SSA_DIFFUSION);
+  double nevent = 0.0;
+
+  Counters c(o.counters);
+  t0 = MPI_Wtime();
+  c.start();
+  for (int rep = 0; rep < o.reps; rep++) {
+    lmp->update->ntimestep++;
+    pair->compute(0,0);
+    for (int s = 0; s < nssa; s++) nevent += stats->species_events[s];
+  }
+  c.stop();
+  double seconds = MPI_Wtime() - t0;
+
+  Counters none(0),diff(0);
+  for (int m = 0; m < NCOUNTER; m++)
+    if (c.value[m] >= 0.0 && c0.value[m] >= 0.0)
+      diff.value[m] = c.value[m] - c0.value[m];
+
+  record("diffusion","events","event",nevent,
+         timer->get_wall(Timer::SSA_DIFFUSION) - events0,none);
+  record("diffusion","ssa","event",nevent,seconds - seconds0,diff);
+
+  command(lmp,"timer full");
+  double matrix0 = timer->get_wall(Timer::TDPD_TRANSPORT);
+  for (int rep = 0; rep < o.reps; rep++) {
+    lmp->update->ntimestep++;
+    pair->compute(0,0);
+  }
+  record("diffusion","jump_matrix","pair",npair,
+         timer->get_wall(Timer::TDPD_TRANSPORT) - matrix0,none);
+  command(lmp,"timer normal");
+
+  delete lmp;
+}
+
+/* ----------------------------------------------------------------------
+   reaction section: the SSA reaction loop of FixSsaTsdpd::final_integrate()
+   on isolated voxels, each of the -ssa species is made and destroyed by
+   0 -> A (k1) and A -> 0 (k2), stationary at -cd copies with -rate
+   firings per voxel and step
+   forces, density rates and jumps are zeroed, so only Cd changes
+------------------------------------------------------------------------- */
+
+static void bench_reaction(const Options &o)
+{
+  LAMMPS *lmp = create_lattice(o,0,o.nssa,2*o.nssa,0.5,0.0);
+
+  double delta = 1.0/o.n;
+  double volume = delta*delta*delta;
+  double k2 = o.rate/(2.0*o.cd*lmp->update->dt);
+  double k1 = k2*o.cd/volume;
+  for (int s = 0; s < o.nssa; s++) {
+    command(lmp,"fix birth%d all ssa_tsdpd/ssa_rxn_mass_action %d %.17g 0 1 %d",
+            s,2*s,k1,s);
+    command(lmp,"fix death%d all ssa_tsdpd/ssa_rxn_mass_action %d %.17g 1 %d 0",
+            s,2*s+1,k2,s);
+  }
+  command(lmp,"run 0");
+
+  Atom *atom = lmp->atom;
+  Timer *timer = lmp->timer;
+  SsaTsdpdStats *stats = atom->ssa_stats;
+  Fix *fix = lmp->modify->fix[lmp->modify->find_fix("integration")];
+  int nrxn = atom->num_ssa_reactions;
+
+  for (int i = 0; i < atom->nlocal; i++) {
+    atom->f[i][0] = atom->f[i][1] = atom->f[i][2] = 0.0;
+    atom->drho[i] = 0.0;
+    for (int s = 0; s < o.nssa; s++) atom->Qd[i][s] = 0;
+  }
+
+  lmp->update->ntimestep++;
+  fix->final_integrate();
+
+  double reaction0 = timer->get_wall(Timer::SSA_REACTION);
+  double nevent = 0.0;
+
+  Counters c(o.counters);
+  double t0 = MPI_Wtime();
+  c.start();
+  for (int rep = 0; rep < o.reps; rep++) {
+    lmp->update->ntimestep++;
+    fix->final_integrate();
+    for (int r = 0; r < nrxn; r++) nevent += stats->reaction_events[r];
+  }
+  c.stop();
+  double seconds = MPI_Wtime() - t0;
+
+  Counters none(0);
+  record("reaction","final_integrate","event",nevent,seconds,c);
+  record("reaction","events","event",nevent,
+         timer->get_wall(Timer::SSA_REACTION) - reaction0,none);
+
+  delete lmp;
+}
+
+/* ----------------------------------------------------------------------
+   kernels of the pair styles, q = r/h, wf = W(r), wfd = dW/dr / r,
+   sw and sd are the normalizations sigma/h^d and dfac*sigma/h^(d+2)
+------------------------------------------------------------------------- */
+
+struct LucyKernel {
+  static const char *name() { return "lucy"; }
+  static double sigma(int d) { return d == 2 ? 5.0/MY_PI : 105.0/(16.0*MY_PI); }
+  static double dfac() { return -12.0; }
+  template <class T>
+  static inline void eval(T q, T sw, T sd, T &wf, T &wfd) {
+    T omq = (T) 1.0 - q;
+    wfd = sd*omq*omq;
+    wf = sw*omq*omq*omq*((T) 1.0 + (T) 3.0*q);
+  }
+};
+
+struct WendlandC2Kernel {
+  static const char *name() { return "wendland_c2"; }
+  static double sigma(int d) { return d == 2 ? 7.0/MY_PI : 21.0/(2.0*MY_PI); }
+  static double dfac() { return -20.0; }
+  template <class T>
+  static inline void eval(T q, T sw, T sd, T &wf, T &wfd) {
+    T omq = (T) 1.0 - q;
+    T omq3 = omq*omq*omq;
+    wfd = sd*omq3;
+    wf = sw*omq3*omq*((T) 1.0 + (T) 4.0*q);
+  }
+};
+
+// synthetic half neighbor list of a jittered lattice of unit spacing
+
+struct KernelData {
+  int nlocal,dimension;
+  double cut,cutsq;
+  std::vector<double> x;          // 3 per particle
+  std::vector<int> firstneigh;    // nlocal+1 offsets into neigh
+  std::vector<int> neigh;
+  std::vector<double> rsq;        // pairs inside the cutoff, packed
+  std::vector<double> f,rhosum;
+};
+
+static volatile double sink;
+
+/* ----------------------------------------------------------------------
+   kernel as in the pair styles: gather through the neighbor list,
+   cutoff test per pair, scatter of the forces to i and j
+------------------------------------------------------------------------- */
+
+template <class K>
+static void kernel_list(KernelData &k)
+{
+  double ih = 1.0/k.cut;
+  double sw = K::sigma(k.dimension)*pow(ih,k.dimension);
+  double sd = K::dfac()*K::sigma(k.dimension)*pow(ih,k.dimension+2);
+  const double *x = &k.x[0];
+  double *f = &k.f[0];
+  double *rhosum = &k.rhosum[0];
+
+  for (int i = 0; i < k.nlocal; i++) {
+    double xtmp = x[3*i];
+    double ytmp = x[3*i+1];
+    double ztmp = x[3*i+2];
+    for (int jj = k.firstneigh[i]; jj < k.firstneigh[i+1]; jj++) {
+      int j = k.neigh[jj];
+      double delx = xtmp - x[3*j];
+      double dely = ytmp - x[3*j+1];
+      double delz = ztmp - x[3*j+2];
+      double rsq = delx*delx + dely*dely + delz*delz;
+      if (rsq < k.cutsq) {
+        double wf,wfd;
+        K::eval(sqrt(rsq)*ih,sw,sd,wf,wfd);
+        f[3*i] += delx*wfd;
+        f[3*i+1] += dely*wfd;
+        f[3*i+2] += delz*wfd;
+        f[3*j] -= delx*wfd;
+        f[3*j+1] -= dely*wfd;
+        f[3*j+2] -= delz*wfd;
+        rhosum[i] += wf;
+        rhosum[j] += wf;
+      }
+    }
+  }
+  sink = f[0] + rhosum[0];
+}
+
+/* ----------------------------------------------------------------------
+   kernel alone over the packed distances of the pairs inside the cutoff,
+   no branch and unit stride, so the compiler can vectorize it
+------------------------------------------------------------------------- */
+
+template <class K, class T>
+static void kernel_packed(KernelData &k, T *wfout, T *wfdout)
+{
+  T ih = (T) (1.0/k.cut);
+  T sw = (T) (K::sigma(k.dimension)*pow(1.0/k.cut,k.dimension));
+  T sd = (T) (K::dfac()*K::sigma(k.dimension)*pow(1.0/k.cut,k.dimension+2));
+  const double *rsq = &k.rsq[0];
+  int npair = k.rsq.size();
+
+  for (int m = 0; m < npair; m++) {
+    T wf,wfd;
+    K::eval((T) sqrt((T) rsq[m])*ih,sw,sd,wf,wfd);
+    wfout[m] = wf;
+    wfdout[m] = wfd;
+  }
+  sink = wfout[0] + wfdout[npair-1];
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <class K>
+static void bench_kernel_one(const Options &o, KernelData &k)
+{
+  char name[32];
+  double npair = (double) k.rsq.size()*o.reps;
+  std::vector<double> wfd(k.rsq.size()+1),wf(k.rsq.size()+1);
+  std::vector<float> wfdf(k.rsq.size()+1),wff(k.rsq.size()+1);
+
+  {
+    Counters c(o.counters);
+    kernel_list<K>(k);
+    double t0 = MPI_Wtime();
+    c.start();
+    for (int rep = 0; rep < o.reps; rep++) kernel_list<K>(k);
+    c.stop();
+    sprintf(name,"%s/list",K::name());
+    record("kernel",name,"pair",npair,MPI_Wtime()-t0,c);
+  }
+
+  {
+    Counters c(o.counters);
+    kernel_packed<K,double>(k,&wf[0],&wfd[0]);
+    double t0 = MPI_Wtime();
+    c.start();
+    for (int rep = 0; rep < o.reps; rep++)
+      kernel_packed<K,double>(k,&wf[0],&wfd[0]);
+    c.stop();
+    sprintf(name,"%s/packed",K::name());
+    record("kernel",name,"pair",npair,MPI_Wtime()-t0,c);
+  }
+
+  {
+    Counters c(o.counters);
+    kernel_packed<K,float>(k,&wff[0],&wfdf[0]);
+    double t0 = MPI_Wtime();
+    c.start();
+    for (int rep = 0; rep < o.reps; rep++)
+      kernel_packed<K,float>(k,&wff[0],&wfdf[0]);
+    c.stop();
+    sprintf(name,"%s/packed/float",K::name());
+    record("kernel",name,"pair",npair,MPI_Wtime()-t0,c);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   kernel section: n^d lattice points jittered by 0.1, cutoff -h,
+   half neighbor list with a skin of 0.3 h as set up by create_lattice()
+------------------------------------------------------------------------- */
+
+static void bench_kernel(const Options &o)
+{
+  KernelData k;
+  int n = o.n;
+  int nz = (o.dimension == 3) ? n : 1;
+  k.dimension = o.dimension;
+  k.nlocal = n*n*nz;
+  k.cut = o.hfac;
+  k.cutsq = o.hfac*o.hfac;
+
+  int me;
+  MPI_Comm_rank(MPI_COMM_WORLD,&me);
+  Rng rng(12345 + me);
+  k.x.resize(3*k.nlocal);
+  for (int iz = 0; iz < nz; iz++)
+    for (int iy = 0; iy < n; iy++)
+      for (int ix = 0; ix < n; ix++) {
+        int i = (iz*n + iy)*n + ix;
+        k.x[3*i] = ix + 0.2*(rng.uniform() - 0.5);
+        k.x[3*i+1] = iy + 0.2*(rng.uniform() - 0.5);
+        k.x[3*i+2] = (o.dimension == 3) ? iz + 0.2*(rng.uniform() - 0.5) : 0.0;
+      }
+
+  // half stencil: offsets after (0,0,0) in x-fastest order
+
+  double cutneigh = 1.3*o.hfac + 0.2;
+  int reach = (int) ceil(cutneigh);
+  int zreach = (o.dimension == 3) ? reach : 0;
+  std::vector<int> stencil;
+  for (int dz = -zreach; dz <= zreach; dz++)
+    for (int dy = -reach; dy <= reach; dy++)
+      for (int dx = -reach; dx <= reach; dx++) {
+        if (dz < 0 || (dz == 0 && (dy < 0 || (dy == 0 && dx <= 0)))) continue;
+        if (dx*dx + dy*dy + dz*dz > cutneigh*cutneigh) continue;
+        stencil.push_back(dx);
+        stencil.push_back(dy);
+        stencil.push_back(dz);
+      }
+
+  k.firstneigh.resize(k.nlocal+1);
+  for (int iz = 0; iz < nz; iz++)
+    for (int iy = 0; iy < n; iy++)
+      for (int ix = 0; ix < n; ix++) {
+        int i = (iz*n + iy)*n + ix;
+        k.firstneigh[i] = k.neigh.size();
+        for (size_t m = 0; m < stencil.size(); m += 3) {
+          int jx = ix + stencil[m];
+          int jy = iy + stencil[m+1];
+          int jz = iz + stencil[m+2];
+          if (jx < 0 || jx >= n || jy < 0 || jy >= n || jz < 0 || jz >= nz)
+            continue;
+          int j = (jz*n + jy)*n + jx;
+          k.neigh.push_back(j);
+          double delx = k.x[3*i] - k.x[3*j];
+          double dely = k.x[3*i+1] - k.x[3*j+1];
+          double delz = k.x[3*i+2] - k.x[3*j+2];
+          double rsq = delx*delx + dely*dely + delz*delz;
+          if (rsq < k.cutsq) k.rsq.push_back(rsq);
+        }
+      }
+  k.firstneigh[k.nlocal] = k.neigh.size();
+  k.f.assign(3*k.nlocal,0.0);
+  k.rhosum.assign(k.nlocal,0.0);
+  if (k.rsq.empty()) return;
+
+  bench_kernel_one<LucyKernel>(o,k);
+  bench_kernel_one<WendlandC2Kernel>(o,k);
+}
+
+/* ----------------------------------------------------------------------
+   selection structures of the SSA, on -nsel voxels with random rates w
+   and -cd copies each, a = w*copies
+   an event selects a voxel with probability a/a0 and moves one copy to
+   the next or previous voxel, so two propensities change, as in the
+   SSA diffusion loop
+------------------------------------------------------------------------- */
+
+// linear scan of the propensities and incremental a0,
+// as the SSA loops of the pair styles and fixes
+
+class SelectLinear {
+ public:
+  std::vector<double> a;
+  double a0;
+
+  void build(const std::vector<double> &values) {
+    a = values;
+    a0 = 0.0;
+    for (size_t i = 0; i < a.size(); i++) a0 += a[i];
+  }
+  int select(double u) const {
+    double r = u*a0, sum = 0.0;
+    int n = a.size(), i;
+    for (i = 0; i < n-1; i++)
+      if ((sum += a[i]) > r) break;
+    return i;
+  }
+  void update(int i, double value) {
+    a0 += value - a[i];
+    a[i] = value;
+  }
+};
+
+// complete binary tree of partial sums, O(log n) select and update
+
+class SelectTree {
+ public:
+  std::vector<double> t;
+  int nleaf;
+
+  void build(const std::vector<double> &values) {
+    nleaf = 1;
+    while (nleaf < (int) values.size()) nleaf *= 2;
+    t.assign(2*nleaf,0.0);
+    for (size_t i = 0; i < values.size(); i++) t[nleaf+i] = values[i];
+    for (int m = nleaf-1; m > 0; m--) t[m] = t[2*m] + t[2*m+1];
+  }
+  int select(double u) const {
+    double r = u*t[1];
+    int m = 1;
+    while (m < nleaf) {
+      if (r < t[2*m]) m = 2*m;
+      else {
+        r -= t[2*m];
+        m = 2*m+1;
+      }
+    }
+    return m - nleaf;
+  }
+  void update(int i, double value) {
+    int m = nleaf + i;
+    t[m] = value;
+    for (m /= 2; m > 0; m /= 2) t[m] = t[2*m] + t[2*m+1];
+  }
+};
+
+// Walker/Vose alias table, O(1) select, O(n) rebuild after any change
+
+class SelectAlias {
+ public:
+  std::vector<double> prob;
+  std::vector<int> alias;
+
+  void build(const std::vector<double> &values) {
+    int n = values.size();
+    double a0 = 0.0;
+    for (int i = 0; i < n; i++) a0 += values[i];
+    prob.resize(n);
+    alias.resize(n);
+    std::vector<int> small,large;
+    for (int i = 0; i < n; i++) {
+      prob[i] = values[i]*n/a0;
+      alias[i] = i;
+      if (prob[i] < 1.0) small.push_back(i);
+      else large.push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+      int s = small.back(), l = large.back();
+      small.pop_back();
+      alias[s] = l;
+      prob[l] -= 1.0 - prob[s];
+      if (prob[l] < 1.0) {
+        large.pop_back();
+        small.push_back(l);
+      }
+    }
+    while (!large.empty()) {
+      prob[large.back()] = 1.0;
+      large.pop_back();
+    }
+    while (!small.empty()) {
+      prob[small.back()] = 1.0;
+      small.pop_back();
+    }
+  }
+  int select(double u) const {
+    double x = u*prob.size();
+    int i = (int) x;
+    if (i >= (int) prob.size()) i = prob.size() - 1;
+    return (x - i < prob[i]) ? i : alias[i];
+  }
+};
+
+/* ---------------------------------------------------------------------- */
+
+template <class S>
+static void select_events(const Options &o, const char *name,
+                          const std::vector<double> &w,
+                          const std::vector<int> &copies)
+{
+  int n = w.size();
+  int me;
+  MPI_Comm_rank(MPI_COMM_WORLD,&me);
+
+  std::vector<int> cd(copies);
+  std::vector<double> a(n);
+  for (int i = 0; i < n; i++) a[i] = w[i]*cd[i];
+  S sel;
+  sel.build(a);
+
+  Rng rng(54321 + me);
+  long nevent = (long) o.nevent;
+  Counters c(o.counters);
+  double t0 = MPI_Wtime();
+  c.start();
+  for (long e = 0; e < nevent; e++) {
+    int src = sel.select(rng.uniform());
+    if (cd[src] == 0) continue;
+    int dest = (rng.uniform() < 0.5) ? src+1 : src-1;
+    if (dest < 0) dest = n-1;
+    else if (dest == n) dest = 0;
+    cd[src]--;
+    cd[dest]++;
+    sel.update(src,w[src]*cd[src]);
+    sel.update(dest,w[dest]*cd[dest]);
+  }
+  c.stop();
+  record("select",name,"event",nevent,MPI_Wtime()-t0,c);
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void bench_select(const Options &o)
+{
+  int me;
+  MPI_Comm_rank(MPI_COMM_WORLD,&me);
+  Rng rng(12345 + me);
+
+  int n = o.nsel;
+  std::vector<double> w(n),a(n);
+  std::vector<int> copies(n);
+  for (int i = 0; i < n; i++) {
+    w[i] = 0.5 + rng.uniform();
+    copies[i] = (int) (2.0*o.cd*rng.uniform());
+    a[i] = w[i]*copies[i];
+  }
+
+  select_events<SelectLinear>(o,"linear",w,copies);
+  select_events<SelectTree>(o,"tree",w,copies);
+
+  // alias: selection from a fixed distribution, and the rebuild
+  // that any change of a propensity would need
+
+  SelectAlias alias;
+  alias.build(a);
+  long nevent = (long) o.nevent;
+  int isum = 0;
+  Counters c(o.counters);
+  double t0 = MPI_Wtime();
+  c.start();
+  for (long e = 0; e < nevent; e++) isum += alias.select(rng.uniform());
+  c.stop();
+  sink = isum;
+  record("select","alias","event",nevent,MPI_Wtime()-t0,c);
+
+  Counters cb(o.counters);
+  t0 = MPI_Wtime();
+  cb.start();
+  for (int rep = 0; rep < o.reps; rep++) alias.build(a);
+  cb.stop();
+  record("select","alias_build","entry",(double) n*o.reps,MPI_Wtime()-t0,cb);
+}
+
+/* ----------------------------------------------------------------------
+   table on the screen, per pair/event/entry and averaged over procs
+------------------------------------------------------------------------- */
+
+static void print_results()
+{
+  printf("%-10s %-24s %-6s %12s %10s","section","name","unit","count","ns/unit");
+  for (int m = 0; m < NCOUNTER; m++) printf(" %13s",counter_names[m]);
+  printf("\n");
+
+  for (size_t k = 0; k < results.size(); k++) {
+    Result &r = results[k];
+    double per = (r.count > 0.0) ? 1.0/r.count : 0.0;
+    printf("%-10s %-24s %-6s %12.6g %10.4g",r.section,r.name,r.unit,
+           r.count,1e9*r.seconds*per);
+    for (int m = 0; m < NCOUNTER; m++) {
+      if (r.counter[m] < 0.0) printf(" %13s","-");
+      else printf(" %13.4g",r.counter[m]*per);
+    }
+    printf("\n");
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void write_json(const Options &o, int nprocs)
+{
+  FILE *fp = fopen(o.json,"w");
+  if (fp == NULL) {
+    fprintf(stderr,"Cannot open %s\n",o.json);
+    return;
+  }
+
+  fprintf(fp,"{\n  \"nprocs\": %d,\n  \"dimension\": %d,\n  \"n\": %d,\n"
+          "  \"h\": %g,\n  \"reps\": %d,\n  \"layout\": \"%s\",\n"
+          "  \"results\": [",nprocs,o.dimension,o.n,o.hfac,o.reps,o.layout);
+  for (size_t k = 0; k < results.size(); k++) {
+    Result &r = results[k];
+    double per = (r.count > 0.0) ? 1.0/r.count : 0.0;
+    fprintf(fp,"%s\n    {\"section\": \"%s\", \"name\": \"%s\", "
+            "\"unit\": \"%s\", \"count\": %.17g, \"seconds\": %.17g, "
+            "\"ns\": %.17g",(k ? "," : ""),r.section,r.name,r.unit,
+            r.count,r.seconds,1e9*r.seconds*per);
+    for (int m = 0; m < NCOUNTER; m++) {
+      if (r.counter[m] < 0.0) fprintf(fp,", \"%s\": null",counter_names[m]);
+      else fprintf(fp,", \"%s\": %.17g",counter_names[m],r.counter[m]*per);
+    }
+    fprintf(fp,"}");
+  }
+  fprintf(fp,"\n  ]\n}\n");
+  fclose(fp);
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void usage()
+{
+  printf(
+"Usage: ssa_tsdpd_microbench [options]\n\n"
+"  -s pair,diffusion,reaction,kernel,select   sections to run (default all)\n"
+"  -d 2|3         dimension (2)\n"
+"  -n N           lattice points per direction (64)\n"
+"  -h H           cutoff in lattice spacings (3.0)\n"
+"  -tdpd N        tDPD species of the pair section (0)\n"
+"  -ssa N         SSA species of the diffusion and reaction sections (1)\n"
+"  -kappa K       diffusivity of all species (1.0)\n"
+"  -layout atom|species   storage of C, Q, Cd, Qd (atom)\n"
+"  -cd N          SSA copies per voxel (100)\n"
+"  -rate R        reactions per voxel and step (10)\n"
+"  -reps N        repetitions of each loop (20)\n"
+"  -nsel N        propensities of the select section (4096)\n"
+"  -events N      events of the select section (1e6)\n"
+"  -nocounters    do not read the hardware counters\n"
+"  -o file        write a JSON report\n\n"
+"Times are per pair or event and averaged over the procs. Counters\n"
+"are read with perf_event_open() on Linux and shown as - elsewhere or\n"
+"when they cannot be opened, see /proc/sys/kernel/perf_event_paranoid.\n");
+}
+
+/* ---------------------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc,&argv);
+
+  int me,nprocs;
+  MPI_Comm_rank(MPI_COMM_WORLD,&me);
+  MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+
+  Options o;
+  for (int k = 0; k < NSECTION; k++) o.run[k] = 1;
+  o.dimension = 2;
+  o.n = 64;
+  o.hfac = 3.0;
+  o.ntdpd = 0;
+  o.nssa = 1;
+  o.kappa = 1.0;
+  o.cd = 100;
+  o.rate = 10.0;
+  o.reps = 20;
+  o.nsel = 4096;
+  o.nevent = 1e6;
+  o.counters = 1;
+  o.layout = "atom";
+  o.json = NULL;
+
+  int error = 0;
+  int iarg = 1;
+  while (iarg < argc && !error) {
+    if (strcmp(argv[iarg],"-nocounters") == 0) {
+      o.counters = 0;
+      iarg++;
+      continue;
+    }
+    if (iarg+1 >= argc) {
+      error = 1;
+      break;
+    }
+    char *value = argv[iarg+1];
+    if (strcmp(argv[iarg],"-s") == 0) {
+      for (int k = 0; k < NSECTION; k++) o.run[k] = 0;
+      for (char *word = strtok(value,","); word; word = strtok(NULL,",")) {
+        int k;
+        for (k = 0; k < NSECTION; k++)
+          if (strcmp(word,"all") == 0 || strcmp(word,section_names[k]) == 0)
+            o.run[k] = 1;
+        for (k = 0; k < NSECTION; k++)
+          if (strcmp(word,section_names[k]) == 0) break;
+        if (k == NSECTION && strcmp(word,"all") != 0) error = 1;
+      }
+    } else if (strcmp(argv[iarg],"-d") == 0) o.dimension = atoi(value);
+    else if (strcmp(argv[iarg],"-n") == 0) o.n = atoi(value);
+    else if (strcmp(argv[iarg],"-h") == 0) o.hfac = atof(value);
+    else if (strcmp(argv[iarg],"-tdpd") == 0) o.ntdpd = atoi(value);
+    else if (strcmp(argv[iarg],"-ssa") == 0) o.nssa = atoi(value);
+    else if (strcmp(argv[iarg],"-kappa") == 0) o.kappa = atof(value);
+    else if (strcmp(argv[iarg],"-layout") == 0) o.layout = value;
+    else if (strcmp(argv[iarg],"-cd") == 0) o.cd = atoi(value);
+    else if (strcmp(argv[iarg],"-rate") == 0) o.rate = atof(value);
+    else if (strcmp(argv[iarg],"-reps") == 0) o.reps = atoi(value);
+    else if (strcmp(argv[iarg],"-nsel") == 0) o.nsel = atoi(value);
+    else if (strcmp(argv[iarg],"-events") == 0) o.nevent = atof(value);
+    else if (strcmp(argv[iarg],"-o") == 0) o.json = value;
+    else error = 1;
+    iarg += 2;
+  }
+
+  if (o.dimension != 2 && o.dimension != 3) error = 1;
+  if (strcmp(o.layout,"atom") != 0 && strcmp(o.layout,"species") != 0)
+    error = 1;
+  if (o.n < 2 || o.hfac <= 0.0 || o.ntdpd < 0 || o.nssa < 1 ||
+      o.cd < 1 || o.rate <= 0.0 || o.reps < 1 || o.nsel < 2 || o.nevent < 1)
+    error = 1;
+
+  if (error) {
+    if (me == 0) usage();
+    MPI_Finalize();
+    return 1;
+  }
+
+  if (o.run[PAIR]) bench_pair(o);
+  if (o.run[DIFFUSION]) bench_diffusion(o);
+  if (o.run[REACTION]) bench_reaction(o);
+  if (o.run[KERNEL]) bench_kernel(o);
+  if (o.run[SELECT]) bench_select(o);
+
+  if (me == 0) {
+    print_results();
+    if (o.json) write_json(o,nprocs);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,59 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_SSA_TSDPD_RNG_H
+#define LMP_SSA_TSDPD_RNG_H
+
+#include <stdio.h>
+
+namespace LAMMPS_NS {
+
+// per-processor RanMars streams of the ssa_tsdpd styles in restart files
+// a record is the global restart data of a fix:
+//   nprocs, nstream, then nstream generator states of each proc
+// write_restart() gathers the states to proc 0, it must be called by all
+//   procs, as Fix::write_restart() is
+// restart() sets the streams of this proc from a record written by the
+//   same # of procs and returns 1, streams that are NULL now or were
+//   NULL when written are skipped
+//   with another # of procs or streams it returns 0, the streams then
+//   keep the state of their seeds
+
+// create_replicas() returns the streams of the nrep SSA replicas of a
+//   style on this proc, replica 0 draws from the style's own stream, so
+//   a run with one replica repeats a run without, replica q > 0 from a
+//   stream of its own seeded with seed + q*nprocs, nprocs of the universe
+// destroy_replicas() frees all but the style's own stream
+
+class LAMMPS;
+class RanMars;
+
+namespace SsaTsdpdRng {
+  void write_restart(LAMMPS *, FILE *, RanMars **, int);
+  int restart(LAMMPS *, char *, RanMars **, int);
+  RanMars **create_replicas(LAMMPS *, RanMars *, int, int);
+  void destroy_replicas(RanMars **, int);
+}
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Too many random streams for restart file
+
+The states of all random streams of a fix, gathered over the processors,
+exceed the 2 GB size of a restart record.
+
+*/
@@ -0,0 +1,91 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "ssa_tsdpd_scratch.h"
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+
+#define ALIGN 64
+
+/* ---------------------------------------------------------------------- */
+
+SsaTsdpdScratch::SsaTsdpdScratch(LAMMPS *lmp) : Pointers(lmp)
+{
+  block = NULL;
+  size = used = demand = 0;
+  extra = NULL;
+  nextra = maxextra = 0;
+  extrabytes = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+SsaTsdpdScratch::~SsaTsdpdScratch()
+{
+  for (int i = 0; i < nextra; i++) memory->sfree(extra[i]);
+  memory->sfree(extra);
+  memory->sfree(block);
+}
+
+/* ----------------------------------------------------------------------
+   take back everything handed out by get()
+   the block only grows, to the largest demand of one step so far
+------------------------------------------------------------------------- */
+
+void SsaTsdpdScratch::reset()
+{
+  for (int i = 0; i < nextra; i++) memory->sfree(extra[i]);
+  nextra = 0;
+  extrabytes = 0;
+
+  if (demand > size) {
+    memory->sfree(block);
+    size = demand;
+    block = (char *) memory->smalloc(size,"ssa_tsdpd:scratch");
+  }
+
+  used = demand = 0;
+}
+
+/* ----------------------------------------------------------------------
+   nbytes rounded up to ALIGN, from the block if it fits
+------------------------------------------------------------------------- */
+
+void *SsaTsdpdScratch::alloc(bigint nbytes)
+{
+  nbytes = (nbytes + ALIGN-1) / ALIGN * ALIGN;
+  demand += nbytes;
+
+  if (used + nbytes <= size) {
+    void *ptr = block + used;
+    used += nbytes;
+    return ptr;
+  }
+
+  if (nextra == maxextra) {
+    maxextra += 4;
+    extra = (char **) memory->srealloc(extra,maxextra*sizeof(char *),
+                                       "ssa_tsdpd:scratch_extra");
+  }
+  extra[nextra] = (char *) memory->smalloc(nbytes,"ssa_tsdpd:scratch_extra");
+  extrabytes += nbytes;
+  return extra[nextra++];
+}
+
+/* ---------------------------------------------------------------------- */
+
+double SsaTsdpdScratch::memory_usage()
+{
+  return (double) size + extrabytes + maxextra*sizeof(char *);
+}
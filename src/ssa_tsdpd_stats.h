@@ -0,0 +1,63 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_SSA_TSDPD_STATS_H
+#define LMP_SSA_TSDPD_STATS_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+// event counters of the SSA diffusion and reaction loops
+// created by compute ssa_tsdpd/ssa/stats and hung on atom->ssa_stats,
+//   the SSA loops record into it only if that pointer is set
+// all counters belong to one timestep, the first start() of a new
+//   step clears them, per-atom values are indexed like the atom arrays
+//   of that step
+
+class SsaTsdpdStats : protected Pointers {
+ public:
+  bigint step;               // timestep the counters belong to
+  int nspecies,nreaction;
+  double *events;            // per-atom # of diffusion jumps out of + reactions in
+  double *a0;                // per-atom total propensity at the start of the step
+  double *species_events;    // # of diffusion jumps per SSA species
+  double *reaction_events;   // # of firings per SSA reaction
+  double wall_start;         // SSA timer total when the step was started
+
+  SsaTsdpdStats(class LAMMPS *);
+  ~SsaTsdpdStats();
+  void start();
+  double memory_usage();
+
+  void diffusion(int i, int s) {
+    events[i] += 1.0;
+    species_events[s] += 1.0;
+  }
+  void diffusion(int i, int s, int n) {    // n jumps at once, as in DFSP
+    events[i] += n;
+    species_events[s] += n;
+  }
+  void reaction(int i, int r) {
+    events[i] += 1.0;
+    if (r < nreaction) reaction_events[r] += 1.0;
+  }
+  void propensity(int i, double a) { a0[i] += a; }
+
+ private:
+  int nmax;
+};
+
+}
+
+#endif
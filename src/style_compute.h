@@ -44,8 +44,10 @@
 #include "compute_reduce.h"
 #include "compute_reduce_region.h"
 #include "compute_slice.h"
+#include "compute_ssa_tsdpd_cd_stats.h"
 #include "compute_ssa_tsdpd_e_atom.h"
 #include "compute_ssa_tsdpd_rho_atom.h"
+#include "compute_ssa_tsdpd_ssa_stats.h"
 #include "compute_ssa_tsdpd_t_atom.h"
 #include "compute_stress_atom.h"
 #include "compute_temp.h"
@@ -7,5 +7,7 @@
 #include "dump_local.h"
 #include "dump_movie.h"
 #include "dump_ssa_tsdpd.h"
+#include "dump_ssa_tsdpd_col.h"
 #include "dump_ssa_tsdpd_vtk.h"
+#include "dump_ssa_tsdpd_vtu.h"
 #include "dump_xyz.h"
@@ -53,11 +53,16 @@
 #include "fix_spring_chunk.h"
 #include "fix_spring_rg.h"
 #include "fix_spring_self.h"
+#include "fix_ssa_tsdpd_bin.h"
 #include "fix_ssa_tsdpd_buffer.h"
 #include "fix_ssa_tsdpd_buoyancy.h"
+#include "fix_ssa_tsdpd_cd_stats.h"
 #include "fix_ssa_tsdpd_chem_rxn_mass_action.h"
+#include "fix_ssa_tsdpd_dt_reset.h"
 #include "fix_ssa_tsdpd_forcing.h"
+#include "fix_ssa_tsdpd_isph_projection.h"
 #include "fix_ssa_tsdpd_reflect.h"
+#include "fix_ssa_tsdpd_shardlow.h"
 #include "fix_ssa_tsdpd_ssa_rxn_mass_action.h"
 #include "fix_ssa_tsdpd_stationary.h"
 #include "fix_ssa_tsdpd_verlet.h"
@@ -64,6 +64,7 @@
 #include "pair_rebo.h"
 #include "pair_soft.h"
 #include "pair_ssa_tsdpd_idealgas.h"
+#include "pair_ssa_tsdpd_isph.h"
 #include "pair_ssa_tsdpd_iwc.h"
 #include "pair_ssa_tsdpd_iwt.h"
 #include "pair_ssa_tsdpd_purediffusion.h"
@@ -154,6 +154,25 @@ void Timer::_stamp(enum ttype which)
 
 /* ---------------------------------------------------------------------- */
 
+void Timer::_sub_start(enum ttype which)
+{
+  sub_cpu[which] = (_level > NORMAL) ? CPU_Time() : 0.0;
+  sub_wall[which] = MPI_Wtime();
+}
+
+/* ----------------------------------------------------------------------
+   add the time since the matching sub_start() to a sub-section timer
+   previous_wall is left alone, so the enclosing section is unaffected
+------------------------------------------------------------------------- */
+
+void Timer::_sub_stamp(enum ttype which)
+{
+  if (_level > NORMAL) cpu_array[which] += CPU_Time() - sub_cpu[which];
+  wall_array[which] += MPI_Wtime() - sub_wall[which];
+}
+
+/* ---------------------------------------------------------------------- */
+
 void Timer::barrier_start()
 {
   double current_cpu=0.0, current_wall=0.0;
@@ -24,7 +24,8 @@ class Timer : protected Pointers {
 
   enum ttype  {RESET=-2,START=-1,TOTAL=0,PAIR,BOND,KSPACE,NEIGH,COMM,
                MODIFY,OUTPUT,SYNC,ALL,DEPHASE,DYNAMICS,QUENCH,NEB,REPCOMM,
-               REPOUT,NUM_TIMER};
+               REPOUT,SDPD_FORCE,TDPD_TRANSPORT,SSA_DIFFUSION,SSA_REACTION,
+               NUM_TIMER};
   enum tlevel {OFF=0,LOOP,NORMAL,FULL};
 
   Timer(class LAMMPS *);
@@ -37,6 +38,17 @@ class Timer : protected Pointers {
     if (_level > LOOP) _stamp(which);
   }
 
+  // sub-sections of the regular sections, e.g. SSA diffusion inside Pair
+  // their time is already counted by the enclosing section, so it is
+  // accumulated separately and not added to ALL
+
+  void sub_start(enum ttype which) {
+    if (_level > LOOP) _sub_start(which);
+  }
+  void sub_stamp(enum ttype which) {
+    if (_level > LOOP) _sub_stamp(which);
+  }
+
   void barrier_start();
   void barrier_stop();
 
@@ -90,6 +102,8 @@ class Timer : protected Pointers {
   double wall_array[NUM_TIMER];
   double previous_cpu;
   double previous_wall;
+  double sub_cpu[NUM_TIMER];   // start times of the running sub-sections
+  double sub_wall[NUM_TIMER];
   double timeout_start;
   int _level;     // level of detail: off=0,loop=1,normal=2,full=3
   int _sync;      // if nonzero, synchronize tasks before setting the timer
@@ -101,6 +115,10 @@ class Timer : protected Pointers {
   // update one specific timer array
   void _stamp(enum ttype);
 
+  // start and update one sub-section timer
+  void _sub_start(enum ttype);
+  void _sub_stamp(enum ttype);
+
   // check for timeout
   bool _check_timeout();
 };
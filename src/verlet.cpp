@@ -397,7 +397,7 @@ void Verlet::force_clear()
 
       if (tdpdflag){
         double **f = atom->f;
-        double **Q = atom->Q;
+        SpeciesArray<double> Q = atom->Q;
 	double **Aetd = atom->Aetd;
 	double **Betd = atom->Betd;
 	double **Cetd = atom->Cetd;
@@ -420,22 +420,13 @@ void Verlet::force_clear()
 
       if (tsdpdflag){
         double **f = atom->f;
-        double **Q = atom->Q;
-        int **Qd = atom->Qd;
+        SpeciesArray<double> Q = atom->Q;
+        SpeciesArray<int> Qd = atom->Qd;
 //        double **ssa_rxn_propensity = atom->ssa_rxn_propensity;
 //        double ***d_ssa_rxn_prop_d_c = atom->d_ssa_rxn_prop_d_c;
 //        int ***ssa_stoich_matrix = atom->ssa_stoich_matrix;
-          for (int i=0;i<nall;i++) {
-   	    for (int k = 0; k<atom->num_tdpd_species; k++)  Q[i][k] = 0.0;
-	    for (int k = 0; k<atom->num_ssa_species; k++) Qd[i][k] = 0;
-//	    for (int k = 0; k<atom->num_ssa_reactions; k++) {
-//              ssa_rxn_propensity[i][k] = 0.0;
-//              for (int l = 0; l<atom->num_ssa_species; l++) {
-//                d_ssa_rxn_prop_d_c[i][k][l] = 0.0;
-//                ssa_stoich_matrix[i][k][l] = 0;
-//              }
-//            }
-	  }
+          Q.zero(nall);
+          Qd.zero(nall);
       }
 
       if (torqueflag) memset(&atom->torque[0][0],0,3*nbytes);
@@ -454,7 +445,7 @@ void Verlet::force_clear()
 
        if (tdpdflag){
          double **f = atom->f;
-         double **Q = atom->Q;
+         SpeciesArray<double> Q = atom->Q;
     	 double **Aetd = atom->Aetd;
 	 double **Betd = atom->Betd;
 	 double **Cetd = atom->Cetd;
@@ -477,22 +468,13 @@ void Verlet::force_clear()
 
        if (tsdpdflag){
          double **f = atom->f;
-         double **Q = atom->Q;
-         int **Qd = atom->Qd;
+         SpeciesArray<double> Q = atom->Q;
+         SpeciesArray<int> Qd = atom->Qd;
 //         double **ssa_rxn_propensity = atom->ssa_rxn_propensity;
 //         double ***d_ssa_rxn_prop_d_c = atom->d_ssa_rxn_prop_d_c;
 //         int ***ssa_stoich_matrix = atom->ssa_stoich_matrix;
-         for (int i=0;i<nall;i++) {
-	   for (int k = 0; k<atom->num_tdpd_species; k++)  Q[i][k] = 0.0;
-	    for (int k = 0; k<atom->num_ssa_species; k++) Qd[i][k] = 0;
-//	    for (int k = 0; k<atom->num_ssa_reactions; k++) {
-//              ssa_rxn_propensity[i][k] = 0.0;
-//              for (int l = 0; l<atom->num_ssa_species; l++) {
-//                d_ssa_rxn_prop_d_c[i][k][l] = 0.0;
-//                ssa_stoich_matrix[i][k][l] = 0;
-//              }
-//            }
-         }
+         Q.zero(nall);
+         Qd.zero(nall);
        }
 
 
@@ -508,7 +490,7 @@ void Verlet::force_clear()
 
        if (tdpdflag){
          double **f = atom->f;
-         double **Q = atom->Q;
+         SpeciesArray<double> Q = atom->Q;
          double **Aetd = atom->Aetd;
 	 double **Betd = atom->Betd;
 	 double **Cetd = atom->Cetd;
@@ -532,22 +514,13 @@ void Verlet::force_clear()
 
        if (tsdpdflag){
          double **f = atom->f;
-         double **Q = atom->Q;
-         int **Qd = atom->Qd;
+         SpeciesArray<double> Q = atom->Q;
+         SpeciesArray<int> Qd = atom->Qd;
 //         double **ssa_rxn_propensity = atom->ssa_rxn_propensity;
 //         double ***d_ssa_rxn_prop_d_c = atom->d_ssa_rxn_prop_d_c;
 //         int ***ssa_stoich_matrix = atom->ssa_stoich_matrix;
-	 for (int i=0;i<nlocal;i++) {
-	   for (int k = 0; k<atom->num_tdpd_species; k++)  Q[i][k] = 0.0;
-	   for (int k = 0; k<atom->num_ssa_species; k++) Qd[i][k] = 0;
-//           for (int k = 0; k<atom->num_ssa_reactions; k++) {
-//             ssa_rxn_propensity[i][k] = 0.0;
-//             for (int l = 0; l<atom->num_ssa_species; l++) {
-//               d_ssa_rxn_prop_d_c[i][k][l] = 0.0;
-//               ssa_stoich_matrix[i][k][l] = 0;
-//             }
-//           }
-         }
+	 Q.zero(nlocal);
+	 Qd.zero(nlocal);
 	}
 
         if (torqueflag) memset(&atom->torque[nlocal][0],0,3*nbytes);
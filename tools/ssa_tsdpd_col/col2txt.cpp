@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------
+   Convert dump ssa_tsdpd/col files to LAMMPS text dump format
+
+   Syntax: col2txt [-f id,C_[0],...] [-t first last] [-e every] file ...
+     -f = fields to write, default all
+     -t = only timesteps between first and last
+     -e = only every Nth timestep
+   output goes to stdout, frames that are not selected are skipped
+     without decoding them
+
+   g++ -O2 -o col2txt col2txt.cpp
+   g++ -O2 -DSSA_TSDPD_ZLIB -o col2txt col2txt.cpp -lz
+------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssa_col.h"
+
+int main(int narg, char **arg)
+{
+  std::vector<std::string> names;
+  long long first = 0, last = -1, every = 1;
+  int iarg = 1;
+
+  while (iarg < narg && arg[iarg][0] == '-') {
+    if (strcmp(arg[iarg],"-f") == 0 && iarg+1 < narg) {
+      char *ptr = strtok(arg[iarg+1],",");
+      while (ptr) {
+        names.push_back(ptr);
+        ptr = strtok(NULL,",");
+      }
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"-t") == 0 && iarg+2 < narg) {
+      first = atoll(arg[iarg+1]);
+      last = atoll(arg[iarg+2]);
+      iarg += 3;
+    } else if (strcmp(arg[iarg],"-e") == 0 && iarg+1 < narg) {
+      every = atoll(arg[iarg+1]);
+      if (every <= 0) every = 1;
+      iarg += 2;
+    } else break;
+  }
+
+  if (iarg == narg) {
+    fprintf(stderr,"Syntax: col2txt [-f field,...] [-t first last] "
+            "[-e every] file ...\n");
+    return 1;
+  }
+
+  try {
+    for (; iarg < narg; iarg++) {
+      ssa_col::Reader reader(arg[iarg]);
+
+      std::vector<int> select;
+      if (names.empty())
+        for (size_t i = 0; i < reader.fields.size(); i++) select.push_back(i);
+      for (size_t i = 0; i < names.size(); i++) {
+        int m = reader.find(names[i]);
+        if (m < 0) {
+          fprintf(stderr,"Field %s not in %s\n",names[i].c_str(),arg[iarg]);
+          return 1;
+        }
+        select.push_back(m);
+      }
+
+      std::vector<std::vector<double> > values(select.size());
+      std::vector<std::vector<int64_t> > ivalues(select.size());
+
+      while (reader.next()) {
+        long long step = reader.timestep();
+        if (step < first || (last >= first && step > last)) continue;
+        if ((step - first) % every) continue;
+
+        const double *box = reader.box();
+        printf("ITEM: TIMESTEP\n%lld\n",step);
+        printf("ITEM: NUMBER OF ATOMS\n%lld\n",(long long) reader.natoms());
+        if (reader.triclinic()) {
+          printf("ITEM: BOX BOUNDS xy xz yz\n");
+          printf("%-1.16e %-1.16e %-1.16e\n",box[0],box[1],box[6]);
+          printf("%-1.16e %-1.16e %-1.16e\n",box[2],box[3],box[7]);
+          printf("%-1.16e %-1.16e %-1.16e\n",box[4],box[5],box[8]);
+        } else {
+          printf("ITEM: BOX BOUNDS\n");
+          printf("%-1.16e %-1.16e\n",box[0],box[1]);
+          printf("%-1.16e %-1.16e\n",box[2],box[3]);
+          printf("%-1.16e %-1.16e\n",box[4],box[5]);
+        }
+        printf("ITEM: ATOMS");
+        for (size_t i = 0; i < select.size(); i++)
+          printf(" %s",reader.fields[select[i]].name.c_str());
+        printf(" \n");
+
+        for (size_t i = 0; i < select.size(); i++) {
+          if (reader.integer(select[i])) reader.read(select[i],ivalues[i]);
+          else reader.read(select[i],values[i]);
+        }
+
+        for (int64_t k = 0; k < reader.natoms(); k++) {
+          for (size_t i = 0; i < select.size(); i++) {
+            if (reader.integer(select[i]))
+              printf("%lld ",(long long) ivalues[i][k]);
+            else printf("%g ",values[i][k]);
+          }
+          printf("\n");
+        }
+      }
+    }
+  } catch (std::exception &e) {
+    fprintf(stderr,"col2txt: %s\n",e.what());
+    return 1;
+  }
+
+  return 0;
+}
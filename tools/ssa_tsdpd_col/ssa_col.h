@@ -0,0 +1,264 @@
+/* ----------------------------------------------------------------------
+   Streaming reader for files written by dump ssa_tsdpd/col
+
+   The file is memory mapped, frames are visited in order and only the
+   index of each frame is parsed.  Field chunks are decoded on request,
+   so skipping timesteps or fields costs nothing.
+
+   Build with -DSSA_TSDPD_ZLIB and link with -lz to read files written
+   with dump_modify codec zlib.  See README for the file layout.
+------------------------------------------------------------------------- */
+
+#ifndef SSA_COL_H
+#define SSA_COL_H
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(SSA_TSDPD_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace ssa_col {
+
+enum{INT32,INT64,FLOAT32,FLOAT64};
+enum{RAW,VARINT,XOR,SHUFFLE};
+const int DEFLATE = 16;
+
+struct Field {
+  std::string name;
+  int type;                  // type in the file header
+};
+
+struct Chunk {
+  uint64_t offset;           // from start of frame
+  uint64_t nbytes;
+  int codec;
+  int type;
+};
+
+class Reader {
+ public:
+  explicit Reader(const char *path) : base(NULL), size(0), next_pos(0)
+  {
+    int fd = open(path,O_RDONLY);
+    if (fd < 0) throw std::runtime_error(std::string("cannot open ") + path);
+    struct stat st;
+    fstat(fd,&st);
+    size = st.st_size;
+    if (size) {
+      void *p = mmap(NULL,size,PROT_READ,MAP_SHARED,fd,0);
+      if (p == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error(std::string("cannot map ") + path);
+      }
+      base = (const unsigned char *) p;
+    }
+    close(fd);
+
+    if (size < 20 || memcmp(base,"SSACOL01",8) != 0)
+      throw std::runtime_error(std::string("not a ssa_tsdpd/col file: ") + path);
+    if (get<int32_t>(8) != 1)
+      throw std::runtime_error("file was written with other byte order");
+
+    int nfield = get<int32_t>(16);
+    size_t pos = 20;
+    for (int i = 0; i < nfield; i++) {
+      Field f;
+      f.type = get<int32_t>(pos);
+      int n = get<int32_t>(pos+4);
+      f.name.assign((const char *) base + pos + 8,n);
+      fields.push_back(f);
+      pos += 8 + n;
+    }
+    next_pos = (pos + 7) / 8 * 8;
+  }
+
+  ~Reader() { if (base) munmap((void *) base,size); }
+
+  // field of given name, -1 if not in file
+
+  int find(const std::string &name) const
+  {
+    for (size_t i = 0; i < fields.size(); i++)
+      if (fields[i].name == name) return i;
+    return -1;
+  }
+
+  // advance to next complete frame, false at end of file
+  // a partially written last frame is ignored
+
+  bool next()
+  {
+    if (next_pos + 16 > size) return false;
+    if (memcmp(base + next_pos,"FRM1",4) != 0)
+      throw std::runtime_error("corrupt frame header");
+    uint64_t nbytes = get<uint64_t>(next_pos + 8);
+    if (next_pos + nbytes > size) return false;
+
+    frame = next_pos;
+    next_pos += nbytes;
+
+    size_t tail = frame + nbytes - 16;
+    if (memcmp(base + tail + 8,"IDX1",4) != 0)
+      throw std::runtime_error("corrupt frame index");
+    size_t index = frame + get<uint64_t>(tail);
+
+    step = get<int64_t>(index);
+    n = get<int64_t>(index + 8);
+    tri = get<int32_t>(index + 16);
+    int nfield = get<int32_t>(index + 20);
+    memcpy(boxbounds,base + index + 24,9*sizeof(double));
+    t = get<double>(index + 96);
+
+    chunks.resize(nfield);
+    for (int i = 0; i < nfield; i++) {
+      size_t p = index + 104 + 24*i;
+      chunks[i].offset = get<uint64_t>(p);
+      chunks[i].nbytes = get<uint64_t>(p + 8);
+      chunks[i].codec = get<int32_t>(p + 16);
+      chunks[i].type = get<int32_t>(p + 20);
+    }
+    return true;
+  }
+
+  // current frame
+
+  int64_t timestep() const { return step; }
+  int64_t natoms() const { return n; }
+  double time() const { return t; }
+  int triclinic() const { return tri; }
+  const double *box() const { return boxbounds; }   // xlo xhi ... xy xz yz
+  bool integer(int i) const
+    { return chunks[i].type == INT32 || chunks[i].type == INT64; }
+
+  // decode field I of current frame
+
+  void read(int i, std::vector<double> &out) const
+  {
+    std::vector<uint64_t> bits;
+    decode(i,bits);
+    out.resize(n);
+    for (int64_t k = 0; k < n; k++) out[k] = convert(chunks[i].type,bits[k]);
+  }
+
+  void read(int i, std::vector<int64_t> &out) const
+  {
+    std::vector<uint64_t> bits;
+    decode(i,bits);
+    out.resize(n);
+    for (int64_t k = 0; k < n; k++)
+      out[k] = (int64_t) convert(chunks[i].type,bits[k]);
+  }
+
+  std::vector<Field> fields;
+
+ private:
+  const unsigned char *base;
+  size_t size;
+  size_t next_pos;           // start of next frame
+
+  size_t frame;              // start of current frame
+  int64_t step,n;
+  int tri;
+  double boxbounds[9];
+  double t;
+  std::vector<Chunk> chunks;
+
+  template <typename T> T get(size_t pos) const
+  {
+    T value;
+    memcpy(&value,base + pos,sizeof(T));
+    return value;
+  }
+
+  static double convert(int type, uint64_t bits)
+  {
+    if (type == INT32) return (double) (int32_t) (uint32_t) bits;
+    if (type == INT64) return (double) (int64_t) bits;
+    if (type == FLOAT32) {
+      uint32_t b = bits;
+      float f;
+      memcpy(&f,&b,4);
+      return f;
+    }
+    double d;
+    memcpy(&d,&bits,8);
+    return d;
+  }
+
+  // chunk bytes to one value per atom, as unsigned bits
+
+  void decode(int i, std::vector<uint64_t> &bits) const
+  {
+    const Chunk &c = chunks[i];
+    const unsigned char *src = base + frame + c.offset;
+    int w = (c.type == INT32 || c.type == FLOAT32) ? 4 : 8;
+
+    std::vector<unsigned char> inflated;
+    if (c.codec & DEFLATE) {
+#if defined(SSA_TSDPD_ZLIB)
+      uLongf nout = (c.codec & ~DEFLATE) == SHUFFLE ? n*w : n*10 + 16;
+      inflated.resize(nout);
+      if (uncompress(&inflated[0],&nout,src,c.nbytes) != Z_OK)
+        throw std::runtime_error("cannot inflate field");
+      src = &inflated[0];
+#else
+      throw std::runtime_error("zlib compressed field, "
+                               "rebuild reader with -DSSA_TSDPD_ZLIB");
+#endif
+    }
+
+    bits.assign(n,0);
+    int base_codec = c.codec & ~DEFLATE;
+    int64_t k;
+    int j;
+
+    if (base_codec == RAW) {
+      for (k = 0; k < n; k++)
+        for (j = 0; j < w; j++) bits[k] |= (uint64_t) src[k*w+j] << 8*j;
+
+    } else if (base_codec == SHUFFLE) {
+      for (j = 0; j < w; j++)
+        for (k = 0; k < n; k++) bits[k] |= (uint64_t) src[j*n+k] << 8*j;
+
+    } else if (base_codec == VARINT) {
+      const unsigned char *p = src;
+      int64_t prev = 0;
+      for (k = 0; k < n; k++) {
+        uint64_t z = 0;
+        int shift = 0;
+        while (*p & 0x80) {
+          z |= (uint64_t) (*p++ & 0x7f) << shift;
+          shift += 7;
+        }
+        z |= (uint64_t) *p++ << shift;
+        int64_t delta = (int64_t) (z >> 1) ^ -(int64_t) (z & 1);
+        prev += delta;
+        bits[k] = (uint64_t) prev;
+      }
+
+    } else if (base_codec == XOR) {
+      const unsigned char *p = src + n;
+      uint64_t prev = 0;
+      for (k = 0; k < n; k++) {
+        uint64_t x = 0;
+        for (j = 0; j < src[k]; j++) x |= (uint64_t) *p++ << 8*j;
+        prev ^= x;
+        bits[k] = prev;
+      }
+
+    } else throw std::runtime_error("unknown codec");
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,172 @@
+"""Streaming reader for files written by dump ssa_tsdpd/col
+
+The file is memory mapped and only the index of each frame is parsed
+while iterating, field chunks are decoded on request with numpy.
+
+  from ssa_col import ColFile
+  col = ColFile("dump.col")
+  for frame in col.frames(first=1000, every=100):
+      c0 = frame["C_[0]"]
+
+  steps, c0 = col.series("C_[0]")      # 2d array, one row per frame
+
+See README for the file layout.
+"""
+
+import mmap
+import struct
+import zlib
+
+import numpy as np
+
+INT32, INT64, FLOAT32, FLOAT64 = range(4)
+RAW, VARINT, XOR, SHUFFLE = range(4)
+DEFLATE = 16
+
+_dtype = {INT32: np.int32, INT64: np.int64,
+          FLOAT32: np.float32, FLOAT64: np.float64}
+_width = {INT32: 4, INT64: 8, FLOAT32: 4, FLOAT64: 8}
+_bits = {4: np.uint32, 8: np.uint64}
+
+
+class Frame(object):
+    """One snapshot, fields are decoded when they are accessed"""
+
+    def __init__(self, buf, start, size):
+        self._buf = buf
+        self._start = start
+        (index,) = struct.unpack_from("<Q", buf, start + size - 16)
+        if buf[start + size - 8:start + size - 4] != b"IDX1":
+            raise IOError("corrupt frame index")
+        p = start + index
+        self.timestep, self.natoms, self.triclinic, nfield = \
+            struct.unpack_from("<qqii", buf, p)
+        values = struct.unpack_from("<10d", buf, p + 24)
+        self.box = values[:9]
+        self.time = values[9]
+        self._chunks = [struct.unpack_from("<QQii", buf, p + 104 + 24*i)
+                        for i in range(nfield)]
+        self.names = None
+
+    def __getitem__(self, name):
+        return self.field(self.names.index(name))
+
+    def field(self, i):
+        offset, nbytes, codec, ftype = self._chunks[i]
+        n = self.natoms
+        w = _width[ftype]
+        p = self._start + offset
+        if codec == RAW:
+            # no copy, the array maps the file
+            return np.frombuffer(self._buf, dtype=_dtype[ftype], count=n,
+                                 offset=p)
+
+        data = self._buf[p:p + nbytes]
+        if codec & DEFLATE:
+            data = zlib.decompress(data)
+        data = np.frombuffer(data, dtype=np.uint8)
+        codec &= ~DEFLATE
+
+        if codec == SHUFFLE:
+            bits = data[:n*w].reshape(w, n).T.copy().view("<u%d" % w)
+            return bits.ravel().view(_dtype[ftype]).copy()
+        if codec == VARINT:
+            return _varint(data, n).astype(_dtype[ftype])
+        if codec == XOR:
+            return _xor(data, n, w).view(_dtype[ftype])
+        raise IOError("unknown codec %d" % codec)
+
+
+def _varint(data, n):
+    """zigzag delta LEB128 varints to int64"""
+    if n == 0:
+        return np.zeros(0, dtype=np.int64)
+    last = np.flatnonzero(data < 0x80)[:n]
+    start = np.empty(n, dtype=np.int64)
+    start[0] = 0
+    start[1:] = last[:-1] + 1
+    count = last - start + 1
+    row = np.repeat(np.arange(n), count)
+    shift = (np.arange(last[-1] + 1) - np.repeat(start, count)) * 7
+    z = np.zeros(n, dtype=np.uint64)
+    np.bitwise_or.at(z, row, (data[:last[-1] + 1] & 0x7f).astype(np.uint64)
+                     << shift.astype(np.uint64))
+    delta = (z >> np.uint64(1)).astype(np.int64) ^ \
+        -(z & np.uint64(1)).astype(np.int64)
+    return np.cumsum(delta)
+
+
+def _xor(data, n, w):
+    """XOR with previous value, low nonzero bytes only"""
+    count = data[:n].astype(np.int64)
+    mask = np.arange(w) < count[:, None]
+    full = np.zeros((n, w), dtype=np.uint8)
+    full[mask] = data[n:n + count.sum()]
+    x = full.view("<u%d" % w).ravel()
+    return np.bitwise_xor.accumulate(x).astype(_bits[w])
+
+
+class ColFile(object):
+    """dump ssa_tsdpd/col file"""
+
+    def __init__(self, path):
+        self._file = open(path, "rb")
+        self._buf = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+        buf = self._buf
+        if buf[:8] != b"SSACOL01":
+            raise IOError("not a ssa_tsdpd/col file: " + path)
+        one, version, nfield = struct.unpack_from("<iii", buf, 8)
+        if one != 1:
+            raise IOError("file was written with other byte order")
+        self.fields = []
+        p = 20
+        for i in range(nfield):
+            ftype, n = struct.unpack_from("<ii", buf, p)
+            self.fields.append(buf[p + 8:p + 8 + n].decode())
+            p += 8 + n
+        self._first = (p + 7) // 8 * 8
+
+    def close(self):
+        self._buf.close()
+        self._file.close()
+
+    def frames(self, first=None, last=None, every=1):
+        """iterate over complete frames with first <= timestep <= last"""
+        buf = self._buf
+        p = self._first
+        while p + 16 <= len(buf):
+            if buf[p:p + 4] != b"FRM1":
+                raise IOError("corrupt frame header")
+            (size,) = struct.unpack_from("<Q", buf, p + 8)
+            if p + size > len(buf):
+                break
+            frame = Frame(buf, p, size)
+            frame.names = self.fields
+            p += size
+            step = frame.timestep
+            if first is not None and step < first:
+                continue
+            if last is not None and step > last:
+                continue
+            if (step - (first or 0)) % every:
+                continue
+            yield frame
+
+    def series(self, name, first=None, last=None, every=1):
+        """timesteps and 2d array of one field, one row per frame"""
+        steps, rows = [], []
+        for frame in self.frames(first, last, every):
+            steps.append(frame.timestep)
+            rows.append(frame[name])
+        return np.array(steps), np.array(rows)
+
+
+if __name__ == "__main__":
+    import sys
+    for path in sys.argv[1:]:
+        col = ColFile(path)
+        print("%s: fields %s" % (path, " ".join(col.fields)))
+        for frame in col.frames():
+            print("  step %d atoms %d time %g" %
+                  (frame.timestep, frame.natoms, frame.time))
+        col.close()
@@ -0,0 +1,145 @@
+#!/usr/bin/env python
+"""Regression of the mixed-precision SDPD pair styles of USER-SSA-TSDPD
+
+  python mixed_check.py -l ../../src/lmp_mpi -m ../../src/lmp_mixed
+  python mixed_check.py -l lmp_mpi -m lmp_mixed -n 4 -o report.json
+
+Runs in.mixed with pair styles ssa_tsdpd/wt and ssa_tsdpd/wc, once with
+an executable built in double precision (-l) and once with one built
+with -DSSA_TSDPD_MIXED (-m), and compares every snapshot atom by atom:
+
+  x        max |dx|, |dy| over the lattice spacing
+  v        max |dvx|, |dvy| over the largest velocity component
+  rho      max |drho| over the largest density
+  C        max |dC| over the largest concentration
+
+A quantity passes if its deviation is below its tolerance in TOLERANCE.
+Both runs use the same seed, so the random stress differs only by the
+rounding of its amplitude. The exit status is 0 if everything passes.
+Two bitwise identical runs also pass but are reported, since the -m
+executable was then most likely not built with -DSSA_TSDPD_MIXED.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+import numpy as np
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, HERE)
+from ssa_equiv import read_dump  # noqa: E402
+
+SPACING = 0.05  # lattice spacing of in.mixed
+STYLES = ["wt", "wc"]
+
+# deviations measured over 200 steps on 2 procs, both styles:
+#   x 2.5e-9, v 9.5e-7, rho 1.1e-8, C 4.1e-6
+# single precision rounding of the per-pair math is about 6e-8, the
+# tolerances leave a margin of 100 or more for other inputs and compilers
+
+TOLERANCE = {"x": 1e-6, "v": 1e-4, "rho": 1e-6, "C": 1e-4}
+ORDER = ["x", "v", "rho", "C"]
+
+
+def run(args, lmp, style, tag):
+    out = os.path.join(args.workdir, "dump.%s.%s" % (style, tag))
+    log = os.path.join(args.workdir, "log.%s.%s" % (style, tag))
+    cmd = args.mpirun.format(np=args.nprocs).split() + [
+        lmp, "-in", os.path.join(HERE, "in.mixed"), "-log", log,
+        "-screen", "none", "-var", "out", out, "-var", "style", style,
+        "-var", "steps", str(args.steps)]
+    if os.path.exists(out):
+        os.remove(out)
+    status = subprocess.call(cmd)
+    if status != 0 or not os.path.exists(out):
+        raise RuntimeError("%s failed, see %s" % (" ".join(cmd), log))
+    return read_dump(out)
+
+
+def deviations(a, b):
+    """relative deviations of one snapshot, atoms matched by id"""
+    if not np.array_equal(a["id"], b["id"]):
+        raise RuntimeError("atom ids differ")
+
+    def rel(cols, scale):
+        d = max(np.abs(a[c] - b[c]).max() for c in cols)
+        return d/scale if scale > 0.0 else d
+
+    vmax = max(np.abs(a[c]).max() for c in ("vx", "vy"))
+    return {"x": rel(("x", "y"), SPACING),
+            "v": rel(("vx", "vy"), vmax),
+            "rho": rel(("c_rho",), np.abs(a["c_rho"]).max()),
+            "C": rel(("C_[0]",), np.abs(a["C_[0]"]).max())}
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    p.add_argument("-l", "--lmp",
+                   default=os.path.join(HERE, "..", "..", "src", "lmp_mpi"),
+                   help="LAMMPS executable in double precision")
+    p.add_argument("-m", "--mixed",
+                   default=os.path.join(HERE, "..", "..", "src", "lmp_mixed"),
+                   help="LAMMPS executable built with -DSSA_TSDPD_MIXED")
+    p.add_argument("-s", "--styles", nargs="+", default=STYLES,
+                   choices=STYLES)
+    p.add_argument("-n", "--nprocs", type=int, default=1)
+    p.add_argument("--steps", type=int, default=200,
+                   help="timesteps (default 200)")
+    p.add_argument("--mpirun", default="mpirun -np {np}",
+                   help="launcher, {np} is replaced (default '%(default)s')")
+    p.add_argument("--workdir", default="mixed",
+                   help="directory of the dumps and logs (default mixed)")
+    p.add_argument("-o", "--output", default=None, help="JSON report")
+    args = p.parse_args()
+
+    if not os.path.isdir(args.workdir):
+        os.makedirs(args.workdir)
+
+    results = []
+    for style in args.styles:
+        try:
+            ref = run(args, args.lmp, style, "double")
+            test = run(args, args.mixed, style, "mixed")
+            worst = dict((k, 0.0) for k in ORDER)
+            for step in sorted(ref):
+                d = deviations(ref[step], test[step])
+                for k in ORDER:
+                    worst[k] = max(worst[k], d[k])
+        except (RuntimeError, KeyError) as e:
+            results.append({"style": style, "error": str(e), "pass": False})
+            continue
+        r = {"style": style, "deviation": worst,
+             "identical": all(v == 0.0 for v in worst.values()),
+             "pass": all(worst[k] <= TOLERANCE[k] for k in ORDER)}
+        results.append(r)
+
+    ok = True
+    for r in results:
+        ok = ok and r["pass"]
+        if "error" in r:
+            print("%-4s %s" % (r["style"], r["error"]))
+            continue
+        print("%-4s %s  %s%s" %
+              (r["style"],
+               " ".join("%s=%.2e/%.0e" % (k, r["deviation"][k], TOLERANCE[k])
+                        for k in ORDER),
+               "ok" if r["pass"] else "FAIL",
+               "  (identical, is -m built with -DSSA_TSDPD_MIXED?)"
+               if r["identical"] else ""))
+    print("%s" % ("PASS" if ok else "FAIL"))
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump({"tolerance": TOLERANCE, "pass": ok,
+                       "results": results}, f, indent=2)
+            f.write("\n")
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,457 @@
+#!/usr/bin/env python
+"""Statistical equivalence tests of the SSA engine of USER-SSA-TSDPD
+
+  python ssa_equiv.py -l ../../src/lmp_mpi                 all tests
+  python ssa_equiv.py -l lmp_new -r lmp_old -n 4           also against lmp_old
+  python ssa_equiv.py -t decay dimer -o report.json
+
+Every test runs one input of this directory, whose replicas are
+independent copies of the same system, and compares the copy numbers
+Cd of each snapshot with their exact distribution
+
+  diffusion_1d, diffusion_2d   Poisson, with the mean of the tDPD field C
+                               computed in the same run
+  decay, birthdeath            binomial and Poisson
+  dimer, annihilation          master equation, solved numerically
+
+by the mean and the variance (sum of squared z-scores over the voxels),
+a chi-square test of the copy-number histograms and a Kolmogorov-Smirnov
+test of the randomized probability integral transform of all samples.
+With -r the same inputs are run with a second executable and compared
+with chi-square tests of homogeneity and a two-sample KS test.
+
+A test passes if none of its p-values is below alpha divided by the
+total number of p-values (Bonferroni). The exit status is 0 if all
+tests pass. A run that fails is reported and fails its test.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import math
+import os
+import subprocess
+import sys
+
+import numpy as np
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+VOLUME = 0.5    # voxel volume of in.reaction
+
+# the tDPD mean of the diffusion tests is integrated with the same
+# timestep, which is small enough for its error to stay well below
+# the sampling error; the reactions are exact for any timestep and
+# fire several times per step
+
+DIFFUSION = {"dt": 2.5e-3, "steps": 4000, "every": 1000}
+REACTION = {"dt": 1e-2, "steps": 50, "every": 10}
+
+TESTS = {
+    "diffusion_1d": ("in.diffusion_1d", dict(DIFFUSION, R=400)),
+    "diffusion_2d": ("in.diffusion_2d", dict(DIFFUSION, P=8)),
+    "decay": ("in.reaction", dict(REACTION, network="decay", n0=100,
+                                  k1=4.0)),
+    "birthdeath": ("in.reaction", dict(REACTION, network="birthdeath",
+                                       k1=400.0, k2=10.0)),
+    "dimer": ("in.reaction", dict(REACTION, network="dimer", n0=100,
+                                  k1=0.04)),
+    "annihilation": ("in.reaction", dict(REACTION, network="annihilation",
+                                         n0=100, k1=0.08)),
+}
+ORDER = ["diffusion_1d", "diffusion_2d", "decay", "birthdeath", "dimer",
+         "annihilation"]
+
+
+# ----------------------------------------------------------------------
+# distributions
+
+def poisson_pmf(mu, n):
+    k = np.arange(n)
+    if mu <= 0.0:
+        p = np.zeros(n)
+        p[0] = 1.0
+        return p
+    lg = np.array([math.lgamma(i + 1.0) for i in k])
+    return np.exp(k*math.log(mu) - mu - lg)
+
+
+def binomial_pmf(n0, q, n):
+    p = np.zeros(n)
+    for k in range(n0 + 1):
+        p[k] = math.exp(math.lgamma(n0 + 1.0) - math.lgamma(k + 1.0) -
+                        math.lgamma(n0 - k + 1.0)) * q**k * (1.0 - q)**(n0 - k)
+    return p
+
+
+def expm(a):
+    """matrix exponential by scaling and squaring of a Taylor series"""
+    norm = np.abs(a).sum(axis=0).max()
+    s = max(0, int(math.ceil(math.log(norm, 2))) + 1) if norm > 0 else 0
+    a = a / 2.0**s
+    e = np.eye(len(a))
+    term = np.eye(len(a))
+    for k in range(1, 30):
+        term = term.dot(a) / k
+        e = e + term
+    for _ in range(s):
+        e = e.dot(e)
+    return e
+
+
+def death_pmf(n0, step, rate, t, n):
+    """pure death process n -> n-step at the given rate(n), from n0"""
+    states = list(range(n0, -1, -step))
+    m = len(states)
+    q = np.zeros((m, m))
+    for i, s in enumerate(states):
+        if i + 1 < m:
+            q[i + 1, i] = rate(s)
+            q[i, i] = -rate(s)
+    p0 = np.zeros(m)
+    p0[0] = 1.0
+    pt = expm(q * t).dot(p0)
+    p = np.zeros(n)
+    for i, s in enumerate(states):
+        p[s] = max(pt[i], 0.0)
+    return p / p.sum()
+
+
+def reference(name, params, t, mean, n):
+    """exact pmf of a voxel on 0..n-1, mean = tDPD value for diffusion"""
+    if name.startswith("diffusion"):
+        return poisson_pmf(mean, n)
+    k1 = params.get("k1", 1.0)
+    if name == "decay":
+        return binomial_pmf(params["n0"], math.exp(-k1*t), n)
+    if name == "birthdeath":
+        k2 = params["k2"]
+        return poisson_pmf(k1*VOLUME/k2*(1.0 - math.exp(-k2*t)), n)
+    # propensities of fix ssa_tsdpd/ssa_rxn_mass_action
+    c = k1/VOLUME/2.0
+    if name == "dimer":
+        return death_pmf(params["n0"], 2, lambda s: c*s*(s - 1), t, n)
+    return death_pmf(params["n0"], 1, lambda s: c*s*s, t, n)
+
+
+# ----------------------------------------------------------------------
+# tests, all return a p-value
+
+def chi2_sf(x, dof):
+    """upper tail of the chi-square distribution"""
+    if dof <= 0:
+        return 1.0
+    if x <= 0.0:
+        return 1.0
+    a, x = 0.5*dof, 0.5*x
+    gln = math.lgamma(a)
+    if x < a + 1.0:
+        term = total = 1.0/a
+        ap = a
+        for _ in range(10000):
+            ap += 1.0
+            term *= x/ap
+            total += term
+            if abs(term) < abs(total)*1e-15:
+                break
+        return max(0.0, 1.0 - total*math.exp(-x + a*math.log(x) - gln))
+    b = x + 1.0 - a
+    c = 1.0/1e-300
+    d = 1.0/b
+    h = d
+    for i in range(1, 10000):
+        an = -i*(i - a)
+        b += 2.0
+        d = an*d + b
+        d = 1e-300 if abs(d) < 1e-300 else d
+        c = b + an/c
+        c = 1e-300 if abs(c) < 1e-300 else c
+        d = 1.0/d
+        h *= d*c
+        if abs(d*c - 1.0) < 1e-15:
+            break
+    return math.exp(-x + a*math.log(x) - gln)*h
+
+
+def ks_sf(d, n):
+    """Kolmogorov distribution with the correction of Stephens"""
+    if n <= 0:
+        return 1.0
+    lam = (math.sqrt(n) + 0.12 + 0.11/math.sqrt(n))*d
+    if lam < 0.2:
+        return 1.0
+    total = 0.0
+    for j in range(1, 101):
+        term = 2.0*(-1)**(j - 1)*math.exp(-2.0*j*j*lam*lam)
+        total += term
+        if abs(term) < 1e-12:
+            break
+    return min(1.0, max(0.0, total))
+
+
+def ks_uniform(u):
+    u = np.sort(u)
+    n = len(u)
+    i = np.arange(1, n + 1)
+    d = max((i/n - u).max(), (u - (i - 1)/n).max())
+    return d, ks_sf(d, n)
+
+
+def ks_two(a, b):
+    a, b = np.sort(a), np.sort(b)
+    grid = np.concatenate([a, b])
+    d = np.abs(np.searchsorted(a, grid, side="right")/len(a) -
+               np.searchsorted(b, grid, side="right")/len(b)).max()
+    return d, ks_sf(d, len(a)*len(b)/float(len(a) + len(b)))
+
+
+def merge_bins(expected, *observed):
+    """adjacent bins merged until each expects at least 5 counts"""
+    edges = []
+    acc = 0.0
+    start = 0
+    for k, e in enumerate(expected):
+        acc += e
+        if acc >= 5.0:
+            edges.append((start, k + 1))
+            start, acc = k + 1, 0.0
+    if not edges:
+        return None
+    edges[-1] = (edges[-1][0], len(expected))
+    e = np.array([expected[i:j].sum() for i, j in edges])
+    o = [np.array([obs[i:j].sum() for i, j in edges]) for obs in observed]
+    return e, o
+
+
+def pit(x, cdf, pmf, rng):
+    """randomized probability integral transform, uniform under H0"""
+    lo = np.where(x > 0, cdf[np.maximum(x - 1, 0)], 0.0)
+    return lo + rng.uniform(size=len(x))*pmf[x]
+
+
+def one_sample(groups, rng):
+    """groups: list of (samples, pmf) sharing one exact distribution"""
+    z_mean = z_var = 0.0
+    n_mean = n_var = 0
+    chi2 = 0.0
+    dof = 0
+    u = []
+    worst = {"mean": 0.0, "var": 0.0}
+    for x, p in groups:
+        r = len(x)
+        k = np.arange(len(p))
+        mu = (k*p).sum()
+        var = ((k - mu)**2*p).sum()
+        mu4 = ((k - mu)**4*p).sum()
+        if var < 1e-12:
+            # deterministic, every sample has to be the mode
+            if np.any(x != np.argmax(p)):
+                return None
+            continue
+        z_mean += (x.mean() - mu)**2/(var/r)
+        n_mean += 1
+        vvar = (mu4 - var*var*(r - 3.0)/(r - 1.0))/r
+        if r > 3 and vvar > 0.0:
+            z_var += (x.var(ddof=1) - var)**2/vvar
+            n_var += 1
+        worst["mean"] = max(worst["mean"], abs(x.mean() - mu)/max(mu, 1.0))
+        worst["var"] = max(worst["var"], abs(x.var(ddof=1) - var)/var)
+        hist = np.bincount(x, minlength=len(p)).astype(float)
+        m = merge_bins(p*r, hist)
+        if m is not None and len(m[0]) > 1:
+            e, (o,) = m
+            chi2 += ((o - e)**2/e).sum()
+            dof += len(e) - 1
+        u.append(pit(x, np.cumsum(p), p, rng))
+    u = np.concatenate(u) if u else np.zeros(0)
+    d, p_ks = ks_uniform(u) if len(u) else (0.0, 1.0)
+    return {"p_mean": chi2_sf(z_mean, n_mean),
+            "p_var": chi2_sf(z_var, n_var),
+            "p_chi2": chi2_sf(chi2, dof),
+            "p_ks": p_ks,
+            "ks_d": d, "chi2": chi2, "dof": dof,
+            "max_rel_mean_err": worst["mean"],
+            "max_rel_var_err": worst["var"]}
+
+
+def two_sample(groups, rng):
+    """groups: list of (samples, reference samples, pmf)"""
+    chi2 = 0.0
+    dof = 0
+    z = 0.0
+    nz = 0
+    ua, ub = [], []
+    for a, b, p in groups:
+        n = max(len(p), a.max() + 1, b.max() + 1)
+        p = np.concatenate([p, np.zeros(n - len(p))])
+        ha = np.bincount(a, minlength=n).astype(float)
+        hb = np.bincount(b, minlength=n).astype(float)
+        tot = ha + hb
+        frac = len(a)/float(len(a) + len(b))
+        m = merge_bins(tot*min(frac, 1.0 - frac), ha, hb)
+        if m is not None and len(m[1][0]) > 1:
+            _, (oa, ob) = m
+            t = oa + ob
+            ea, eb = t*frac, t*(1.0 - frac)
+            chi2 += ((oa - ea)**2/ea).sum() + ((ob - eb)**2/eb).sum()
+            dof += len(t) - 1
+        s = a.var(ddof=1)/len(a) + b.var(ddof=1)/len(b)
+        if s > 0.0:
+            z += (a.mean() - b.mean())**2/s
+            nz += 1
+        cdf = np.cumsum(p)
+        ua.append(pit(a, cdf, p, rng))
+        ub.append(pit(b, cdf, p, rng))
+    d, p_ks = ks_two(np.concatenate(ua), np.concatenate(ub))
+    return {"p_mean2": chi2_sf(z, nz), "p_chi2_2": chi2_sf(chi2, dof),
+            "p_ks2": p_ks, "ks2_d": d}
+
+
+# ----------------------------------------------------------------------
+# runs
+
+def read_dump(path):
+    """snapshots as {step: {column: array}}"""
+    frames = {}
+    with open(path) as f:
+        lines = f.read().splitlines()
+    i = 0
+    while i < len(lines):
+        if lines[i].startswith("ITEM: TIMESTEP"):
+            step = int(lines[i + 1])
+            n = int(lines[i + 3])
+            cols = lines[i + 8].split()[2:]
+            data = np.array([l.split() for l in lines[i + 9:i + 9 + n]],
+                            dtype=float).reshape(n, len(cols))
+            frames[step] = dict((c, data[:, j]) for j, c in enumerate(cols))
+            i += 9 + n
+        else:
+            i += 1
+    return frames
+
+
+def run(args, lmp, name, tag):
+    infile, params = TESTS[name]
+    out = os.path.join(args.workdir, "dump.%s.%s" % (name, tag))
+    log = os.path.join(args.workdir, "log.%s.%s" % (name, tag))
+    cmd = args.mpirun.format(np=args.nprocs).split() + [
+        lmp, "-in", os.path.join(HERE, infile), "-log", log,
+        "-screen", "none", "-var", "out", out,
+        "-var", "diffusion", args.diffusion]
+    for k, v in sorted(params.items()):
+        cmd += ["-var", k, str(v)]
+    if args.replicas:
+        cmd += ["-var", "R" if name == "diffusion_1d" else "P",
+                str(args.replicas)]
+    if os.path.exists(out):
+        os.remove(out)
+    status = subprocess.call(cmd)
+    if status != 0 or not os.path.exists(out):
+        raise RuntimeError("%s failed, see %s" % (" ".join(cmd), log))
+    return read_dump(out)
+
+
+def sample_groups(name, params, step, frame):
+    """(key, samples, pmf) of each voxel and species of one snapshot"""
+    t = step*params["dt"]
+    voxel = frame["v_voxel"].astype(int)
+    volume = frame["mass"]/frame["c_rho"]
+    groups = []
+    for s in range(2):
+        col = "Cd_[%d]" % s
+        if col not in frame:
+            break
+        cd = np.rint(frame[col]).astype(int)
+        for v in np.unique(voxel):
+            sel = voxel == v
+            x = cd[sel]
+            mean = 0.0
+            if "C_[%d]" % s in frame:
+                mean = (frame["C_[%d]" % s][sel]*volume[sel]).mean()
+            n = int(max(x.max(), mean + 20.0*math.sqrt(mean + 1.0),
+                        params.get("n0", 0))) + 20
+            groups.append(((s, v), x, reference(name, params, t, mean, n)))
+    return groups
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    p.add_argument("-l", "--lmp",
+                   default=os.path.join(HERE, "..", "..", "src", "lmp_mpi"),
+                   help="LAMMPS executable under test")
+    p.add_argument("-r", "--ref", default=None,
+                   help="second executable to compare with (optional)")
+    p.add_argument("-t", "--tests", nargs="+", default=ORDER, choices=ORDER)
+    p.add_argument("-n", "--nprocs", type=int, default=1)
+    p.add_argument("-d", "--diffusion", default="ssa", choices=["ssa", "dfsp"],
+                   help="diffusion keyword of the pair style (default ssa)")
+    p.add_argument("-R", "--replicas", type=int, default=0,
+                   help="replicas (diffusion_1d) or replicas per direction")
+    p.add_argument("-a", "--alpha", type=float, default=0.01,
+                   help="family-wise significance level (default 0.01)")
+    p.add_argument("--mpirun", default="mpirun -np {np}",
+                   help="launcher, {np} is replaced (default '%(default)s')")
+    p.add_argument("--workdir", default="equiv",
+                   help="directory of the dumps and logs (default equiv)")
+    p.add_argument("--seed", type=int, default=12345,
+                   help="seed of the randomized PIT")
+    p.add_argument("-o", "--output", default=None, help="JSON report")
+    args = p.parse_args()
+
+    if not os.path.isdir(args.workdir):
+        os.makedirs(args.workdir)
+    rng = np.random.RandomState(args.seed)
+
+    results = []
+    for name in args.tests:
+        params = TESTS[name][1]
+        try:
+            frames = run(args, args.lmp, name, "test")
+            ref = run(args, args.ref, name, "ref") if args.ref else None
+        except RuntimeError as e:
+            results.append({"test": name, "error": str(e), "pass": False})
+            continue
+        for step in sorted(frames):
+            if step == 0:
+                continue
+            groups = sample_groups(name, params, step, frames[step])
+            r = one_sample([(x, pmf) for _, x, pmf in groups], rng)
+            if r is None:
+                r = {"p_impossible": 0.0}
+            if ref is not None:
+                rg = dict((k, x) for k, x, _ in
+                          sample_groups(name, params, step, ref[step]))
+                r.update(two_sample([(x, rg[k], pmf) for k, x, pmf in groups],
+                                    rng))
+            r.update({"test": name, "step": step, "time": step*params["dt"],
+                      "samples": int(sum(len(x) for _, x, _ in groups))})
+            results.append(r)
+
+    npvalues = sum(len([k for k in r if k.startswith("p_")]) for r in results)
+    threshold = args.alpha/max(npvalues, 1)
+    ok = True
+    for r in results:
+        if "error" in r:
+            ok = False
+            print("%-13s %s" % (r["test"], r["error"]))
+            continue
+        pv = dict((k, v) for k, v in r.items() if k.startswith("p_"))
+        r["pass"] = bool(min(pv.values()) >= threshold)
+        ok = ok and r["pass"]
+        print("%-13s t=%-6g n=%-7d %s  %s" %
+              (r["test"], r["time"], r["samples"],
+               " ".join("%s=%.3g" % (k[2:], v) for k, v in sorted(pv.items())),
+               "ok" if r["pass"] else "FAIL"))
+    print("%d p-values, threshold %.3g: %s" %
+          (npvalues, threshold, "PASS" if ok else "FAIL"))
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump({"alpha": args.alpha, "threshold": threshold,
+                       "pass": ok, "results": results}, f, indent=2)
+            f.write("\n")
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()